@@ -54,10 +54,18 @@ OF SUCH DAMAGE.
 #define ENET_RXBUF_SIZE                  ENET_MAX_FRAME_SIZE                    /*!< ethernet receive buffer size */
 #endif
 
+#ifndef ENET_RXFRAME_SEG_NUM
+#define ENET_RXFRAME_SEG_NUM             ENET_RXBUF_NUM                         /*!< max number of Rx descriptors a received frame spans */
+#endif
+
 #ifndef ENET_TXBUF_SIZE
 #define ENET_TXBUF_SIZE                  ENET_MAX_FRAME_SIZE                    /*!< ethernet transmit buffer size */
 #endif
 
+/* define ENET_RING_SECTION as a linker section name (e.g. ".enet_ram") to place the default descriptors
+   and buffers in a dedicated SRAM bank, so DMA does not contend with the CPU for the bank it runs in */
+//#define ENET_RING_SECTION                ".enet_ram"
+
 /* #define SELECT_DESCRIPTORS_ENHANCED_MODE */
 
 /* #define USE_DELAY */
@@ -859,6 +867,7 @@ typedef enum
 typedef enum
 {
     ENET_AUTO_NEGOTIATION           = 0x01u,                                        /*!< PHY auto negotiation */
+    ENET_PHY_DEFERRED               = 0x02U,                                        /*!< PHY run by the application, speed and duplex set by enet_media_config() */
     ENET_100M_FULLDUPLEX            = (ENET_MAC_CFG_SPD | ENET_MAC_CFG_DPM),        /*!< 100Mbit/s, full-duplex */
     ENET_100M_HALFDUPLEX            = ENET_MAC_CFG_SPD ,                            /*!< 100Mbit/s, half-duplex */
     ENET_10M_FULLDUPLEX             = ENET_MAC_CFG_DPM,                             /*!< 10Mbit/s, full-duplex */
@@ -987,6 +996,66 @@ typedef struct
     uint32_t sign;                                                                  /*!< sign of system time */
 }enet_ptp_systime_struct;
 
+/* structure of a received frame lent to application without data copy */
+typedef struct
+{
+    uint8_t *buffer;                                                                /*!< frame data in the DMA receive buffer, the first segment */
+    uint32_t length;                                                                /*!< frame length */
+    uint32_t segments;                                                              /*!< number of segments, one per descriptor */
+    uint32_t checksum;                                                              /*!< checksum offload results, ENET_RXCSUM_x flags */
+    uint8_t *seg_buffer[ENET_RXFRAME_SEG_NUM];                                      /*!< data of each segment in the DMA receive buffers */
+    uint32_t seg_length[ENET_RXFRAME_SEG_NUM];                                      /*!< data length of each segment */
+}enet_rxframe_struct;
+
+/* structure of a transmit frame fragment, sent in place by DMA */
+typedef struct
+{
+    uint8_t *buffer;                                                                /*!< fragment data */
+    uint32_t length;                                                                /*!< fragment length */
+}enet_txfrag_struct;
+
+/* structure of the descriptor rings and buffers provided by application */
+typedef struct
+{
+    enet_descriptors_struct *rxdesc;                                                /*!< Rx descriptor table of rxdesc_num descriptors */
+    enet_descriptors_struct *txdesc;                                                /*!< Tx descriptor table of txdesc_num descriptors */
+    uint8_t *rxbuf;                                                                 /*!< rxdesc_num receive buffers of rxbuf_size bytes */
+    uint8_t *txbuf;                                                                 /*!< txdesc_num transmit buffers of txbuf_size bytes */
+    void **txtoken;                                                                 /*!< txdesc_num entries for enet_frame_transmit_sg(), can be NULL */
+    uint32_t rxdesc_num;                                                            /*!< number of Rx descriptors */
+    uint32_t txdesc_num;                                                            /*!< number of Tx descriptors */
+    uint32_t rxbuf_size;                                                            /*!< size of each receive buffer, multiple of 4 */
+    uint32_t txbuf_size;                                                            /*!< size of each transmit buffer */
+}enet_ring_struct;
+
+/* statistics of the checksum offload */
+typedef struct
+{
+    uint32_t rx_verified;                                                           /*!< received IP frames whose checksums are all verified good by hardware */
+    uint32_t rx_error;                                                              /*!< received IP frames with a checksum error found by hardware */
+    uint32_t rx_unverified;                                                         /*!< received IP frames not fully verified by hardware, left to software */
+    uint32_t tx_offload;                                                            /*!< frames transmitted with checksum insertion */
+    uint32_t tx_software;                                                           /*!< frames transmitted without checksum insertion */
+}enet_checksum_stat_struct;
+
+/* release callback of the application buffers of a sent frame */
+typedef void (*enet_txrelease_callback)(void *token);
+
+/* handler of a frame lent by enet_rx_poll(), it releases the frame when done */
+typedef void (*enet_rxframe_handler)(enet_rxframe_struct *frame);
+
+/* statistics of the Rx poll mode */
+typedef struct
+{
+    uint32_t interrupts;                                                            /*!< Rx interrupts which masked Rx interrupt and scheduled a poll */
+    uint32_t polls;                                                                 /*!< calls of enet_rx_poll() */
+    uint32_t frames;                                                                /*!< frames handled by all the polls */
+    uint32_t dropped;                                                               /*!< bad frames dropped by all the polls, counted in their budget */
+    uint32_t budget_exhausted;                                                      /*!< polls which used up the budget, Rx interrupt stays masked */
+    uint32_t frames_last;                                                           /*!< frames handled by the last poll */
+    uint32_t frames_max;                                                            /*!< most frames handled by one poll */
+}enet_rxpoll_stat_struct;
+
 /* mac_cfg register value */
 #define MAC_CFG_BOL(regval)                       (BITS(5,6) & ((uint32_t)(regval) << 5))       /*!< write value to ENET_MAC_CFG_BOL bit field */
 #define ENET_BACKOFFLIMIT_10                      MAC_CFG_BOL(0)                                /*!< min (n, 10) */
@@ -1384,6 +1453,14 @@ typedef struct
 #define ENET_CHECKSUM_TCPUDPICMP_SEGMENT          TDES0_CM(2)                                   /*!< TCP/UDP/ICMP checksum insertion calculated but pseudo-header  */ 
 #define ENET_CHECKSUM_TCPUDPICMP_FULL             TDES0_CM(3)                                   /*!< TCP/UDP/ICMP checksum insertion fully calculated */ 
 
+/* checksum offload results of a received frame */
+#define ENET_RXCSUM_IP                            BIT(0)                                        /*!< IPv4 or IPv6 frame */
+#define ENET_RXCSUM_IPV6                          BIT(1)                                        /*!< IPv6 frame, only reported by enhanced descriptors */
+#define ENET_RXCSUM_IPHDR_OK                      BIT(2)                                        /*!< IP header checksum verified good, or no header checksum in IPv6 */
+#define ENET_RXCSUM_PAYLOAD_OK                    BIT(3)                                        /*!< TCP/UDP/ICMP checksum verified good */
+#define ENET_RXCSUM_IPHDR_ERR                     BIT(4)                                        /*!< IP header checksum error */
+#define ENET_RXCSUM_PAYLOAD_ERR                   BIT(5)                                        /*!< TCP/UDP/ICMP checksum error */
+
 /* dma tx descriptor tdes1 register value */
 #define TDES1_TB1S(regval)                        (BITS(0,12) & ((uint32_t)(regval) << 0))      /*!< write value to ENET DMA TDES1 TB1S bit field */
 
@@ -1450,6 +1527,7 @@ typedef enum{
 
 /* ENET frame size */ 
 #define ENET_MAX_FRAME_SIZE                       1524U                                         /*!< header + frame_extra + payload + CRC */    
+#define ENET_MAX_JUMBO_FRAME_SIZE                 16384U                                        /*!< max frame when watchdog and jabber are disabled */
 
 /* ENET delay timeout */
 #define ENET_DELAY_TO                             ((uint32_t)0x0004FFFFU)                       /*!< ENET delay timeout */
@@ -1469,6 +1547,14 @@ ErrStatus enet_init(enet_mediamode_enum mediamode, enet_chksumconf_enum checksum
 ErrStatus enet_software_reset(void);
 /* check receive frame valid and return frame size */
 uint32_t enet_rxframe_size_get(void);
+/* use application provided descriptor rings and buffers, or the default ones */
+ErrStatus enet_ring_config(enet_ring_struct *ring);
+/* get the size of each transmit buffer of the configured ring */
+uint32_t enet_txbuf_size_get(void);
+/* get the buffer of the current transmit descriptor, to build a frame in place */
+uint8_t *enet_txbuf_current_get(void);
+/* get the number of transmit descriptors free for new frames */
+uint32_t enet_txdesc_free_get(void);
 /* initialize the dma tx/rx descriptors's parameters in chain mode */
 void enet_descriptors_chain_init(enet_dmadirection_enum direction);
 /* initialize the dma tx/rx descriptors's parameters in ring mode */
@@ -1477,12 +1563,44 @@ void enet_descriptors_ring_init(enet_dmadirection_enum direction);
 ErrStatus enet_frame_receive(uint8_t *buffer, uint32_t bufsize);
 /* handle current received frame but without data copy to application buffer */
 #define ENET_NOCOPY_FRAME_RECEIVE()         enet_frame_receive(NULL, 0U)
+/* provide the spare buffers used to re-arm Rx descriptors while received frames are lent out */
+void enet_rxbuf_pool_init(uint8_t *pool, uint32_t num);
+/* lend current received frame to application without data copy */
+ErrStatus enet_frame_receive_borrow(enet_rxframe_struct *frame);
+/* give a buffer lent by enet_frame_receive_borrow() back to the driver */
+void enet_frame_receive_release(uint8_t *buffer);
+/* give all the segment buffers of a lent frame back to the driver */
+void enet_rxframe_release(enet_rxframe_struct *frame);
+/* copy the segments of a lent frame to a contiguous application buffer */
+uint32_t enet_rxframe_copy(enet_rxframe_struct *frame, uint8_t *buffer, uint32_t bufsize);
 /* handle application buffer data to transmit it */
 ErrStatus enet_frame_transmit(uint8_t *buffer, uint32_t length);
 /* handle current transmit frame but without data copy from application buffer */
 #define ENET_NOCOPY_FRAME_TRANSMIT(len)     enet_frame_transmit(NULL, (len))
+/* transmit a frame made of several fragments, each fragment is sent in place by one descriptor */
+ErrStatus enet_frame_transmit_sg(enet_txfrag_struct frag[], uint32_t num, uint32_t checksum, void *token);
+/* reclaim the descriptors sent by DMA, and release the application buffers of the sent frames */
+uint32_t enet_tx_reclaim(enet_txrelease_callback release);
+/* configure the Rx poll mode, with optional Rx interrupt delay on all the Rx descriptors */
+void enet_rx_poll_config(uint32_t delay_time);
+/* Rx interrupt service of the poll mode, mask Rx interrupt and tell whether to schedule a poll */
+FlagStatus enet_rx_poll_irq(void);
+/* handle up to budget received frames, unmask Rx interrupt when the ring is drained */
+uint32_t enet_rx_poll(uint32_t budget, enet_rxframe_handler handler);
+/* get the statistics of the Rx poll mode */
+void enet_rx_poll_stat_get(enet_rxpoll_stat_struct *stat);
+/* get the occupancy of the RxDMA descriptor ring */
+uint32_t enet_rxdesc_occupancy_get(uint32_t *total);
 /* configure the transmit IP frame checksum offload calculation and insertion */
 ErrStatus enet_transmit_checksum_config(enet_descriptors_struct *desc, uint32_t checksum);
+/* handle application buffer data to transmit it with checksum insertion */
+ErrStatus enet_frame_transmit_checksum(uint8_t *buffer, uint32_t length, uint32_t checksum);
+/* get the checksum offload results of current received frame */
+uint32_t enet_rxframe_checksum_get(void);
+/* get the statistics of the checksum offload */
+void enet_checksum_stat_get(enet_checksum_stat_struct *stat);
+/* clear the statistics of the checksum offload */
+void enet_checksum_stat_clear(void);
 /* ENET Tx and Rx function enable (include MAC and DMA module) */
 void enet_enable(void);   
 /* ENET Tx and Rx function disable (include MAC and DMA module) */
@@ -1526,8 +1644,16 @@ void enet_address_filter_disable(enet_macaddress_enum mac_addr);
 void enet_address_filter_config(enet_macaddress_enum mac_addr, uint32_t addr_mask, uint32_t filter_type);
 /* PHY interface configuration (configure SMI clock and reset PHY chip) */
 ErrStatus enet_phy_config(void);
+/* configure the SMI clock according to HCLK */
+ErrStatus enet_phy_clock_config(void);
 /* write to/read from a PHY register */
 ErrStatus enet_phy_write_read(enet_phydirection_enum direction, uint16_t phy_address, uint16_t phy_reg, uint16_t *pvalue);
+/* start a write to/read from a PHY register without waiting for it */
+ErrStatus enet_phy_access_start(enet_phydirection_enum direction, uint16_t phy_address, uint16_t phy_reg, uint16_t value);
+/* check whether the PHY register access started by enet_phy_access_start() is complete */
+FlagStatus enet_phy_access_complete(uint16_t *pvalue);
+/* configure the MAC speed and duplex mode */
+void enet_media_config(enet_mediamode_enum mediamode);
 /* enable the loopback function of phy chip */
 ErrStatus enet_phyloopback_enable(void);
 /* disable the loopback function of phy chip */
@@ -34,34 +34,46 @@ OF SUCH DAMAGE.
 
 #include "gd32f30x_enet.h"
 #include <stdlib.h>
+#include <string.h>
+
+/* optional dedicated section of the default descriptors and buffers */
+#ifdef ENET_RING_SECTION
+#if defined ( __ICCARM__ )
+#define ENET_RING_PLACE     @ ENET_RING_SECTION
+#else
+#define ENET_RING_PLACE     __attribute__((section(ENET_RING_SECTION)))
+#endif
+#else
+#define ENET_RING_PLACE
+#endif
 
 #ifdef GD32F30X_CL
 
 #if defined   (__CC_ARM)                                    /*!< ARM compiler */
 __align(4) 
-enet_descriptors_struct  rxdesc_tab[ENET_RXBUF_NUM];        /*!< ENET RxDMA descriptor */
+enet_descriptors_struct  rxdesc_tab[ENET_RXBUF_NUM] ENET_RING_PLACE;        /*!< ENET RxDMA descriptor */
 __align(4) 
-enet_descriptors_struct  txdesc_tab[ENET_TXBUF_NUM];        /*!< ENET TxDMA descriptor */
+enet_descriptors_struct  txdesc_tab[ENET_TXBUF_NUM] ENET_RING_PLACE;        /*!< ENET TxDMA descriptor */
 __align(4) 
-uint8_t rx_buff[ENET_RXBUF_NUM][ENET_RXBUF_SIZE];           /*!< ENET receive buffer */
+uint8_t rx_buff[ENET_RXBUF_NUM][ENET_RXBUF_SIZE] ENET_RING_PLACE;           /*!< ENET receive buffer */
 __align(4) 
-uint8_t tx_buff[ENET_TXBUF_NUM][ENET_TXBUF_SIZE];           /*!< ENET transmit buffer */
+uint8_t tx_buff[ENET_TXBUF_NUM][ENET_TXBUF_SIZE] ENET_RING_PLACE;           /*!< ENET transmit buffer */
 
 #elif defined ( __ICCARM__ )                                /*!< IAR compiler */
 #pragma data_alignment=4
-enet_descriptors_struct  rxdesc_tab[ENET_RXBUF_NUM];        /*!< ENET RxDMA descriptor */
+enet_descriptors_struct  rxdesc_tab[ENET_RXBUF_NUM] ENET_RING_PLACE;        /*!< ENET RxDMA descriptor */
 #pragma data_alignment=4
-enet_descriptors_struct  txdesc_tab[ENET_TXBUF_NUM];        /*!< ENET TxDMA descriptor */
+enet_descriptors_struct  txdesc_tab[ENET_TXBUF_NUM] ENET_RING_PLACE;        /*!< ENET TxDMA descriptor */
 #pragma data_alignment=4
-uint8_t rx_buff[ENET_RXBUF_NUM][ENET_RXBUF_SIZE];           /*!< ENET receive buffer */
+uint8_t rx_buff[ENET_RXBUF_NUM][ENET_RXBUF_SIZE] ENET_RING_PLACE;           /*!< ENET receive buffer */
 #pragma data_alignment=4
-uint8_t tx_buff[ENET_TXBUF_NUM][ENET_TXBUF_SIZE];           /*!< ENET transmit buffer */
+uint8_t tx_buff[ENET_TXBUF_NUM][ENET_TXBUF_SIZE] ENET_RING_PLACE;           /*!< ENET transmit buffer */
 
 #elif defined (__GNUC__)        /* GNU Compiler */
-enet_descriptors_struct  rxdesc_tab[ENET_RXBUF_NUM] __attribute__ ((aligned (4)));        /*!< ENET RxDMA descriptor */ 
-enet_descriptors_struct  txdesc_tab[ENET_TXBUF_NUM] __attribute__ ((aligned (4)));        /*!< ENET TxDMA descriptor */
-uint8_t rx_buff[ENET_RXBUF_NUM][ENET_RXBUF_SIZE] __attribute__ ((aligned (4)));           /*!< ENET receive buffer */
-uint8_t tx_buff[ENET_TXBUF_NUM][ENET_TXBUF_SIZE] __attribute__ ((aligned (4)));           /*!< ENET transmit buffer */
+enet_descriptors_struct  rxdesc_tab[ENET_RXBUF_NUM] __attribute__ ((aligned (4))) ENET_RING_PLACE;        /*!< ENET RxDMA descriptor */ 
+enet_descriptors_struct  txdesc_tab[ENET_TXBUF_NUM] __attribute__ ((aligned (4))) ENET_RING_PLACE;        /*!< ENET TxDMA descriptor */
+uint8_t rx_buff[ENET_RXBUF_NUM][ENET_RXBUF_SIZE] __attribute__ ((aligned (4))) ENET_RING_PLACE;           /*!< ENET receive buffer */
+uint8_t tx_buff[ENET_TXBUF_NUM][ENET_TXBUF_SIZE] __attribute__ ((aligned (4))) ENET_RING_PLACE;           /*!< ENET transmit buffer */
 
 #endif /* __CC_ARM */
 
@@ -73,6 +85,29 @@ enet_descriptors_struct  *dma_current_rxdesc;
 enet_descriptors_struct  *dma_current_ptp_txdesc = NULL;
 enet_descriptors_struct  *dma_current_ptp_rxdesc = NULL;
 
+/* zero-copy receive: free list of spare Rx buffers, and the lent descriptors waiting for a buffer */
+static uint32_t rxpool_head = 0U;
+static enet_descriptors_struct *dma_rearm_rxdesc = NULL;
+static uint32_t rxdesc_pending = 0U;
+/* scatter-gather transmit: the oldest descriptor not reclaimed yet, and the frame token on each last segment */
+static enet_descriptors_struct *dma_reclaim_txdesc = NULL;
+static uint32_t txdesc_inflight = 0U;
+static void *txdesc_token[ENET_TXBUF_NUM];
+/* checksum offload statistics */
+static enet_checksum_stat_struct checksum_stat;
+/* descriptor rings and buffers in use, the default ones or set by enet_ring_config() */
+static enet_descriptors_struct *rxdesc_base = rxdesc_tab;
+static enet_descriptors_struct *txdesc_base = txdesc_tab;
+static uint8_t *rxbuf_base = &rx_buff[0][0];
+static uint8_t *txbuf_base = &tx_buff[0][0];
+static void **txtoken_base = txdesc_token;
+static uint32_t rxdesc_num = ENET_RXBUF_NUM;
+static uint32_t txdesc_num = ENET_TXBUF_NUM;
+static uint32_t rxbuf_size = ENET_RXBUF_SIZE;
+static uint32_t txbuf_size = ENET_TXBUF_SIZE;
+/* Rx poll mode statistics */
+static enet_rxpoll_stat_struct rxpoll_stat;
+
 /* init structure parameters for ENET initialization */
 static enet_initpara_struct enet_initpara ={0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
@@ -91,6 +126,22 @@ static const uint16_t enet_reg_tab[] = {
 
 /* initialize ENET peripheral with generally concerned parameters, call it by enet_init() */
 static void enet_default_init(void);
+/* check the memory is reachable by ENET DMA */
+static ErrStatus enet_dma_memory_check(void *addr, uint32_t size);
+/* get the next descriptor in RxDMA descriptor table */
+static enet_descriptors_struct *enet_rxdesc_next(enet_descriptors_struct *desc);
+/* give spare buffers to the lent Rx descriptors and return them to DMA */
+static void enet_rxdesc_rearm(void);
+/* get the next descriptor in TxDMA descriptor table */
+static enet_descriptors_struct *enet_txdesc_next(enet_descriptors_struct *desc);
+/* get the index of a Tx descriptor in the descriptor table */
+static uint32_t enet_txdesc_index(enet_descriptors_struct *desc);
+/* decode the checksum offload results in the last Rx descriptor of a frame */
+static uint32_t enet_rxdesc_checksum(enet_descriptors_struct *desc);
+/* count the checksum offload results of a received frame in the statistics */
+static void enet_rxchecksum_count(uint32_t flags);
+/* hand the frame in current TxDMA descriptor to DMA, with the checksum insertion of this frame */
+static ErrStatus enet_txframe_submit(uint8_t *buffer, uint32_t length, uint32_t checksum);
 
 #ifndef USE_DELAY
 /* insert a delay time */
@@ -255,6 +306,9 @@ void enet_initpara_config(enet_option_enum option, uint32_t para)
 
 #ifndef SELECT_DESCRIPTORS_ENHANCED_MODE
         para &= ~ENET_ENHANCED_DESCRIPTOR;
+#else
+        /* the descriptors are laid out in enhanced mode */
+        para |= ENET_ENHANCED_DESCRIPTOR;
 #endif /* SELECT_DESCRIPTORS_ENHANCED_MODE */  
 
         enet_initpara.dma_function = para;
@@ -310,6 +364,8 @@ void enet_initpara_config(enet_option_enum option, uint32_t para)
     \param[in]  mediamode: PHY mode and mac loopback configurations, only one parameter can be selected
                            which is shown as below, refer to enet_mediamode_enum 
       \arg        ENET_AUTO_NEGOTIATION: PHY auto negotiation
+      \arg        ENET_PHY_DEFERRED: PHY run by the application, only the SMI clock is configured and
+                                     the speed and duplex are set later by enet_media_config()
       \arg        ENET_100M_FULLDUPLEX: 100Mbit/s, full-duplex
       \arg        ENET_100M_HALFDUPLEX: 100Mbit/s, half-duplex
       \arg        ENET_10M_FULLDUPLEX: 10Mbit/s, full-duplex
@@ -339,7 +395,12 @@ ErrStatus enet_init(enet_mediamode_enum mediamode, enet_chksumconf_enum checksum
     ErrStatus phy_state= ERROR, enet_state = ERROR;
 
     /* PHY interface configuration, configure SMI clock and reset PHY chip */
-    if(ERROR == enet_phy_config()){
+    if(ENET_PHY_DEFERRED == mediamode){
+        /* the application runs the PHY, only the SMI clock is needed */
+        if(ERROR == enet_phy_clock_config()){
+            return enet_state;
+        }
+    }else if(ERROR == enet_phy_config()){
         _ENET_DELAY_(PHY_RESETDELAY);
         if(ERROR == enet_phy_config()){
             return enet_state;
@@ -400,6 +461,9 @@ ErrStatus enet_init(enet_mediamode_enum mediamode, enet_chksumconf_enum checksum
         }else{
             media_temp |= ENET_SPEEDMODE_100M;
         }
+    }else if((uint32_t)ENET_PHY_DEFERRED == media_temp){
+        /* keep the speed and duplex until enet_media_config() */
+        media_temp = ENET_MAC_CFG & (ENET_MAC_CFG_SPD | ENET_MAC_CFG_DPM);
     }else{
         phy_value = (uint16_t)((media_temp & ENET_MAC_CFG_DPM) >> 3);
         phy_value |= (uint16_t)((media_temp & ENET_MAC_CFG_SPD) >> 1);
@@ -427,6 +491,10 @@ ErrStatus enet_init(enet_mediamode_enum mediamode, enet_chksumconf_enum checksum
         reg_value &= ~ENET_DMA_CTL_DTCERFD;
         reg_value |= ((uint32_t)checksum & ENET_DMA_CTL_DTCERFD);
         ENET_DMA_CTL = reg_value;
+#ifdef SELECT_DESCRIPTORS_ENHANCED_MODE
+        /* the extended status of enhanced descriptors reports IPv6 and the payload type of checksum offload */
+        ENET_DMA_BCTL |= ENET_DMA_BCTL_DFM;
+#endif /* SELECT_DESCRIPTORS_ENHANCED_MODE */
     }
 
     /* 3rd, configure recept */
@@ -652,30 +720,52 @@ ErrStatus enet_software_reset(void)
 */
 uint32_t enet_rxframe_size_get(void)
 {
+    enet_descriptors_struct *desc;
     uint32_t size = 0U;
-    uint32_t status;
-    
+    uint32_t status, num = 1U;
+
     /* get rdes0 information of current RxDMA descriptor */
-    status = dma_current_rxdesc->status;
-    
+    desc = dma_current_rxdesc;
+    status = desc->status;
+
     /* if the desciptor is owned by DMA */
     if((uint32_t)RESET != (status & ENET_RDES0_DAV)){
         return 0U;
     }
-    
-    /* if has any error, or the frame uses two or more descriptors */
+
+    /* the frame spans several descriptors, its length and status are in the last one */
+    if((uint32_t)RESET != (status & ENET_RDES0_FDES)){
+        while(((uint32_t)RESET == (status & ENET_RDES0_LDES)) && (num < rxdesc_num)){
+            desc = enet_rxdesc_next(desc);
+            status = desc->status;
+            /* the frame is still being received */
+            if((uint32_t)RESET != (status & ENET_RDES0_DAV)){
+                return 0U;
+            }
+            num++;
+        }
+    }
+
+    /* if has any error, or the descriptor is the rest of a dropped frame */
     if((((uint32_t)RESET) != (status & ENET_RDES0_ERRS)) ||
-       (((uint32_t)RESET) == (status & ENET_RDES0_LDES)) ||
-       (((uint32_t)RESET) == (status & ENET_RDES0_FDES))){
+       (((uint32_t)RESET) == (dma_current_rxdesc->status & ENET_RDES0_FDES))){
         /* drop current receive frame */
         enet_rxframe_drop();
 
+        return 1U;
+    }
+    /* no last descriptor in the whole ring */
+    if(((uint32_t)RESET) == (status & ENET_RDES0_LDES)){
+        enet_unknow_err++;
+        enet_rxframe_drop();
+
         return 1U;
     }
 #ifdef SELECT_DESCRIPTORS_ENHANCED_MODE
     /* if is an ethernet-type frame, and IP frame payload error occurred */
-    if(((uint32_t)RESET) != (dma_current_rxdesc->status & ENET_RDES0_FRMT) &&
-       ((uint32_t)RESET) != (dma_current_rxdesc->extended_status & ENET_RDES4_IPPLDERR)){
+    if(((uint32_t)RESET) != (status & ENET_RDES0_FRMT) &&
+       ((uint32_t)RESET) != (desc->extended_status & ENET_RDES4_IPPLDERR)){
+        enet_rxchecksum_count(enet_rxdesc_checksum(desc));
         /* drop current receive frame */
         enet_rxframe_drop();
 
@@ -685,37 +775,128 @@ uint32_t enet_rxframe_size_get(void)
     /* if is an ethernet-type frame, and IP frame payload error occurred */
     if((((uint32_t)RESET) != (status & ENET_RDES0_FRMT)) &&
        (((uint32_t)RESET) != (status & ENET_RDES0_PCERR))){
-         /* drop current receive frame */
-         enet_rxframe_drop();
-
-        return 1U;
-    }
-#endif 
-    /* if CPU owns current descriptor, no error occured, the frame uses only one descriptor */
-    if((((uint32_t)RESET) == (status & ENET_RDES0_DAV)) &&
-       (((uint32_t)RESET) == (status & ENET_RDES0_ERRS)) &&
-       (((uint32_t)RESET) != (status & ENET_RDES0_LDES)) &&
-       (((uint32_t)RESET) != (status & ENET_RDES0_FDES))){
-        /* get the size of the received data including CRC */
-        size = GET_RDES0_FRML(status);
-        /* substract the CRC size */ 
-        size = size - 4U;
-
-        /* if is a type frame, and CRC is not included in forwarding frame */ 
-        if((RESET != (ENET_MAC_CFG & ENET_MAC_CFG_TFCD)) && (RESET != (status & ENET_RDES0_FRMT))){
-            size = size + 4U;
-        }
-    }else{
-        enet_unknow_err++;
+        enet_rxchecksum_count(enet_rxdesc_checksum(desc));
+        /* drop current receive frame */
         enet_rxframe_drop();
 
         return 1U;
     }
+#endif
+    /* get the size of the received data including CRC */
+    size = GET_RDES0_FRML(status);
+    /* substract the CRC size */
+    size = size - 4U;
+
+    /* if is a type frame, and CRC is not included in forwarding frame */
+    if((RESET != (ENET_MAC_CFG & ENET_MAC_CFG_TFCD)) && (RESET != (status & ENET_RDES0_FRMT))){
+        size = size + 4U;
+    }
 
-    /* return packet size */ 
+    /* return packet size */
     return size;
 }
 
+/*!
+    \brief      use application provided descriptor rings and buffers, or the default ones
+                note -- call it before the descriptors initialization, the memory must be reachable by
+                ENET DMA, that is the SRAM or the external memories, a dedicated SRAM bank avoids contention with the CPU
+    \param[in]  ring: the descriptor rings and buffers, refer to enet_ring_struct, NULL for the default
+                rxdesc_tab, txdesc_tab, rx_buff and tx_buff
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus enet_ring_config(enet_ring_struct *ring)
+{
+    if(NULL == ring){
+        rxdesc_base = rxdesc_tab;
+        txdesc_base = txdesc_tab;
+        rxbuf_base = &rx_buff[0][0];
+        txbuf_base = &tx_buff[0][0];
+        txtoken_base = txdesc_token;
+        rxdesc_num = ENET_RXBUF_NUM;
+        txdesc_num = ENET_TXBUF_NUM;
+        rxbuf_size = ENET_RXBUF_SIZE;
+        txbuf_size = ENET_TXBUF_SIZE;
+        return SUCCESS;
+    }
+
+    /* the buffer size is limited by the descriptor buffer size field, Rx buffer size is a multiple of 4 */
+    if((0U == ring->rxdesc_num) || (0U == ring->txdesc_num)){
+        return ERROR;
+    }
+    if((0U == ring->rxbuf_size) || (0U != (ring->rxbuf_size & 3U)) || (ring->rxbuf_size > ENET_RDES1_RB1S)){
+        return ERROR;
+    }
+    if((0U == ring->txbuf_size) || (ring->txbuf_size > ENET_TDES1_TB1S)){
+        return ERROR;
+    }
+    if((ERROR == enet_dma_memory_check(ring->rxdesc, ring->rxdesc_num * sizeof(enet_descriptors_struct))) ||
+       (ERROR == enet_dma_memory_check(ring->txdesc, ring->txdesc_num * sizeof(enet_descriptors_struct))) ||
+       (ERROR == enet_dma_memory_check(ring->rxbuf, ring->rxdesc_num * ring->rxbuf_size)) ||
+       (ERROR == enet_dma_memory_check(ring->txbuf, ring->txdesc_num * ring->txbuf_size))){
+        return ERROR;
+    }
+
+    rxdesc_base = ring->rxdesc;
+    txdesc_base = ring->txdesc;
+    rxbuf_base = ring->rxbuf;
+    txbuf_base = ring->txbuf;
+    txtoken_base = ring->txtoken;
+    rxdesc_num = ring->rxdesc_num;
+    txdesc_num = ring->txdesc_num;
+    rxbuf_size = ring->rxbuf_size;
+    txbuf_size = ring->txbuf_size;
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      get the size of each transmit buffer of the configured ring
+    \param[in]  none
+    \param[out] none
+    \retval     transmit buffer size in bytes
+*/
+uint32_t enet_txbuf_size_get(void)
+{
+    return txbuf_size;
+}
+
+/*!
+    \brief      get the buffer of the current transmit descriptor, to build a frame in place
+                  before ENET_NOCOPY_FRAME_TRANSMIT()
+    \param[in]  none
+    \param[out] none
+    \retval     the buffer address, NULL while the descriptor is owned by the DMA
+*/
+uint8_t *enet_txbuf_current_get(void)
+{
+    if((uint32_t)RESET != (dma_current_txdesc->status & ENET_TDES0_DAV)){
+        return NULL;
+    }
+
+    return (uint8_t *)(uint32_t)dma_current_txdesc->buffer1_addr;
+}
+
+/*!
+    \brief      get the number of transmit descriptors free for new frames
+    \param[in]  none
+    \param[out] none
+    \retval     descriptors owned by the CPU from the current one on, up to the ring size
+*/
+uint32_t enet_txdesc_free_get(void)
+{
+    enet_descriptors_struct *desc = dma_current_txdesc;
+    uint32_t count = 0U;
+
+    /* the DMA takes the descriptors in order, the free ones follow the current one */
+    while((count < txdesc_num) && ((uint32_t)RESET == (desc->status & ENET_TDES0_DAV))){
+        count++;
+        desc = enet_txdesc_next(desc);
+    }
+
+    return count;
+}
+
 /*!
     \brief      initialize the DMA Tx/Rx descriptors's parameters in chain mode
     \param[in]  direction: the descriptors which users want to init, refer to enet_dmadirection_enum,
@@ -735,10 +916,10 @@ void enet_descriptors_chain_init(enet_dmadirection_enum direction)
     /* if want to initialize DMA Tx descriptors */
     if (ENET_DMA_TX == direction){
         /* save a copy of the DMA Tx descriptors */
-        desc_tab = txdesc_tab;
-        buf = &tx_buff[0][0];
-        count = ENET_TXBUF_NUM;
-        maxsize = ENET_TXBUF_SIZE;
+        desc_tab = txdesc_base;
+        buf = txbuf_base;
+        count = txdesc_num;
+        maxsize = txbuf_size;
 
         /* select chain mode */
         desc_status = ENET_TDES0_TCHM;
@@ -746,22 +927,26 @@ void enet_descriptors_chain_init(enet_dmadirection_enum direction)
         /* configure DMA Tx descriptor table address register */
         ENET_DMA_TDTADDR = (uint32_t)desc_tab;
         dma_current_txdesc = desc_tab;
+        dma_reclaim_txdesc = desc_tab;
+        txdesc_inflight = 0U;
     }else{
         /* if want to initialize DMA Rx descriptors */
         /* save a copy of the DMA Rx descriptors */
-        desc_tab = rxdesc_tab;
-        buf = &rx_buff[0][0];
-        count = ENET_RXBUF_NUM;
-        maxsize = ENET_RXBUF_SIZE;
+        desc_tab = rxdesc_base;
+        buf = rxbuf_base;
+        count = rxdesc_num;
+        maxsize = rxbuf_size;
 
         /* enable receiving */
         desc_status = ENET_RDES0_DAV;
         /* select receive chained mode and set buffer1 size */
-        desc_bufsize = ENET_RDES1_RCHM | (uint32_t)ENET_RXBUF_SIZE;
+        desc_bufsize = ENET_RDES1_RCHM | rxbuf_size;
       
         /* configure DMA Rx descriptor table address register */
         ENET_DMA_RDTADDR = (uint32_t)desc_tab;
         dma_current_rxdesc = desc_tab; 
+        dma_rearm_rxdesc = desc_tab;
+        rxdesc_pending = 0U;
     }
     dma_current_ptp_rxdesc = NULL;
     dma_current_ptp_txdesc = NULL;
@@ -812,30 +997,34 @@ void enet_descriptors_ring_init(enet_dmadirection_enum direction)
     /* if want to initialize DMA Tx descriptors */
     if (ENET_DMA_TX == direction){
         /* save a copy of the DMA Tx descriptors */
-        desc_tab = txdesc_tab;
-        buf = &tx_buff[0][0];
-        count = ENET_TXBUF_NUM;
-        maxsize = ENET_TXBUF_SIZE;      
+        desc_tab = txdesc_base;
+        buf = txbuf_base;
+        count = txdesc_num;
+        maxsize = txbuf_size;      
 
         /* configure DMA Tx descriptor table address register */
         ENET_DMA_TDTADDR = (uint32_t)desc_tab;
         dma_current_txdesc = desc_tab;
+        dma_reclaim_txdesc = desc_tab;
+        txdesc_inflight = 0U;
     }else{
         /* if want to initialize DMA Rx descriptors */
         /* save a copy of the DMA Rx descriptors */
-        desc_tab = rxdesc_tab;
-        buf = &rx_buff[0][0];
-        count = ENET_RXBUF_NUM;
-        maxsize = ENET_RXBUF_SIZE;      
+        desc_tab = rxdesc_base;
+        buf = rxbuf_base;
+        count = rxdesc_num;
+        maxsize = rxbuf_size;      
 
         /* enable receiving */
         desc_status = ENET_RDES0_DAV;
         /* set buffer1 size */
-        desc_bufsize = ENET_RXBUF_SIZE;
+        desc_bufsize = rxbuf_size;
 
          /* configure DMA Rx descriptor table address register */
         ENET_DMA_RDTADDR = (uint32_t)desc_tab;
         dma_current_rxdesc = desc_tab; 
+        dma_rearm_rxdesc = desc_tab;
+        rxdesc_pending = 0U;
     }
     dma_current_ptp_rxdesc = NULL;
     dma_current_ptp_txdesc = NULL;
@@ -865,81 +1054,301 @@ void enet_descriptors_ring_init(enet_dmadirection_enum direction)
 
 /*!
     \brief      handle current received frame data to application buffer
+                note -- a frame spanning several descriptors is copied segment by segment, all its
+                descriptors are given back to DMA, a bad frame or one longer than bufsize is dropped
     \param[in]  bufsize: the size of buffer which is the parameter in function
     \param[out] buffer: pointer to the received frame data
-                note -- if the input is NULL, user should copy data in application by himself
+                note -- if the input is NULL, user should copy data in application by himself,
+                only the current descriptor is given back to DMA
     \retval     ErrStatus: SUCCESS or ERROR
 */
 ErrStatus enet_frame_receive(uint8_t *buffer, uint32_t bufsize)
 {
-    uint32_t offset = 0U, size = 0U;
+    enet_descriptors_struct *desc;
+    uint32_t offset = 0U, size = 0U, seglen, status, num, i;
+    ErrStatus reval = SUCCESS;
 
+    desc = dma_current_rxdesc;
+    status = desc->status;
     /* the descriptor is busy due to own by the DMA */
-    if((uint32_t)RESET != (dma_current_rxdesc->status & ENET_RDES0_DAV)){
-        return ERROR; 
+    if((uint32_t)RESET != (status & ENET_RDES0_DAV)){
+        return ERROR;
     }
 
+    num = 1U;
     /* if buffer pointer is null, indicates that users has copied data in application */
     if(NULL != buffer){
-        /* if no error occurs, and the frame uses only one descriptor */
-        if((((uint32_t)RESET) == (dma_current_rxdesc->status & ENET_RDES0_ERRS)) && 
-           (((uint32_t)RESET) != (dma_current_rxdesc->status & ENET_RDES0_LDES)) &&  
-           (((uint32_t)RESET) != (dma_current_rxdesc->status & ENET_RDES0_FDES))){      
+        if((uint32_t)RESET != (status & ENET_RDES0_FDES)){
+            /* find the last descriptor of the frame */
+            while((uint32_t)RESET == (status & ENET_RDES0_LDES)){
+                if(rxdesc_num <= num){
+                    /* no last descriptor in the whole ring, drop the received part */
+                    reval = ERROR;
+                    break;
+                }
+                desc = enet_rxdesc_next(desc);
+                status = desc->status;
+                if((uint32_t)RESET != (status & ENET_RDES0_DAV)){
+                    /* the frame is still being received */
+                    return ERROR;
+                }
+                num++;
+            }
+            /* error status is only valid in the last descriptor */
+            if((SUCCESS == reval) && ((uint32_t)RESET != (status & ENET_RDES0_ERRS))){
+                reval = ERROR;
+            }
+        }else{
+            /* the rest of a dropped frame */
+            reval = ERROR;
+        }
+
+        if(SUCCESS == reval){
             /* get the frame length except CRC */
-            size = GET_RDES0_FRML(dma_current_rxdesc->status);
+            size = GET_RDES0_FRML(status);
             size = size - 4U;
 
-            /* if is a type frame, and CRC is not included in forwarding frame */ 
-            if((RESET != (ENET_MAC_CFG & ENET_MAC_CFG_TFCD)) && (RESET != (dma_current_rxdesc->status & ENET_RDES0_FRMT))){
+            /* if is a type frame, and CRC is not included in forwarding frame */
+            if((RESET != (ENET_MAC_CFG & ENET_MAC_CFG_TFCD)) && (RESET != (status & ENET_RDES0_FRMT))){
                 size = size + 4U;
             }
 
-            /* to avoid situation that the frame size exceeds the buffer length */
+            /* to avoid situation that the frame size exceeds the buffer length, drop the frame */
             if(size > bufsize){
-                return ERROR;
+                reval = ERROR;
             }
+        }
 
-            /* copy data from Rx buffer to application buffer */
-            for(offset = 0U; offset<size; offset++){
-                (*(buffer + offset)) = (*(__IO uint8_t *) (uint32_t)((dma_current_rxdesc->buffer1_addr) + offset));
+        if(SUCCESS == reval){
+            /* the checksum offload results are counted once, when the frame is taken */
+            enet_rxchecksum_count(enet_rxdesc_checksum(desc));
+
+            /* copy data from each Rx buffer to application buffer, the last one may only hold CRC */
+            desc = dma_current_rxdesc;
+            for(i = 0U; (i < num) && (offset < size); i++){
+                seglen = GET_RDES1_RB1S(desc->control_buffer_size);
+                if(seglen > (size - offset)){
+                    seglen = size - offset;
+                }
+                memcpy(&buffer[offset], (uint8_t *)(uint32_t)desc->buffer1_addr, seglen);
+                offset += seglen;
+                desc = enet_rxdesc_next(desc);
             }
-            
-        }else{
-            /* return ERROR */
-            return ERROR;
         }
+    }else if(((uint32_t)RESET != (status & ENET_RDES0_LDES)) && ((uint32_t)RESET == (status & ENET_RDES0_ERRS))){
+        /* the application has taken the frame in place */
+        enet_rxchecksum_count(enet_rxdesc_checksum(desc));
     }
-    /* enable reception, descriptor is owned by DMA */
-    dma_current_rxdesc->status = ENET_RDES0_DAV; 
- 
+
+    /* enable reception, the descriptors of the frame are owned by DMA */
+    for(i = 0U; i < num; i++){
+        dma_current_rxdesc->status = ENET_RDES0_DAV;
+        dma_current_rxdesc = enet_rxdesc_next(dma_current_rxdesc);
+    }
+
     /* check Rx buffer unavailable flag status */
-    if ((uint32_t)RESET != (ENET_DMA_STAT & ENET_DMA_STAT_RBU)){
+    if((uint32_t)RESET != (ENET_DMA_STAT & ENET_DMA_STAT_RBU)){
         /* clear RBU flag */
         ENET_DMA_STAT = ENET_DMA_STAT_RBU;
         /* resume DMA reception by writing to the RPEN register*/
         ENET_DMA_RPEN = 0U;
     }
-  
-    /* update the current RxDMA descriptor pointer to the next decriptor in RxDMA decriptor table */
-    /* chained mode */
-    if((uint32_t)RESET != (dma_current_rxdesc->control_buffer_size & ENET_RDES1_RCHM)){      
-        dma_current_rxdesc = (enet_descriptors_struct*) (dma_current_rxdesc->buffer2_next_desc_addr);
+
+    return reval;
+}
+
+/*!
+    \brief      provide the spare buffers used to re-arm Rx descriptors while received frames are lent out
+                note -- call it after the Rx descriptors initialization, the buffers are linked
+                through their first word while they are free
+    \param[in]  pool: num contiguous buffers of the receive buffer size, 4 bytes aligned
+    \param[in]  num: number of buffers in pool
+    \param[out] none
+    \retval     none
+*/
+void enet_rxbuf_pool_init(uint8_t *pool, uint32_t num)
+{
+    uint32_t i;
+
+    rxpool_head = 0U;
+    for(i = 0U; i < num; i++){
+        *(uint32_t *)(uint32_t)(&pool[i * rxbuf_size]) = rxpool_head;
+        rxpool_head = (uint32_t)(&pool[i * rxbuf_size]);
+    }
+}
+
+/*!
+    \brief      lend current received frame to application without data copy
+                note -- a frame may span several descriptors, each segment stays in its DMA receive
+                buffer, the descriptors get spare buffers from the pool and are given back to DMA
+                at once, if the pool is empty they wait until the segments are released
+    \param[in]  none
+    \param[out] frame: segments and length of the received frame, refer to enet_rxframe_struct
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus enet_frame_receive_borrow(enet_rxframe_struct *frame)
+{
+    enet_descriptors_struct *desc;
+    uint32_t status, size = 0U, seglen, primask;
+    uint32_t num, avail, i;
+    uint32_t buffer;
+    ErrStatus reval = SUCCESS;
+
+    /* all the descriptors are lent out, the current one is not a new frame */
+    avail = rxdesc_num - rxdesc_pending;
+    if(0U == avail){
+        return ERROR;
+    }
+
+    desc = dma_current_rxdesc;
+    status = desc->status;
+    /* the descriptor is busy due to own by the DMA */
+    if((uint32_t)RESET != (status & ENET_RDES0_DAV)){
+        return ERROR;
+    }
+
+    num = 1U;
+    if((uint32_t)RESET != (status & ENET_RDES0_FDES)){
+        /* find the last descriptor of the frame */
+        while((uint32_t)RESET == (status & ENET_RDES0_LDES)){
+            if(ENET_RXFRAME_SEG_NUM <= num){
+                /* the frame is too long, drop the received part */
+                reval = ERROR;
+                break;
+            }
+            if(avail <= num){
+                /* the rest of the frame waits for the lent descriptors */
+                return ERROR;
+            }
+            desc = enet_rxdesc_next(desc);
+            status = desc->status;
+            if((uint32_t)RESET != (status & ENET_RDES0_DAV)){
+                /* the frame is still being received */
+                return ERROR;
+            }
+            num++;
+        }
+        /* error status is only valid in the last descriptor */
+        if((SUCCESS == reval) && ((uint32_t)RESET != (status & ENET_RDES0_ERRS))){
+            reval = ERROR;
+        }
     }else{
-        /* ring mode */
-        if((uint32_t)RESET != (dma_current_rxdesc->control_buffer_size & ENET_RDES1_RERM)){
-            /* if is the last descriptor in table, the next descriptor is the table header */
-            dma_current_rxdesc = (enet_descriptors_struct*) (ENET_DMA_RDTADDR);      
-        }else{ 
-            /* the next descriptor is the current address, add the descriptor size, and descriptor skip length */
-            dma_current_rxdesc = (enet_descriptors_struct*) (uint32_t)((uint32_t)dma_current_rxdesc + ETH_DMARXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL)));      
+        /* the rest of a dropped frame */
+        reval = ERROR;
+    }
+
+    if(SUCCESS == reval){
+        /* get the frame length except CRC */
+        size = GET_RDES0_FRML(status) - 4U;
+        /* if is a type frame, and CRC is not included in forwarding frame */
+        if((RESET != (ENET_MAC_CFG & ENET_MAC_CFG_TFCD)) && (RESET != (status & ENET_RDES0_FRMT))){
+            size = size + 4U;
         }
+        frame->length = size;
+        frame->segments = 0U;
+        frame->checksum = enet_rxdesc_checksum(desc);
+        enet_rxchecksum_count(frame->checksum);
     }
 
-    return SUCCESS;
+    primask = __get_PRIMASK();
+    __disable_irq();
+    desc = dma_current_rxdesc;
+    for(i = 0U; i < num; i++){
+        buffer = desc->buffer1_addr;
+        seglen = GET_RDES1_RB1S(desc->control_buffer_size);
+        if((SUCCESS == reval) && (0U != size)){
+            if(seglen > size){
+                seglen = size;
+            }
+            frame->seg_buffer[frame->segments] = (uint8_t *)buffer;
+            frame->seg_length[frame->segments] = seglen;
+            frame->segments++;
+            size -= seglen;
+        }else{
+            /* bad frame, or only CRC in the buffer, it is a spare one again */
+            *(uint32_t *)buffer = rxpool_head;
+            rxpool_head = buffer;
+        }
+        desc = enet_rxdesc_next(desc);
+    }
+    /* the descriptors now wait for spare buffers */
+    dma_current_rxdesc = desc;
+    rxdesc_pending += num;
+    enet_rxdesc_rearm();
+    __set_PRIMASK(primask);
+
+    if(SUCCESS == reval){
+        frame->buffer = frame->seg_buffer[0];
+    }
+
+    return reval;
+}
+
+/*!
+    \brief      give a buffer lent by enet_frame_receive_borrow() back to the driver
+    \param[in]  buffer: one segment buffer got from enet_frame_receive_borrow()
+    \param[out] none
+    \retval     none
+*/
+void enet_frame_receive_release(uint8_t *buffer)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *(uint32_t *)(uint32_t)buffer = rxpool_head;
+    rxpool_head = (uint32_t)buffer;
+    enet_rxdesc_rearm();
+    __set_PRIMASK(primask);
+}
+
+/*!
+    \brief      give all the segment buffers of a lent frame back to the driver
+    \param[in]  frame: the frame got from enet_frame_receive_borrow()
+    \param[out] none
+    \retval     none
+*/
+void enet_rxframe_release(enet_rxframe_struct *frame)
+{
+    uint32_t i, primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for(i = 0U; i < frame->segments; i++){
+        *(uint32_t *)(uint32_t)(frame->seg_buffer[i]) = rxpool_head;
+        rxpool_head = (uint32_t)(frame->seg_buffer[i]);
+    }
+    frame->segments = 0U;
+    enet_rxdesc_rearm();
+    __set_PRIMASK(primask);
+}
+
+/*!
+    \brief      copy the segments of a lent frame to a contiguous application buffer
+    \param[in]  frame: the frame got from enet_frame_receive_borrow()
+    \param[in]  bufsize: the size of buffer
+    \param[out] buffer: pointer to the frame data
+    \retval     copied length, 0 if the frame exceeds the buffer length
+*/
+uint32_t enet_rxframe_copy(enet_rxframe_struct *frame, uint8_t *buffer, uint32_t bufsize)
+{
+    uint32_t i, offset = 0U;
+
+    /* to avoid situation that the frame size exceeds the buffer length */
+    if(frame->length > bufsize){
+        return 0U;
+    }
+    for(i = 0U; i < frame->segments; i++){
+        memcpy(&buffer[offset], frame->seg_buffer[i], frame->seg_length[i]);
+        offset += frame->seg_length[i];
+    }
+
+    return offset;
 }
 
 /*!
     \brief      handle application buffer data to transmit it
+                note -- the frame is sent without checksum insertion, see enet_frame_transmit_checksum()
     \param[in]  buffer: pointer to the frame data to be transmitted,
                 note -- if the input is NULL, user should handle the data in application by himself
     \param[in]  length: the length of frame data to be transmitted
@@ -948,84 +1357,405 @@ ErrStatus enet_frame_receive(uint8_t *buffer, uint32_t bufsize)
 */
 ErrStatus enet_frame_transmit(uint8_t *buffer, uint32_t length)
 {
-    uint32_t offset = 0U;
-    uint32_t dma_tbu_flag, dma_tu_flag;
+    return enet_txframe_submit(buffer, length, ENET_CHECKSUM_DISABLE);
+}
 
-    /* the descriptor is busy due to own by the DMA */
-    if((uint32_t)RESET != (dma_current_txdesc->status & ENET_TDES0_DAV)){
+/*!
+    \brief      transmit a frame made of several fragments, each fragment is sent in place by one descriptor
+                note -- the fragment buffers must stay untouched until enet_tx_reclaim() releases the token,
+                do not mix it with enet_frame_transmit() on the same descriptors
+    \param[in]  frag: the fragments of the frame in order, refer to enet_txfrag_struct
+    \param[in]  num: number of fragments
+    \param[in]  checksum: IP frame checksum insertion of the frame
+                only one parameter can be selected which is shown as below
+      \arg        ENET_CHECKSUM_DISABLE: checksum insertion disabled
+      \arg        ENET_CHECKSUM_IPV4HEADER: only IP header checksum calculation and insertion are enabled
+      \arg        ENET_CHECKSUM_TCPUDPICMP_SEGMENT: TCP/UDP/ICMP checksum insertion calculated but pseudo-header
+      \arg        ENET_CHECKSUM_TCPUDPICMP_FULL: TCP/UDP/ICMP checksum insertion fully calculated
+    \param[in]  token: passed to the release callback of enet_tx_reclaim() when the frame is sent
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus enet_frame_transmit_sg(enet_txfrag_struct frag[], uint32_t num, uint32_t checksum, void *token)
+{
+    enet_descriptors_struct *desc, *first;
+    uint32_t i, length = 0U, status, primask;
+    uint32_t dma_tbu_flag, dma_tu_flag, maxsize;
+
+    /* not enough free descriptors for the fragments */
+    if((0U == num) || (num > (txdesc_num - txdesc_inflight)) || (NULL == txtoken_base)){
         return ERROR;
     }
-
-    /* only frame length no more than ENET_MAX_FRAME_SIZE is allowed */
-    if(length > ENET_MAX_FRAME_SIZE){
+    for(i = 0U; i < num; i++){
+        if(frag[i].length > ENET_TDES1_TB1S){
+            return ERROR;
+        }
+        length += frag[i].length;
+    }
+    /* only frame length no more than ENET_MAX_FRAME_SIZE is allowed, or jumbo frame when jabber is disabled */
+    maxsize = ENET_MAX_FRAME_SIZE;
+    if(RESET != (ENET_MAC_CFG & ENET_MAC_CFG_JBD)){
+        maxsize = ENET_MAX_JUMBO_FRAME_SIZE;
+    }
+    if(length > maxsize){
         return ERROR;
     }
 
-    /* if buffer pointer is null, indicates that users has handled data in application */
-    if(NULL != buffer){    
-        /* copy frame data from application buffer to Tx buffer */
-        for(offset = 0U; offset < length; offset++){
-            (*(__IO uint8_t *) (uint32_t)((dma_current_txdesc->buffer1_addr) + offset)) = (*(buffer + offset));
+    first = dma_current_txdesc;
+    desc = first;
+    for(i = 0U; i < num; i++){
+        /* the descriptor is busy due to own by the DMA */
+        if((uint32_t)RESET != (desc->status & ENET_TDES0_DAV)){
+            return ERROR;
         }
+        desc = enet_txdesc_next(desc);
     }
 
-    /* set the frame length */
-    dma_current_txdesc->control_buffer_size = length;
-    /* set the segment of frame, frame is transmitted in one descriptor */    
-    dma_current_txdesc->status |= ENET_TDES0_LSG | ENET_TDES0_FSG;
-    /* enable the DMA transmission */
-    dma_current_txdesc->status |= ENET_TDES0_DAV;
+    desc = first;
+    for(i = 0U; i < num; i++){
+        desc->buffer1_addr = (uint32_t)frag[i].buffer;
+        desc->control_buffer_size = TDES1_TB1S(frag[i].length);
+
+        status = desc->status & ~(ENET_TDES0_FSG | ENET_TDES0_LSG | ENET_TDES0_INTC | ENET_TDES0_CM);
+        if(0U == i){
+            /* the checksum insertion is taken from the first descriptor */
+            status |= ENET_TDES0_FSG | checksum;
+        }else{
+            /* the first descriptor is given to DMA at last */
+            status |= ENET_TDES0_DAV;
+        }
+        if((num - 1U) == i){
+            status |= ENET_TDES0_LSG | ENET_TDES0_INTC;
+            txtoken_base[enet_txdesc_index(desc)] = token;
+        }else{
+            txtoken_base[enet_txdesc_index(desc)] = NULL;
+        }
+        desc->status = status;
+        desc = enet_txdesc_next(desc);
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    txdesc_inflight += num;
+    __set_PRIMASK(primask);
+    dma_current_txdesc = desc;
+    if(ENET_CHECKSUM_DISABLE == checksum){
+        checksum_stat.tx_software++;
+    }else{
+        checksum_stat.tx_offload++;
+    }
+
+    /* enable the DMA transmission, the whole frame is ready now */
+    first->status |= ENET_TDES0_DAV;
 
     /* check Tx buffer unavailable flag status */
-    dma_tbu_flag = (ENET_DMA_STAT & ENET_DMA_STAT_TBU); 
+    dma_tbu_flag = (ENET_DMA_STAT & ENET_DMA_STAT_TBU);
     dma_tu_flag = (ENET_DMA_STAT & ENET_DMA_STAT_TU);
 
-    if ((RESET != dma_tbu_flag) || (RESET != dma_tu_flag)){
+    if((RESET != dma_tbu_flag) || (RESET != dma_tu_flag)){
         /* clear TBU and TU flag */
         ENET_DMA_STAT = (dma_tbu_flag | dma_tu_flag);
         /* resume DMA transmission by writing to the TPEN register*/
         ENET_DMA_TPEN = 0U;
     }
 
-    /* update the current TxDMA descriptor pointer to the next decriptor in TxDMA decriptor table*/
-    /* chained mode */
-    if((uint32_t)RESET != (dma_current_txdesc->status & ENET_TDES0_TCHM)){     
-        dma_current_txdesc = (enet_descriptors_struct*) (dma_current_txdesc->buffer2_next_desc_addr);
-    }else{
-        /* ring mode */
-        if((uint32_t)RESET != (dma_current_txdesc->status & ENET_TDES0_TERM)){
-            /* if is the last descriptor in table, the next descriptor is the table header */
-            dma_current_txdesc = (enet_descriptors_struct*) (ENET_DMA_TDTADDR);
+    return SUCCESS;
+}
+
+/*!
+    \brief      reclaim the descriptors sent by DMA, and release the application buffers of the sent frames
+    \param[in]  release: called with the token of each sent frame, can be NULL
+    \param[out] none
+    \retval     number of frames reclaimed
+*/
+uint32_t enet_tx_reclaim(enet_txrelease_callback release)
+{
+    uint32_t index, frames = 0U, primask;
+    void *token;
+
+    while((0U != txdesc_inflight) && ((uint32_t)RESET == (dma_reclaim_txdesc->status & ENET_TDES0_DAV))){
+        index = enet_txdesc_index(dma_reclaim_txdesc);
+        token = txtoken_base[index];
+        txtoken_base[index] = NULL;
+        /* point the descriptor back to its own transmit buffer */
+        dma_reclaim_txdesc->buffer1_addr = (uint32_t)(&txbuf_base[index * txbuf_size]);
+
+        if((uint32_t)RESET != (dma_reclaim_txdesc->status & ENET_TDES0_LSG)){
+            frames++;
+            if((NULL != release) && (NULL != token)){
+                release(token);
+            }
+        }
+        dma_reclaim_txdesc = enet_txdesc_next(dma_reclaim_txdesc);
+
+        primask = __get_PRIMASK();
+        __disable_irq();
+        txdesc_inflight--;
+        __set_PRIMASK(primask);
+    }
+
+    return frames;
+}
+
+/*!
+    \brief      configure the Rx poll mode, with optional Rx interrupt delay on all the Rx descriptors
+                note -- call it after the Rx descriptors initialization, the statistics are cleared
+    \param[in]  delay_time: 0 for RS bit set immediately after Rx completed, or delay a time of
+                256*delay_time HCLK(0x00000001 - 0x000000FF) by the receive watchdog
+    \param[out] none
+    \retval     none
+*/
+void enet_rx_poll_config(uint32_t delay_time)
+{
+    enet_descriptors_struct *desc;
+    uint32_t i;
+
+    desc = (enet_descriptors_struct *)ENET_DMA_RDTADDR;
+    for(i = 0U; i < rxdesc_num; i++){
+        if(0U == delay_time){
+            enet_rx_desc_immediate_receive_complete_interrupt(desc);
         }else{
-            /* the next descriptor is the current address, add the descriptor size, and descriptor skip length */
-            dma_current_txdesc = (enet_descriptors_struct*) (uint32_t)((uint32_t)dma_current_txdesc + ETH_DMATXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL)));
+            enet_rx_desc_delay_receive_complete_interrupt(desc, delay_time);
         }
+        desc = enet_rxdesc_next(desc);
+    }
+    if(0U == delay_time){
+        ENET_DMA_RSWDC = 0U;
+    }
+
+    rxpoll_stat.interrupts = 0U;
+    rxpoll_stat.polls = 0U;
+    rxpoll_stat.frames = 0U;
+    rxpoll_stat.dropped = 0U;
+    rxpoll_stat.budget_exhausted = 0U;
+    rxpoll_stat.frames_last = 0U;
+    rxpoll_stat.frames_max = 0U;
+}
+
+/*!
+    \brief      Rx interrupt service of the poll mode, mask Rx interrupt and tell whether to schedule a poll
+                note -- call it from the ENET interrupt handler, the frames are handled by enet_rx_poll()
+                from a deferred context, which unmasks Rx interrupt again
+    \param[in]  none
+    \param[out] none
+    \retval     FlagStatus: SET when a poll is to be scheduled, RESET otherwise
+*/
+FlagStatus enet_rx_poll_irq(void)
+{
+    if(RESET == enet_interrupt_flag_get(ENET_DMA_INT_FLAG_RS)){
+        return RESET;
+    }
+    /* RS is cleared before the poll, so a frame received after it raises the interrupt again once unmasked */
+    enet_interrupt_disable(ENET_DMA_INT_RIE);
+    enet_interrupt_flag_clear(ENET_DMA_INT_FLAG_RS_CLR);
+    enet_interrupt_flag_clear(ENET_DMA_INT_FLAG_NI_CLR);
+    rxpoll_stat.interrupts++;
+
+    return SET;
+}
+
+/*!
+    \brief      handle up to budget received frames, unmask Rx interrupt when the ring is drained
+                note -- the frames are lent by enet_frame_receive_borrow(), the handler gives them back
+                by enet_rxframe_release(), if the budget is used up the poll must be scheduled again
+    \param[in]  budget: the most frames to handle in this poll
+    \param[in]  handler: called with each received frame, NULL to drop the frames
+    \param[out] none
+    \retval     number of frames handled, the bad frames dropped on the way take from the budget too,
+                the ring is not drained when both reach budget
+*/
+uint32_t enet_rx_poll(uint32_t budget, enet_rxframe_handler handler)
+{
+    enet_rxframe_struct frame;
+    enet_descriptors_struct *desc;
+    uint32_t frames = 0U, dropped = 0U, drained = 0U, primask;
+
+    /* the dropped frames count, so that a burst of bad frames can not hold the CPU either */
+    while((frames + dropped) < budget){
+        desc = dma_current_rxdesc;
+        if(SUCCESS == enet_frame_receive_borrow(&frame)){
+            frames++;
+            if(NULL != handler){
+                handler(&frame);
+            }else{
+                enet_rxframe_release(&frame);
+            }
+        }else if(desc == dma_current_rxdesc){
+            /* no complete frame left, the next one raises the interrupt */
+            drained = 1U;
+            break;
+        }else{
+            /* a bad frame is dropped, go on */
+            dropped++;
+        }
+    }
+
+    rxpoll_stat.polls++;
+    rxpoll_stat.frames += frames;
+    rxpoll_stat.dropped += dropped;
+    rxpoll_stat.frames_last = frames;
+    if(frames > rxpoll_stat.frames_max){
+        rxpoll_stat.frames_max = frames;
+    }
+
+    if(0U != drained){
+        primask = __get_PRIMASK();
+        __disable_irq();
+        enet_interrupt_enable(ENET_DMA_INT_RIE);
+        __set_PRIMASK(primask);
+    }else{
+        rxpoll_stat.budget_exhausted++;
+    }
+
+    return frames;
+}
+
+/*!
+    \brief      get the statistics of the Rx poll mode
+    \param[in]  none
+    \param[out] stat: the statistics, refer to enet_rxpoll_stat_struct
+    \retval     none
+*/
+void enet_rx_poll_stat_get(enet_rxpoll_stat_struct *stat)
+{
+    *stat = rxpoll_stat;
+}
+
+/*!
+    \brief      get the occupancy of the RxDMA descriptor ring
+    \param[in]  none
+    \param[out] total: number of descriptors in the ring, NULL if not needed
+    \retval     number of descriptors the RxDMA can not use, holding received frames
+                or lent by enet_frame_receive_borrow() and not rearmed yet
+*/
+uint32_t enet_rxdesc_occupancy_get(uint32_t *total)
+{
+    enet_descriptors_struct *desc = dma_current_rxdesc;
+    uint32_t used = rxdesc_pending;
+
+    if(NULL != total){
+        *total = rxdesc_num;
+    }
+    /* the received frames follow the current descriptor, the lent ones precede it */
+    while((used < rxdesc_num) && ((uint32_t)RESET == (desc->status & ENET_RDES0_DAV))){
+        used++;
+        desc = enet_rxdesc_next(desc);
+    }
+
+    return used;
+}
+
+/*!
+    \brief      configure the transmit IP frame checksum offload calculation and insertion
+                note -- for descriptors the application gives to DMA itself, enet_frame_transmit(),
+                enet_frame_transmit_checksum() and enet_frame_transmit_sg() set it for each frame
+    \param[in]  desc: the descriptor pointer which users want to configure
+    \param[in]  checksum: IP frame checksum configuration
+                only one parameter can be selected which is shown as below
+      \arg        ENET_CHECKSUM_DISABLE: checksum insertion disabled
+      \arg        ENET_CHECKSUM_IPV4HEADER: only IP header checksum calculation and insertion are enabled
+      \arg        ENET_CHECKSUM_TCPUDPICMP_SEGMENT: TCP/UDP/ICMP checksum insertion calculated but pseudo-header
+      \arg        ENET_CHECKSUM_TCPUDPICMP_FULL: TCP/UDP/ICMP checksum insertion fully calculated
+    \param[out] none
+    \retval     ErrStatus: ERROR, SUCCESS
+*/
+ErrStatus enet_transmit_checksum_config(enet_descriptors_struct *desc, uint32_t checksum)
+{
+    if(NULL != desc){
+        desc->status &= ~ENET_TDES0_CM;
+        desc->status |= checksum;
+        return SUCCESS;
+    }else{
+        return ERROR;
+    }
+}
+
+/*!
+    \brief      handle application buffer data to transmit it with checksum insertion
+                note -- checksum insertion needs the Tx FIFO in store-and-forward mode
+    \param[in]  buffer: pointer on the application buffer
+                note -- if the input is NULL, user should copy data in application by himself
+    \param[in]  length: the length of frame data to be transmitted
+    \param[in]  checksum: IP frame checksum insertion of the frame
+                only one parameter can be selected which is shown as below
+      \arg        ENET_CHECKSUM_DISABLE: checksum insertion disabled
+      \arg        ENET_CHECKSUM_IPV4HEADER: only IP header checksum calculation and insertion are enabled
+      \arg        ENET_CHECKSUM_TCPUDPICMP_SEGMENT: TCP/UDP/ICMP checksum insertion calculated but pseudo-header
+      \arg        ENET_CHECKSUM_TCPUDPICMP_FULL: TCP/UDP/ICMP checksum insertion fully calculated
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus enet_frame_transmit_checksum(uint8_t *buffer, uint32_t length, uint32_t checksum)
+{
+    if(ERROR == enet_txframe_submit(buffer, length, checksum)){
+        return ERROR;
+    }
+
+    if(ENET_CHECKSUM_DISABLE == checksum){
+        checksum_stat.tx_software++;
+    }else{
+        checksum_stat.tx_offload++;
     }
 
     return SUCCESS;
 }
 
 /*!
-    \brief      configure the transmit IP frame checksum offload calculation and insertion
-    \param[in]  desc: the descriptor pointer which users want to configure
-    \param[in]  checksum: IP frame checksum configuration
-                only one parameter can be selected which is shown as below
-      \arg        ENET_CHECKSUM_DISABLE: checksum insertion disabled
-      \arg        ENET_CHECKSUM_IPV4HEADER: only IP header checksum calculation and insertion are enabled
-      \arg        ENET_CHECKSUM_TCPUDPICMP_SEGMENT: TCP/UDP/ICMP checksum insertion calculated but pseudo-header
-      \arg        ENET_CHECKSUM_TCPUDPICMP_FULL: TCP/UDP/ICMP checksum insertion fully calculated
+    \brief      get the checksum offload results of current received frame
+                note -- call it before the frame is received, it only reads the descriptors, the
+                statistics count each frame once when it is received, the results are valid
+                only when IP frame checksum offload is enabled by enet_init()
+    \param[in]  none
     \param[out] none
-    \retval     ErrStatus: ERROR, SUCCESS
+    \retval     ENET_RXCSUM_x flags, 0 if it is not an IP frame or the frame is not complete
 */
-ErrStatus enet_transmit_checksum_config(enet_descriptors_struct *desc, uint32_t checksum)
+uint32_t enet_rxframe_checksum_get(void)
 {
-    if(NULL != desc){
-        desc->status &= ~ENET_TDES0_CM;
-        desc->status |= checksum;
-        return SUCCESS;
-    }else{
-        return ERROR;
+    enet_descriptors_struct *desc = dma_current_rxdesc;
+    uint32_t num = 1U;
+
+    if(((uint32_t)RESET != (desc->status & ENET_RDES0_DAV)) || ((uint32_t)RESET == (desc->status & ENET_RDES0_FDES))){
+        return 0U;
+    }
+    /* the results are in the last descriptor of the frame */
+    while((uint32_t)RESET == (desc->status & ENET_RDES0_LDES)){
+        if(rxdesc_num <= num){
+            return 0U;
+        }
+        desc = enet_rxdesc_next(desc);
+        if((uint32_t)RESET != (desc->status & ENET_RDES0_DAV)){
+            return 0U;
+        }
+        num++;
     }
+
+    return enet_rxdesc_checksum(desc);
+}
+
+/*!
+    \brief      get the statistics of the checksum offload
+    \param[in]  none
+    \param[out] stat: the statistics, refer to enet_checksum_stat_struct
+    \retval     none
+*/
+void enet_checksum_stat_get(enet_checksum_stat_struct *stat)
+{
+    *stat = checksum_stat;
+}
+
+/*!
+    \brief      clear the statistics of the checksum offload
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void enet_checksum_stat_clear(void)
+{
+    checksum_stat.rx_verified = 0U;
+    checksum_stat.rx_error = 0U;
+    checksum_stat.rx_unverified = 0U;
+    checksum_stat.tx_offload = 0U;
+    checksum_stat.tx_software = 0U;
 }
 
 /*!
@@ -1530,17 +2260,15 @@ void enet_address_filter_config(enet_macaddress_enum mac_addr, uint32_t addr_mas
 }
 
 /*!
-    \brief      PHY interface configuration (configure SMI clock and reset PHY chip)
+    \brief      configure the SMI clock according to HCLK
     \param[in]  none
     \param[out] none
     \retval     ErrStatus: SUCCESS or ERROR
-*/ 
-ErrStatus enet_phy_config(void)
+*/
+ErrStatus enet_phy_clock_config(void)
 {
     uint32_t ahbclk;
     uint32_t reg;
-    uint16_t phy_value;
-    ErrStatus enet_state = ERROR;
 
     /* clear the previous MDC clock */
     reg = ENET_MAC_PHY_CTL;
@@ -1559,10 +2287,29 @@ ErrStatus enet_phy_config(void)
     }else if((ENET_RANGE(ahbclk, 100000000U, 168000000U))||(168000000U == ahbclk)){
         reg |= ENET_MDC_HCLK_DIV62;    
     }else{
-        return enet_state;
+        return ERROR;
     }
     ENET_MAC_PHY_CTL = reg;
 
+    return SUCCESS;
+}
+
+/*!
+    \brief      PHY interface configuration (configure SMI clock and reset PHY chip)
+    \param[in]  none
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/ 
+ErrStatus enet_phy_config(void)
+{
+    uint16_t phy_value;
+    ErrStatus enet_state = ERROR;
+
+    /* configure the SMI clock */
+    if(ERROR == enet_phy_clock_config()){
+        return enet_state;
+    }
+
     /* reset PHY */
     phy_value = PHY_RESET;
     if(ERROR == (enet_phy_write_read(ENET_PHY_WRITE, PHY_ADDRESS, PHY_REG_BCR, &phy_value))){
@@ -1632,6 +2379,77 @@ ErrStatus enet_phy_write_read(enet_phydirection_enum direction, uint16_t phy_add
     return enet_state;
 }
 
+/*!
+    \brief      start a write to / read from a PHY register without waiting for it
+    \param[in]  direction: only one parameter can be selected which is shown as below, refer to enet_phydirection_enum
+      \arg        ENET_PHY_WRITE: write data to phy register
+      \arg        ENET_PHY_READ:  read data from phy register
+    \param[in]  phy_address: 0x0000 - 0x001F
+    \param[in]  phy_reg: 0x0000 - 0x001F
+    \param[in]  value: the value will be written to the PHY register in ENET_PHY_WRITE direction
+    \param[out] none
+    \retval     ErrStatus: ERROR if a PHY register access is still in progress, SUCCESS otherwise
+*/
+ErrStatus enet_phy_access_start(enet_phydirection_enum direction, uint16_t phy_address, uint16_t phy_reg, uint16_t value)
+{
+    uint32_t reg;
+
+    if((uint32_t)RESET != (ENET_MAC_PHY_CTL & ENET_MAC_PHY_CTL_PB)){
+        return ERROR;
+    }
+
+    /* configure ENET_MAC_PHY_CTL with write/read operation */
+    reg = ENET_MAC_PHY_CTL;
+    reg &= ~(ENET_MAC_PHY_CTL_PB | ENET_MAC_PHY_CTL_PW | ENET_MAC_PHY_CTL_PR | ENET_MAC_PHY_CTL_PA);
+    reg |= (direction | MAC_PHY_CTL_PR(phy_reg) | MAC_PHY_CTL_PA(phy_address) | ENET_MAC_PHY_CTL_PB);
+
+    /* if do the write operation, write value to the register */
+    if(ENET_PHY_WRITE == direction){
+        ENET_MAC_PHY_DATA = value;
+    }
+    ENET_MAC_PHY_CTL = reg;
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      check whether the PHY register access started by enet_phy_access_start() is complete
+    \param[in]  none
+    \param[out] pvalue: the value read from the PHY register, NULL after a write
+    \retval     FlagStatus: SET when the access is complete, RESET while it is in progress
+*/
+FlagStatus enet_phy_access_complete(uint16_t *pvalue)
+{
+    if((uint32_t)RESET != (ENET_MAC_PHY_CTL & ENET_MAC_PHY_CTL_PB)){
+        return RESET;
+    }
+    if(NULL != pvalue){
+        *pvalue = (uint16_t)ENET_MAC_PHY_DATA;
+    }
+
+    return SET;
+}
+
+/*!
+    \brief      configure the MAC speed and duplex mode, used once the PHY reports the link
+    \param[in]  mediamode: only one parameter can be selected which is shown as below, refer to enet_mediamode_enum
+      \arg        ENET_100M_FULLDUPLEX: 100Mbit/s, full-duplex
+      \arg        ENET_100M_HALFDUPLEX: 100Mbit/s, half-duplex
+      \arg        ENET_10M_FULLDUPLEX: 10Mbit/s, full-duplex
+      \arg        ENET_10M_HALFDUPLEX: 10Mbit/s, half-duplex
+    \param[out] none
+    \retval     none
+*/
+void enet_media_config(enet_mediamode_enum mediamode)
+{
+    uint32_t reg_value;
+
+    reg_value = ENET_MAC_CFG;
+    reg_value &= ~(ENET_MAC_CFG_SPD | ENET_MAC_CFG_DPM);
+    reg_value |= ((uint32_t)mediamode & (ENET_MAC_CFG_SPD | ENET_MAC_CFG_DPM));
+    ENET_MAC_CFG = reg_value;
+}
+
 /*!
     \brief      enable the loopback function of PHY chip
     \param[in]  none
@@ -2241,7 +3059,7 @@ void enet_rxframe_drop(void)
             }
         }else{
             /* the next descriptor is the current address, add the descriptor size, and descriptor skip length */
-            dma_current_rxdesc = (enet_descriptors_struct*) (uint32_t)((uint32_t)dma_current_rxdesc + ETH_DMARXDESC_SIZE + GET_DMA_BCTL_DPSL(ENET_DMA_BCTL));
+            dma_current_rxdesc = (enet_descriptors_struct*) (uint32_t)((uint32_t)dma_current_rxdesc + ETH_DMARXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL) << 2U));
             if(NULL != dma_current_ptp_rxdesc){
                 dma_current_ptp_rxdesc++;
             }
@@ -2347,10 +3165,10 @@ void enet_ptp_enhanced_descriptors_chain_init(enet_dmadirection_enum direction)
     /* if want to initialize DMA Tx descriptors */
     if (ENET_DMA_TX == direction){
         /* save a copy of the DMA Tx descriptors */
-        desc_tab = txdesc_tab;
-        buf = &tx_buff[0][0];
-        count = ENET_TXBUF_NUM;
-        maxsize = ENET_TXBUF_SIZE;        
+        desc_tab = txdesc_base;
+        buf = txbuf_base;
+        count = txdesc_num;
+        maxsize = txbuf_size;        
       
         /* select chain mode, and enable transmit timestamp function */
         desc_status = ENET_TDES0_TCHM | ENET_TDES0_TTSEN;
@@ -2361,15 +3179,15 @@ void enet_ptp_enhanced_descriptors_chain_init(enet_dmadirection_enum direction)
     }else{
         /* if want to initialize DMA Rx descriptors */
         /* save a copy of the DMA Rx descriptors */
-        desc_tab = rxdesc_tab;
-        buf = &rx_buff[0][0];
-        count = ENET_RXBUF_NUM;
-        maxsize = ENET_RXBUF_SIZE;       
+        desc_tab = rxdesc_base;
+        buf = rxbuf_base;
+        count = rxdesc_num;
+        maxsize = rxbuf_size;       
   
         /* enable receiving */
         desc_status = ENET_RDES0_DAV;
         /* select receive chained mode and set buffer1 size */
-        desc_bufsize = ENET_RDES1_RCHM | (uint32_t)ENET_RXBUF_SIZE;
+        desc_bufsize = ENET_RDES1_RCHM | rxbuf_size;
       
         /* configure DMA Rx descriptor table address register */
         ENET_DMA_RDTADDR = (uint32_t)desc_tab;
@@ -2422,10 +3240,10 @@ void enet_ptp_enhanced_descriptors_ring_init(enet_dmadirection_enum direction)
     /* if want to initialize DMA Tx descriptors */
     if (ENET_DMA_TX == direction){
         /* save a copy of the DMA Tx descriptors */
-        desc_tab = txdesc_tab;
-        buf = &tx_buff[0][0];
-        count = ENET_TXBUF_NUM;
-        maxsize = ENET_TXBUF_SIZE;      
+        desc_tab = txdesc_base;
+        buf = txbuf_base;
+        count = txdesc_num;
+        maxsize = txbuf_size;      
 
         /* select ring mode, and enable transmit timestamp function */
         desc_status = ENET_TDES0_TTSEN;
@@ -2436,15 +3254,15 @@ void enet_ptp_enhanced_descriptors_ring_init(enet_dmadirection_enum direction)
     }else{
         /* if want to initialize DMA Rx descriptors */
         /* save a copy of the DMA Rx descriptors */
-        desc_tab = rxdesc_tab;
-        buf = &rx_buff[0][0];
-        count = ENET_RXBUF_NUM;
-        maxsize = ENET_RXBUF_SIZE;      
+        desc_tab = rxdesc_base;
+        buf = rxbuf_base;
+        count = rxdesc_num;
+        maxsize = rxbuf_size;      
       
         /* enable receiving */
         desc_status = ENET_RDES0_DAV;
         /* set buffer1 size */
-        desc_bufsize = ENET_RXBUF_SIZE;
+        desc_bufsize = rxbuf_size;
       
          /* configure DMA Rx descriptor table address register */
         ENET_DMA_RDTADDR = (uint32_t)desc_tab;
@@ -2565,7 +3383,7 @@ ErrStatus enet_ptpframe_receive_enhanced_mode(uint8_t *buffer, uint32_t bufsize,
             dma_current_rxdesc = (enet_descriptors_struct*) (ENET_DMA_RDTADDR);      
         }else{ 
             /* the next descriptor is the current address, add the descriptor size, and descriptor skip length */
-            dma_current_rxdesc = (enet_descriptors_struct*) ((uint32_t)dma_current_rxdesc + ETH_DMARXDESC_SIZE + GET_DMA_BCTL_DPSL(ENET_DMA_BCTL));      
+            dma_current_rxdesc = (enet_descriptors_struct*) ((uint32_t)dma_current_rxdesc + ETH_DMARXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL) << 2U));      
         }
     }
   
@@ -2609,7 +3427,7 @@ ErrStatus enet_ptpframe_transmit_enhanced_mode(uint8_t *buffer, uint32_t length,
     /* set the frame length */
     dma_current_txdesc->control_buffer_size = length;
     /* set the segment of frame, frame is transmitted in one descriptor */   
-    dma_current_txdesc->status |= ENET_TDES0_LSG | ENET_TDES0_FSG;
+    dma_current_txdesc->status = (dma_current_txdesc->status & ~ENET_TDES0_CM) | ENET_TDES0_LSG | ENET_TDES0_FSG;
     /* enable the DMA transmission */
     dma_current_txdesc->status |= ENET_TDES0_DAV;
 
@@ -2655,7 +3473,7 @@ ErrStatus enet_ptpframe_transmit_enhanced_mode(uint8_t *buffer, uint32_t length,
             dma_current_txdesc = (enet_descriptors_struct*) (ENET_DMA_TDTADDR);      
         }else{ 
             /* the next descriptor is the current address, add the descriptor size, and descriptor skip length */
-            dma_current_txdesc = (enet_descriptors_struct*) ((uint32_t)dma_current_txdesc + ETH_DMATXDESC_SIZE + GET_DMA_BCTL_DPSL(ENET_DMA_BCTL));
+            dma_current_txdesc = (enet_descriptors_struct*) ((uint32_t)dma_current_txdesc + ETH_DMATXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL) << 2U));
         }
     }
 
@@ -2695,10 +3513,10 @@ void enet_ptp_normal_descriptors_chain_init(enet_dmadirection_enum direction, en
     /* if want to initialize DMA Tx descriptors */
     if(ENET_DMA_TX == direction){
         /* save a copy of the DMA Tx descriptors */
-        desc_tab = txdesc_tab;
-        buf = &tx_buff[0][0];
-        count = ENET_TXBUF_NUM;
-        maxsize = ENET_TXBUF_SIZE;        
+        desc_tab = txdesc_base;
+        buf = txbuf_base;
+        count = txdesc_num;
+        maxsize = txbuf_size;        
 
         /* select chain mode, and enable transmit timestamp function */
         desc_status = ENET_TDES0_TCHM | ENET_TDES0_TTSEN;
@@ -2710,15 +3528,15 @@ void enet_ptp_normal_descriptors_chain_init(enet_dmadirection_enum direction, en
     }else{
         /* if want to initialize DMA Rx descriptors */
         /* save a copy of the DMA Rx descriptors */
-        desc_tab = rxdesc_tab;
-        buf = &rx_buff[0][0];
-        count = ENET_RXBUF_NUM;
-        maxsize = ENET_RXBUF_SIZE;       
+        desc_tab = rxdesc_base;
+        buf = rxbuf_base;
+        count = rxdesc_num;
+        maxsize = rxbuf_size;       
 
         /* enable receiving */
         desc_status = ENET_RDES0_DAV;
         /* select receive chained mode and set buffer1 size */
-        desc_bufsize = ENET_RDES1_RCHM | (uint32_t)ENET_RXBUF_SIZE;
+        desc_bufsize = ENET_RDES1_RCHM | rxbuf_size;
 
         /* configure DMA Rx descriptor table address register */
         ENET_DMA_RDTADDR = (uint32_t)desc_tab;
@@ -2778,10 +3596,10 @@ void enet_ptp_normal_descriptors_ring_init(enet_dmadirection_enum direction, ene
     /* if want to initialize DMA Tx descriptors */
     if(ENET_DMA_TX == direction){
         /* save a copy of the DMA Tx descriptors */
-        desc_tab = txdesc_tab;
-        buf = &tx_buff[0][0];
-        count = ENET_TXBUF_NUM;
-        maxsize = ENET_TXBUF_SIZE;        
+        desc_tab = txdesc_base;
+        buf = txbuf_base;
+        count = txdesc_num;
+        maxsize = txbuf_size;        
 
         /* select ring mode, and enable transmit timestamp function */
         desc_status = ENET_TDES0_TTSEN;
@@ -2793,15 +3611,15 @@ void enet_ptp_normal_descriptors_ring_init(enet_dmadirection_enum direction, ene
     }else{
         /* if want to initialize DMA Rx descriptors */
         /* save a copy of the DMA Rx descriptors */
-        desc_tab = rxdesc_tab;
-        buf = &rx_buff[0][0];
-        count = ENET_RXBUF_NUM;
-        maxsize = ENET_RXBUF_SIZE;
+        desc_tab = rxdesc_base;
+        buf = rxbuf_base;
+        count = rxdesc_num;
+        maxsize = rxbuf_size;
 
         /* enable receiving */
         desc_status = ENET_RDES0_DAV;
         /* select receive ring mode and set buffer1 size */
-        desc_bufsize = (uint32_t)ENET_RXBUF_SIZE;
+        desc_bufsize = rxbuf_size;
 
         /* configure DMA Rx descriptor table address register */
         ENET_DMA_RDTADDR = (uint32_t)desc_tab;
@@ -2923,7 +3741,7 @@ ErrStatus enet_ptpframe_receive_normal_mode(uint8_t *buffer, uint32_t bufsize, u
             dma_current_ptp_rxdesc = (enet_descriptors_struct*) (dma_current_ptp_rxdesc->status);
         }else{
             /* the next descriptor is the current address, add the descriptor size, and descriptor skip length */
-            dma_current_rxdesc = (enet_descriptors_struct*) (uint32_t)((uint32_t)dma_current_rxdesc + ETH_DMARXDESC_SIZE + GET_DMA_BCTL_DPSL(ENET_DMA_BCTL));
+            dma_current_rxdesc = (enet_descriptors_struct*) (uint32_t)((uint32_t)dma_current_rxdesc + ETH_DMARXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL) << 2U));
             dma_current_ptp_rxdesc ++;
         }
     }
@@ -2965,7 +3783,7 @@ ErrStatus enet_ptpframe_transmit_normal_mode(uint8_t *buffer, uint32_t length, u
     /* set the frame length */
     dma_current_txdesc->control_buffer_size = (length & (uint32_t)0x1FFF);
     /* set the segment of frame, frame is transmitted in one descriptor */
-    dma_current_txdesc->status |= ENET_TDES0_LSG | ENET_TDES0_FSG;
+    dma_current_txdesc->status = (dma_current_txdesc->status & ~ENET_TDES0_CM) | ENET_TDES0_LSG | ENET_TDES0_FSG;
     /* enable the DMA transmission */
     dma_current_txdesc->status |= ENET_TDES0_DAV;
 
@@ -3024,7 +3842,7 @@ ErrStatus enet_ptpframe_transmit_normal_mode(uint8_t *buffer, uint32_t length, u
             dma_current_ptp_txdesc = (enet_descriptors_struct*) (dma_current_ptp_txdesc->status);
         }else{
             /* the next descriptor is the current address, add the descriptor size, and descriptor skip length */
-            dma_current_txdesc = (enet_descriptors_struct*) (uint32_t)((uint32_t)dma_current_txdesc + ETH_DMATXDESC_SIZE + GET_DMA_BCTL_DPSL(ENET_DMA_BCTL));
+            dma_current_txdesc = (enet_descriptors_struct*) (uint32_t)((uint32_t)dma_current_txdesc + ETH_DMATXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL) << 2U));
             dma_current_ptp_txdesc ++;
         }
     }
@@ -3669,6 +4487,260 @@ static void enet_default_init(void)
     ENET_DMA_BCTL = reg_value; 
 }
 
+/*!
+    \brief      get the next descriptor in RxDMA descriptor table
+    \param[in]  desc: the current RxDMA descriptor
+    \param[out] none
+    \retval     the next RxDMA descriptor
+*/
+static enet_descriptors_struct *enet_rxdesc_next(enet_descriptors_struct *desc)
+{
+    /* chained mode */
+    if((uint32_t)RESET != (desc->control_buffer_size & ENET_RDES1_RCHM)){
+        return (enet_descriptors_struct *)(desc->buffer2_next_desc_addr);
+    }
+    /* ring mode, the last descriptor in table is followed by the table header */
+    if((uint32_t)RESET != (desc->control_buffer_size & ENET_RDES1_RERM)){
+        return (enet_descriptors_struct *)(ENET_DMA_RDTADDR);
+    }
+    /* the next descriptor is the current address, add the descriptor size, and descriptor skip length */
+    return (enet_descriptors_struct *)(uint32_t)((uint32_t)desc + ETH_DMARXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL) << 2U));
+}
+
+/*!
+    \brief      get the next descriptor in TxDMA descriptor table
+    \param[in]  desc: the current TxDMA descriptor
+    \param[out] none
+    \retval     the next TxDMA descriptor
+*/
+static enet_descriptors_struct *enet_txdesc_next(enet_descriptors_struct *desc)
+{
+    /* chained mode */
+    if((uint32_t)RESET != (desc->status & ENET_TDES0_TCHM)){
+        return (enet_descriptors_struct *)(desc->buffer2_next_desc_addr);
+    }
+    /* ring mode, the last descriptor in table is followed by the table header */
+    if((uint32_t)RESET != (desc->status & ENET_TDES0_TERM)){
+        return (enet_descriptors_struct *)(ENET_DMA_TDTADDR);
+    }
+    /* the next descriptor is the current address, add the descriptor size, and descriptor skip length */
+    return (enet_descriptors_struct *)(uint32_t)((uint32_t)desc + ETH_DMATXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL) << 2U));
+}
+
+/*!
+    \brief      get the index of a Tx descriptor in the descriptor table
+    \param[in]  desc: the TxDMA descriptor
+    \param[out] none
+    \retval     index of the descriptor, also the index of its buffer and token
+*/
+static uint32_t enet_txdesc_index(enet_descriptors_struct *desc)
+{
+    uint32_t stride = ETH_DMATXDESC_SIZE;
+
+    /* ring mode descriptors are spaced by the descriptor skip length in words */
+    if((uint32_t)RESET == (desc->status & ENET_TDES0_TCHM)){
+        stride += GET_DMA_BCTL_DPSL(ENET_DMA_BCTL) << 2U;
+    }
+
+    return ((uint32_t)desc - ENET_DMA_TDTADDR) / stride;
+}
+
+/*!
+    \brief      give spare buffers to the lent Rx descriptors in order, and return them to DMA
+                note -- called with interrupts disabled
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void enet_rxdesc_rearm(void)
+{
+    while((0U != rxdesc_pending) && (0U != rxpool_head)){
+        dma_rearm_rxdesc->buffer1_addr = rxpool_head;
+        rxpool_head = *(uint32_t *)rxpool_head;
+        /* enable reception, descriptor is owned by DMA */
+        dma_rearm_rxdesc->status = ENET_RDES0_DAV;
+        dma_rearm_rxdesc = enet_rxdesc_next(dma_rearm_rxdesc);
+        rxdesc_pending--;
+    }
+
+    /* check Rx buffer unavailable flag status */
+    if((uint32_t)RESET != (ENET_DMA_STAT & ENET_DMA_STAT_RBU)){
+        /* clear RBU flag */
+        ENET_DMA_STAT = ENET_DMA_STAT_RBU;
+        /* resume DMA reception by writing to the RPEN register*/
+        ENET_DMA_RPEN = 0U;
+    }
+}
+
+/*!
+    \brief      check the memory is reachable by ENET DMA
+    \param[in]  addr: start address of the memory, 4 bytes aligned
+    \param[in]  size: size of the memory in bytes
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus enet_dma_memory_check(void *addr, uint32_t size)
+{
+    uint32_t start = (uint32_t)addr;
+    uint32_t end = start + size;
+
+    if((NULL == addr) || (0U != (start & 3U)) || (end <= start)){
+        return ERROR;
+    }
+    /* ENET DMA masters the SRAM and the external memories */
+    if((start >= SRAM_BASE) && (end <= 0x40000000U)){
+        return SUCCESS;
+    }
+    if((start >= 0x60000000U) && (end <= 0xE0000000U)){
+        return SUCCESS;
+    }
+
+    return ERROR;
+}
+
+/*!
+    \brief      decode the checksum offload results in the last Rx descriptor of a frame
+    \param[in]  desc: the last descriptor of a received frame
+    \param[out] none
+    \retval     ENET_RXCSUM_x flags
+*/
+static uint32_t enet_rxdesc_checksum(enet_descriptors_struct *desc)
+{
+    uint32_t status = desc->status, flags = 0U;
+#ifdef SELECT_DESCRIPTORS_ENHANCED_MODE
+    uint32_t ext = desc->extended_status;
+#endif /* SELECT_DESCRIPTORS_ENHANCED_MODE */
+
+    /* the receive checksum offload is disabled */
+    if((uint32_t)RESET == (ENET_MAC_CFG & ENET_MAC_CFG_IPFCO)){
+        return 0U;
+    }
+
+#ifdef SELECT_DESCRIPTORS_ENHANCED_MODE
+    /* the extended status is valid for IP frames only */
+    if(((uint32_t)RESET != (status & ENET_RDES0_EXSV)) &&
+            ((uint32_t)RESET != (ext & (ENET_RDES4_IPF4 | ENET_RDES4_IPF6)))){
+        flags = ENET_RXCSUM_IP;
+        if((uint32_t)RESET != (ext & ENET_RDES4_IPF6)){
+            flags |= ENET_RXCSUM_IPV6;
+        }
+        if((uint32_t)RESET == (ext & ENET_RDES4_IPCKSB)){
+            if((uint32_t)RESET != (ext & ENET_RDES4_IPHERR)){
+                flags |= ENET_RXCSUM_IPHDR_ERR;
+            }else{
+                flags |= ENET_RXCSUM_IPHDR_OK;
+            }
+            if((uint32_t)RESET != (ext & ENET_RDES4_IPPLDERR)){
+                flags |= ENET_RXCSUM_PAYLOAD_ERR;
+            }else if(0U != GET_RDES4_IPPLDT(ext)){
+                /* the payload is UDP, TCP or ICMP */
+                flags |= ENET_RXCSUM_PAYLOAD_OK;
+            }else{
+                /* unknown payload, not checked */
+            }
+        }
+    }
+#else
+    if((uint32_t)RESET != (status & ENET_RDES0_FRMT)){
+        /* IPv4 or IPv6 frame, both checksums are checked */
+        flags = ENET_RXCSUM_IP;
+        if((uint32_t)RESET != (status & ENET_RDES0_IPHERR)){
+            flags |= ENET_RXCSUM_IPHDR_ERR;
+        }else{
+            flags |= ENET_RXCSUM_IPHDR_OK;
+        }
+        if((uint32_t)RESET != (status & ENET_RDES0_PCERR)){
+            flags |= ENET_RXCSUM_PAYLOAD_ERR;
+        }else{
+            flags |= ENET_RXCSUM_PAYLOAD_OK;
+        }
+    }else if(((uint32_t)RESET != (status & ENET_RDES0_PCERR)) &&
+              ((uint32_t)RESET == (status & ENET_RDES0_IPHERR))){
+        /* IP frame with an unsupported payload, the payload check is bypassed */
+        flags = ENET_RXCSUM_IP | ENET_RXCSUM_IPHDR_OK;
+    }else{
+        /* not an IP frame */
+    }
+#endif /* SELECT_DESCRIPTORS_ENHANCED_MODE */
+
+    return flags;
+}
+
+/*!
+    \brief      count the checksum offload results of a received frame in the statistics
+    \param[in]  flags: ENET_RXCSUM_x flags of the frame
+    \param[out] none
+    \retval     none
+*/
+static void enet_rxchecksum_count(uint32_t flags)
+{
+    if(0U != (flags & (ENET_RXCSUM_IPHDR_ERR | ENET_RXCSUM_PAYLOAD_ERR))){
+        checksum_stat.rx_error++;
+    }else if((ENET_RXCSUM_IPHDR_OK | ENET_RXCSUM_PAYLOAD_OK) == (flags & (ENET_RXCSUM_IPHDR_OK | ENET_RXCSUM_PAYLOAD_OK))){
+        checksum_stat.rx_verified++;
+    }else if(0U != flags){
+        checksum_stat.rx_unverified++;
+    }else{
+        /* not an IP frame, or the offload is disabled */
+    }
+}
+
+/*!
+    \brief        hand the frame in current TxDMA descriptor to DMA, with the checksum insertion of this frame
+    \param[in]  buffer: pointer to the frame data to be transmitted, NULL if it is already in the Tx buffer
+    \param[in]  length: the length of frame data to be transmitted
+    \param[in]  checksum: IP frame checksum insertion of the frame, ENET_CHECKSUM_x
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus enet_txframe_submit(uint8_t *buffer, uint32_t length, uint32_t checksum)
+{
+    uint32_t offset = 0U;
+    uint32_t dma_tbu_flag, dma_tu_flag;
+
+    /* the descriptor is busy due to own by the DMA */
+    if((uint32_t)RESET != (dma_current_txdesc->status & ENET_TDES0_DAV)){
+        return ERROR;
+    }
+
+    /* only frame length no more than ENET_MAX_FRAME_SIZE and the Tx buffer size is allowed */
+    if((length > ENET_MAX_FRAME_SIZE) || (length > txbuf_size)){
+        return ERROR;
+    }
+
+    /* if buffer pointer is null, indicates that users has handled data in application */
+    if(NULL != buffer){    
+        /* copy frame data from application buffer to Tx buffer */
+        for(offset = 0U; offset < length; offset++){
+            (*(__IO uint8_t *) (uint32_t)((dma_current_txdesc->buffer1_addr) + offset)) = (*(buffer + offset));
+        }
+    }
+
+    /* set the frame length */
+    dma_current_txdesc->control_buffer_size = length;
+    /* set the segment of frame, frame is transmitted in one descriptor, and the checksum insertion
+       of this frame, not the one a previous frame left in the descriptor */
+    dma_current_txdesc->status = (dma_current_txdesc->status & ~ENET_TDES0_CM) | checksum | ENET_TDES0_LSG | ENET_TDES0_FSG;
+    /* enable the DMA transmission */
+    dma_current_txdesc->status |= ENET_TDES0_DAV;
+
+    /* check Tx buffer unavailable flag status */
+    dma_tbu_flag = (ENET_DMA_STAT & ENET_DMA_STAT_TBU); 
+    dma_tu_flag = (ENET_DMA_STAT & ENET_DMA_STAT_TU);
+
+    if ((RESET != dma_tbu_flag) || (RESET != dma_tu_flag)){
+        /* clear TBU and TU flag */
+        ENET_DMA_STAT = (dma_tbu_flag | dma_tu_flag);
+        /* resume DMA transmission by writing to the TPEN register*/
+        ENET_DMA_TPEN = 0U;
+    }
+
+    /* update the current TxDMA descriptor pointer to the next decriptor in TxDMA decriptor table*/
+    dma_current_txdesc = enet_txdesc_next(dma_current_txdesc);
+
+    return SUCCESS;
+}
+
 #ifndef USE_DELAY
 /*!
     \brief      insert a delay time
@@ -0,0 +1,304 @@
+/*!
+    \file    critical_latency.c
+    \brief   latency of the highest priority interrupt behind the gd32_drivers critical sections
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+/*
+    The System Control Space is plain memory mapped at its address, so NVIC_GetPriorityGrouping()
+    and the BASEPRI encoding of gd32_common.c run unmodified. A timer signal raises two interrupts
+    every 50 us: IRQ_HIGH at pre-emption priority 0, a fault or PWM handler, and IRQ_LOW at
+    priority 2, a UART or DMA handler. A masked interrupt stays pending until the critical section
+    lowers the mask, conf/core_cmFunc.h then delivers it through cmsis_host_unmasked.
+
+    The latency is measured from the signal to the handler. It only holds the delay added by the
+    masks, the entry time of a Cortex-M4 exception (12 cycles) comes on top on the MCU. The maximum
+    also holds the times the host scheduler took the CPU away from the test. The hold
+    times stand for a flash write of 8 and of 64 words at about 16 us each.
+*/
+
+#define _GNU_SOURCE
+
+#include "sdk_board.h"
+#include "gd32_common.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <time.h>
+
+#define SCS_MAP_BASE            0xE0000000UL    /* DWT, SysTick, NVIC and SCB */
+#define SCS_MAP_SIZE            0x10000UL
+#define RAISE_PERIOD_US         50
+#define RUN_NS                  400000000ULL    /* time of each case */
+
+enum {
+    IRQ_HIGH = 0,
+    IRQ_LOW,
+    IRQ_NUM
+};
+
+/* a section style under test */
+typedef enum {
+    CS_INTERRUPT_DISABLE = 0,                   /* sdk_hw_interrupt_disable(), PRIMASK */
+    CS_CRITICAL,                                /* sdk_hw_critical_enter(), BASEPRI */
+    CS_CRITICAL_NESTED                          /* two nested sdk_hw_critical_enter() */
+} cs_style_enum;
+
+static const char *const style_name[] = {"interrupt_disable", "critical", "critical nested"};
+static const uint32_t hold_us[] = {128U, 1024U};
+
+/* state of a simulated interrupt */
+typedef struct {
+    uint32_t prio;                              /* priority byte as written to NVIC_IP */
+    volatile uint32_t pending;
+    volatile uint64_t raise_ns;
+    volatile uint32_t count;                    /* handler runs */
+    volatile uint32_t deferred;                 /* runs that waited for a mask */
+    volatile uint64_t wait_ns;                  /* sum of the latencies of the deferred runs */
+    volatile uint64_t max_ns;
+} irq_state_struct;
+
+static irq_state_struct irq[IRQ_NUM];
+static volatile uint32_t in_section;            /* the masked part of the workload is running */
+static volatile uint32_t errors;
+
+/* monotonic time in ns, also safe from the signal handler */
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* the interrupt is masked by PRIMASK or by BASEPRI */
+static uint32_t irq_masked(const irq_state_struct *s)
+{
+    if(0U != cmsis_host_primask) {
+        return 1U;
+    }
+    return ((0U != cmsis_host_basepri) && (s->prio >= cmsis_host_basepri)) ? 1U : 0U;
+}
+
+/* the handler of both interrupts, a lower priority one must never run inside a section */
+static void irq_handler(irq_state_struct *s, uint64_t raise_ns, uint32_t deferred)
+{
+    uint64_t latency = time_ns() - raise_ns;
+
+    if((0U != in_section) && (&irq[IRQ_LOW] == s)) {
+        errors++;
+    }
+    s->count++;
+    if(0U != deferred) {
+        s->deferred++;
+        s->wait_ns += latency;
+    }
+    if(latency > s->max_ns) {
+        s->max_ns = latency;
+    }
+}
+
+/* a mask was lowered, deliver what it held back */
+static void irq_unmasked(void)
+{
+    uint32_t i;
+
+    for(i = 0U; i < IRQ_NUM; i++) {
+        if((0U != irq[i].pending) && (0U == irq_masked(&irq[i]))) {
+            /* the timer signal may deliver it at the same moment */
+            if(0U != __atomic_exchange_n(&irq[i].pending, 0U, __ATOMIC_SEQ_CST)) {
+                irq_handler(&irq[i], irq[i].raise_ns, 1U);
+            }
+        }
+    }
+}
+
+/* the timer signal raises both interrupts */
+static void irq_raise(int sig)
+{
+    uint64_t now = time_ns();
+    uint32_t i;
+
+    (void)sig;
+    for(i = 0U; i < IRQ_NUM; i++) {
+        if(0U != irq[i].pending) {
+            continue;
+        }
+        if(0U != irq_masked(&irq[i])) {
+            irq[i].raise_ns = now;
+            __atomic_store_n(&irq[i].pending, 1U, __ATOMIC_SEQ_CST);
+        } else {
+            irq_handler(&irq[i], now, 0U);
+        }
+    }
+}
+
+/* busy wait, the flash programming time of the real section */
+static void hold(uint32_t us)
+{
+    uint64_t end = time_ns() + (uint64_t)us * 1000ULL;
+
+    while(time_ns() < end) {
+    }
+}
+
+/* run one section style for RUN_NS, half of the time inside the section */
+static void run_case(cs_style_enum style, uint32_t us)
+{
+    uint64_t end;
+    uint32_t level, inner;
+
+    memset(irq, 0, sizeof(irq));
+    irq[IRQ_HIGH].prio = NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0U, 0U) << (8U - __NVIC_PRIO_BITS);
+    irq[IRQ_LOW].prio = NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 2U, 0U) << (8U - __NVIC_PRIO_BITS);
+
+    end = time_ns() + RUN_NS;
+    while(time_ns() < end) {
+        switch(style) {
+        case CS_INTERRUPT_DISABLE:
+            sdk_hw_interrupt_disable();
+            in_section = 1U;
+            hold(us);
+            in_section = 0U;
+            sdk_hw_interrupt_enable();
+            break;
+        case CS_CRITICAL:
+            level = sdk_hw_critical_enter();
+            in_section = 1U;
+            hold(us);
+            in_section = 0U;
+            sdk_hw_critical_exit(level);
+            break;
+        default:
+            level = sdk_hw_critical_enter();
+            in_section = 1U;
+            hold(us / 2U);
+            inner = sdk_hw_critical_enter();
+            hold(us / 2U);
+            sdk_hw_critical_exit(inner);
+            /* still inside the outer section, the inner exit must not unmask */
+            hold(us / 2U);
+            in_section = 0U;
+            sdk_hw_critical_exit(level);
+            break;
+        }
+        hold(us);
+    }
+}
+
+/* nesting of the PRIMASK pair, and an enable without a disable */
+static void check_interrupt_nesting(void)
+{
+    sdk_hw_interrupt_disable();
+    sdk_hw_interrupt_disable();
+    sdk_hw_interrupt_enable();
+    if(0U == cmsis_host_primask) {
+        printf("nested sdk_hw_interrupt_enable() unmasked early\n");
+        errors++;
+    }
+    sdk_hw_interrupt_enable();
+    if(0U != cmsis_host_primask) {
+        printf("outer sdk_hw_interrupt_enable() left PRIMASK set\n");
+        errors++;
+    }
+    /* the masks of some start up code, then an enable that has no disable */
+    __disable_irq();
+    sdk_hw_interrupt_enable();
+    if(0U != cmsis_host_primask) {
+        printf("unbalanced sdk_hw_interrupt_enable() left PRIMASK set\n");
+        errors++;
+    }
+}
+
+int main(void)
+{
+    struct sigaction sa;
+    struct itimerval it;
+    irq_state_struct *s;
+    uint32_t style, h, i, level, basepri;
+
+    if(MAP_FAILED == mmap((void *)SCS_MAP_BASE, SCS_MAP_SIZE, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0)) {
+        perror("mmap SCS");
+        return 1;
+    }
+    NVIC_SetPriorityGrouping(3U);               /* 4 bits of pre-emption priority, as NVIC_PRIGROUP_PRE4_SUB0 */
+    sdk_hw_critical_threshold_set(SDK_HW_CRITICAL_PREEMPT_PRIO);
+
+    check_interrupt_nesting();
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = irq_raise;
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &sa, NULL);
+    cmsis_host_unmasked = irq_unmasked;
+    it.it_interval.tv_sec = 0;
+    it.it_interval.tv_usec = RAISE_PERIOD_US;
+    it.it_value = it.it_interval;
+    setitimer(ITIMER_REAL, &it, NULL);
+
+    level = sdk_hw_critical_enter();
+    basepri = cmsis_host_basepri;
+    sdk_hw_critical_exit(level);
+    printf("critical threshold pre-emption priority %u, BASEPRI 0x%02x\n",
+           (unsigned)SDK_HW_CRITICAL_PREEMPT_PRIO, (unsigned)basepri);
+    printf("section             hold us  irq   prio  count  deferred  wait us   max us\n");
+    for(style = CS_INTERRUPT_DISABLE; style <= CS_CRITICAL_NESTED; style++) {
+        for(h = 0U; h < sizeof(hold_us) / sizeof(hold_us[0]); h++) {
+            run_case((cs_style_enum)style, hold_us[h]);
+            for(i = 0U; i < IRQ_NUM; i++) {
+                s = &irq[i];
+                printf("%-18s %8u  %-4s  0x%02x %6u %9u %8.1f %8.1f\n", style_name[style], (unsigned)hold_us[h],
+                       (IRQ_HIGH == i) ? "high" : "low", (unsigned)s->prio, (unsigned)s->count, (unsigned)s->deferred,
+                       (0U != s->deferred) ? (double)s->wait_ns / s->deferred / 1000.0 : 0.0, (double)s->max_ns / 1000.0);
+            }
+            /* under BASEPRI the highest priority interrupt is never held back */
+            if((CS_INTERRUPT_DISABLE != style) && (0U != irq[IRQ_HIGH].deferred)) {
+                printf("%s held back the priority 0 interrupt\n", style_name[style]);
+                errors++;
+            }
+            if((0U == irq[IRQ_LOW].deferred) || ((CS_INTERRUPT_DISABLE == style) && (0U == irq[IRQ_HIGH].deferred))) {
+                printf("%s did not mask\n", style_name[style]);
+                errors++;
+            }
+        }
+    }
+
+    it.it_value.tv_usec = 0;
+    it.it_interval.tv_usec = 0;
+    setitimer(ITIMER_REAL, &it, NULL);
+    printf("%s\n", (0U == errors) ? "PASS" : "FAIL");
+    return (0U == errors) ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+/*!
+    \file    core_cmFunc.h
+    \brief   host replacement of the CMSIS core register access functions
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef __CORE_CMFUNC_H
+#define __CORE_CMFUNC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* the drivers only mask interrupts around short critical sections, the masks are kept
+   so that a test can check them, a test raising its own interrupts sets cmsis_host_unmasked
+   to deliver the pending ones when a mask is lowered */
+extern volatile uint32_t cmsis_host_primask;
+extern volatile uint32_t cmsis_host_basepri;
+extern void (*volatile cmsis_host_unmasked)(void);
+
+static inline uint32_t __get_PRIMASK(void)
+{
+    return cmsis_host_primask;
+}
+
+static inline void __set_PRIMASK(uint32_t priMask)
+{
+    cmsis_host_primask = priMask;
+    if((0U == priMask) && (NULL != cmsis_host_unmasked)) {
+        cmsis_host_unmasked();
+    }
+}
+
+static inline void __disable_irq(void)
+{
+    cmsis_host_primask = 1U;
+}
+
+static inline void __enable_irq(void)
+{
+    cmsis_host_primask = 0U;
+    if(NULL != cmsis_host_unmasked) {
+        cmsis_host_unmasked();
+    }
+}
+
+static inline uint32_t __get_BASEPRI(void)
+{
+    return cmsis_host_basepri;
+}
+
+static inline void __set_BASEPRI(uint32_t basePri)
+{
+    cmsis_host_basepri = basePri;
+    if(NULL != cmsis_host_unmasked) {
+        cmsis_host_unmasked();
+    }
+}
+
+#endif /* __CORE_CMFUNC_H */
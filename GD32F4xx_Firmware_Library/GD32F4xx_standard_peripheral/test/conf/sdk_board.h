@@ -0,0 +1,64 @@
+/*!
+    \file    sdk_board.h
+    \brief   host stand-in for the board header of the SDK the gd32_drivers are built in
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef SDK_BOARD_H
+#define SDK_BOARD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "gd32f4xx.h"
+
+/* the error codes of the SDK, the drivers return them negated */
+typedef int32_t sdk_err_t;
+
+#define SDK_OK                      0
+#define SDK_ERROR                   1
+#define SDK_E_TIMEOUT               2
+#define SDK_E_FULL                  3
+#define SDK_E_EMPTY                 4
+#define SDK_E_NOMEM                 5
+#define SDK_E_BUSY                  7
+#define SDK_E_INVALID               10
+
+#define SDK_SYSTICK_PER_SECOND      1000U
+
+/* PRIMASK pair of gd32_common.c */
+void sdk_hw_interrupt_enable(void);
+void sdk_hw_interrupt_disable(void);
+
+/* ticks of SDK_SYSTICK_PER_SECOND, provided by each test */
+uint32_t sdk_hw_get_systick(void);
+
+#endif /* SDK_BOARD_H */
@@ -0,0 +1,47 @@
+/*!
+    \file    sdk_log.h
+    \brief   host stand-in for the log header of the SDK the gd32_drivers are built in
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef SDK_LOG_H
+#define SDK_LOG_H
+
+#include <stdio.h>
+
+/* the driver sets DBG_TAG and DBG_LVL before the include, every level goes to stdout */
+#define LOG_E(...)                  do { printf("E/" DBG_TAG ": " __VA_ARGS__); printf("\n"); } while(0)
+#define LOG_W(...)                  do { printf("W/" DBG_TAG ": " __VA_ARGS__); printf("\n"); } while(0)
+#define LOG_I(...)                  do { printf("I/" DBG_TAG ": " __VA_ARGS__); printf("\n"); } while(0)
+#define LOG_D(...)                  do { printf("D/" DBG_TAG ": " __VA_ARGS__); printf("\n"); } while(0)
+
+#endif /* SDK_LOG_H */
@@ -0,0 +1,670 @@
+/*!
+    \file    enet_dma_bench.c
+    \brief   ENET driver receive and transmit paths against the host DMA model
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+/*
+    The bench measures the CPU time the driver spends in each path, the DMA model runs between
+    the measured batches. The times are those of the host CPU, they compare driver changes, they are
+    not the times of the MCU. x100M is the frame rate relative to a 100 Mbit/s line.
+*/
+
+/* the compiler intrinsics go first, CMSIS redefines names they use */
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define BENCH_CYCLES()           __rdtsc()
+#else
+    #define BENCH_CYCLES()           0ULL
+#endif
+
+#include "enet_model.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#define BENCH_FRAMES                 200000U    /* frames of each measurement */
+#define BENCH_VERIFY_FRAMES          2000U      /* frames checked byte by byte before each measurement */
+#define BENCH_ETHERTYPE              0x88B5U    /* local experimental ethertype */
+#define BENCH_HDR_LEN                18U        /* MAC header and sequence number */
+#define BENCH_LINE_RATE              100000000.0
+#define BENCH_WIRE_EXTRA             24U        /* CRC, preamble and interframe gap */
+#define BENCH_SPAN_DESC_NUM          16U        /* Rx descriptors of the ring with small buffers */
+#define BENCH_SPAN_BUF_SIZE          256U       /* their buffer size, a long frame spans 6 of them */
+
+/* a measured path of the driver */
+typedef enum
+{
+    BENCH_RX_COPY = 0,                          /* enet_rxframe_size_get() and enet_frame_receive() */
+    BENCH_RX_POLL,                              /* enet_rx_poll() lending the frames without copy */
+    BENCH_TX_COPY,                              /* enet_frame_transmit() */
+    BENCH_TX_SG                                 /* enet_frame_transmit_sg() and enet_tx_reclaim() */
+} bench_path_enum;
+
+static const char *const path_name[] = {"rx copy", "rx poll", "tx copy", "tx sg"};
+static const uint32_t frame_len[] = {60U, 508U, 1514U};
+
+static uint8_t bench_mac[6] = {0x02U, 0x00U, 0x00U, 0x00U, 0x00U, 0x01U};
+
+/* application side buffers */
+static uint8_t rx_store[ENET_RXBUF_NUM][ENET_MAX_FRAME_SIZE];
+static uint8_t rx_pool[ENET_RXBUF_NUM][ENET_RXBUF_SIZE] __attribute__((aligned(4)));
+static uint8_t tx_src[ENET_TXBUF_NUM][ENET_MAX_FRAME_SIZE];
+static uint8_t gen_frame[ENET_MAX_FRAME_SIZE];
+
+/* application provided ring with small receive buffers, mapped where enet_ring_config() accepts it */
+typedef struct {
+    enet_descriptors_struct rxdesc[BENCH_SPAN_DESC_NUM];
+    enet_descriptors_struct txdesc[ENET_TXBUF_NUM];
+    uint8_t rxbuf[BENCH_SPAN_DESC_NUM][BENCH_SPAN_BUF_SIZE];
+    uint8_t txbuf[ENET_TXBUF_NUM][ENET_TXBUF_SIZE];
+} span_ring_struct;
+
+/* sequence numbers of the generator and of the checker */
+static uint32_t seq_out, seq_in, bench_len, bench_errors, bench_verify;
+static uint32_t tx_released, bench_batches;
+static uint64_t timer_ns, timer_cycles;
+
+/*!
+    \brief    build a test frame to this station
+    \param[in]  buf: frame buffer
+    \param[in]  seq: sequence number, it also selects the payload
+    \param[in]  length: frame length without CRC
+    \param[out] none
+    \retval     none
+*/
+static void frame_build(uint8_t *buf, uint32_t seq, uint32_t length)
+{
+    uint32_t i;
+
+    memcpy(&buf[0], bench_mac, 6U);
+    memcpy(&buf[6], bench_mac, 6U);
+    buf[11] = 0x02U;
+    buf[12] = (uint8_t)(BENCH_ETHERTYPE >> 8);
+    buf[13] = (uint8_t)BENCH_ETHERTYPE;
+    buf[14] = (uint8_t)(seq >> 24);
+    buf[15] = (uint8_t)(seq >> 16);
+    buf[16] = (uint8_t)(seq >> 8);
+    buf[17] = (uint8_t)seq;
+    for(i = BENCH_HDR_LEN; i < length; i++) {
+        buf[i] = (uint8_t)((seq * 31U) + (i * 7U));
+    }
+}
+
+/*!
+    \brief    check the next received or sent frame
+    \param[in]  seg: segments of the frame
+    \param[in]  seg_len: length of each segment
+    \param[in]  num: number of segments
+    \param[in]  length: frame length
+    \param[out] none
+    \retval     none
+*/
+static void frame_check(uint8_t *const seg[], const uint32_t seg_len[], uint32_t num, uint32_t length)
+{
+    uint32_t s, i, pos = 0U, seq = 0U;
+    uint8_t expect;
+
+    if((length != bench_len) || (seg_len[0] < BENCH_HDR_LEN)) {
+        bench_errors++;
+        seq_in++;
+        return;
+    }
+    if(0U == bench_verify) {
+        /* the sequence number and the last byte only, not to weigh on the measured path */
+        seq = ((uint32_t)seg[0][14] << 24) | ((uint32_t)seg[0][15] << 16) | ((uint32_t)seg[0][16] << 8) | seg[0][17];
+        if((seq != seq_in) || (seg[num - 1U][seg_len[num - 1U] - 1U] != (uint8_t)((seq * 31U) + ((length - 1U) * 7U)))) {
+            bench_errors++;
+        }
+        seq_in = seq + 1U;
+        return;
+    }
+    for(s = 0U; s < num; s++) {
+        for(i = 0U; i < seg_len[s]; i++, pos++) {
+            if((pos >= 14U) && (pos < BENCH_HDR_LEN)) {
+                seq = (seq << 8) | seg[s][i];
+                continue;
+            }
+            if(pos < 14U) {
+                expect = (pos < 12U) ? bench_mac[pos % 6U] : (uint8_t)(BENCH_ETHERTYPE >> ((13U - pos) * 8U));
+                if(11U == pos) {
+                    expect = 0x02U;
+                }
+            } else {
+                expect = (uint8_t)((seq * 31U) + (pos * 7U));
+            }
+            if(seg[s][i] != expect) {
+                bench_errors++;
+                seq_in++;
+                return;
+            }
+        }
+    }
+    if(seq != seq_in) {
+        bench_errors++;
+    }
+    seq_in = seq + 1U;
+}
+
+/*!
+    \brief    check a frame put on the wire
+    \param[in]  frame: frame data
+    \param[in]  length: frame length
+    \param[out] none
+    \retval     none
+*/
+static void wire_receive(const uint8_t *frame, uint32_t length)
+{
+    uint8_t *seg[1] = {(uint8_t *)frame};
+
+    frame_check(seg, &length, 1U, length);
+}
+
+/*!
+    \brief    handle a frame lent by enet_rx_poll()
+    \param[in]  frame: the received frame
+    \param[out] none
+    \retval     none
+*/
+static void rx_handler(enet_rxframe_struct *frame)
+{
+    frame_check(frame->seg_buffer, frame->seg_length, frame->segments, frame->length);
+    enet_rxframe_release(frame);
+}
+
+/*!
+    \brief    count the frames sent by enet_frame_transmit_sg()
+    \param[in]  token: the frame token
+    \param[out] none
+    \retval     none
+*/
+static void tx_release(void *token)
+{
+    (void)token;
+    tx_released++;
+}
+
+/*!
+    \brief    get the monotonic time
+    \param[in]  none
+    \param[out] none
+    \retval     time in ns
+*/
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*!
+    \brief    reset and initialize the ENET with the descriptors in chain or ring mode
+    \param[in]  chain: 1 for chain mode, 0 for ring mode
+    \param[in]  path: the path to be measured
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus bench_setup(uint32_t chain, bench_path_enum path)
+{
+    ErrStatus state = ERROR;
+
+    enet_model_start();
+    enet_deinit();
+    if((SUCCESS == enet_software_reset()) &&
+            (SUCCESS == enet_init(ENET_AUTO_NEGOTIATION, ENET_NO_AUTOCHECKSUM, ENET_BROADCAST_FRAMES_PASS))) {
+        enet_mac_address_set(ENET_MAC_ADDRESS0, bench_mac);
+        if(0U != chain) {
+            enet_descriptors_chain_init(ENET_DMA_TX);
+            enet_descriptors_chain_init(ENET_DMA_RX);
+        } else {
+            enet_descriptors_ring_init(ENET_DMA_TX);
+            enet_descriptors_ring_init(ENET_DMA_RX);
+        }
+        if(BENCH_RX_POLL == path) {
+            enet_rxbuf_pool_init(&rx_pool[0][0], ENET_RXBUF_NUM);
+            enet_rx_poll_config(0U);
+            enet_interrupt_enable(ENET_DMA_INT_NIE);
+            enet_interrupt_enable(ENET_DMA_INT_RIE);
+        }
+        enet_enable();
+        state = SUCCESS;
+    }
+    enet_model_stop();
+
+    enet_model_run();
+    enet_model_stat_clear();
+    seq_out = 0U;
+    seq_in = 0U;
+    tx_released = 0U;
+
+    return state;
+}
+
+/*!
+    \brief    run one path for a number of frames, in batches of one ring of frames
+    \param[in]  path: the measured path
+    \param[in]  frames: number of frames
+    \param[out] ns: driver time in ns
+    \param[out] cycles: driver time in TSC cycles
+    \retval     none, the number of batches is left in bench_batches
+*/
+static void bench_path(bench_path_enum path, uint32_t frames, uint64_t *ns, uint64_t *cycles)
+{
+    enet_txfrag_struct frag[2];
+    uint32_t batch, i, size, done = 0U;
+    uint64_t t0, c0;
+
+    *ns = 0U;
+    *cycles = 0U;
+    bench_batches = 0U;
+
+    while(done < frames) {
+        batch = ENET_RXBUF_NUM;
+        if((BENCH_TX_COPY == path) || (BENCH_TX_SG == path)) {
+            /* the scatter-gather frames take a descriptor for the header and one for the payload */
+            batch = (BENCH_TX_SG == path) ? (ENET_TXBUF_NUM / 2U) : ENET_TXBUF_NUM;
+        }
+        if(batch > (frames - done)) {
+            batch = frames - done;
+        }
+
+        switch(path) {
+        case BENCH_RX_COPY:
+            for(i = 0U; i < batch; i++) {
+                frame_build(gen_frame, seq_out++, bench_len);
+                enet_model_receive(gen_frame, bench_len);
+            }
+            t0 = time_ns();
+            c0 = BENCH_CYCLES();
+            for(i = 0U; i < batch; i++) {
+                size = enet_rxframe_size_get();
+                if((size <= 1U) || (ERROR == enet_frame_receive(rx_store[i], size))) {
+                    break;
+                }
+            }
+            *cycles += BENCH_CYCLES() - c0;
+            *ns += time_ns() - t0;
+            batch = i;
+            for(i = 0U; i < batch; i++) {
+                uint8_t *seg[1] = {rx_store[i]};
+                frame_check(seg, &bench_len, 1U, bench_len);
+            }
+            break;
+
+        case BENCH_RX_POLL:
+            for(i = 0U; i < batch; i++) {
+                frame_build(gen_frame, seq_out++, bench_len);
+                enet_model_receive(gen_frame, bench_len);
+            }
+            if(SET != enet_model_irq_pending()) {
+                bench_errors++;
+                return;
+            }
+            t0 = time_ns();
+            c0 = BENCH_CYCLES();
+            batch = 0U;
+            if(SET == enet_rx_poll_irq()) {
+                /* poll again while the budget is used up, the last poll unmasks the interrupt */
+                do {
+                    size = enet_rx_poll(ENET_RXBUF_NUM, rx_handler);
+                    batch += size;
+                } while(ENET_RXBUF_NUM == size);
+            }
+            *cycles += BENCH_CYCLES() - c0;
+            *ns += time_ns() - t0;
+            break;
+
+        case BENCH_TX_COPY:
+            for(i = 0U; i < batch; i++) {
+                frame_build(tx_src[i], seq_out++, bench_len);
+            }
+            t0 = time_ns();
+            c0 = BENCH_CYCLES();
+            for(i = 0U; i < batch; i++) {
+                if(ERROR == enet_frame_transmit(tx_src[i], bench_len)) {
+                    break;
+                }
+            }
+            *cycles += BENCH_CYCLES() - c0;
+            *ns += time_ns() - t0;
+            batch = i;
+            break;
+
+        case BENCH_TX_SG:
+        default:
+            for(i = 0U; i < batch; i++) {
+                frame_build(tx_src[i], seq_out++, bench_len);
+            }
+            t0 = time_ns();
+            c0 = BENCH_CYCLES();
+            enet_tx_reclaim(tx_release);
+            for(i = 0U; i < batch; i++) {
+                frag[0].buffer = tx_src[i];
+                frag[0].length = BENCH_HDR_LEN;
+                frag[1].buffer = &tx_src[i][BENCH_HDR_LEN];
+                frag[1].length = bench_len - BENCH_HDR_LEN;
+                if(ERROR == enet_frame_transmit_sg(frag, 2U, ENET_CHECKSUM_DISABLE, &tx_src[i])) {
+                    break;
+                }
+            }
+            *cycles += BENCH_CYCLES() - c0;
+            *ns += time_ns() - t0;
+            batch = i;
+            break;
+        }
+
+        /* the DMA sends the frames and takes the descriptors given back */
+        enet_model_run();
+
+        if(0U == batch) {
+            bench_errors++;
+            return;
+        }
+        done += batch;
+        bench_batches++;
+    }
+
+    if(BENCH_TX_SG == path) {
+        enet_tx_reclaim(tx_release);
+        if(tx_released != frames) {
+            bench_errors++;
+        }
+    }
+}
+
+/*!
+    \brief    measure the cost of the time stamps of one batch
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void timer_cost(void)
+{
+    uint64_t t0, c0, ns = 0U, cycles = 0U;
+    uint32_t i;
+
+    for(i = 0U; i < 10000U; i++) {
+        t0 = time_ns();
+        c0 = BENCH_CYCLES();
+        cycles += BENCH_CYCLES() - c0;
+        ns += time_ns() - t0;
+    }
+
+    timer_ns = ns / 10000U;
+    timer_cycles = cycles / 10000U;
+}
+
+/*!
+    \brief    check the RxDMA suspend on a full ring, the flushed frames and the resume by the driver
+    \param[in]  chain: 1 for chain mode, 0 for ring mode
+    \param[out] none
+    \retval     number of failed checks
+*/
+static uint32_t bench_rbu_check(uint32_t chain)
+{
+    enet_model_stat_struct stat;
+    uint32_t fails = 0U, i, size, fifo_drop, dma_drop;
+
+    if(ERROR == bench_setup(chain, BENCH_RX_COPY)) {
+        return 1U;
+    }
+    bench_len = 60U;
+    bench_verify = 1U;
+
+    /* the ring takes ENET_RXBUF_NUM frames, the next ones are flushed */
+    for(i = 0U; i < (ENET_RXBUF_NUM + 3U); i++) {
+        frame_build(gen_frame, seq_out++, bench_len);
+        enet_model_receive(gen_frame, bench_len);
+    }
+    enet_missed_frame_counter_get(&fifo_drop, &dma_drop);
+    fails += (ENET_RX_STATE_SUSPENDED != enet_dmaprocess_state_get(ENET_DMA_RX)) ? 1U : 0U;
+    fails += (SET != enet_flag_get(ENET_DMA_FLAG_RBU)) ? 1U : 0U;
+    fails += (3U != dma_drop) ? 1U : 0U;
+
+    /* the driver drains the ring, clears RBU and issues a poll demand */
+    for(i = 0U; 0U != (size = enet_rxframe_size_get()); i++) {
+        enet_frame_receive(rx_store[0], size);
+        uint8_t *seg[1] = {rx_store[0]};
+        frame_check(seg, &bench_len, 1U, bench_len);
+    }
+    fails += (ENET_RXBUF_NUM != i) ? 1U : 0U;
+    enet_model_run();
+    enet_model_stat_get(&stat);
+    fails += (0U == stat.rx_polls) ? 1U : 0U;
+    fails += (ENET_RX_STATE_WAITING != enet_dmaprocess_state_get(ENET_DMA_RX)) ? 1U : 0U;
+
+    /* the flushed frames are missing from the sequence, the next ones arrive */
+    seq_in += 3U;
+    frame_build(gen_frame, seq_out++, bench_len);
+    fails += (SUCCESS != enet_model_receive(gen_frame, bench_len)) ? 1U : 0U;
+    size = enet_rxframe_size_get();
+    fails += ((size != bench_len) || (ERROR == enet_frame_receive(rx_store[0], size))) ? 1U : 0U;
+    {
+        uint8_t *seg[1] = {rx_store[0]};
+        frame_check(seg, &bench_len, 1U, bench_len);
+    }
+
+    printf("%s RBU check: %u frames flushed, %u poll demands, %s\n", (0U != chain) ? "chain" : "ring ",
+           dma_drop, stat.rx_polls, (0U == (fails + bench_errors)) ? "ok" : "FAIL");
+
+    return fails + bench_errors;
+}
+
+/*!
+    \brief    check that the bad frames dropped by enet_rx_poll() take from its budget
+    \param[in]  chain: 1 for chain mode, 0 for ring mode
+    \param[out] none
+    \retval     number of failed checks
+*/
+static uint32_t bench_poll_drop_check(uint32_t chain)
+{
+    enet_rxpoll_stat_struct stat;
+    uint32_t fails = 0U, i, first, second;
+
+    if(ERROR == bench_setup(chain, BENCH_RX_POLL)) {
+        return 1U;
+    }
+    /* the frames with a CRC error reach the descriptors */
+    ENET_DMA_CTL |= ENET_DMA_CTL_FERF;
+    bench_len = 60U;
+    bench_verify = 1U;
+    bench_errors = 0U;
+
+    /* three bad frames ahead of two good ones, a budget of 4 stops after the first good one */
+    for(i = 0U; i < 3U; i++) {
+        frame_build(gen_frame, 0x8000U + i, bench_len);
+        fails += (SUCCESS != enet_model_receive_crc_error(gen_frame, bench_len)) ? 1U : 0U;
+    }
+    for(i = 0U; i < 2U; i++) {
+        frame_build(gen_frame, seq_out++, bench_len);
+        fails += (SUCCESS != enet_model_receive(gen_frame, bench_len)) ? 1U : 0U;
+    }
+    /* the Rx interrupt masks itself and schedules the poll */
+    fails += (SET != enet_rx_poll_irq()) ? 1U : 0U;
+    first = enet_rx_poll(4U, rx_handler);
+    fails += (RESET != (ENET_DMA_INTEN & ENET_DMA_INTEN_RIE)) ? 1U : 0U;
+    enet_model_run();
+    second = enet_rx_poll(4U, rx_handler);
+    fails += (RESET == (ENET_DMA_INTEN & ENET_DMA_INTEN_RIE)) ? 1U : 0U;
+    enet_rx_poll_stat_get(&stat);
+    fails += ((1U != first) || (1U != second) || (2U != seq_in)) ? 1U : 0U;
+    fails += ((3U != stat.dropped) || (1U != stat.budget_exhausted)) ? 1U : 0U;
+
+    printf("%s poll drop check: %u dropped, %u + %u frames over two polls of budget 4, %s\n",
+           (0U != chain) ? "chain" : "ring ", stat.dropped, first, second,
+           (0U == (fails + bench_errors)) ? "ok" : "FAIL");
+
+    return fails + bench_errors;
+}
+
+/*!
+    \brief    check the copy receive path on frames spanning several small descriptor buffers
+    \param[in]  chain: 1 for chain mode, 0 for ring mode
+    \param[out] none
+    \retval     number of failed checks
+*/
+static uint32_t bench_span_check(uint32_t chain)
+{
+    static const uint32_t span_len[] = {60U, 252U, 253U, 256U, 600U, 1514U, 1000U};
+    span_ring_struct *span;
+    enet_ring_struct ring;
+    uint8_t *seg[1] = {rx_store[0]};
+    uint32_t fails = 0U, frames = 0U, pass, i, size;
+
+    span = mmap((void *)(uintptr_t)SRAM_BASE, sizeof(span_ring_struct), PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if(MAP_FAILED == span) {
+        return 1U;
+    }
+    ring.rxdesc = span->rxdesc;
+    ring.txdesc = span->txdesc;
+    ring.rxbuf = &span->rxbuf[0][0];
+    ring.txbuf = &span->txbuf[0][0];
+    ring.txtoken = NULL;
+    ring.rxdesc_num = BENCH_SPAN_DESC_NUM;
+    ring.txdesc_num = ENET_TXBUF_NUM;
+    ring.rxbuf_size = BENCH_SPAN_BUF_SIZE;
+    ring.txbuf_size = ENET_TXBUF_SIZE;
+    if((ERROR == enet_ring_config(&ring)) || (ERROR == bench_setup(chain, BENCH_RX_COPY))) {
+        enet_ring_config(NULL);
+        munmap(span, sizeof(span_ring_struct));
+        return 1U;
+    }
+    bench_verify = 1U;
+    bench_errors = 0U;
+
+    /* several rounds, so that the frames start at every place of the ring */
+    for(pass = 0U; pass < 5U; pass++) {
+        for(i = 0U; i < (sizeof(span_len) / sizeof(span_len[0])); i++) {
+            bench_len = span_len[i];
+            frame_build(gen_frame, seq_out++, bench_len);
+            fails += (SUCCESS != enet_model_receive(gen_frame, bench_len)) ? 1U : 0U;
+            size = enet_rxframe_size_get();
+            fails += ((size != bench_len) || (SUCCESS != enet_frame_receive(rx_store[0], ENET_MAX_FRAME_SIZE))) ? 1U : 0U;
+            frame_check(seg, &bench_len, 1U, bench_len);
+            enet_model_run();
+            frames++;
+        }
+        /* a frame longer than the application buffer is dropped with all its descriptors */
+        bench_len = 1514U;
+        frame_build(gen_frame, seq_out++, bench_len);
+        enet_model_receive(gen_frame, bench_len);
+        fails += (ERROR != enet_frame_receive(rx_store[0], 1000U)) ? 1U : 0U;
+        seq_in++;
+        enet_model_run();
+    }
+    enet_model_stop();
+    enet_ring_config(NULL);
+    munmap(span, sizeof(span_ring_struct));
+
+    printf("%s span check: %u frames over %u byte buffers, %s\n", (0U != chain) ? "chain" : "ring ",
+           frames, BENCH_SPAN_BUF_SIZE, (0U == (fails + bench_errors)) ? "ok" : "FAIL");
+
+    return fails + bench_errors;
+}
+
+int main(void)
+{
+    enet_model_stat_struct stat;
+    uint64_t ns, cycles;
+    uint32_t chain, path, len, fails = 0U;
+    double fps, line_fps;
+
+    if(ERROR == enet_model_init()) {
+        return 1;
+    }
+    enet_model_wire_set(wire_receive);
+    timer_cost();
+
+    for(chain = 1U; chain < 2U; chain--) {
+        fails += bench_rbu_check(chain);
+        fails += bench_span_check(chain);
+        fails += bench_poll_drop_check(chain);
+    }
+
+    printf("%u Rx and %u Tx descriptors, %u frames each, %u ns timer cost per batch removed\n",
+           (unsigned)ENET_RXBUF_NUM, (unsigned)ENET_TXBUF_NUM, BENCH_FRAMES, (unsigned)timer_ns);
+    printf("mode   path     bytes   frames/s      MB/s  ns/frame  cycles/frame  x100M   RBU/TBU  polls\n");
+
+    for(chain = 1U; chain < 2U; chain--) {
+        for(path = BENCH_RX_COPY; path <= BENCH_TX_SG; path++) {
+            for(len = 0U; len < (sizeof(frame_len) / sizeof(frame_len[0])); len++) {
+                bench_errors = 0U;
+                bench_len = frame_len[len];
+
+                /* a short run checking every byte, then the measurement */
+                if(ERROR == bench_setup(chain, (bench_path_enum)path)) {
+                    printf("the ENET initialization failed\n");
+                    return 1;
+                }
+                bench_verify = 1U;
+                bench_path((bench_path_enum)path, BENCH_VERIFY_FRAMES, &ns, &cycles);
+                if((seq_in != BENCH_VERIFY_FRAMES) || (0U != bench_errors)) {
+                    fails++;
+                }
+
+                bench_setup(chain, (bench_path_enum)path);
+                bench_verify = 0U;
+                bench_path((bench_path_enum)path, BENCH_FRAMES, &ns, &cycles);
+                enet_model_stat_get(&stat);
+                if((seq_in != BENCH_FRAMES) || (0U != bench_errors)) {
+                    fails++;
+                }
+
+                /* the timer cost is counted once per batch */
+                if(ns > (bench_batches * timer_ns)) {
+                    ns -= bench_batches * timer_ns;
+                }
+                if(cycles > (bench_batches * timer_cycles)) {
+                    cycles -= bench_batches * timer_cycles;
+                }
+                fps = (double)BENCH_FRAMES * 1e9 / (double)ns;
+                line_fps = BENCH_LINE_RATE / (8.0 * (double)(bench_len + BENCH_WIRE_EXTRA));
+                printf("%s  %-7s  %5u  %9.0f  %8.1f  %8.1f  %12.0f  %5.1f  %8u  %5u%s\n",
+                       (0U != chain) ? "chain" : "ring ", path_name[path], bench_len, fps,
+                       fps * (double)bench_len / 1e6, (double)ns / BENCH_FRAMES,
+                       (double)cycles / BENCH_FRAMES, fps / line_fps,
+                       (path < BENCH_TX_COPY) ? stat.rx_rbu : stat.tx_tbu,
+                       (path < BENCH_TX_COPY) ? stat.rx_polls : stat.tx_polls,
+                       (0U != bench_errors) ? "  FAIL" : "");
+            }
+        }
+    }
+
+    printf("%s\n", (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
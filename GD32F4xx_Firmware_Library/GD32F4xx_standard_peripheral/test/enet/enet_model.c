@@ -0,0 +1,1146 @@
+/*!
+    \file    enet_model.c
+    \brief   host model of the ENET DMA descriptor engine
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+/*
+    The registers of the ENET are plain memory mapped at ENET_BASE, so the unmodified driver
+    runs against them. The driver keeps descriptor and buffer addresses in 32 bits, the test is
+    linked without PIE so that its data lies below 4 GB.
+
+    The DMA model runs in the caller's thread, from enet_model_receive() and enet_model_run().
+    Between two calls it sees the register writes of the driver as the hardware would:
+    - ENET_DMA_RPEN and ENET_DMA_TPEN hold a value the driver never writes, any other value is a poll demand
+    - the status bits of ENET_DMA_STAT are cleared by writing 1, a written value differs from the shown one
+    - ENET_DMA_RDTADDR and ENET_DMA_TDTADDR reload the current descriptor when they change
+    The bits the driver waits for in busy loops, SWR, FTF and the SMI busy bit, are served from a timer
+    signal started with enet_model_start(), so that it also interrupts the loops on a single CPU. The PHY
+    has a 100 Mbit/s full duplex link.
+
+    The checksum offload handles IPv4 with TCP, UDP or ICMP, other IP frames are reported good.
+    The PTP system time runs from the HCLK cycles given to enet_model_ptp_clock(), which also serves
+    the TMSSTI, TMSSTU and TMSARU bits, the caller reads a timestamp from ENET_PTP_TSH and ENET_PTP_TSL.
+    Not modelled: address filtering, timestamps in the descriptors, PPS and target time, MSC counters, wire timing. A frame is only written when enough descriptors are available for all of it.
+*/
+
+#define _GNU_SOURCE
+
+#include "enet_model.h"
+
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+#define MODEL_REG_SIZE                   0x2000U                /* bytes of the ENET register block */
+#define MODEL_PEN_IDLE                   0xFFFFFFFFU            /* poll enable register content without a poll demand */
+#define MODEL_DESC_MAX                   256U                   /* most descriptors of one frame, against broken rings */
+#define MODEL_RXFIFO_FRAMES              64U
+#define MODEL_SERVICE_US                 10                     /* period of the service of the self clearing bits */
+
+/* status bits cleared by writing 1, and the two interrupt summaries */
+#define MODEL_STAT_W1C                   (BITS(0,10) | BITS(13,16))
+#define MODEL_STAT_NORMAL                (ENET_DMA_STAT_TS | ENET_DMA_STAT_TBU | ENET_DMA_STAT_RS | ENET_DMA_STAT_ER)
+#define MODEL_STAT_ABNORMAL              (ENET_DMA_STAT_TPS | ENET_DMA_STAT_TJT | ENET_DMA_STAT_RO | ENET_DMA_STAT_TU | \
+                                          ENET_DMA_STAT_RBU | ENET_DMA_STAT_RPS | ENET_DMA_STAT_RWT | ENET_DMA_STAT_ET | \
+                                          ENET_DMA_STAT_FBE)
+
+/* frames waiting in the receive FIFO */
+typedef struct
+{
+    uint32_t length;
+    uint32_t crc_error;                                         /* the frame check sequence is broken */
+    uint8_t data[ENET_MODEL_FRAME_MAX];
+} model_frame_struct;
+
+static model_frame_struct rxfifo[MODEL_RXFIFO_FRAMES];
+static uint32_t rxfifo_head = 0U, rxfifo_num = 0U, rxfifo_bytes = 0U;
+static uint8_t tx_frame[ENET_MODEL_FRAME_MAX + 4U];
+
+/* DMA state, the status register shows dma_stat with the process states */
+static uint32_t dma_stat = 0U, stat_shown = 0U;
+static uint32_t rx_state = ENET_RX_STATE_STOPPED, tx_state = ENET_TX_STATE_STOPPED;
+static uint32_t rx_desc = 0U, tx_desc = 0U;
+static uint32_t rdtaddr_seen = 0U, tdtaddr_seen = 0U;
+static uint32_t rx_irq_delayed = 0U;
+static volatile uint32_t reset_pending = 0U;
+
+static enet_model_wire_fn model_wire = NULL;
+static enet_model_stat_struct model_stat;
+static uint32_t crc_table[256];
+
+/* PTP system time, the addend in use and the accumulator of the fine update */
+static uint32_t ptp_addend = 0U, ptp_acc = 0U;
+
+/* PHY registers and the service of the self clearing bits */
+static uint16_t phy_reg[32];
+static uint32_t service_run = 0U;
+
+/*!
+    \brief    reset the registers to their reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void model_regs_reset(void)
+{
+    uint8_t *regs = (uint8_t *)(uintptr_t)ENET_BASE;
+
+    /* ENET_DMA_BCTL is written at last, the driver goes on when SWR reads 0 */
+    memset(regs, 0, 0x1000U);
+    memset(&regs[0x1004U], 0, MODEL_REG_SIZE - 0x1004U);
+
+    ENET_MAC_CFG = 0x00008000U;
+    ENET_MAC_ADDR0H = 0x8000FFFFU;
+    ENET_MAC_ADDR0L = 0xFFFFFFFFU;
+    ENET_DMA_TPEN = MODEL_PEN_IDLE;
+    ENET_DMA_RPEN = MODEL_PEN_IDLE;
+
+    ptp_addend = 0U;
+    ptp_acc = 0U;
+
+    reset_pending = 1U;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    ENET_DMA_BCTL = 0x00020100U;
+}
+
+/*!
+    \brief    reset the PHY registers, the link is up at 100 Mbit/s full duplex
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void model_phy_reset(void)
+{
+    memset(phy_reg, 0, sizeof(phy_reg));
+
+    phy_reg[PHY_REG_BCR] = PHY_AUTONEGOTIATION | PHY_FULLDUPLEX_100M;
+    phy_reg[PHY_REG_BSR] = 0x7809U | PHY_LINKED_STATUS | PHY_AUTONEGO_COMPLETE;
+    phy_reg[PHY_SR] = PHY_DUPLEX_STATUS;
+}
+
+/*!
+    \brief    serve the self clearing bits the driver waits for, and the PHY accesses
+                note -- the driver only writes these registers before it waits, or when they are idle
+    \param[in]  signum: unused
+    \param[out] none
+    \retval     none
+*/
+static void model_service(int signum)
+{
+    uint32_t reg, addr, num;
+
+    (void)signum;
+
+    if((uint32_t)RESET != (ENET_DMA_BCTL & ENET_DMA_BCTL_SWR)) {
+        /* the software reset resets all the registers, SWR reads 0 at last */
+        model_regs_reset();
+    }
+    if((uint32_t)RESET != (ENET_DMA_CTL & ENET_DMA_CTL_FTF)) {
+        ENET_DMA_CTL &= ~ENET_DMA_CTL_FTF;
+    }
+
+    reg = ENET_MAC_PHY_CTL;
+    if((uint32_t)RESET != (reg & ENET_MAC_PHY_CTL_PB)) {
+        addr = GET_BITS(reg, 11, 15);
+        num = GET_BITS(reg, 6, 10);
+        if((uint32_t)RESET != (reg & ENET_MAC_PHY_CTL_PW)) {
+            if(PHY_ADDRESS == addr) {
+                phy_reg[num] = (uint16_t)ENET_MAC_PHY_DATA;
+                if((PHY_REG_BCR == num) && (0U != (phy_reg[num] & PHY_RESET))) {
+                    model_phy_reset();
+                }
+            }
+        } else {
+            /* nothing answers at the other addresses */
+            ENET_MAC_PHY_DATA = (PHY_ADDRESS == addr) ? phy_reg[num] : 0xFFFFU;
+        }
+        ENET_MAC_PHY_CTL = reg & ~ENET_MAC_PHY_CTL_PB;
+    }
+}
+
+/*!
+    \brief    build the CRC table of the frame check sequence
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void model_crc_init(void)
+{
+    uint32_t i, j, c;
+
+    for(i = 0U; i < 256U; i++) {
+        c = i;
+        for(j = 0U; j < 8U; j++) {
+            c = (0U != (c & 1U)) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+        }
+        crc_table[i] = c;
+    }
+}
+
+/*!
+    \brief    calculate the frame check sequence
+    \param[in]  data: frame data
+    \param[in]  length: frame length
+    \param[out] none
+    \retval     CRC32 of the frame
+*/
+static uint32_t model_crc(const uint8_t *data, uint32_t length)
+{
+    uint32_t c = 0xFFFFFFFFU, i;
+
+    for(i = 0U; i < length; i++) {
+        c = crc_table[(c ^ data[i]) & 0xFFU] ^ (c >> 8);
+    }
+
+    return ~c;
+}
+
+/*!
+    \brief    add 16 bit words to a one's complement sum
+    \param[in]  sum: sum so far
+    \param[in]  data: words in network byte order, an odd last byte is padded with zero
+    \param[in]  length: bytes of data
+    \param[out] none
+    \retval     the sum, not folded
+*/
+static uint32_t model_inet_sum(uint32_t sum, const uint8_t *data, uint32_t length)
+{
+    uint32_t i;
+
+    for(i = 0U; (i + 1U) < length; i += 2U) {
+        sum += ((uint32_t)data[i] << 8) | data[i + 1U];
+    }
+    if(0U != (length & 1U)) {
+        sum += (uint32_t)data[length - 1U] << 8;
+    }
+
+    return sum;
+}
+
+/*!
+    \brief    fold a one's complement sum to 16 bits
+    \param[in]  sum: sum of model_inet_sum()
+    \param[out] none
+    \retval     folded sum, 0xFFFF over data holding a good checksum
+*/
+static uint16_t model_inet_fold(uint32_t sum)
+{
+    while(0U != (sum >> 16)) {
+        sum = (sum & 0xFFFFU) + (sum >> 16);
+    }
+
+    return (uint16_t)sum;
+}
+
+/*!
+    \brief    locate the IPv4 header and payload of a frame
+    \param[in]  frame: frame data
+    \param[in]  length: frame length
+    \param[out] ihl: IP header length
+    \param[out] plen: IP payload length
+    \retval     the IPv4 header, NULL when the frame is not an IPv4 frame
+*/
+static uint8_t *model_ipv4(uint8_t *frame, uint32_t length, uint32_t *ihl, uint32_t *plen)
+{
+    uint8_t *ip = &frame[14];
+    uint32_t total;
+
+    if((length < 34U) || (0x08U != frame[12]) || (0x00U != frame[13]) || (4U != (ip[0] >> 4))) {
+        return NULL;
+    }
+    *ihl = (uint32_t)(ip[0] & 0x0FU) * 4U;
+    total = ((uint32_t)ip[2] << 8) | ip[3];
+    if((*ihl < 20U) || (total < *ihl) || ((14U + total) > length)) {
+        return NULL;
+    }
+    *plen = total - *ihl;
+
+    return ip;
+}
+
+/*!
+    \brief    sum the TCP, UDP or ICMP payload of an IPv4 frame, with the pseudo-header but ICMP
+    \param[in]  ip: IPv4 header
+    \param[in]  ihl: IP header length
+    \param[in]  plen: IP payload length
+    \param[in]  pseudo: 1 to add the pseudo-header
+    \param[out] none
+    \retval     the sum, not folded
+*/
+static uint32_t model_payload_sum(const uint8_t *ip, uint32_t ihl, uint32_t plen, uint32_t pseudo)
+{
+    uint32_t sum = 0U;
+
+    if((0U != pseudo) && (1U != ip[9])) {
+        sum = model_inet_sum(ip[9] + plen, &ip[12], 8U);
+    }
+
+    return model_inet_sum(sum, &ip[ihl], plen);
+}
+
+/*!
+    \brief    get the offset of the checksum in a TCP, UDP or ICMP header
+    \param[in]  protocol: IP protocol number
+    \param[in]  plen: IP payload length
+    \param[out] none
+    \retval     the offset, 0 for another protocol or a truncated header
+*/
+static uint32_t model_payload_checksum_offset(uint8_t protocol, uint32_t plen)
+{
+    switch(protocol) {
+    case 1U:
+        return (plen >= 8U) ? 2U : 0U;
+    case 6U:
+        return (plen >= 20U) ? 16U : 0U;
+    case 17U:
+        return (plen >= 8U) ? 6U : 0U;
+    default:
+        return 0U;
+    }
+}
+
+/*!
+    \brief    insert the checksums requested by the checksum mode of a transmitted frame
+    \param[in]  frame: frame data
+    \param[in]  length: frame length
+    \param[in]  cm: TDES0 CM bits of the first descriptor
+    \param[out] none
+    \retval     none
+*/
+static void model_tx_checksum(uint8_t *frame, uint32_t length, uint32_t cm)
+{
+    uint8_t *ip;
+    uint32_t ihl, plen, offset, csum;
+
+    ip = model_ipv4(frame, length, &ihl, &plen);
+    if((ENET_CHECKSUM_DISABLE == cm) || (NULL == ip)) {
+        return;
+    }
+
+    ip[10] = 0U;
+    ip[11] = 0U;
+    csum = (uint16_t)~model_inet_fold(model_inet_sum(0U, ip, ihl));
+    ip[10] = (uint8_t)(csum >> 8);
+    ip[11] = (uint8_t)csum;
+
+    offset = model_payload_checksum_offset(ip[9], plen);
+    if((ENET_CHECKSUM_IPV4HEADER == cm) || (0U == offset)) {
+        return;
+    }
+    /* the segment mode takes the pseudo-header sum the software left in the field */
+    if(ENET_CHECKSUM_TCPUDPICMP_FULL == cm) {
+        ip[ihl + offset] = 0U;
+        ip[ihl + offset + 1U] = 0U;
+    }
+    csum = (uint16_t)~model_inet_fold(model_payload_sum(ip, ihl, plen, (ENET_CHECKSUM_TCPUDPICMP_FULL == cm) ? 1U : 0U));
+    if((17U == ip[9]) && (0U == csum)) {
+        /* zero means no checksum in UDP */
+        csum = 0xFFFFU;
+    }
+    ip[ihl + offset] = (uint8_t)(csum >> 8);
+    ip[ihl + offset + 1U] = (uint8_t)csum;
+}
+
+/*!
+    \brief    get the frame type and checksum status bits of a received frame
+    \param[in]  frame: frame data
+    \param[in]  length: frame length
+    \param[out] none
+    \retval     FRMT, IPHERR and PCERR bits of RDES0
+*/
+static uint32_t model_rx_checksum(uint8_t *frame, uint32_t length)
+{
+    uint8_t *ip;
+    uint32_t type, ihl, plen, offset, status = 0U;
+
+    if(length < 14U) {
+        return 0U;
+    }
+    type = ((uint32_t)frame[12] << 8) | frame[13];
+    if(type < 0x0600U) {
+        /* IEEE 802.3 frame */
+        return 0U;
+    }
+    if((uint32_t)RESET == (ENET_MAC_CFG & ENET_MAC_CFG_IPFCO)) {
+        return ENET_RDES0_FRMT;
+    }
+    if(0x86DDU == type) {
+        return ENET_RDES0_FRMT;
+    }
+    ip = model_ipv4(frame, length, &ihl, &plen);
+    if(NULL == ip) {
+        /* neither IPv4 nor IPv6, the checksum offload is bypassed */
+        return ENET_RDES0_IPHERR | ENET_RDES0_PCERR;
+    }
+
+    if(0xFFFFU != model_inet_fold(model_inet_sum(0U, ip, ihl))) {
+        status |= ENET_RDES0_IPHERR;
+    }
+    offset = model_payload_checksum_offset(ip[9], plen);
+    if(0U == offset) {
+        /* unsupported payload, not checked */
+        return (0U != status) ? (status | ENET_RDES0_FRMT) : ENET_RDES0_PCERR;
+    }
+    if(((17U != ip[9]) || (0U != (ip[ihl + offset] | ip[ihl + offset + 1U]))) &&
+            (0xFFFFU != model_inet_fold(model_payload_sum(ip, ihl, plen, 1U)))) {
+        status |= ENET_RDES0_PCERR;
+    }
+
+    return status | ENET_RDES0_FRMT;
+}
+
+/*!
+    \brief    get a descriptor from its DMA address
+    \param[in]  addr: descriptor address
+    \param[out] none
+    \retval     the descriptor
+*/
+static enet_descriptors_struct *model_desc(uint32_t addr)
+{
+    return (enet_descriptors_struct *)(uintptr_t)addr;
+}
+
+/*!
+    \brief    get the next Rx descriptor as the RxDMA walks the list
+    \param[in]  desc: current descriptor
+    \param[out] none
+    \retval     address of the next descriptor
+*/
+static uint32_t model_rxdesc_next(enet_descriptors_struct *desc)
+{
+    if((uint32_t)RESET != (desc->control_buffer_size & ENET_RDES1_RCHM)) {
+        return desc->buffer2_next_desc_addr;
+    }
+    if((uint32_t)RESET != (desc->control_buffer_size & ENET_RDES1_RERM)) {
+        return ENET_DMA_RDTADDR;
+    }
+
+    return (uint32_t)(uintptr_t)desc + ETH_DMARXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL) << 2U);
+}
+
+/*!
+    \brief    get the next Tx descriptor as the TxDMA walks the list
+    \param[in]  desc: current descriptor
+    \param[out] none
+    \retval     address of the next descriptor
+*/
+static uint32_t model_txdesc_next(enet_descriptors_struct *desc)
+{
+    if((uint32_t)RESET != (desc->status & ENET_TDES0_TCHM)) {
+        return desc->buffer2_next_desc_addr;
+    }
+    if((uint32_t)RESET != (desc->status & ENET_TDES0_TERM)) {
+        return ENET_DMA_TDTADDR;
+    }
+
+    return (uint32_t)(uintptr_t)desc + ETH_DMATXDESC_SIZE + (GET_DMA_BCTL_DPSL(ENET_DMA_BCTL) << 2U);
+}
+
+/*!
+    \brief    take the register writes of the driver
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void model_sync(void)
+{
+    uint32_t reg;
+
+    if(0U != reset_pending) {
+        reset_pending = 0U;
+        dma_stat = 0U;
+        stat_shown = 0U;
+        rx_state = ENET_RX_STATE_STOPPED;
+        tx_state = ENET_TX_STATE_STOPPED;
+        rx_desc = 0U;
+        tx_desc = 0U;
+        rdtaddr_seen = 0U;
+        tdtaddr_seen = 0U;
+        rx_irq_delayed = 0U;
+        rxfifo_num = 0U;
+        rxfifo_bytes = 0U;
+    }
+
+    /* a written status clears the bits written with 1 */
+    reg = ENET_DMA_STAT;
+    if(reg != stat_shown) {
+        dma_stat &= ~(reg & MODEL_STAT_W1C);
+    }
+
+    /* a new descriptor list is taken from its first descriptor */
+    if(ENET_DMA_RDTADDR != rdtaddr_seen) {
+        rdtaddr_seen = ENET_DMA_RDTADDR;
+        rx_desc = rdtaddr_seen;
+    }
+    if(ENET_DMA_TDTADDR != tdtaddr_seen) {
+        tdtaddr_seen = ENET_DMA_TDTADDR;
+        tx_desc = tdtaddr_seen;
+    }
+
+    /* start and stop */
+    if((uint32_t)RESET != (ENET_DMA_CTL & ENET_DMA_CTL_SRE)) {
+        if(ENET_RX_STATE_STOPPED == rx_state) {
+            rx_state = ENET_RX_STATE_WAITING;
+        }
+    } else if(ENET_RX_STATE_STOPPED != rx_state) {
+        rx_state = ENET_RX_STATE_STOPPED;
+        dma_stat |= ENET_DMA_STAT_RPS;
+    }
+    if((uint32_t)RESET != (ENET_DMA_CTL & ENET_DMA_CTL_STE)) {
+        if(ENET_TX_STATE_STOPPED == tx_state) {
+            tx_state = ENET_TX_STATE_FETCHING;
+        }
+    } else if(ENET_TX_STATE_STOPPED != tx_state) {
+        tx_state = ENET_TX_STATE_STOPPED;
+        dma_stat |= ENET_DMA_STAT_TPS;
+    }
+
+    /* poll demands resume a suspended process */
+    if(MODEL_PEN_IDLE != ENET_DMA_RPEN) {
+        ENET_DMA_RPEN = MODEL_PEN_IDLE;
+        model_stat.rx_polls++;
+        if(ENET_RX_STATE_SUSPENDED == rx_state) {
+            rx_state = ENET_RX_STATE_WAITING;
+        }
+    }
+    if(MODEL_PEN_IDLE != ENET_DMA_TPEN) {
+        ENET_DMA_TPEN = MODEL_PEN_IDLE;
+        model_stat.tx_polls++;
+        if(ENET_TX_STATE_SUSPENDED == tx_state) {
+            tx_state = ENET_TX_STATE_FETCHING;
+        }
+    }
+
+    /* the receive watchdog of the descriptors with delayed interrupt has expired */
+    if((0U != rx_irq_delayed) && (0U != ENET_DMA_RSWDC)) {
+        rx_irq_delayed = 0U;
+        dma_stat |= ENET_DMA_STAT_RS;
+    }
+}
+
+/*!
+    \brief    show the status and the current descriptors in the registers
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void model_publish(void)
+{
+    if(0U != (dma_stat & ENET_DMA_INTEN & MODEL_STAT_NORMAL)) {
+        dma_stat |= ENET_DMA_STAT_NI;
+    }
+    if(0U != (dma_stat & ENET_DMA_INTEN & MODEL_STAT_ABNORMAL)) {
+        dma_stat |= ENET_DMA_STAT_AI;
+    }
+
+    stat_shown = dma_stat | rx_state | tx_state;
+    ENET_DMA_STAT = stat_shown;
+    ENET_DMA_CRDADDR = rx_desc;
+    ENET_DMA_CTDADDR = tx_desc;
+    if(0U != rx_desc) {
+        ENET_DMA_CRBADDR = model_desc(rx_desc)->buffer1_addr;
+    }
+    if(0U != tx_desc) {
+        ENET_DMA_CTBADDR = model_desc(tx_desc)->buffer1_addr;
+    }
+}
+
+/*!
+    \brief    move the frames of the receive FIFO to the Rx descriptors
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void model_rx(void)
+{
+    enet_descriptors_struct *desc;
+    model_frame_struct *frame;
+    uint32_t addr, room, num, need, offset, seg, size, i, status, csum;
+
+    while((ENET_RX_STATE_WAITING == rx_state) && (0U != rxfifo_num)) {
+        frame = &rxfifo[rxfifo_head];
+        need = frame->length + 4U;
+
+        /* CRC errors are dropped unless FERF is set */
+        if((0U != frame->crc_error) && ((uint32_t)RESET == (ENET_DMA_CTL & ENET_DMA_CTL_FERF))) {
+            model_stat.rx_crc_dropped++;
+            rxfifo_bytes -= need;
+            rxfifo_head = (rxfifo_head + 1U) % MODEL_RXFIFO_FRAMES;
+            rxfifo_num--;
+            continue;
+        }
+
+        /* IP frames failing the checksum offload are dropped unless DTCERFD is set */
+        csum = model_rx_checksum(frame->data, frame->length);
+        if(((uint32_t)RESET != (csum & ENET_RDES0_FRMT)) && (0U != (csum & (ENET_RDES0_IPHERR | ENET_RDES0_PCERR))) &&
+                ((uint32_t)RESET == (ENET_DMA_CTL & ENET_DMA_CTL_DTCERFD))) {
+            model_stat.rx_checksum_dropped++;
+            rxfifo_bytes -= need;
+            rxfifo_head = (rxfifo_head + 1U) % MODEL_RXFIFO_FRAMES;
+            rxfifo_num--;
+            continue;
+        }
+
+        /* the descriptors for the whole frame */
+        addr = rx_desc;
+        room = 0U;
+        for(num = 0U; room < need; num++) {
+            desc = model_desc(addr);
+            if((MODEL_DESC_MAX == num) || ((uint32_t)RESET == (desc->status & ENET_RDES0_DAV))) {
+                break;
+            }
+            room += GET_RDES1_RB1S(desc->control_buffer_size);
+            if((uint32_t)RESET == (desc->control_buffer_size & ENET_RDES1_RCHM)) {
+                room += GET_RDES1_RB2S(desc->control_buffer_size);
+            }
+            addr = model_rxdesc_next(desc);
+        }
+
+        if(room < need) {
+            /* suspended until a poll demand or the next frame, the frame is flushed unless DAFRF is set */
+            dma_stat |= ENET_DMA_STAT_RBU;
+            rx_state = ENET_RX_STATE_SUSPENDED;
+            model_stat.rx_rbu++;
+            if((uint32_t)RESET == (ENET_DMA_CTL & ENET_DMA_CTL_DAFRF)) {
+                model_stat.rx_flushed++;
+                if(GET_DMA_MFBOCNT_MSFC(ENET_DMA_MFBOCNT) < 0xFFFFU) {
+                    ENET_DMA_MFBOCNT += 1U;
+                }
+                rxfifo_bytes -= need;
+                rxfifo_head = (rxfifo_head + 1U) % MODEL_RXFIFO_FRAMES;
+                rxfifo_num--;
+            }
+            break;
+        }
+
+        /* the frame and its CRC fill the buffers in order */
+        offset = 0U;
+        addr = rx_desc;
+        for(i = 0U; i < num; i++) {
+            desc = model_desc(addr);
+            size = GET_RDES1_RB1S(desc->control_buffer_size);
+            seg = ((need - offset) < size) ? (need - offset) : size;
+            memcpy((void *)(uintptr_t)desc->buffer1_addr, &frame->data[offset], seg);
+            offset += seg;
+            if(((uint32_t)RESET == (desc->control_buffer_size & ENET_RDES1_RCHM)) && (offset < need)) {
+                size = GET_RDES1_RB2S(desc->control_buffer_size);
+                seg = ((need - offset) < size) ? (need - offset) : size;
+                memcpy((void *)(uintptr_t)desc->buffer2_next_desc_addr, &frame->data[offset], seg);
+                offset += seg;
+            }
+
+            status = 0U;
+            if(0U == i) {
+                status |= ENET_RDES0_FDES;
+            }
+            if((num - 1U) == i) {
+                status |= ENET_RDES0_LDES | RDES0_FRML(need) | csum;
+                if(0U != frame->crc_error) {
+                    status |= ENET_RDES0_ERRS | ENET_RDES0_CERR;
+                }
+                if((uint32_t)RESET == (desc->control_buffer_size & ENET_RDES1_DINTC)) {
+                    dma_stat |= ENET_DMA_STAT_RS;
+                } else {
+                    rx_irq_delayed = 1U;
+                }
+            }
+            addr = model_rxdesc_next(desc);
+            /* giving the descriptor back to the driver is the last write */
+            desc->status = status;
+        }
+
+        rx_desc = addr;
+        model_stat.rx_frames++;
+        rxfifo_bytes -= need;
+        rxfifo_head = (rxfifo_head + 1U) % MODEL_RXFIFO_FRAMES;
+        rxfifo_num--;
+
+        /* the next descriptor is fetched at once, a full ring suspends the RxDMA */
+        if((uint32_t)RESET == (model_desc(rx_desc)->status & ENET_RDES0_DAV)) {
+            dma_stat |= ENET_DMA_STAT_RBU;
+            rx_state = ENET_RX_STATE_SUSPENDED;
+            model_stat.rx_rbu++;
+        }
+    }
+}
+
+/*!
+    \brief    send the frames of the Tx descriptors given to the DMA
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void model_tx(void)
+{
+    enet_descriptors_struct *desc;
+    uint32_t addr, length, num, i, size, last, cm;
+
+    while((ENET_TX_STATE_FETCHING == tx_state) && ((uint32_t)RESET != (ENET_MAC_CFG & ENET_MAC_CFG_TEN))) {
+        /* gather the segments of the frame */
+        addr = tx_desc;
+        length = 0U;
+        last = 0U;
+        for(num = 0U; (0U == last) && (num < MODEL_DESC_MAX); num++) {
+            desc = model_desc(addr);
+            if((uint32_t)RESET == (desc->status & ENET_TDES0_DAV)) {
+                break;
+            }
+            size = GET_BITS(desc->control_buffer_size, 0, 12);
+            if((length + size) <= ENET_MODEL_FRAME_MAX) {
+                memcpy(&tx_frame[length], (void *)(uintptr_t)desc->buffer1_addr, size);
+            }
+            length += size;
+            if((uint32_t)RESET == (desc->status & ENET_TDES0_TCHM)) {
+                size = GET_BITS(desc->control_buffer_size, 16, 28);
+                if((length + size) <= ENET_MODEL_FRAME_MAX) {
+                    memcpy(&tx_frame[length], (void *)(uintptr_t)desc->buffer2_next_desc_addr, size);
+                }
+                length += size;
+            }
+            last = desc->status & ENET_TDES0_LSG;
+            addr = model_txdesc_next(desc);
+        }
+
+        if(0U == last) {
+            if(0U == num) {
+                /* nothing to send, suspended until a poll demand */
+                dma_stat |= ENET_DMA_STAT_TBU;
+                model_stat.tx_tbu++;
+            } else {
+                /* the rest of the frame is not ready */
+                dma_stat |= ENET_DMA_STAT_TU;
+            }
+            tx_state = ENET_TX_STATE_SUSPENDED;
+            break;
+        }
+
+        /* close the descriptors, no transmit error */
+        cm = model_desc(tx_desc)->status & ENET_TDES0_CM;
+        addr = tx_desc;
+        for(i = 0U; i < num; i++) {
+            desc = model_desc(addr);
+            addr = model_txdesc_next(desc);
+            if(((num - 1U) == i) && ((uint32_t)RESET != (desc->status & ENET_TDES0_INTC))) {
+                dma_stat |= ENET_DMA_STAT_TS;
+            }
+            desc->status &= ~(ENET_TDES0_DAV | BITS(0,16));
+        }
+        tx_desc = addr;
+
+        if(length > ENET_MODEL_FRAME_MAX) {
+            length = ENET_MODEL_FRAME_MAX;
+        }
+        model_tx_checksum(tx_frame, length, cm);
+        model_stat.tx_frames++;
+        model_stat.tx_bytes += length;
+        if(NULL != model_wire) {
+            model_wire(tx_frame, length);
+        }
+    }
+}
+
+/*!
+    \brief    send the pause frame asked for in full duplex mode, the busy bit clears once it is out
+                in half duplex mode the same bit is the back pressure, it stays as the driver set it
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void model_pause(void)
+{
+    static const uint8_t pause_addr[6] = {0x01U, 0x80U, 0xC2U, 0x00U, 0x00U, 0x01U};
+    uint8_t frame[60];
+    uint32_t addr;
+
+    if(((uint32_t)RESET == (ENET_MAC_CFG & ENET_MAC_CFG_DPM)) || ((uint32_t)RESET == (ENET_MAC_CFG & ENET_MAC_CFG_TEN)) ||
+            ((uint32_t)RESET == (ENET_MAC_FCTL & ENET_MAC_FCTL_TFCEN)) ||
+            ((uint32_t)RESET == (ENET_MAC_FCTL & ENET_MAC_FCTL_FLCBBKPA))) {
+        return;
+    }
+
+    memset(frame, 0, sizeof(frame));
+    memcpy(frame, pause_addr, sizeof(pause_addr));
+    addr = ENET_MAC_ADDR0L;
+    frame[6] = (uint8_t)addr;
+    frame[7] = (uint8_t)(addr >> 8);
+    frame[8] = (uint8_t)(addr >> 16);
+    frame[9] = (uint8_t)(addr >> 24);
+    addr = ENET_MAC_ADDR0H;
+    frame[10] = (uint8_t)addr;
+    frame[11] = (uint8_t)(addr >> 8);
+    /* MAC control frame, PAUSE opcode and the pause time in quanta */
+    frame[12] = 0x88U;
+    frame[13] = 0x08U;
+    frame[15] = 0x01U;
+    frame[16] = (uint8_t)(ENET_MAC_FCTL >> 24);
+    frame[17] = (uint8_t)(ENET_MAC_FCTL >> 16);
+
+    ENET_MAC_FCTL &= ~ENET_MAC_FCTL_FLCBBKPA;
+    model_stat.tx_pause_frames++;
+    if(NULL != model_wire) {
+        model_wire(frame, sizeof(frame));
+    }
+}
+
+/*!
+    \brief    map the ENET registers at ENET_BASE and reset the model
+    \param[in]  none
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus enet_model_init(void)
+{
+    static uint32_t mapped = 0U;
+    void *regs;
+
+    if(0U == mapped) {
+        /* the driver stores the addresses of its descriptors and buffers in 32 bits */
+        if((uintptr_t)&mapped > 0xFFFFFFFFU) {
+            printf("the test data is above 4 GB, link it without PIE\n");
+            return ERROR;
+        }
+        regs = mmap((void *)(uintptr_t)ENET_BASE, MODEL_REG_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if((void *)(uintptr_t)ENET_BASE != regs) {
+            printf("the ENET registers can not be mapped at 0x%08x\n", (unsigned)ENET_BASE);
+            return ERROR;
+        }
+        mapped = 1U;
+        model_crc_init();
+    }
+
+    model_regs_reset();
+    model_phy_reset();
+    enet_model_stat_clear();
+    model_sync();
+
+    return SUCCESS;
+}
+
+/*!
+    \brief    start the service of the self clearing bits and of the PHY
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void enet_model_start(void)
+{
+    struct itimerval period = {{0, MODEL_SERVICE_US}, {0, MODEL_SERVICE_US}};
+    struct sigaction action;
+
+    if(0U == service_run) {
+        service_run = 1U;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = model_service;
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGALRM, &action, NULL);
+        setitimer(ITIMER_REAL, &period, NULL);
+    }
+}
+
+/*!
+    \brief    stop the service of the self clearing bits and of the PHY
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void enet_model_stop(void)
+{
+    struct itimerval off = {{0, 0}, {0, 0}};
+
+    if(0U != service_run) {
+        service_run = 0U;
+        setitimer(ITIMER_REAL, &off, NULL);
+    }
+}
+
+/*!
+    \brief    set the receiver of the transmitted frames
+    \param[in]  wire: called with each frame put on the wire, NULL to drop them
+    \param[out] none
+    \retval     none
+*/
+void enet_model_wire_set(enet_model_wire_fn wire)
+{
+    model_wire = wire;
+}
+
+/*!
+    \brief    a frame arrives from the wire, without CRC
+    \param[in]  frame: frame data
+    \param[in]  length: frame length
+    \param[in]  crc_error: 1 when its frame check sequence is broken
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if it is lost
+*/
+static ErrStatus model_receive(const uint8_t *frame, uint32_t length, uint32_t crc_error)
+{
+    model_frame_struct *slot;
+    uint32_t crc;
+
+    model_sync();
+
+    if(((uint32_t)RESET == (ENET_MAC_CFG & ENET_MAC_CFG_REN)) || (length > (ENET_MODEL_FRAME_MAX - 4U))) {
+        model_stat.rx_refused++;
+        return ERROR;
+    }
+    if((MODEL_RXFIFO_FRAMES == rxfifo_num) || ((rxfifo_bytes + length + 4U) > ENET_MODEL_RXFIFO_SIZE)) {
+        /* receive FIFO overflow */
+        model_stat.rx_overflow++;
+        dma_stat |= ENET_DMA_STAT_RO;
+        if(GET_DMA_MFBOCNT_MSFA(ENET_DMA_MFBOCNT) < 0x7FFU) {
+            ENET_DMA_MFBOCNT += (1U << 17);
+        }
+        model_publish();
+        return ERROR;
+    }
+
+    slot = &rxfifo[(rxfifo_head + rxfifo_num) % MODEL_RXFIFO_FRAMES];
+    memcpy(slot->data, frame, length);
+    crc = model_crc(frame, length);
+    slot->data[length] = (uint8_t)crc;
+    slot->data[length + 1U] = (uint8_t)(crc >> 8);
+    slot->data[length + 2U] = (uint8_t)(crc >> 16);
+    slot->data[length + 3U] = (uint8_t)(crc >> 24);
+    slot->length = length;
+    slot->crc_error = crc_error;
+    rxfifo_num++;
+    rxfifo_bytes += length + 4U;
+
+    /* a new frame makes a suspended RxDMA fetch the descriptor again */
+    if(ENET_RX_STATE_SUSPENDED == rx_state) {
+        rx_state = ENET_RX_STATE_WAITING;
+    }
+    model_rx();
+    model_publish();
+
+    return SUCCESS;
+}
+
+/*!
+    \brief    a frame arrives from the wire, the RxDMA writes it at once if it can
+    \param[in]  frame: frame data from the destination address, without CRC
+    \param[in]  length: frame length
+    \param[out] none
+    \retval     ErrStatus: SUCCESS if the frame is taken by the receive FIFO, ERROR if it is lost
+*/
+ErrStatus enet_model_receive(const uint8_t *frame, uint32_t length)
+{
+    return model_receive(frame, length, 0U);
+}
+
+/*!
+    \brief    a frame with a broken frame check sequence arrives from the wire
+    \param[in]  frame: frame data
+    \param[in]  length: frame length, without CRC
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if it is lost
+*/
+ErrStatus enet_model_receive_crc_error(const uint8_t *frame, uint32_t length)
+{
+    return model_receive(frame, length, 1U);
+}
+
+/*!
+    \brief    let the DMA act on the register writes and the descriptors given back by the driver
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void enet_model_run(void)
+{
+    model_sync();
+    model_tx();
+    model_pause();
+    model_rx();
+    model_publish();
+}
+
+/*!
+    \brief    check whether an enabled ENET interrupt is pending
+    \param[in]  none
+    \param[out] none
+    \retval     FlagStatus: SET or RESET
+*/
+FlagStatus enet_model_irq_pending(void)
+{
+    uint32_t inten = ENET_DMA_INTEN;
+
+    model_sync();
+    model_publish();
+
+    if(((uint32_t)RESET != (inten & ENET_DMA_INTEN_NIE)) && (0U != (dma_stat & inten & MODEL_STAT_NORMAL))) {
+        return SET;
+    }
+    if(((uint32_t)RESET != (inten & ENET_DMA_INTEN_AIE)) && (0U != (dma_stat & inten & MODEL_STAT_ABNORMAL))) {
+        return SET;
+    }
+
+    return RESET;
+}
+
+/*!
+    \brief    get the counters of the model
+    \param[in]  none
+    \param[out] stat: the counters
+    \retval     none
+*/
+void enet_model_stat_get(enet_model_stat_struct *stat)
+{
+    *stat = model_stat;
+}
+
+/*!
+    \brief    clear the counters of the model
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void enet_model_stat_clear(void)
+{
+    memset(&model_stat, 0, sizeof(model_stat));
+}
+
+/*!
+    \brief    add a time to the PTP system time, the subseconds roll over at rollover
+    \param[in]  sec: seconds
+    \param[in]  subsec: subseconds, below rollover
+    \param[in]  rollover: subseconds of a second
+    \param[out] none
+    \retval     none
+*/
+static void model_ptp_add(uint32_t sec, uint32_t subsec, uint32_t rollover)
+{
+    uint32_t now_sec = ENET_PTP_TSH;
+    uint32_t now_subsec = GET_PTP_TSL_STMSS(ENET_PTP_TSL) + subsec;
+
+    if(now_subsec >= rollover) {
+        now_subsec -= rollover;
+        now_sec++;
+    }
+    ENET_PTP_TSL = now_subsec;
+    ENET_PTP_TSH = now_sec + sec;
+}
+
+/*!
+    \brief    subtract a time from the PTP system time, the subseconds roll over at rollover
+    \param[in]  sec: seconds
+    \param[in]  subsec: subseconds, below rollover
+    \param[in]  rollover: subseconds of a second
+    \param[out] none
+    \retval     none
+*/
+static void model_ptp_sub(uint32_t sec, uint32_t subsec, uint32_t rollover)
+{
+    uint32_t now_sec = ENET_PTP_TSH;
+    uint32_t now_subsec = GET_PTP_TSL_STMSS(ENET_PTP_TSL);
+
+    if(now_subsec < subsec) {
+        now_subsec += rollover;
+        now_sec--;
+    }
+    ENET_PTP_TSL = now_subsec - subsec;
+    ENET_PTP_TSH = now_sec - sec;
+}
+
+/*!
+    \brief    run the PTP system time for a number of HCLK cycles
+    \param[in]  cycles: HCLK cycles since the last call, below 2^32
+    \param[out] none
+    \retval     none
+*/
+void enet_model_ptp_clock(uint64_t cycles)
+{
+    uint32_t tsctl = ENET_PTP_TSCTL;
+    uint32_t rollover = (0U != (tsctl & ENET_PTP_TSCTL_SCROM)) ? 1000000000U : 0x80000000U;
+    uint32_t subsec = GET_PTP_TSL_STMSS(ENET_PTP_TSUL);
+    uint64_t ticks, step;
+
+    /* the updates the driver requested since the last call, before the time runs on */
+    if(0U != (tsctl & ENET_PTP_TSCTL_TMSSTI)) {
+        ENET_PTP_TSH = ENET_PTP_TSUH;
+        ENET_PTP_TSL = (subsec < rollover) ? subsec : 0U;
+    } else if(0U != (tsctl & ENET_PTP_TSCTL_TMSSTU)) {
+        if(subsec < rollover) {
+            if(0U != (ENET_PTP_TSUL & ENET_PTP_TSUL_TMSUPNS)) {
+                model_ptp_sub(ENET_PTP_TSUH, subsec, rollover);
+            } else {
+                model_ptp_add(ENET_PTP_TSUH, subsec, rollover);
+            }
+        }
+    }
+    if(0U != (tsctl & ENET_PTP_TSCTL_TMSARU)) {
+        ptp_addend = ENET_PTP_TSADDEND;
+    }
+    ENET_PTP_TSCTL = tsctl & ~(ENET_PTP_TSCTL_TMSSTI | ENET_PTP_TSCTL_TMSSTU | ENET_PTP_TSCTL_TMSARU);
+
+    if(0U == (tsctl & ENET_PTP_TSCTL_TMSEN)) {
+        return;
+    }
+
+    /* the coarse update adds the increment every cycle, the fine one on each carry of the accumulator */
+    if(0U != (tsctl & ENET_PTP_TSCTL_TMSFCU)) {
+        ticks = ((uint64_t)ptp_acc + cycles * ptp_addend) >> 32;
+        ptp_acc += (uint32_t)(cycles * ptp_addend);
+    } else {
+        ticks = cycles;
+    }
+
+    /* whole seconds first, the rest stays below a second */
+    step = ticks * (ENET_PTP_SSINC & ENET_PTP_SSINC_STMSSI);
+    model_ptp_add((uint32_t)(step / rollover), (uint32_t)(step % rollover), rollover);
+}
+
+/* the RCU functions called by the ENET driver */
+void rcu_periph_reset_enable(rcu_periph_reset_enum periph_reset)
+{
+    if(RCU_ENETRST == periph_reset) {
+        model_regs_reset();
+        model_phy_reset();
+    }
+}
+
+void rcu_periph_reset_disable(rcu_periph_reset_enum periph_reset)
+{
+    (void)periph_reset;
+}
+
+uint32_t rcu_clock_freq_get(rcu_clock_freq_enum clock)
+{
+    (void)clock;
+
+    return ENET_MODEL_HCLK;
+}
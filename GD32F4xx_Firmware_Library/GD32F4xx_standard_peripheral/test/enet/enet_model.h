@@ -0,0 +1,97 @@
+/*!
+    \file    enet_model.h
+    \brief   host model of the ENET DMA descriptor engine
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef ENET_MODEL_H
+#define ENET_MODEL_H
+
+#include "gd32f4xx.h"
+
+/* bytes of the receive FIFO, frames wait there while no Rx descriptor is available */
+#ifndef ENET_MODEL_RXFIFO_SIZE
+    #define ENET_MODEL_RXFIFO_SIZE       2048U
+#endif /* ENET_MODEL_RXFIFO_SIZE */
+
+/* HCLK reported to the driver, it selects the SMI clock divider */
+#ifndef ENET_MODEL_HCLK
+    #define ENET_MODEL_HCLK              200000000U
+#endif /* ENET_MODEL_HCLK */
+
+#define ENET_MODEL_FRAME_MAX             16384U                 /* longest frame the model moves */
+
+/* a frame put on the wire by the TxDMA, without the CRC the MAC appends */
+typedef void (*enet_model_wire_fn)(const uint8_t *frame, uint32_t length);
+
+/* counters of the model */
+typedef struct
+{
+    uint32_t rx_frames;                                         /*!< frames written to the Rx descriptors */
+    uint32_t rx_flushed;                                        /*!< frames flushed as no Rx descriptor was available */
+    uint32_t rx_overflow;                                       /*!< frames lost as the receive FIFO was full */
+    uint32_t rx_refused;                                        /*!< frames arriving while the receiver is disabled */
+    uint32_t rx_checksum_dropped;                               /*!< IP frames dropped by the checksum offload */
+    uint32_t rx_crc_dropped;                                    /*!< frames with a CRC error dropped, FERF is not set */
+    uint32_t rx_rbu;                                            /*!< times the RxDMA was suspended by an unavailable descriptor */
+    uint32_t rx_polls;                                          /*!< writes to ENET_DMA_RPEN */
+    uint32_t tx_frames;                                         /*!< frames put on the wire */
+    uint64_t tx_bytes;                                          /*!< frame bytes put on the wire */
+    uint32_t tx_pause_frames;                                   /*!< pause frames sent for the flow control */
+    uint32_t tx_tbu;                                            /*!< times the TxDMA was suspended by an unavailable descriptor */
+    uint32_t tx_polls;                                          /*!< writes to ENET_DMA_TPEN */
+} enet_model_stat_struct;
+
+/* map the ENET registers at ENET_BASE and reset the model */
+ErrStatus enet_model_init(void);
+/* start the service of the self clearing bits and of the PHY, needed while the driver waits for them */
+void enet_model_start(void);
+/* stop that service, so that it does not take CPU time from a measurement */
+void enet_model_stop(void);
+/* set the receiver of the transmitted frames */
+void enet_model_wire_set(enet_model_wire_fn wire);
+/* a frame arrives from the wire, without CRC */
+ErrStatus enet_model_receive(const uint8_t *frame, uint32_t length);
+/* a frame with a broken frame check sequence arrives from the wire */
+ErrStatus enet_model_receive_crc_error(const uint8_t *frame, uint32_t length);
+/* let the DMA act on the register writes and the descriptors given back by the driver */
+void enet_model_run(void);
+/* check whether an enabled ENET interrupt is pending */
+FlagStatus enet_model_irq_pending(void);
+/* get the counters of the model */
+void enet_model_stat_get(enet_model_stat_struct *stat);
+/* clear the counters of the model */
+void enet_model_stat_clear(void);
+/* run the PTP system time for a number of HCLK cycles, applies the pending time and addend updates first */
+void enet_model_ptp_clock(uint64_t cycles);
+
+#endif /* ENET_MODEL_H */
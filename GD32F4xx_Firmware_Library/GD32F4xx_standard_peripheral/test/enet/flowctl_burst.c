@@ -0,0 +1,327 @@
+/*!
+    \file    flowctl_burst.c
+    \brief   flow control of the gd32_drivers against bursts over the host ENET DMA model
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+/*
+    The Rx flow control of gd32_drivers against a link partner sending bursts faster than the
+    host drains its ring, over the ENET DMA model:
+    - without flow control the ring and the receive FIFO overflow
+    - with it no frame is lost, in full duplex the partner honors the pause frames and in half
+      duplex the back pressure
+    - the pause is refreshed at half its duration at the speed of the link, so the partner never
+      resumes while the ring is above the low watermark, also after a change of speed or duplex
+    Time runs in steps of 1 ms, the partner sends FLOW_RATE frames per step and the host takes one
+    each FLOW_DRAIN_MS, slow enough for the pause to be refreshed at 10 Mbit/s too.
+*/
+
+#include "enet_model.h"
+#include "sdk_board.h"
+#include "gd32_enet.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define FLOW_DESC_NUM                16U                    /* Rx descriptors of the test ring */
+#define FLOW_HIGH                    12U
+#define FLOW_LOW                     4U
+#define FLOW_FRAMES                  400U                   /* frames of a burst */
+#define FLOW_RATE                    3U                     /* frames the partner sends per ms */
+#define FLOW_DRAIN_MS                16U                    /* the host takes a frame each 16 ms */
+#define FLOW_LEN                     60U
+#define FLOW_ETHERTYPE               0x88B5U                /* local experimental */
+#define FLOW_TIMEOUT_MS              (FLOW_FRAMES * FLOW_DRAIN_MS * 2U)
+#define SCS_MAP_BASE                 0xE0000000UL           /* the critical sections read the NVIC and SCB */
+#define SCS_MAP_SIZE                 0x10000UL
+
+/* application provided ring, mapped where enet_ring_config() accepts it */
+typedef struct {
+    enet_descriptors_struct rxdesc[FLOW_DESC_NUM];
+    enet_descriptors_struct txdesc[ENET_TXBUF_NUM];
+    uint8_t rxbuf[FLOW_DESC_NUM][ENET_RXBUF_SIZE];
+    uint8_t txbuf[ENET_TXBUF_NUM][ENET_TXBUF_SIZE];
+} flow_ring_struct;
+
+static uint8_t host_mac[6] = {0x02U, 0x00U, 0x00U, 0x00U, 0x00U, 0x0AU};
+static uint8_t host_frame[ENET_MAX_FRAME_SIZE];
+
+/* the partner, time in us */
+static uint32_t now_ms = 0U;
+static uint64_t partner_hold_us = 0U;
+static uint32_t partner_pauses = 0U, partner_resumes = 0U, partner_lapses = 0U;
+static uint32_t partner_last_pause_ms = 0U, partner_refresh_min_ms = 0U, partner_quanta_ns = 0U;
+
+/*!
+    \brief    get the systick of the SDK, the time of the test
+    \param[in]  none
+    \param[out] none
+    \retval     ticks
+*/
+uint32_t sdk_hw_get_systick(void)
+{
+    return now_ms;
+}
+
+/*!
+    \brief    the partner takes the pause frames from the wire
+    \param[in]  frame: frame data
+    \param[in]  length: frame length
+    \param[out] none
+    \retval     none
+*/
+static void partner_wire(const uint8_t *frame, uint32_t length)
+{
+    uint64_t now_us = (uint64_t)now_ms * 1000U;
+    uint32_t quanta, quanta_ns;
+
+    if((length < 18U) || (0x88U != frame[12]) || (0x08U != frame[13]) || (0x01U != frame[15])) {
+        return;
+    }
+    quanta = ((uint32_t)frame[16] << 8) | frame[17];
+    if(0U == quanta) {
+        partner_hold_us = 0U;
+        partner_resumes++;
+        return;
+    }
+    quanta_ns = ((uint32_t)RESET != (ENET_MAC_CFG & ENET_MAC_CFG_SPD)) ? 5120U : 51200U;
+    /* a refresh at the same speed comes not much earlier than half of the pause */
+    if((0U != partner_hold_us) && (quanta_ns == partner_quanta_ns)) {
+        if((0U == partner_refresh_min_ms) || ((now_ms - partner_last_pause_ms) < partner_refresh_min_ms)) {
+            partner_refresh_min_ms = now_ms - partner_last_pause_ms;
+        }
+    }
+    partner_quanta_ns = quanta_ns;
+    partner_hold_us = now_us + ((uint64_t)quanta * quanta_ns) / 1000U;
+    partner_last_pause_ms = now_ms;
+    partner_pauses++;
+}
+
+/*!
+    \brief    check whether the partner may send
+    \param[in]  none
+    \param[out] none
+    \retval     1 if it may, 0 while it is held
+*/
+static uint32_t partner_may_send(void)
+{
+    if((uint32_t)RESET == (ENET_MAC_CFG & ENET_MAC_CFG_DPM)) {
+        /* half duplex, the back pressure jams the medium */
+        return ((uint32_t)RESET == (ENET_MAC_FCTL & ENET_MAC_FCTL_FLCBBKPA)) ? 1U : 0U;
+    }
+    if(0U == partner_hold_us) {
+        return 1U;
+    }
+    if(((uint64_t)now_ms * 1000U) < partner_hold_us) {
+        return 0U;
+    }
+    /* the pause ran out, neither refreshed nor released */
+    partner_hold_us = 0U;
+    partner_lapses++;
+
+    return 1U;
+}
+
+/*!
+    \brief    configure the test ring and initialize the ENET in chain mode
+    \param[in]  ring: memory of the ring
+    \param[in]  mediamode: mode of the link
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus flow_setup(flow_ring_struct *ring, enet_mediamode_enum mediamode)
+{
+    enet_ring_struct config;
+    ErrStatus state = ERROR;
+
+    config.rxdesc = ring->rxdesc;
+    config.txdesc = ring->txdesc;
+    config.rxbuf = &ring->rxbuf[0][0];
+    config.txbuf = &ring->txbuf[0][0];
+    config.txtoken = NULL;
+    config.rxdesc_num = FLOW_DESC_NUM;
+    config.txdesc_num = ENET_TXBUF_NUM;
+    config.rxbuf_size = ENET_RXBUF_SIZE;
+    config.txbuf_size = ENET_TXBUF_SIZE;
+    if(ERROR == enet_ring_config(&config)) {
+        return ERROR;
+    }
+
+    enet_model_start();
+    enet_deinit();
+    if((SUCCESS == enet_software_reset()) &&
+            (SUCCESS == enet_init(mediamode, ENET_NO_AUTOCHECKSUM, ENET_BROADCAST_FRAMES_PASS))) {
+        enet_mac_address_set(ENET_MAC_ADDRESS0, host_mac);
+        enet_descriptors_chain_init(ENET_DMA_TX);
+        enet_descriptors_chain_init(ENET_DMA_RX);
+        enet_enable();
+        state = SUCCESS;
+    }
+    enet_model_stop();
+    enet_model_run();
+    enet_model_stat_clear();
+
+    return state;
+}
+
+/*!
+    \brief    run a burst of the partner, the link changes to a second mode halfway
+    \param[in]  flowctl: 1 to run the flow control, 0 without it
+    \param[in]  mode: mode of the link at the start
+    \param[in]  next: mode of the link after half of the burst
+    \param[out] lost: frames lost in the ring and the receive FIFO
+    \retval     number of frames delivered in order, FLOW_FRAMES when none is missing
+*/
+static uint32_t flow_burst(uint32_t flowctl, enet_mediamode_enum mode, enet_mediamode_enum next, uint32_t *lost)
+{
+    enet_model_stat_struct stat;
+    uint32_t seq_out = 0U, seq_in = 0U, start_ms = now_ms, delivered = 0U, i, size, seq;
+    enet_mediamode_enum current = mode;
+    uint8_t frame[FLOW_LEN];
+
+    enet_media_config(mode);
+    partner_hold_us = 0U;
+    memset(frame, 0, sizeof(frame));
+    memcpy(frame, host_mac, sizeof(host_mac));
+    frame[12] = (uint8_t)(FLOW_ETHERTYPE >> 8);
+    frame[13] = (uint8_t)FLOW_ETHERTYPE;
+    if(0U != flowctl) {
+        gd32_enet_flowctl_init(FLOW_HIGH, FLOW_LOW);
+    }
+
+    while((seq_in < FLOW_FRAMES) && ((now_ms - start_ms) < FLOW_TIMEOUT_MS)) {
+        now_ms++;
+        for(i = 0U; (i < FLOW_RATE) && (seq_out < FLOW_FRAMES) && (0U != partner_may_send()); i++) {
+            frame[14] = (uint8_t)(seq_out >> 8);
+            frame[15] = (uint8_t)seq_out;
+            seq_out++;
+            enet_model_receive(frame, FLOW_LEN);
+        }
+        enet_model_run();
+
+        size = (0U == (now_ms % FLOW_DRAIN_MS)) ? enet_rxframe_size_get() : 0U;
+        if(size > 1U) {
+            if(SUCCESS == enet_frame_receive(host_frame, sizeof(host_frame))) {
+                seq = ((uint32_t)host_frame[14] << 8) | host_frame[15];
+                delivered += (seq == seq_in) ? 1U : 0U;
+                seq_in = seq + 1U;
+            }
+            enet_model_run();
+        }
+
+        /* the PHY driver sets the new mode on link up, the update follows from the timer */
+        if((seq_out >= (FLOW_FRAMES / 2U)) && (current != next)) {
+            current = next;
+            enet_media_config(next);
+        }
+        if(0U != flowctl) {
+            gd32_enet_flowctl_update(now_ms);
+            enet_model_run();
+        }
+        if((seq_out == FLOW_FRAMES) && (0U == enet_rxdesc_occupancy_get(NULL))) {
+            /* the rest was lost */
+            break;
+        }
+    }
+
+    enet_model_stat_get(&stat);
+    *lost = stat.rx_overflow + stat.rx_flushed;
+    enet_model_stat_clear();
+
+    return delivered;
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        enet_mediamode_enum mode;
+        enet_mediamode_enum next;
+    } link[] = {
+        {"100M full", ENET_100M_FULLDUPLEX, ENET_100M_FULLDUPLEX},
+        {"10M full", ENET_10M_FULLDUPLEX, ENET_10M_FULLDUPLEX},
+        {"100M to 10M full", ENET_100M_FULLDUPLEX, ENET_10M_FULLDUPLEX},
+        {"10M half", ENET_10M_HALFDUPLEX, ENET_10M_HALFDUPLEX},
+        {"100M full to 10M half", ENET_100M_FULLDUPLEX, ENET_10M_HALFDUPLEX},
+        {"10M half to 100M full", ENET_10M_HALFDUPLEX, ENET_100M_FULLDUPLEX},
+    };
+    flow_ring_struct *ring;
+    gd32_enet_flowctl_stat_t stat;
+    uint32_t i, delivered, lost, refresh_ms, fails = 0U;
+
+    if(MAP_FAILED == mmap((void *)SCS_MAP_BASE, SCS_MAP_SIZE, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0)) {
+        printf("the System Control Space can not be mapped\n");
+        return 1;
+    }
+    ring = mmap((void *)(uintptr_t)SRAM_BASE, sizeof(flow_ring_struct), PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if((MAP_FAILED == ring) || (ERROR == enet_model_init()) || (ERROR == flow_setup(ring, ENET_100M_FULLDUPLEX))) {
+        printf("the ENET initialization failed\n");
+        return 1;
+    }
+    enet_model_wire_set(partner_wire);
+
+    /* the burst overflows the ring without flow control */
+    delivered = flow_burst(0U, ENET_100M_FULLDUPLEX, ENET_100M_FULLDUPLEX, &lost);
+    i = (0U != lost) ? 0U : 1U;
+    printf("no flow control: %u of %u frames delivered, %u lost, %s\n", delivered, FLOW_FRAMES, lost,
+           (0U == i) ? "ok" : "FAIL");
+    fails += i;
+
+    printf("link                      delivered  lost  pauses  resumes  refresh ms  lapses  occupancy\n");
+    for(i = 0U; i < (sizeof(link) / sizeof(link[0])); i++) {
+        partner_pauses = 0U;
+        partner_resumes = 0U;
+        partner_lapses = 0U;
+        partner_refresh_min_ms = 0U;
+        delivered = flow_burst(1U, link[i].mode, link[i].next, &lost);
+        gd32_enet_flowctl_stat_get(&stat);
+        /* the shortest refresh expected, half of the pause at the fastest speed of the burst */
+        refresh_ms = (((uint32_t)link[i].mode | (uint32_t)link[i].next) & ENET_MAC_CFG_SPD) ? 10U : 104U;
+        if((FLOW_FRAMES != delivered) || (0U != lost) || (0U != partner_lapses) || (0U != stat.paused) ||
+                (stat.occupancy_max >= (FLOW_HIGH + FLOW_RATE)) ||
+                ((0U != partner_refresh_min_ms) && (partner_refresh_min_ms < refresh_ms))) {
+            fails++;
+        }
+        printf("%-24s  %9u  %4u  %6u  %7u  %10u  %6u  %9u\n", link[i].name, delivered, lost, partner_pauses,
+               partner_resumes, partner_refresh_min_ms, partner_lapses, stat.occupancy_max);
+    }
+
+    enet_ring_config(NULL);
+    munmap(ring, sizeof(flow_ring_struct));
+
+    printf("%s\n", (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+/*!
+    \file    ptp_sync.c
+    \brief   PTP slave servo of the gd32_drivers against a master clock, on the modelled system time
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+/*
+    Two clocks exchange PTP messages over a network with a path delay and a jitter. The slave is
+    the gd32_drivers PTP code on the system time of the ENET model, its HCLK runs off by some ppm.
+    The master is an ideal time scale scaled by its own frequency error, with timestamps of 8 ns.
+    The slave takes its timestamps from the model when a message arrives or leaves, as the MAC would.
+    Once per second the master sends a two step Sync, the slave a Delay_Req 200 ms later. Halfway
+    through every interval the true offset of the slave from the master is taken. Time is simulated.
+*/
+
+#include "enet_model.h"
+#include "sdk_board.h"
+#include "gd32_enet.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_INTERVAL_NS              1000000000LL           /* sync interval */
+#define SIM_FOLLOW_UP_NS             50000LL                /* Follow_Up after its Sync */
+#define SIM_DELAY_REQ_NS             200000000LL            /* Delay_Req after the Sync */
+#define SIM_DELAY_RESP_NS            500000LL               /* Delay_Resp after its Delay_Req */
+#define SIM_PROBE_NS                 500000000LL            /* true offset taken after the Sync */
+#define SIM_PATH_NS                  5000LL                 /* path delay of both directions */
+#define SIM_MASTER_TICK_NS           8LL                    /* timestamp resolution of the master */
+#define SIM_MASTER_EPOCH_NS          1700000000000000000LL
+#define SIM_INTERVALS                120U
+#define SIM_SETTLED                  60U                    /* the last intervals, the offsets are checked there */
+#define SIM_LIMIT_NS                 1000LL
+
+/* PTP v2 layout of IEEE 1588, the messages of the master */
+#define PTP_MSG_SYNC                 0x0U
+#define PTP_MSG_DELAY_REQ            0x1U
+#define PTP_MSG_FOLLOW_UP            0x8U
+#define PTP_MSG_DELAY_RESP           0x9U
+#define PTP_SYNC_LEN                 44U
+#define PTP_DELAY_RESP_LEN           54U
+#define PTP_OFS_PORT_ID              20U
+#define PTP_OFS_SEQ                  30U
+#define PTP_OFS_TIMESTAMP            34U
+#define PTP_OFS_REQ_PORT_ID          44U
+#define PTP_PORT_ID_LEN              10U
+
+typedef struct {
+    const char *name;
+    double slave_ppm;                                           /* error of the HCLK of the slave */
+    double master_ppm;                                          /* error of the master clock */
+    int64_t jitter_ns;                                          /* the path delay varies by up to that */
+} sim_case_struct;
+
+static const uint8_t master_port[PTP_PORT_ID_LEN] = {0x02U, 0x00U, 0x00U, 0xFFU, 0xFEU, 0x00U, 0x00U, 0x01U, 0x00U, 0x01U};
+static const uint8_t slave_clock_id[8] = {0x02U, 0x00U, 0x00U, 0xFFU, 0xFEU, 0x00U, 0x00U, 0x02U};
+
+static const sim_case_struct *sim_case;
+static int64_t sim_now = 0;
+static uint64_t sim_cycles = 0U;
+static uint32_t sim_rand = 1U;
+
+/* the Delay_Req of the slave, as the master received it */
+static uint8_t req_port[PTP_PORT_ID_LEN];
+static uint16_t req_seq = 0U;
+static int64_t req_t4 = 0;
+static uint32_t req_valid = 0U;
+
+/*!
+    \brief    a path delay with jitter
+    \param[in]  none
+    \param[out] none
+    \retval     delay in ns
+*/
+static int64_t sim_path(void)
+{
+    sim_rand ^= sim_rand << 13;
+    sim_rand ^= sim_rand >> 17;
+    sim_rand ^= sim_rand << 5;
+
+    return SIM_PATH_NS + (int64_t)(sim_rand % (uint32_t)(sim_case->jitter_ns + 1));
+}
+
+/*!
+    \brief    the time of the master clock
+    \param[in]  t: true time in ns
+    \param[out] none
+    \retval     master time in ns
+*/
+static double sim_master(int64_t t)
+{
+    return (double)SIM_MASTER_EPOCH_NS + (double)t * (1.0 + sim_case->master_ppm / 1e6);
+}
+
+/*!
+    \brief    run the slave system time up to a true time
+    \param[in]  t: true time in ns
+    \param[out] none
+    \retval     none
+*/
+static void sim_advance(int64_t t)
+{
+    uint64_t cycles = (uint64_t)((double)t * (double)ENET_MODEL_HCLK * (1.0 + sim_case->slave_ppm / 1e6) / 1e9);
+
+    enet_model_ptp_clock(cycles - sim_cycles);
+    sim_cycles = cycles;
+    sim_now = t;
+}
+
+/*!
+    \brief    the slave time in ns
+    \param[in]  none
+    \param[out] none
+    \retval     slave time in ns
+*/
+static int64_t sim_slave(void)
+{
+    gd32_enet_ptp_time_t ts;
+
+    gd32_enet_ptp_time_get(&ts);
+
+    return (int64_t)ts.sec * 1000000000LL + ts.nsec;
+}
+
+/*!
+    \brief    build a message of the master
+    \param[in]  msg: message buffer
+    \param[in]  type: message type
+    \param[in]  len: message length
+    \param[in]  seq: sequence number
+    \param[in]  ns: origin or receive timestamp
+    \param[out] none
+    \retval     none
+*/
+static void sim_message(uint8_t *msg, uint8_t type, uint32_t len, uint16_t seq, int64_t ns)
+{
+    uint64_t sec = (uint64_t)ns / 1000000000ULL;
+    uint32_t nsec = (uint32_t)((uint64_t)ns % 1000000000ULL);
+    int i;
+
+    memset(msg, 0, len);
+    msg[0] = type;
+    msg[1] = 2U;
+    msg[2] = (uint8_t)(len >> 8);
+    msg[3] = (uint8_t)len;
+    if(PTP_MSG_SYNC == type) {
+        msg[6] = 0x02U;
+    }
+    memcpy(&msg[PTP_OFS_PORT_ID], master_port, PTP_PORT_ID_LEN);
+    msg[PTP_OFS_SEQ] = (uint8_t)(seq >> 8);
+    msg[PTP_OFS_SEQ + 1U] = (uint8_t)seq;
+    for(i = 5; i >= 0; i--) {
+        msg[PTP_OFS_TIMESTAMP + i] = (uint8_t)sec;
+        sec >>= 8;
+    }
+    for(i = 9; i >= 6; i--) {
+        msg[PTP_OFS_TIMESTAMP + i] = (uint8_t)nsec;
+        nsec >>= 8;
+    }
+}
+
+/*!
+    \brief    transmit of the slave, the master timestamps the arrival of a Delay_Req
+    \param[in]  msg: PTP message
+    \param[in]  len: message length
+    \param[in]  event: 1 for an event message, its transmit timestamp is returned
+    \param[out] tx_ts: transmit timestamp
+    \retval     SDK_OK
+*/
+static int sim_slave_send(const uint8_t *msg, uint32_t len, int event, gd32_enet_ptp_time_t *tx_ts)
+{
+    if((0 != event) && (NULL != tx_ts)) {
+        gd32_enet_ptp_time_get(tx_ts);
+    }
+    if((PTP_SYNC_LEN <= len) && (PTP_MSG_DELAY_REQ == (msg[0] & 0x0FU))) {
+        memcpy(req_port, &msg[PTP_OFS_PORT_ID], PTP_PORT_ID_LEN);
+        req_seq = (uint16_t)((msg[PTP_OFS_SEQ] << 8) | msg[PTP_OFS_SEQ + 1U]);
+        req_t4 = (int64_t)sim_master(sim_now + sim_path());
+        req_t4 -= req_t4 % SIM_MASTER_TICK_NS;
+        req_valid = 1U;
+    }
+
+    return SDK_OK;
+}
+
+/*!
+    \brief    run one case
+    \param[in]  trace: 1 to print the offsets of the first intervals
+    \param[out] lock_s: second the servo locked at, 0 if never
+    \param[out] max_ns: largest true offset of the settled intervals
+    \param[out] rms_ns: RMS of the true offsets of the settled intervals
+    \param[out] stat: the servo state at the end
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus sim_run(uint32_t trace, uint32_t *lock_s, int64_t *max_ns, double *rms_ns, gd32_enet_ptp_stat_t *stat)
+{
+    uint8_t msg[PTP_DELAY_RESP_LEN];
+    gd32_enet_ptp_time_t t2;
+    int64_t t, t1, offset;
+    double sum = 0.0;
+    uint32_t k;
+
+    sim_now = 0;
+    sim_cycles = 0U;
+    req_valid = 0U;
+    *lock_s = 0U;
+    *max_ns = 0;
+    if((ERROR == enet_model_init()) ||
+            (SDK_OK != gd32_enet_ptp_init(ENET_MODEL_HCLK, 0, slave_clock_id, sim_slave_send))) {
+        return ERROR;
+    }
+
+    for(k = 0U; k < SIM_INTERVALS; k++) {
+        t = (int64_t)(k + 1U) * SIM_INTERVAL_NS;
+
+        /* Sync, stamped by the slave MAC on arrival, and its Follow_Up */
+        t1 = (int64_t)sim_master(t);
+        t1 -= t1 % SIM_MASTER_TICK_NS;
+        sim_advance(t + sim_path());
+        gd32_enet_ptp_time_get(&t2);
+        sim_message(msg, PTP_MSG_SYNC, PTP_SYNC_LEN, (uint16_t)k, 0);
+        gd32_enet_ptp_rx(msg, PTP_SYNC_LEN, &t2);
+        sim_advance(t + SIM_FOLLOW_UP_NS);
+        sim_message(msg, PTP_MSG_FOLLOW_UP, PTP_SYNC_LEN, (uint16_t)k, t1);
+        gd32_enet_ptp_rx(msg, PTP_SYNC_LEN, NULL);
+
+        /* Delay_Req and the answer of the master */
+        sim_advance(t + SIM_DELAY_REQ_NS);
+        gd32_enet_ptp_poll();
+        if(0U != req_valid) {
+            req_valid = 0U;
+            sim_advance(t + SIM_DELAY_REQ_NS + SIM_DELAY_RESP_NS);
+            sim_message(msg, PTP_MSG_DELAY_RESP, PTP_DELAY_RESP_LEN, req_seq, req_t4);
+            memcpy(&msg[PTP_OFS_REQ_PORT_ID], req_port, PTP_PORT_ID_LEN);
+            gd32_enet_ptp_rx(msg, PTP_DELAY_RESP_LEN, NULL);
+        }
+
+        /* the true offset, between the exchanges */
+        sim_advance(t + SIM_PROBE_NS);
+        offset = sim_slave() - (int64_t)sim_master(t + SIM_PROBE_NS);
+        gd32_enet_ptp_stat_get(stat);
+        if((0U == *lock_s) && (0U != stat->locked)) {
+            *lock_s = k + 1U;
+        }
+        if(k >= (SIM_INTERVALS - SIM_SETTLED)) {
+            if((offset > *max_ns) || (-offset > *max_ns)) {
+                *max_ns = (offset < 0) ? -offset : offset;
+            }
+            sum += (double)offset * (double)offset;
+        }
+        if((0U != trace) && (k < 16U)) {
+            printf("  %2u s  offset %12lld ns  servo %12lld ns  freq %7d ppb  delay %5lld ns  %s\n", k + 1U,
+                   (long long)offset, (long long)stat->offset_ns, stat->freq_ppb, (long long)stat->delay_ns,
+                   (0U != stat->locked) ? "locked" : "");
+        }
+    }
+    *rms_ns = sqrt(sum / SIM_SETTLED);
+
+    return SUCCESS;
+}
+
+int main(void)
+{
+    static const sim_case_struct cases[] = {
+        {"slave +30 ppm, master -20 ppm", 30.0, -20.0, 100},
+        {"slave -100 ppm", -100.0, 0.0, 100},
+        {"master +50 ppm, jitter 1 us", 0.0, 50.0, 1000},
+        {"slave +200 ppm, master -200 ppm", 200.0, -200.0, 400},
+    };
+    gd32_enet_ptp_stat_t stat;
+    uint32_t i, lock_s, fails = 0U;
+    int64_t max_ns;
+    double rms_ns;
+
+    for(i = 0U; i < (sizeof(cases) / sizeof(cases[0])); i++) {
+        sim_case = &cases[i];
+        if(0U == i) {
+            printf("%s, first seconds:\n", cases[i].name);
+        }
+        if(ERROR == sim_run((0U == i) ? 1U : 0U, &lock_s, &max_ns, &rms_ns, &stat)) {
+            printf("the PTP initialization failed\n");
+            return 1;
+        }
+        if(0U == i) {
+            printf("case                              lock s  steps  freq ppb  delay ns  max |offset| ns  rms ns\n");
+        }
+        if((0U == lock_s) || (0U == stat.locked) || (max_ns >= SIM_LIMIT_NS)) {
+            fails++;
+        }
+        printf("%-32s  %6u  %5u  %8d  %8lld  %15lld  %6.0f\n", cases[i].name, lock_s, stat.steps, stat.freq_ppb,
+               (long long)stat.delay_ns, (long long)max_ns, rms_ns);
+    }
+
+    printf("%s\n", (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
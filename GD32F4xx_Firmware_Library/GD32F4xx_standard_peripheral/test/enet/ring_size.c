@@ -0,0 +1,249 @@
+/*!
+    \file    ring_size.c
+    \brief   receive throughput of application provided ENET rings of several sizes over the host DMA model
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+/*
+    Receive throughput of the rings set up by enet_ring_config() against the ENET DMA model.
+    A link partner sends bursts of frames at 100 Mbit/s, half of the time, and the application
+    empties the ring with enet_frame_receive() once per service period, as a task of an RTOS tick.
+    The frames arriving while the ring is full wait in the receive FIFO of the model or are lost.
+    Time is simulated, the throughput only depends on the ring size, not on the host CPU.
+*/
+
+#include "enet_model.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define RING_DESC_MAX                128U                   /* largest ring of the comparison */
+#define RING_LINE_RATE               100000000ULL
+#define RING_WIRE_EXTRA              24U                    /* CRC, preamble and interframe gap */
+#define RING_BURST_BYTES             65536U                 /* a TCP window sent back to back */
+#define RING_SERVICE_NS              1000000ULL             /* the application empties the ring every 1 ms */
+#define RING_TIME_NS                 400000000ULL           /* simulated time of each case */
+#define RING_ETHERTYPE               0x88B5U                /* local experimental */
+#define RING_HDR_LEN                 18U                    /* MAC header and sequence number */
+
+/* application provided ring, mapped where enet_ring_config() accepts it */
+typedef struct {
+    enet_descriptors_struct rxdesc[RING_DESC_MAX];
+    enet_descriptors_struct txdesc[ENET_TXBUF_NUM];
+    uint8_t rxbuf[RING_DESC_MAX][ENET_RXBUF_SIZE];
+    uint8_t txbuf[ENET_TXBUF_NUM][ENET_TXBUF_SIZE];
+} ring_mem_struct;
+
+static const uint32_t ring_num[] = {4U, 8U, 16U, 32U, 64U, 128U};
+static const uint32_t ring_len[] = {1514U, 512U, 128U};
+
+static uint8_t ring_frame[ENET_MAX_FRAME_SIZE];
+static uint8_t ring_store[ENET_MAX_FRAME_SIZE];
+
+/*!
+    \brief    configure a ring of a number of Rx descriptors and initialize the ENET in chain mode
+    \param[in]  mem: memory of the ring
+    \param[in]  num: number of Rx descriptors
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus ring_setup(ring_mem_struct *mem, uint32_t num)
+{
+    enet_ring_struct ring;
+    ErrStatus state = ERROR;
+
+    ring.rxdesc = mem->rxdesc;
+    ring.txdesc = mem->txdesc;
+    ring.rxbuf = &mem->rxbuf[0][0];
+    ring.txbuf = &mem->txbuf[0][0];
+    ring.txtoken = NULL;
+    ring.rxdesc_num = num;
+    ring.txdesc_num = ENET_TXBUF_NUM;
+    ring.rxbuf_size = ENET_RXBUF_SIZE;
+    ring.txbuf_size = ENET_TXBUF_SIZE;
+    if(ERROR == enet_ring_config(&ring)) {
+        return ERROR;
+    }
+
+    enet_model_start();
+    enet_deinit();
+    if((SUCCESS == enet_software_reset()) &&
+            (SUCCESS == enet_init(ENET_AUTO_NEGOTIATION, ENET_NO_AUTOCHECKSUM, ENET_BROADCAST_FRAMES_PASS))) {
+        enet_descriptors_chain_init(ENET_DMA_TX);
+        enet_descriptors_chain_init(ENET_DMA_RX);
+        enet_enable();
+        state = SUCCESS;
+    }
+    enet_model_stop();
+    enet_model_run();
+    enet_model_stat_clear();
+
+    return state;
+}
+
+/*!
+    \brief    build a broadcast frame carrying a sequence number
+    \param[in]  seq: sequence number
+    \param[in]  length: frame length without CRC
+    \param[out] none
+    \retval     none
+*/
+static void ring_frame_build(uint32_t seq, uint32_t length)
+{
+    memset(&ring_frame[0], 0xFF, 6U);
+    memset(&ring_frame[6], 0x02, 6U);
+    ring_frame[12] = (uint8_t)(RING_ETHERTYPE >> 8);
+    ring_frame[13] = (uint8_t)RING_ETHERTYPE;
+    ring_frame[14] = (uint8_t)(seq >> 24);
+    ring_frame[15] = (uint8_t)(seq >> 16);
+    ring_frame[16] = (uint8_t)(seq >> 8);
+    ring_frame[17] = (uint8_t)seq;
+    memset(&ring_frame[RING_HDR_LEN], (int)(seq & 0xFFU), length - RING_HDR_LEN);
+}
+
+/*!
+    \brief    run the bursts of one frame length against the configured ring
+    \param[in]  length: frame length without CRC
+    \param[out] lost: frames lost in the FIFO or flushed by the DMA
+    \param[out] errors: frames received out of order or damaged
+    \retval     received bytes
+*/
+static uint64_t ring_run(uint32_t length, uint32_t *lost, uint32_t *errors)
+{
+    enet_model_stat_struct stat;
+    uint64_t now = 0U, next_frame = 0U, next_service = RING_SERVICE_NS, burst_end, bytes = 0U;
+    uint64_t frame_ns = ((uint64_t)(length + RING_WIRE_EXTRA) * 8U * 1000000000ULL) / RING_LINE_RATE;
+    uint32_t burst_frames = (RING_BURST_BYTES + length - 1U) / length;
+    uint32_t seq_out = 0U, seq_in = 0U, seq, burst = 0U, size;
+
+    *errors = 0U;
+    burst_end = next_frame + (uint64_t)burst_frames * frame_ns;
+
+    while(now < RING_TIME_NS) {
+        if(next_frame < next_service) {
+            now = next_frame;
+            ring_frame_build(seq_out++, length);
+            enet_model_receive(ring_frame, length);
+
+            next_frame += frame_ns;
+            /* the partner waits as long as the burst lasted, half of the line rate on average */
+            if(++burst == burst_frames) {
+                burst = 0U;
+                next_frame = burst_end + (uint64_t)burst_frames * frame_ns;
+                burst_end = next_frame + (uint64_t)burst_frames * frame_ns;
+            }
+        } else {
+            now = next_service;
+            next_service += RING_SERVICE_NS;
+
+            while(0U != (size = enet_rxframe_size_get())) {
+                if((size != length) || (ERROR == enet_frame_receive(ring_store, sizeof(ring_store)))) {
+                    (*errors)++;
+                    enet_model_run();
+                    continue;
+                }
+                seq = ((uint32_t)ring_store[14] << 24) | ((uint32_t)ring_store[15] << 16) |
+                      ((uint32_t)ring_store[16] << 8) | ring_store[17];
+                if((seq < seq_in) || (ring_store[length - 1U] != (uint8_t)(seq & 0xFFU))) {
+                    (*errors)++;
+                }
+                seq_in = seq + 1U;
+                bytes += length;
+                /* the descriptor given back lets the DMA take the frames waiting in the FIFO */
+                enet_model_run();
+            }
+        }
+    }
+
+    enet_model_stat_get(&stat);
+    *lost = stat.rx_flushed + stat.rx_overflow;
+
+    /* every frame sent is received, lost, or still waiting in the ring for the next service */
+    if((bytes / length) + *lost > seq_out) {
+        (*errors)++;
+    }
+
+    return bytes;
+}
+
+int main(void)
+{
+    ring_mem_struct *mem;
+    uint64_t bytes;
+    uint32_t l, r, lost, errors, fails = 0U;
+    double mbps, last;
+
+    mem = mmap((void *)(uintptr_t)SRAM_BASE, sizeof(ring_mem_struct), PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if((MAP_FAILED == mem) || (ERROR == enet_model_init())) {
+        printf("the ENET model can not be set up\n");
+        return 1;
+    }
+
+    printf("bursts of %u KB at 100 Mbit/s, 50 Mbit/s on average, ring emptied every %u us\n",
+           RING_BURST_BYTES / 1024U, (unsigned)(RING_SERVICE_NS / 1000U));
+    printf("bytes  Rx desc  ring KB  received Mbit/s  lost %%\n");
+
+    for(l = 0U; l < (sizeof(ring_len) / sizeof(ring_len[0])); l++) {
+        last = 0.0;
+        for(r = 0U; r < (sizeof(ring_num) / sizeof(ring_num[0])); r++) {
+            if(ERROR == ring_setup(mem, ring_num[r])) {
+                printf("the ENET initialization failed\n");
+                return 1;
+            }
+            bytes = ring_run(ring_len[l], &lost, &errors);
+            mbps = (double)bytes * 8.0 * 1000.0 / (double)RING_TIME_NS;
+
+            printf("%5u  %7u  %7u  %15.2f  %6.2f%s\n", ring_len[l], ring_num[r],
+                   (unsigned)((ring_num[r] * ENET_RXBUF_SIZE) / 1024U), mbps,
+                   100.0 * (double)lost / (double)(lost + (bytes / ring_len[l])),
+                   (0U != errors) ? "  FAIL" : "");
+
+            /* a larger ring never receives less */
+            if((0U != errors) || (mbps < last * 0.999)) {
+                fails++;
+            }
+            last = mbps;
+        }
+        /* the largest ring holds more than a service period of frames at the line rate */
+        if(0U != lost) {
+            fails++;
+        }
+    }
+    enet_ring_config(NULL);
+    munmap(mem, sizeof(ring_mem_struct));
+
+    printf("%s\n", (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
@@ -0,0 +1,260 @@
+/*!
+    \file    txq_priority.c
+    \brief   priority Tx scheduler of the gd32_drivers over the host ENET DMA model
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+/*
+    The priority Tx scheduler of gd32_drivers against the ENET DMA model:
+    - unshaped bulk traffic leaves GD32_ENET_TXQ_RESERVE descriptors free for the higher queues
+    - a frame is released only once enet_frame_transmit() has handed it to the DMA
+    - the enqueue limit is the smaller of the Tx buffer size and ENET_MAX_FRAME_SIZE
+    The Tx ring has more and larger buffers than the default one, so that both limits differ.
+    The System Control Space is plain memory mapped at its address, like in critical_latency.
+*/
+
+#include "enet_model.h"
+#include "sdk_board.h"
+#include "gd32_enet.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define TXQ_DESC_NUM                 8U                     /* Tx descriptors of the test ring */
+#define TXQ_BUF_SIZE                 2048U                  /* larger than ENET_MAX_FRAME_SIZE */
+#define TXQ_FRAMES                   16U
+#define TXQ_FRAME_LEN                200U
+#define TXQ_ETHERTYPE                0x88B5U                /* local experimental */
+#define TXQ_CONTROL                  0U
+#define TXQ_BULK                     (GD32_ENET_TXQ_NUM - 1U)
+#define SCS_MAP_BASE                 0xE0000000UL           /* the critical sections read the NVIC and SCB */
+#define SCS_MAP_SIZE                 0x10000UL
+
+/* application provided ring, mapped where enet_ring_config() accepts it */
+typedef struct {
+    enet_descriptors_struct rxdesc[ENET_RXBUF_NUM];
+    enet_descriptors_struct txdesc[TXQ_DESC_NUM];
+    uint8_t rxbuf[ENET_RXBUF_NUM][ENET_RXBUF_SIZE];
+    uint8_t txbuf[TXQ_DESC_NUM][TXQ_BUF_SIZE];
+} txq_ring_struct;
+
+static uint8_t txq_frame[TXQ_FRAMES][TXQ_FRAME_LEN];
+static uint8_t txq_long[TXQ_BUF_SIZE];
+
+/* frames released, and how many of them were not on the DMA yet */
+static uint32_t released = 0U, released_early = 0U, released_since_run = 0U;
+static uint32_t released_token[TXQ_FRAMES + 2U];
+
+/* frames on the wire, in order */
+static uint32_t wire_num = 0U, wire_errors = 0U;
+static uint32_t wire_token[TXQ_FRAMES + 2U];
+
+uint32_t sdk_hw_get_systick(void)
+{
+    return 0U;
+}
+
+/*!
+    \brief    the frame of a token is free again, it must already be owned by the DMA
+    \param[in]  token: index of the frame
+    \param[out] none
+    \retval     none
+*/
+static void txq_release(void *token)
+{
+    released_since_run++;
+    /* the frames handed to the DMA since the last run are the descriptors it owns */
+    if((TXQ_DESC_NUM - enet_txdesc_free_get()) != released_since_run) {
+        released_early++;
+    }
+    if(released < (sizeof(released_token) / sizeof(released_token[0]))) {
+        released_token[released] = (uint32_t)(uintptr_t)token;
+    }
+    released++;
+}
+
+/*!
+    \brief    a frame on the wire, the token follows the 802.1Q tag
+    \param[in]  frame: frame data
+    \param[in]  length: frame length
+    \param[out] none
+    \retval     none
+*/
+static void txq_wire(const uint8_t *frame, uint32_t length)
+{
+    if((length != (TXQ_FRAME_LEN + 4U)) || (0x81U != frame[12]) || (0x00U != frame[13]) ||
+            (TXQ_ETHERTYPE != (((uint32_t)frame[16] << 8) | frame[17]))) {
+        wire_errors++;
+        return;
+    }
+    if(wire_num < (sizeof(wire_token) / sizeof(wire_token[0]))) {
+        wire_token[wire_num] = frame[18];
+    }
+    wire_num++;
+}
+
+/*!
+    \brief    let the DMA send what it owns
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void txq_dma_run(void)
+{
+    enet_model_run();
+    released_since_run = 0U;
+}
+
+/*!
+    \brief    configure the test ring and initialize the ENET in chain mode
+    \param[in]  ring: memory of the ring
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus txq_setup(txq_ring_struct *ring)
+{
+    enet_ring_struct config;
+    ErrStatus state = ERROR;
+
+    config.rxdesc = ring->rxdesc;
+    config.txdesc = ring->txdesc;
+    config.rxbuf = &ring->rxbuf[0][0];
+    config.txbuf = &ring->txbuf[0][0];
+    config.txtoken = NULL;
+    config.rxdesc_num = ENET_RXBUF_NUM;
+    config.txdesc_num = TXQ_DESC_NUM;
+    config.rxbuf_size = ENET_RXBUF_SIZE;
+    config.txbuf_size = TXQ_BUF_SIZE;
+    if(ERROR == enet_ring_config(&config)) {
+        return ERROR;
+    }
+
+    enet_model_start();
+    enet_deinit();
+    if((SUCCESS == enet_software_reset()) &&
+            (SUCCESS == enet_init(ENET_AUTO_NEGOTIATION, ENET_NO_AUTOCHECKSUM, ENET_BROADCAST_FRAMES_PASS))) {
+        enet_descriptors_chain_init(ENET_DMA_TX);
+        enet_descriptors_chain_init(ENET_DMA_RX);
+        enet_enable();
+        state = SUCCESS;
+    }
+    enet_model_stop();
+    enet_model_run();
+
+    return state;
+}
+
+int main(void)
+{
+    txq_ring_struct *ring;
+    uint32_t i, sent, control, fails = 0U;
+    int result;
+
+    if(MAP_FAILED == mmap((void *)SCS_MAP_BASE, SCS_MAP_SIZE, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0)) {
+        printf("the System Control Space can not be mapped\n");
+        return 1;
+    }
+    ring = mmap((void *)(uintptr_t)SRAM_BASE, sizeof(txq_ring_struct), PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if((MAP_FAILED == ring) || (ERROR == enet_model_init()) || (ERROR == txq_setup(ring))) {
+        printf("the ENET initialization failed\n");
+        return 1;
+    }
+    enet_model_wire_set(txq_wire);
+    if(SDK_OK != gd32_enet_txq_init(0U, 0U, txq_release)) {
+        printf("the scheduler initialization failed\n");
+        return 1;
+    }
+
+    for(i = 0U; i < TXQ_FRAMES; i++) {
+        memset(txq_frame[i], 0xFF, 6U);
+        memset(&txq_frame[i][6], 0x02, 6U);
+        txq_frame[i][12] = (uint8_t)(TXQ_ETHERTYPE >> 8);
+        txq_frame[i][13] = (uint8_t)TXQ_ETHERTYPE;
+        memset(&txq_frame[i][14], (int)i, TXQ_FRAME_LEN - 14U);
+    }
+
+    /* unshaped bulk fills the ring up to the reserve */
+    for(i = 0U; i < (TXQ_FRAMES - 2U); i++) {
+        fails += (SDK_OK != gd32_enet_txq_enqueue(TXQ_BULK, txq_frame[i], TXQ_FRAME_LEN, GD32_ENET_VLAN_TCI(1U, 0U),
+                                                  (void *)(uintptr_t)i, 0U)) ? 1U : 0U;
+    }
+    sent = gd32_enet_txq_run(0U);
+
+    /* control frames queued behind it still find a descriptor */
+    for(i = TXQ_FRAMES - 2U; i < TXQ_FRAMES; i++) {
+        fails += (SDK_OK != gd32_enet_txq_enqueue(TXQ_CONTROL, txq_frame[i], TXQ_FRAME_LEN, GD32_ENET_VLAN_TCI(7U, 0U),
+                                                  (void *)(uintptr_t)i, 0U)) ? 1U : 0U;
+    }
+    control = gd32_enet_txq_run(0U);
+    txq_dma_run();
+    i = ((TXQ_DESC_NUM - GD32_ENET_TXQ_RESERVE) == sent) && (2U == control) && (TXQ_DESC_NUM == wire_num) &&
+        ((TXQ_FRAMES - 2U) == wire_token[sent]) ? 0U : 1U;
+    printf("reserve: %u bulk frames in a ring of %u, then %u control frames, %s\n", sent, TXQ_DESC_NUM, control,
+           (0U == i) ? "ok" : "FAIL");
+    fails += i;
+
+    /* the rest of the bulk, in order */
+    while(0U != gd32_enet_txq_run(0U)) {
+        txq_dma_run();
+    }
+    for(i = 0U; i < (TXQ_FRAMES - 2U); i++) {
+        if(wire_token[(i < sent) ? i : (i + 2U)] != i) {
+            wire_errors++;
+        }
+    }
+    i = ((TXQ_FRAMES == wire_num) && (TXQ_FRAMES == released) && (0U == released_early) && (0U == wire_errors)) ? 0U : 1U;
+    printf("release: %u frames on the wire, %u released, %u of them before the DMA owned them, %s\n", wire_num,
+           released, released_early, (0U == i) ? "ok" : "FAIL");
+    fails += i;
+
+    /* the tag makes the first frame too long for the MAC, though it fits the buffer */
+    memset(txq_long, 0, sizeof(txq_long));
+    result = gd32_enet_txq_enqueue(TXQ_CONTROL, txq_long, ENET_MAX_FRAME_SIZE - 2U, GD32_ENET_VLAN_TCI(7U, 0U), NULL, 0U);
+    i = (-SDK_E_INVALID == result) ? 0U : 1U;
+    result = gd32_enet_txq_enqueue(TXQ_CONTROL, txq_long, ENET_MAX_FRAME_SIZE, GD32_ENET_VLAN_NONE, NULL, 0U);
+    i += (SDK_OK == result) ? 0U : 1U;
+    printf("frame size: %u byte buffers, frames of up to %u bytes with the tag accepted, %s\n", TXQ_BUF_SIZE,
+           ENET_MAX_FRAME_SIZE, (0U == i) ? "ok" : "FAIL");
+    fails += i;
+    gd32_enet_txq_run(0U);
+    txq_dma_run();
+
+    enet_ring_config(NULL);
+    munmap(ring, sizeof(txq_ring_struct));
+
+    printf("%s\n", (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
@@ -37,6 +37,10 @@ OF SUCH DAMAGE.
 
 #include "usbd_enum.h"
 
+#ifdef USE_USB_AD_SRC
+#include "audio_src.h"
+#endif /* USE_USB_AD_SRC */
+
 #define FORMAT_24BIT(x)                           (uint8_t)(x);(uint8_t)((x) >> 8U);(uint8_t)((x) >> 16U)
 
 /* number of sub-packets in the audio transfer buffer. you can modify this value but always make sure
@@ -47,6 +51,16 @@ OF SUCH DAMAGE.
 #define OUT_BUF_MARGIN                            0U
 #define TOTAL_OUT_BUF_SIZE                        ((uint32_t)((SPEAKER_OUT_PACKET + OUT_BUF_MARGIN) * OUT_PACKET_NUM))
 
+/* feedback loop time constant in frames, as a power of two */
+#ifndef AD_FEEDBACK_TC_SHIFT
+    #define AD_FEEDBACK_TC_SHIFT                  10U
+#endif /* AD_FEEDBACK_TC_SHIFT */
+
+/* smoothing of the ring fill level sampled at every SOF, as a power of two */
+#ifndef AD_FEEDBACK_FILTER_SHIFT
+    #define AD_FEEDBACK_FILTER_SHIFT              4U
+#endif /* AD_FEEDBACK_FILTER_SHIFT */
+
 #define AD_CONFIG_DESC_SET_LEN                    (sizeof(usb_desc_config_set))
 #define AD_INTERFACE_DESC_SIZE                    9U
 
@@ -292,10 +306,12 @@ typedef struct
 
 typedef struct
 {
-    /* main buffer for audio data out transfers and its relative pointers */
-    uint8_t  isoc_out_buff[TOTAL_OUT_BUF_SIZE];
+    /* main buffer for audio data out transfers and its relative pointers, packets are received
+       in place and the spare area past the ring end takes the part of a packet that wraps */
+    uint8_t  isoc_out_buff[TOTAL_OUT_BUF_SIZE + SPEAKER_OUT_MAX_PACKET];
     uint8_t* isoc_out_wrptr;
     uint8_t* isoc_out_rdptr;
+    uint8_t* isoc_out_rxptr;
     uint16_t buf_free_size;
     uint16_t dam_tx_len;
 
@@ -303,10 +319,19 @@ typedef struct
     __IO uint8_t play_flag;
     uint8_t feedback_freq[3];
     uint32_t cur_sam_freq;
+    uint32_t fill_level;
 
-    /* usb receive buffer */
+    /* usb receive buffer, only used to drop packets when the ring is full */
     uint8_t usb_rx_buffer[SPEAKER_OUT_MAX_PACKET];
 
+#ifdef USE_USB_AD_SRC
+    /* rate matched output, the codec DMA plays it circularly and calls audio_out_dma_refill()
+       at half and full transfer; audio_out_src_read() then owns isoc_out_rdptr, so the codec
+       interrupt must not advance it, and dam_tx_len stays 0 */
+    int16_t src_out_buff[SPEAKER_OUT_PACKET];
+    audio_src_struct src;
+#endif /* USE_USB_AD_SRC */
+
     /* main buffer for audio control requests transfers and its relative variables */
     uint8_t  audioctl[64];
     uint8_t  audioctl_unit;
@@ -317,4 +342,10 @@ extern usb_desc audio_desc;
 extern usb_class_core usbd_audio_cb;
 extern usbd_audio_handler audio_handler;
 
+#ifdef USE_USB_AD_SRC
+/* function declarations */
+/* fill the output buffer with rate matched audio from the OUT ring */
+void audio_out_src_read (uint8_t *pbuf, uint32_t len);
+#endif /* USE_USB_AD_SRC */
+
 #endif /* __AUDIO_CORE_H */
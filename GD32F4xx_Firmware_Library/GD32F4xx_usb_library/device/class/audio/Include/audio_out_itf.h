@@ -46,4 +46,14 @@ typedef struct {
 
 extern audio_fops_struct audio_out_fops;
 
+#ifdef USE_USB_AD_SRC
+/* halves of the circular output buffer played by the codec DMA */
+#define AD_OUT_HALF_FIRST                         0U
+#define AD_OUT_HALF_SECOND                        1U
+
+/* function declarations */
+/* refill the half of the output buffer the codec DMA has just played */
+void audio_out_dma_refill (uint8_t half);
+#endif /* USE_USB_AD_SRC */
+
 #endif /* __AUDIO_OUT_ITF_H */
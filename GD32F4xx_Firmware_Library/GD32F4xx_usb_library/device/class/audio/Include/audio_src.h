@@ -0,0 +1,88 @@
+/*!
+    \file    audio_src.h
+    \brief   the header file of the audio sample rate converter
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+#ifndef __AUDIO_SRC_H
+#define __AUDIO_SRC_H
+
+#include "usbd_conf.h"
+
+/* number of interleaved 16-bit channels in a sample frame */
+#ifndef AD_SRC_CHANNELS
+    #define AD_SRC_CHANNELS                       SPEAKER_OUT_CHANNEL_NBR
+#endif /* AD_SRC_CHANNELS */
+
+/* ratio loop time constant in output frames, as a power of two */
+#ifndef AD_SRC_TC_SHIFT
+    #define AD_SRC_TC_SHIFT                       19U
+#endif /* AD_SRC_TC_SHIFT */
+
+/* smoothing of the ring fill level sampled at every call, as a power of two; packets and
+   refills both come once per millisecond, so the sampled level steps by a packet as their
+   phases slide past each other, and a long average keeps that out of the ratio */
+#ifndef AD_SRC_FILTER_SHIFT
+    #define AD_SRC_FILTER_SHIFT                   9U
+#endif /* AD_SRC_FILTER_SHIFT */
+
+/* maximum ratio deviation from 1 in parts per million */
+#ifndef AD_SRC_LIMIT_PPM
+    #define AD_SRC_LIMIT_PPM                      5000U
+#endif /* AD_SRC_LIMIT_PPM */
+
+/* ratio and phase are unsigned 8.24 fixed point */
+#define AD_SRC_ONE                                (1UL << 24U)
+
+/* the windowed sinc filter, the coefficient table of audio_src.c is built for these */
+#define AD_SRC_TAPS                               32U
+#define AD_SRC_PHASE_BITS                         6U
+#define AD_SRC_PHASES                             (1UL << AD_SRC_PHASE_BITS)
+
+typedef struct
+{
+    int16_t  hist[AD_SRC_CHANNELS][2U * AD_SRC_TAPS];   /*!< input history of each channel, every frame is
+                                                             written twice so that a window is contiguous */
+    uint32_t pos;                         /*!< oldest input frame of the window */
+    uint32_t phase;                       /*!< output position past the centre of the window, in input frames */
+    uint32_t step;                        /*!< input frames consumed per output frame */
+    uint32_t fill_level;                  /*!< filtered input fill level in frames */
+} audio_src_struct;
+
+/* function declarations */
+/* initialize the converter to a ratio of 1 */
+void audio_src_init (audio_src_struct *src, uint32_t fill_target);
+/* adapt the conversion ratio to the input fill level */
+void audio_src_adjust (audio_src_struct *src, uint32_t fill, uint32_t fill_target);
+/* convert input frames until the output is full or the input runs out */
+uint32_t audio_src_process (audio_src_struct *src, const int16_t *in, uint32_t *in_frames, int16_t *out, uint32_t out_frames);
+
+#endif /* __AUDIO_SRC_H */
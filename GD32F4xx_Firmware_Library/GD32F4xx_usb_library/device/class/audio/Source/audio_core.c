@@ -45,6 +45,13 @@ OF SUCH DAMAGE.
 #define VOL_RES                      1U    /* volume Resolution */
 #define VOL_0dB                      70U   /* 0dB is in the middle of VOL_MIN and VOL_MAX */
 
+/* size of one sample frame of the speaker stream */
+#define AD_OUT_FRAME_SIZE            (SPEAKER_OUT_CHANNEL_NBR * 2U)
+
+/* nominal feedback value and its maximum deviation in 10.14 format */
+#define AD_FEEDBACK_NOMINAL          (((uint32_t)I2S_ACTUAL_SAM_FREQ(USBD_SPEAKER_FREQ) << 14U) / 1000U)
+#define AD_FEEDBACK_LIMIT            (((uint32_t)FEEDBACK_FREQ_OFFSET << 14U) / 1000U)
+
 #ifdef USE_USB_AD_MICPHONE
 extern volatile uint32_t count_data;
 extern const char wavetestdata[];
@@ -65,7 +72,9 @@ static uint8_t audio_sof (usb_dev *udev);
 static uint8_t audio_iso_in_incomplete (usb_dev *udev);
 static uint8_t audio_iso_out_incomplete (usb_dev *udev);
 static uint32_t usbd_audio_spk_get_feedback(usb_dev *udev);
-static void get_feedback_fs_rate(uint32_t rate, uint8_t *buf);
+static void get_feedback_fs_value(uint32_t value, uint8_t *buf);
+static uint32_t audio_out_fill (void);
+static void audio_out_recev (usb_dev *udev);
 
 usb_class_core usbd_audio_cb = {
     .init      = audio_init,
@@ -566,7 +575,7 @@ static uint8_t audio_init (usb_dev *udev, uint8_t config_index)
     usbd_ep_setup (udev, &ep1);
 
     /* prepare out endpoint to receive next audio packet */
-    usbd_ep_recev (udev, AD_OUT_EP, audio_handler.usb_rx_buffer, SPEAKER_OUT_MAX_PACKET);
+    audio_out_recev (udev);
 
     /* initialize the audio output hardware layer */
     if (USBD_OK != audio_out_fops.audio_init(USBD_SPEAKER_FREQ, DEFAULT_VOLUME)) {
@@ -705,9 +714,13 @@ static uint8_t audio_set_intf(usb_dev *udev, usb_req *req)
             audio_handler.isoc_out_rdptr = audio_handler.isoc_out_buff;
             audio_handler.isoc_out_wrptr = audio_handler.isoc_out_buff;
 
-            /* feedback calculate sample freq */
+            /* feedback calculate sample freq, starting from a half full ring */
             audio_handler.actual_freq = I2S_ACTUAL_SAM_FREQ(USBD_SPEAKER_FREQ);
-            get_feedback_fs_rate(audio_handler.actual_freq, audio_handler.feedback_freq);
+            audio_handler.fill_level = (TOTAL_OUT_BUF_SIZE / 2U) << AD_FEEDBACK_FILTER_SHIFT;
+            get_feedback_fs_value(AD_FEEDBACK_NOMINAL, audio_handler.feedback_freq);
+
+            /* the receive pointer was cleared with the handler, arm the OUT endpoint at the ring start again */
+            audio_out_recev (udev);
 
             /* send feedback data of estimated frequence*/
             usbd_ep_send(udev, AD_FEEDBACK_IN_EP, audio_handler.feedback_freq, FEEDBACK_IN_PACKET);
@@ -782,8 +795,7 @@ static uint8_t audio_data_in (usb_dev *udev, uint8_t ep_num)
 #ifdef USE_USB_AD_SPEAKER
     if(ep_num == EP_ID(AD_FEEDBACK_IN_EP)){
         /* calculate feedback actual freq */
-        audio_handler.actual_freq = usbd_audio_spk_get_feedback(udev);
-        get_feedback_fs_rate(audio_handler.actual_freq, audio_handler.feedback_freq);
+        get_feedback_fs_value(usbd_audio_spk_get_feedback(udev), audio_handler.feedback_freq);
 
         usbd_ep_send(udev, AD_FEEDBACK_IN_EP, audio_handler.feedback_freq, FEEDBACK_IN_PACKET);
     }
@@ -801,47 +813,24 @@ static uint8_t audio_data_in (usb_dev *udev, uint8_t ep_num)
 */
 static uint8_t audio_data_out (usb_dev *udev, uint8_t ep_num)
 {
-    uint16_t usb_rx_length, tail_len;
+    uint16_t usb_rx_length, over_len;
+    uint8_t *ring_end = audio_handler.isoc_out_buff + TOTAL_OUT_BUF_SIZE;
 
     /* get receive length */
     usb_rx_length = ((usb_core_driver *)udev)->dev.transc_out[ep_num].xfer_count;
 
-    if(audio_handler.isoc_out_wrptr >= audio_handler.isoc_out_rdptr){
-        audio_handler.buf_free_size = TOTAL_OUT_BUF_SIZE + audio_handler.isoc_out_rdptr - audio_handler.isoc_out_wrptr;
-    }else{
-        audio_handler.buf_free_size = audio_handler.isoc_out_rdptr - audio_handler.isoc_out_wrptr;
-    }
+    /* the packet is already in the ring unless it went to the drop buffer */
+    if (audio_handler.isoc_out_rxptr == audio_handler.isoc_out_wrptr) {
+        /* increment the buffer pointer */
+        audio_handler.isoc_out_wrptr += usb_rx_length;
 
-    /* free buffer enough to save rx data */
-    if(audio_handler.buf_free_size > usb_rx_length){
-        if(audio_handler.isoc_out_wrptr >= audio_handler.isoc_out_rdptr){
-            tail_len = audio_handler.isoc_out_buff + TOTAL_OUT_BUF_SIZE - audio_handler.isoc_out_wrptr;
-
-            if(tail_len >= usb_rx_length){
-                memcpy(audio_handler.isoc_out_wrptr, audio_handler.usb_rx_buffer, usb_rx_length);
-
-                /* increment the buffer pointer */
-                audio_handler.isoc_out_wrptr += usb_rx_length;
-
-                /* increment the Buffer pointer or roll it back when all buffers are full */
-                if(audio_handler.isoc_out_wrptr >= (audio_handler.isoc_out_buff + TOTAL_OUT_BUF_SIZE)){
-                    /* all buffers are full: roll back */
-                    audio_handler.isoc_out_wrptr = audio_handler.isoc_out_buff;
-                }
-            }else{
-                memcpy(audio_handler.isoc_out_wrptr, audio_handler.usb_rx_buffer, tail_len);
-                /* adjust write pointer */
-                audio_handler.isoc_out_wrptr = audio_handler.isoc_out_buff;
-
-                memcpy(audio_handler.isoc_out_wrptr, &audio_handler.usb_rx_buffer[tail_len], usb_rx_length - tail_len);
-                /* adjust write pointer */
-                audio_handler.isoc_out_wrptr += usb_rx_length - tail_len;
-            }
-        }else{
-            memcpy(audio_handler.isoc_out_wrptr, audio_handler.usb_rx_buffer, usb_rx_length);
-
-            /* increment the buffer pointer */
-            audio_handler.isoc_out_wrptr += usb_rx_length;
+        /* move the part received past the ring end to the ring start */
+        if (audio_handler.isoc_out_wrptr >= ring_end) {
+            over_len = audio_handler.isoc_out_wrptr - ring_end;
+
+            memcpy(audio_handler.isoc_out_buff, ring_end, over_len);
+
+            audio_handler.isoc_out_wrptr = audio_handler.isoc_out_buff + over_len;
         }
     }
 
@@ -849,29 +838,80 @@ static uint8_t audio_data_out (usb_dev *udev, uint8_t ep_num)
     udev->dev.transc_out[ep_num].frame_num = (udev->dev.transc_out[ep_num].frame_num)? 0U:1U;
 
     /* prepare out endpoint to receive next audio packet */
-    usbd_ep_recev (udev, AD_OUT_EP, audio_handler.usb_rx_buffer, SPEAKER_OUT_MAX_PACKET);
-
-    if(audio_handler.isoc_out_wrptr >= audio_handler.isoc_out_rdptr){
-        audio_handler.buf_free_size = TOTAL_OUT_BUF_SIZE + audio_handler.isoc_out_rdptr - audio_handler.isoc_out_wrptr;
-    }else{
-        audio_handler.buf_free_size = audio_handler.isoc_out_rdptr - audio_handler.isoc_out_wrptr;
-    }
+    audio_out_recev (udev);
 
     if ((0U == audio_handler.play_flag) && (audio_handler.buf_free_size < TOTAL_OUT_BUF_SIZE/2)) {
         /* enable start of streaming */
         audio_handler.play_flag = 1U;
 
+#ifdef USE_USB_AD_SRC
+        /* start from a ratio of 1, aiming at a half full ring */
+        audio_src_init(&audio_handler.src, TOTAL_OUT_BUF_SIZE / 2U / AD_OUT_FRAME_SIZE);
+        audio_out_src_read((uint8_t *)audio_handler.src_out_buff, sizeof(audio_handler.src_out_buff));
+
+        /* initialize the audio output hardware layer */
+        if (USBD_OK != audio_out_fops.audio_cmd((uint8_t *)audio_handler.src_out_buff, SPEAKER_OUT_PACKET, AD_CMD_PLAY)) {
+            return USBD_FAIL;
+        }
+#else
         /* initialize the audio output hardware layer */
         if (USBD_OK != audio_out_fops.audio_cmd(audio_handler.isoc_out_rdptr, SPEAKER_OUT_MAX_PACKET/2, AD_CMD_PLAY)) {
             return USBD_FAIL;
         }
 
         audio_handler.dam_tx_len = SPEAKER_OUT_MAX_PACKET;
+#endif /* USE_USB_AD_SRC */
     }
 
     return USBD_OK;
 }
 
+#ifdef USE_USB_AD_SRC
+
+/*!
+    \brief      fill the output buffer with rate matched audio from the OUT ring, at play start
+                and from audio_out_dma_refill() afterwards
+    \param[in]  pbuf: pointer to output buffer of interleaved 16-bit frames
+    \param[in]  len: output length in bytes
+    \param[out] none
+    \retval     none
+*/
+void audio_out_src_read (uint8_t *pbuf, uint32_t len)
+{
+    uint8_t *ring_end = audio_handler.isoc_out_buff + TOTAL_OUT_BUF_SIZE;
+    uint32_t out_frames = len / AD_OUT_FRAME_SIZE, done = 0U, in_frames, seg, i;
+    int16_t *out = (int16_t *)pbuf;
+
+    audio_src_adjust(&audio_handler.src, audio_out_fill() / AD_OUT_FRAME_SIZE, TOTAL_OUT_BUF_SIZE / 2U / AD_OUT_FRAME_SIZE);
+
+    /* the waiting data is at most two contiguous pieces, before and after the ring end */
+    for (i = 0U; (i < 2U) && (done < out_frames); i++) {
+        seg = audio_out_fill();
+
+        if (seg > (uint32_t)(ring_end - audio_handler.isoc_out_rdptr)) {
+            seg = (uint32_t)(ring_end - audio_handler.isoc_out_rdptr);
+        }
+
+        in_frames = seg / AD_OUT_FRAME_SIZE;
+
+        done += audio_src_process(&audio_handler.src, (const int16_t *)audio_handler.isoc_out_rdptr, &in_frames, \
+                                  &out[done * SPEAKER_OUT_CHANNEL_NBR], out_frames - done);
+
+        audio_handler.isoc_out_rdptr += in_frames * AD_OUT_FRAME_SIZE;
+
+        if (audio_handler.isoc_out_rdptr >= ring_end) {
+            audio_handler.isoc_out_rdptr = audio_handler.isoc_out_buff;
+        }
+    }
+
+    /* the ring ran dry, play silence for the rest */
+    if (done < out_frames) {
+        memset(&out[done * SPEAKER_OUT_CHANNEL_NBR], 0, (out_frames - done) * AD_OUT_FRAME_SIZE);
+    }
+}
+
+#endif /* USE_USB_AD_SRC */
+
 /*!
     \brief      handles the SOF event (data buffer update and synchronization)
     \param[in]  udev: pointer to USB device instance
@@ -880,6 +920,13 @@ static uint8_t audio_data_out (usb_dev *udev, uint8_t ep_num)
 */
 static uint8_t audio_sof (usb_dev *udev)
 {
+#ifdef USE_USB_AD_SPEAKER
+    /* sample the ring fill level once per frame for the feedback, decaying before adding
+       the new sample so that the filter settles at the fill level times 2^AD_FEEDBACK_FILTER_SHIFT */
+    audio_handler.fill_level -= audio_handler.fill_level >> AD_FEEDBACK_FILTER_SHIFT;
+    audio_handler.fill_level += audio_out_fill();
+#endif /* USE_USB_AD_SPEAKER */
+
     return USBD_OK;
 }
 
@@ -893,8 +940,7 @@ static uint8_t audio_iso_in_incomplete (usb_dev *udev)
 {
     (void)usb_txfifo_flush (&udev->regs, EP_ID(AD_FEEDBACK_IN_EP));
 
-    audio_handler.actual_freq = usbd_audio_spk_get_feedback(udev);
-    get_feedback_fs_rate(audio_handler.actual_freq, audio_handler.feedback_freq);
+    get_feedback_fs_value(usbd_audio_spk_get_feedback(udev), audio_handler.feedback_freq);
 
     /* send feedback data of estimated frequence*/
     usbd_ep_send(udev, AD_FEEDBACK_IN_EP, audio_handler.feedback_freq, FEEDBACK_IN_PACKET);
@@ -917,43 +963,81 @@ static uint8_t audio_iso_out_incomplete (usb_dev *udev)
     \brief      calculate feedback sample frequency
     \param[in]  udev: pointer to USB device instance
     \param[out] none
-    \retval     feedback frequency value
+    \retval     feedback value in 10.14 format
 */
 static uint32_t usbd_audio_spk_get_feedback(usb_dev *udev)
 {
-    static uint32_t fb_freq;
-
-    /* calculate buffer free size */
-    if(audio_handler.isoc_out_wrptr >= audio_handler.isoc_out_rdptr){
-        audio_handler.buf_free_size = TOTAL_OUT_BUF_SIZE + audio_handler.isoc_out_rdptr - audio_handler.isoc_out_wrptr;
-    }else{
-        audio_handler.buf_free_size = audio_handler.isoc_out_rdptr - audio_handler.isoc_out_wrptr;
+    int32_t err, corr;
+    uint32_t fb;
+
+    /* fill level error in sample frames, scaled by the filter gain */
+    err = (int32_t)audio_handler.fill_level - (int32_t)((TOTAL_OUT_BUF_SIZE / 2U) << AD_FEEDBACK_FILTER_SHIFT);
+    err /= (int32_t)AD_OUT_FRAME_SIZE;
+
+    /* drain the error over the loop time constant: a fuller ring asks the host for fewer samples */
+    corr = (int32_t)(((int64_t)err * 16384) / ((int64_t)1 << (AD_FEEDBACK_TC_SHIFT + AD_FEEDBACK_FILTER_SHIFT)));
+
+    if (corr > (int32_t)AD_FEEDBACK_LIMIT) {
+        corr = (int32_t)AD_FEEDBACK_LIMIT;
+    } else if (corr < -(int32_t)AD_FEEDBACK_LIMIT) {
+        corr = -(int32_t)AD_FEEDBACK_LIMIT;
+    } else {
+        /* no operation */
     }
 
-    /* calculate feedback frequency */
-    if(audio_handler.buf_free_size <= (TOTAL_OUT_BUF_SIZE/4)){
-        fb_freq = I2S_ACTUAL_SAM_FREQ(USBD_SPEAKER_FREQ) - FEEDBACK_FREQ_OFFSET;
-    }else if(audio_handler.buf_free_size >= (TOTAL_OUT_BUF_SIZE*3/4)){
-        fb_freq = I2S_ACTUAL_SAM_FREQ(USBD_SPEAKER_FREQ) + FEEDBACK_FREQ_OFFSET;
-    }else{
-        fb_freq = I2S_ACTUAL_SAM_FREQ(USBD_SPEAKER_FREQ);
-    }
+    fb = (uint32_t)((int32_t)AD_FEEDBACK_NOMINAL - corr);
+    audio_handler.actual_freq = (fb * 1000U) >> 14U;
 
-    return fb_freq;
+    return fb;
 }
 
 /*!
-    \brief      get feedback value from rate in USB full speed
-    \param[in]  rate: sample frequence
+    \brief      get feedback value in USB full speed format
+    \param[in]  value: feedback value in 10.14 format
     \param[in]  buf: pointer to result buffer
     \param[out] none
-    \retval     USB device operation status
+    \retval     none
+*/
+static void get_feedback_fs_value(uint32_t value, uint8_t *buf)
+{
+    buf[0] = (uint8_t)value;
+    buf[1] = (uint8_t)(value >> 8U);
+    buf[2] = (uint8_t)(value >> 16U);
+}
+
+/*!
+    \brief      get the number of bytes waiting in the audio out ring
+    \param[in]  none
+    \param[out] none
+    \retval     bytes written and not yet played
+*/
+static uint32_t audio_out_fill (void)
+{
+    uint8_t *rdptr = audio_handler.isoc_out_rdptr;
+
+    if (audio_handler.isoc_out_wrptr >= rdptr) {
+        return (uint32_t)(audio_handler.isoc_out_wrptr - rdptr);
+    } else {
+        return TOTAL_OUT_BUF_SIZE - (uint32_t)(rdptr - audio_handler.isoc_out_wrptr);
+    }
+}
+
+/*!
+    \brief      prepare the OUT endpoint to receive the next audio packet
+    \param[in]  udev: pointer to USB device instance
+    \param[out] none
+    \retval     none
 */
-static void get_feedback_fs_rate(uint32_t rate, uint8_t *buf)
+static void audio_out_recev (usb_dev *udev)
 {
-    rate = ((rate / 1000) << 14) | ((rate % 1000) << 4);
+    audio_handler.buf_free_size = (uint16_t)(TOTAL_OUT_BUF_SIZE - audio_out_fill());
+
+    /* receive straight into the ring, the spare area past its end holds a wrapping packet */
+    if (audio_handler.buf_free_size > SPEAKER_OUT_MAX_PACKET) {
+        audio_handler.isoc_out_rxptr = audio_handler.isoc_out_wrptr;
+    } else {
+        audio_handler.isoc_out_rxptr = audio_handler.usb_rx_buffer;
+    }
 
-    buf[0] = rate;
-    buf[1] = rate >> 8;
-    buf[2] = rate >> 16;
+    usbd_ep_recev (udev, AD_OUT_EP, audio_handler.isoc_out_rxptr, SPEAKER_OUT_MAX_PACKET);
 }
@@ -166,3 +166,28 @@ static uint8_t audio_cmd (uint8_t* pbuf, uint32_t size, uint8_t cmd)
         return AD_FAIL;
     }
 }
+
+#ifdef USE_USB_AD_SRC
+
+/*!
+    \brief      refill the half of the output buffer the codec DMA has just played, to be called
+                from the DMA half transfer and full transfer interrupts when the sample rate
+                converter is used; the DMA runs circularly over the buffer passed with AD_CMD_PLAY
+                and the interrupt must not move isoc_out_rdptr itself
+    \param[in]  half: half of the buffer the DMA has left
+      \arg        AD_OUT_HALF_FIRST: on the half transfer interrupt
+      \arg        AD_OUT_HALF_SECOND: on the full transfer interrupt
+    \param[out] none
+    \retval     none
+*/
+void audio_out_dma_refill (uint8_t half)
+{
+    uint32_t len = sizeof(audio_handler.src_out_buff) / 2U;
+    uint8_t *pbuf = (uint8_t *)audio_handler.src_out_buff;
+
+    if (AD_STATE_PLAYING == audio_state) {
+        audio_out_src_read(&pbuf[(AD_OUT_HALF_SECOND == half) ? len : 0U], len);
+    }
+}
+
+#endif /* USE_USB_AD_SRC */
@@ -0,0 +1,608 @@
+/*!
+    \file    audio_src.c
+    \brief   audio sample rate converter, polyphase windowed sinc filter in fixed point
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+#include "audio_src.h"
+#include <string.h>
+
+/*
+    Each output sample is the dot product of the 32 input samples around its position with a
+    Kaiser windowed sinc (beta 8, cutoff 0.44 fs) delayed by the fractional position. The table
+    holds the filter at 64 delays, the coefficients between two of them are linearly interpolated.
+
+    Passband, ratio near 1: flat within 0.05 dB up to 0.375 fs (18 kHz at 48 kHz), -0.7 dB at
+    0.4 fs, -8.8 dB at 0.45 fs. Images and aliases are attenuated by 89 dB or more from 0.55 fs,
+    so a tone up to 0.45 fs has no image that folds back into the audio band.
+*/
+
+#define AD_SRC_LIMIT                 ((uint32_t)(((uint64_t)AD_SRC_LIMIT_PPM << 24U) / 1000000U))
+#define AD_SRC_FRAC_SHIFT            (24U - AD_SRC_PHASE_BITS - 15U)
+
+/* saturate to 16 bits and the dual 16-bit multiply accumulate, single instructions on Cortex-M4,
+   define AD_SRC_PORTABLE for the plain C version when building for another target such as a
+   host benchmark */
+#if defined(__CORTEX_M) && (__CORTEX_M >= 0x04U) && !defined(AD_SRC_PORTABLE)
+    #define AD_SRC_SAT16(x)          ((int16_t)__SSAT((x), 16U))
+    #define AD_SRC_SIMD
+#else
+    #define AD_SRC_SAT16(x)          ((int16_t)(((x) > 32767) ? 32767 : (((x) < -32768) ? -32768 : (x))))
+#endif /* __CORTEX_M */
+
+/* the filter at the delays 0 to 1 in steps of 1/64, Q15, each delay sums to 32768; the absolute
+   values of a delay sum to less than 2 * 32768, so a dot product stays in 32 bits */
+static const int16_t audio_src_coef[AD_SRC_PHASES + 1U][AD_SRC_TAPS] =
+{
+    {
+            -4,     15,    -37,     71,   -106,    121,    -80,    -60,
+           339,   -777,   1365,  -2053,   2755,  -3367,   3784,  28836,
+          3784,  -3367,   2755,  -2053,   1365,   -777,    339,    -60,
+           -80,    121,   -106,     71,    -37,     15,     -4,      0
+    },
+    {
+            -4,     15,    -37,     69,   -102,    113,    -66,    -80,
+           363,   -800,   1375,  -2033,   2679,  -3181,   3314,  28827,
+          4262,  -3549,   2827,  -2068,   1352,   -753,    314,    -40,
+           -94,    129,   -110,     72,    -37,     15,     -4,      0
+    },
+    {
+            -4,     15,    -37,     68,    -98,    104,    -52,   -100,
+           386,   -821,   1383,  -2011,   2599,  -2992,   2853,  28801,
+          4747,  -3728,   2895,  -2080,   1336,   -727,    288,    -19,
+          -107,    136,   -113,     73,    -37,     14,     -4,      0
+    },
+    {
+            -4,     15,    -37,     66,    -94,     96,    -38,   -119,
+           408,   -840,   1388,  -1984,   2515,  -2801,   2401,  28753,
+          5240,  -3904,   2958,  -2088,   1318,   -699,    261,      2,
+          -121,    144,   -116,     74,    -37,     14,     -3,      0
+    },
+    {
+            -4,     15,    -36,     65,    -90,     88,    -24,   -138,
+           430,   -857,   1390,  -1954,   2427,  -2609,   1958,  28690,
+          5739,  -4075,   3016,  -2092,   1297,   -670,    233,     23,
+          -135,    152,   -120,     75,    -37,     14,     -3,      0
+    },
+    {
+            -5,     16,    -36,     63,    -85,     79,    -11,   -156,
+           450,   -872,   1389,  -1921,   2336,  -2414,   1525,  28610,
+          6245,  -4241,   3070,  -2093,   1273,   -639,    205,     45,
+          -149,    159,   -123,     75,    -37,     13,     -3,      0
+    },
+    {
+            -5,     16,    -35,     61,    -81,     71,      2,   -174,
+           469,   -886,   1386,  -1885,   2241,  -2218,   1101,  28513,
+          6756,  -4402,   3118,  -2089,   1246,   -606,    175,     66,
+          -163,    166,   -125,     76,    -36,     13,     -3,      0
+    },
+    {
+            -5,     16,    -35,     59,    -77,     62,     16,   -191,
+           487,   -898,   1381,  -1845,   2144,  -2022,    688,  28393,
+          7274,  -4558,   3161,  -2081,   1217,   -572,    146,     88,
+          -176,    173,   -128,     76,    -36,     13,     -2,      0
+    },
+    {
+            -5,     15,    -34,     57,    -72,     54,     29,   -208,
+           504,   -908,   1373,  -1803,   2044,  -1824,    286,  28261,
+          7796,  -4708,   3198,  -2069,   1185,   -537,    115,    110,
+          -190,    180,   -131,     76,    -36,     12,     -2,      0
+    },
+    {
+            -5,     15,    -34,     55,    -67,     46,     41,   -224,
+           519,   -916,   1362,  -1757,   1941,  -1627,   -106,  28109,
+          8322,  -4851,   3230,  -2053,   1151,   -500,     84,    132,
+          -203,    186,   -133,     77,    -35,     11,     -2,      0
+    },
+    {
+            -5,     15,    -33,     53,    -63,     37,     54,   -239,
+           534,   -922,   1349,  -1709,   1836,  -1430,   -486,  27938,
+          8852,  -4989,   3256,  -2033,   1114,   -461,     53,    154,
+          -216,    192,   -135,     77,    -34,     11,     -2,      0
+    },
+    {
+            -5,     15,    -32,     51,    -58,     29,     66,   -254,
+           547,   -927,   1333,  -1658,   1729,  -1233,   -855,  27753,
+          9386,  -5119,   3276,  -2009,   1074,   -422,     21,    176,
+          -229,    198,   -136,     76,    -34,     10,     -1,      0
+    },
+    {
+            -5,     15,    -31,     49,    -53,     21,     78,   -268,
+           559,   -929,   1315,  -1605,   1620,  -1038,  -1212,  27548,
+          9923,  -5242,   3291,  -1981,   1032,   -381,    -12,    198,
+          -241,    204,   -138,     76,    -33,     10,     -1,     -1
+    },
+    {
+            -5,     15,    -31,     47,    -48,     12,     90,   -282,
+           570,   -930,   1295,  -1549,   1509,   -843,  -1558,  27330,
+         10462,  -5357,   3299,  -1949,    988,   -339,    -45,    220,
+          -253,    209,   -139,     75,    -32,      9,     -1,     -1
+    },
+    {
+            -5,     15,    -30,     44,    -44,      4,    101,   -294,
+           580,   -930,   1273,  -1491,   1397,   -650,  -1891,  27094,
+         11003,  -5465,   3301,  -1912,    941,   -296,    -78,    241,
+          -265,    214,   -140,     75,    -31,      8,      0,     -1
+    },
+    {
+            -5,     14,    -29,     42,    -39,     -4,    112,   -306,
+           589,   -927,   1248,  -1430,   1284,   -459,  -2212,  26841,
+         11545,  -5564,   3297,  -1872,    892,   -252,   -111,    263,
+          -277,    219,   -141,     74,    -30,      7,      0,     -1
+    },
+    {
+            -5,     14,    -28,     39,    -34,    -11,    122,   -318,
+           596,   -923,   1222,  -1368,   1169,   -270,  -2520,  26570,
+         12088,  -5654,   3287,  -1827,    840,   -206,   -144,    284,
+          -288,    223,   -141,     73,    -29,      7,      1,     -1
+    },
+    {
+            -5,     14,    -27,     37,    -29,    -19,    133,   -328,
+           602,   -917,   1193,  -1304,   1054,    -84,  -2816,  26285,
+         12631,  -5735,   3270,  -1779,    787,   -160,   -178,    305,
+          -298,    227,   -142,     72,    -27,      6,      1,     -1
+    },
+    {
+            -5,     13,    -26,     34,    -24,    -27,    142,   -338,
+           607,   -909,   1163,  -1238,    939,    100,  -3099,  25990,
+         13173,  -5807,   3247,  -1726,    731,   -114,   -212,    326,
+          -309,    230,   -142,     70,    -26,      5,      1,     -1
+    },
+    {
+            -5,     13,    -25,     32,    -20,    -34,    152,   -347,
+           611,   -900,   1130,  -1170,    823,    280,  -3369,  25674,
+         13715,  -5870,   3217,  -1670,    673,    -66,   -245,    346,
+          -318,    233,   -141,     69,    -25,      4,      2,     -1
+    },
+    {
+            -5,     13,    -24,     29,    -15,    -41,    161,   -355,
+           613,   -889,   1096,  -1101,    707,    458,  -3626,  25347,
+         14255,  -5922,   3181,  -1610,    614,    -18,   -279,    365,
+          -328,    236,   -141,     67,    -23,      3,      2,     -2
+    },
+    {
+            -4,     12,    -23,     27,    -10,    -48,    169,   -363,
+           614,   -876,   1060,  -1031,    591,    631,  -3870,  25004,
+         14793,  -5964,   3138,  -1546,    552,     31,   -312,    385,
+          -336,    238,   -140,     65,    -22,      2,      3,     -2
+    },
+    {
+            -4,     12,    -21,     24,     -6,    -55,    178,   -369,
+           614,   -862,   1023,   -960,    475,    801,  -4101,  24645,
+         15329,  -5996,   3088,  -1478,    489,     80,   -345,    404,
+          -345,    240,   -138,     64,    -20,      1,      3,     -2
+    },
+    {
+            -4,     12,    -20,     22,     -1,    -62,    185,   -375,
+           613,   -847,    984,   -887,    360,    967,  -4318,  24275,
+         15861,  -6017,   3032,  -1407,    424,    130,   -378,    422,
+          -352,    242,   -137,     61,    -18,      0,      3,     -2
+    },
+    {
+            -4,     11,    -19,     19,      3,    -68,    193,   -380,
+           611,   -830,    943,   -814,    246,   1128,  -4523,  23893,
+         16390,  -6027,   2970,  -1332,    358,    180,   -410,    439,
+          -360,    243,   -135,     59,    -17,     -1,      4,     -2
+    },
+    {
+            -4,     11,    -18,     17,      8,    -74,    199,   -385,
+           608,   -812,    902,   -740,    132,   1285,  -4714,  23496,
+         16914,  -6025,   2901,  -1253,    290,    230,   -443,    457,
+          -366,    243,   -133,     57,    -15,     -2,      4,     -2
+    },
+    {
+            -4,     10,    -17,     14,     12,    -80,    206,   -388,
+           603,   -792,    858,   -666,     20,   1437,  -4891,  23089,
+         17434,  -6012,   2825,  -1172,    221,    281,   -474,    473,
+          -372,    243,   -131,     54,    -13,     -3,      5,     -2
+    },
+    {
+            -4,     10,    -16,     12,     16,    -86,    211,   -391,
+           598,   -771,    814,   -591,    -91,   1583,  -5056,  22673,
+         17948,  -5988,   2743,  -1087,    150,    331,   -505,    489,
+          -377,    243,   -128,     51,    -11,     -4,      5,     -3
+    },
+    {
+            -4,     10,    -14,      9,     20,    -91,    217,   -393,
+           591,   -749,    769,   -516,   -200,   1725,  -5207,  22242,
+         18456,  -5951,   2654,   -999,     79,    381,   -536,    503,
+          -382,    242,   -125,     48,     -9,     -5,      6,     -3
+    },
+    {
+            -4,      9,    -13,      7,     24,    -97,    222,   -394,
+           584,   -726,    723,   -440,   -308,   1862,  -5345,  21800,
+         18957,  -5902,   2559,   -908,      7,    431,   -565,    518,
+          -386,    240,   -122,     45,     -7,     -6,      6,     -3
+    },
+    {
+            -3,      9,    -12,      5,     28,   -102,    226,   -395,
+           575,   -702,    676,   -365,   -413,   1993,  -5470,  21346,
+         19452,  -5841,   2458,   -814,    -67,    481,   -594,    531,
+          -389,    238,   -118,     42,     -4,     -7,      7,     -3
+    },
+    {
+            -3,      8,    -11,      2,     32,   -106,    230,   -394,
+           565,   -676,    628,   -290,   -517,   2118,  -5582,  20885,
+         19939,  -5767,   2351,   -717,   -140,    531,   -623,    543,
+          -391,    236,   -115,     39,     -2,     -9,      7,     -3
+    },
+    {
+            -3,      8,    -10,      0,     35,   -111,    233,   -393,
+           555,   -650,    580,   -215,   -618,   2237,  -5681,  20417,
+         20417,  -5681,   2237,   -618,   -215,    580,   -650,    555,
+          -393,    233,   -111,     35,      0,    -10,      8,     -3
+    },
+    {
+            -3,      7,     -9,     -2,     39,   -115,    236,   -391,
+           543,   -623,    531,   -140,   -717,   2351,  -5767,  19939,
+         20885,  -5582,   2118,   -517,   -290,    628,   -676,    565,
+          -394,    230,   -106,     32,      2,    -11,      8,     -3
+    },
+    {
+            -3,      7,     -7,     -4,     42,   -118,    238,   -389,
+           531,   -594,    481,    -67,   -814,   2458,  -5841,  19452,
+         21346,  -5470,   1993,   -413,   -365,    676,   -702,    575,
+          -395,    226,   -102,     28,      5,    -12,      9,     -3
+    },
+    {
+            -3,      6,     -6,     -7,     45,   -122,    240,   -386,
+           518,   -565,    431,      7,   -908,   2559,  -5902,  18957,
+         21800,  -5345,   1862,   -308,   -440,    723,   -726,    584,
+          -394,    222,    -97,     24,      7,    -13,      9,     -4
+    },
+    {
+            -3,      6,     -5,     -9,     48,   -125,    242,   -382,
+           503,   -536,    381,     79,   -999,   2654,  -5951,  18456,
+         22242,  -5207,   1725,   -200,   -516,    769,   -749,    591,
+          -393,    217,    -91,     20,      9,    -14,     10,     -4
+    },
+    {
+            -3,      5,     -4,    -11,     51,   -128,    243,   -377,
+           489,   -505,    331,    150,  -1087,   2743,  -5988,  17948,
+         22673,  -5056,   1583,    -91,   -591,    814,   -771,    598,
+          -391,    211,    -86,     16,     12,    -16,     10,     -4
+    },
+    {
+            -2,      5,     -3,    -13,     54,   -131,    243,   -372,
+           473,   -474,    281,    221,  -1172,   2825,  -6012,  17434,
+         23089,  -4891,   1437,     20,   -666,    858,   -792,    603,
+          -388,    206,    -80,     12,     14,    -17,     10,     -4
+    },
+    {
+            -2,      4,     -2,    -15,     57,   -133,    243,   -366,
+           457,   -443,    230,    290,  -1253,   2901,  -6025,  16914,
+         23496,  -4714,   1285,    132,   -740,    902,   -812,    608,
+          -385,    199,    -74,      8,     17,    -18,     11,     -4
+    },
+    {
+            -2,      4,     -1,    -17,     59,   -135,    243,   -360,
+           439,   -410,    180,    358,  -1332,   2970,  -6027,  16390,
+         23893,  -4523,   1128,    246,   -814,    943,   -830,    611,
+          -380,    193,    -68,      3,     19,    -19,     11,     -4
+    },
+    {
+            -2,      3,      0,    -18,     61,   -137,    242,   -352,
+           422,   -378,    130,    424,  -1407,   3032,  -6017,  15861,
+         24275,  -4318,    967,    360,   -887,    984,   -847,    613,
+          -375,    185,    -62,     -1,     22,    -20,     12,     -4
+    },
+    {
+            -2,      3,      1,    -20,     64,   -138,    240,   -345,
+           404,   -345,     80,    489,  -1478,   3088,  -5996,  15329,
+         24645,  -4101,    801,    475,   -960,   1023,   -862,    614,
+          -369,    178,    -55,     -6,     24,    -21,     12,     -4
+    },
+    {
+            -2,      3,      2,    -22,     65,   -140,    238,   -336,
+           385,   -312,     31,    552,  -1546,   3138,  -5964,  14793,
+         25004,  -3870,    631,    591,  -1031,   1060,   -876,    614,
+          -363,    169,    -48,    -10,     27,    -23,     12,     -4
+    },
+    {
+            -2,      2,      3,    -23,     67,   -141,    236,   -328,
+           365,   -279,    -18,    614,  -1610,   3181,  -5922,  14255,
+         25347,  -3626,    458,    707,  -1101,   1096,   -889,    613,
+          -355,    161,    -41,    -15,     29,    -24,     13,     -5
+    },
+    {
+            -1,      2,      4,    -25,     69,   -141,    233,   -318,
+           346,   -245,    -66,    673,  -1670,   3217,  -5870,  13715,
+         25674,  -3369,    280,    823,  -1170,   1130,   -900,    611,
+          -347,    152,    -34,    -20,     32,    -25,     13,     -5
+    },
+    {
+            -1,      1,      5,    -26,     70,   -142,    230,   -309,
+           326,   -212,   -114,    731,  -1726,   3247,  -5807,  13173,
+         25990,  -3099,    100,    939,  -1238,   1163,   -909,    607,
+          -338,    142,    -27,    -24,     34,    -26,     13,     -5
+    },
+    {
+            -1,      1,      6,    -27,     72,   -142,    227,   -298,
+           305,   -178,   -160,    787,  -1779,   3270,  -5735,  12631,
+         26285,  -2816,    -84,   1054,  -1304,   1193,   -917,    602,
+          -328,    133,    -19,    -29,     37,    -27,     14,     -5
+    },
+    {
+            -1,      1,      7,    -29,     73,   -141,    223,   -288,
+           284,   -144,   -206,    840,  -1827,   3287,  -5654,  12088,
+         26570,  -2520,   -270,   1169,  -1368,   1222,   -923,    596,
+          -318,    122,    -11,    -34,     39,    -28,     14,     -5
+    },
+    {
+            -1,      0,      7,    -30,     74,   -141,    219,   -277,
+           263,   -111,   -252,    892,  -1872,   3297,  -5564,  11545,
+         26841,  -2212,   -459,   1284,  -1430,   1248,   -927,    589,
+          -306,    112,     -4,    -39,     42,    -29,     14,     -5
+    },
+    {
+            -1,      0,      8,    -31,     75,   -140,    214,   -265,
+           241,    -78,   -296,    941,  -1912,   3301,  -5465,  11003,
+         27094,  -1891,   -650,   1397,  -1491,   1273,   -930,    580,
+          -294,    101,      4,    -44,     44,    -30,     15,     -5
+    },
+    {
+            -1,     -1,      9,    -32,     75,   -139,    209,   -253,
+           220,    -45,   -339,    988,  -1949,   3299,  -5357,  10462,
+         27330,  -1558,   -843,   1509,  -1549,   1295,   -930,    570,
+          -282,     90,     12,    -48,     47,    -31,     15,     -5
+    },
+    {
+            -1,     -1,     10,    -33,     76,   -138,    204,   -241,
+           198,    -12,   -381,   1032,  -1981,   3291,  -5242,   9923,
+         27548,  -1212,  -1038,   1620,  -1605,   1315,   -929,    559,
+          -268,     78,     21,    -53,     49,    -31,     15,     -5
+    },
+    {
+             0,     -1,     10,    -34,     76,   -136,    198,   -229,
+           176,     21,   -422,   1074,  -2009,   3276,  -5119,   9386,
+         27753,   -855,  -1233,   1729,  -1658,   1333,   -927,    547,
+          -254,     66,     29,    -58,     51,    -32,     15,     -5
+    },
+    {
+             0,     -2,     11,    -34,     77,   -135,    192,   -216,
+           154,     53,   -461,   1114,  -2033,   3256,  -4989,   8852,
+         27938,   -486,  -1430,   1836,  -1709,   1349,   -922,    534,
+          -239,     54,     37,    -63,     53,    -33,     15,     -5
+    },
+    {
+             0,     -2,     11,    -35,     77,   -133,    186,   -203,
+           132,     84,   -500,   1151,  -2053,   3230,  -4851,   8322,
+         28109,   -106,  -1627,   1941,  -1757,   1362,   -916,    519,
+          -224,     41,     46,    -67,     55,    -34,     15,     -5
+    },
+    {
+             0,     -2,     12,    -36,     76,   -131,    180,   -190,
+           110,    115,   -537,   1185,  -2069,   3198,  -4708,   7796,
+         28261,    286,  -1824,   2044,  -1803,   1373,   -908,    504,
+          -208,     29,     54,    -72,     57,    -34,     15,     -5
+    },
+    {
+             0,     -2,     13,    -36,     76,   -128,    173,   -176,
+            88,    146,   -572,   1217,  -2081,   3161,  -4558,   7274,
+         28393,    688,  -2022,   2144,  -1845,   1381,   -898,    487,
+          -191,     16,     62,    -77,     59,    -35,     16,     -5
+    },
+    {
+             0,     -3,     13,    -36,     76,   -125,    166,   -163,
+            66,    175,   -606,   1246,  -2089,   3118,  -4402,   6756,
+         28513,   1101,  -2218,   2241,  -1885,   1386,   -886,    469,
+          -174,      2,     71,    -81,     61,    -35,     16,     -5
+    },
+    {
+             0,     -3,     13,    -37,     75,   -123,    159,   -149,
+            45,    205,   -639,   1273,  -2093,   3070,  -4241,   6245,
+         28610,   1525,  -2414,   2336,  -1921,   1389,   -872,    450,
+          -156,    -11,     79,    -85,     63,    -36,     16,     -5
+    },
+    {
+             0,     -3,     14,    -37,     75,   -120,    152,   -135,
+            23,    233,   -670,   1297,  -2092,   3016,  -4075,   5739,
+         28690,   1958,  -2609,   2427,  -1954,   1390,   -857,    430,
+          -138,    -24,     88,    -90,     65,    -36,     15,     -4
+    },
+    {
+             0,     -3,     14,    -37,     74,   -116,    144,   -121,
+             2,    261,   -699,   1318,  -2088,   2958,  -3904,   5240,
+         28753,   2401,  -2801,   2515,  -1984,   1388,   -840,    408,
+          -119,    -38,     96,    -94,     66,    -37,     15,     -4
+    },
+    {
+             0,     -4,     14,    -37,     73,   -113,    136,   -107,
+           -19,    288,   -727,   1336,  -2080,   2895,  -3728,   4747,
+         28801,   2853,  -2992,   2599,  -2011,   1383,   -821,    386,
+          -100,    -52,    104,    -98,     68,    -37,     15,     -4
+    },
+    {
+             0,     -4,     15,    -37,     72,   -110,    129,    -94,
+           -40,    314,   -753,   1352,  -2068,   2827,  -3549,   4262,
+         28827,   3314,  -3181,   2679,  -2033,   1375,   -800,    363,
+           -80,    -66,    113,   -102,     69,    -37,     15,     -4
+    },
+    {
+             0,     -4,     15,    -37,     71,   -106,    121,    -80,
+           -60,    339,   -777,   1365,  -2053,   2755,  -3367,   3784,
+         28836,   3784,  -3367,   2755,  -2053,   1365,   -777,    339,
+           -60,    -80,    121,   -106,     71,    -37,     15,     -4
+    }
+};
+
+/* local function prototypes ('static') */
+static void audio_src_coef_get (uint32_t phase, int16_t *coef);
+static int32_t audio_src_dot (const int16_t *x, const int16_t *coef);
+
+/*!
+    \brief      initialize the converter to a ratio of 1
+    \param[in]  src: pointer to converter instance
+    \param[in]  fill_target: input fill level in frames the ratio loop settles to
+    \param[out] none
+    \retval     none
+*/
+void audio_src_init (audio_src_struct *src, uint32_t fill_target)
+{
+    memset((void *)src, 0, sizeof(audio_src_struct));
+
+    src->step = AD_SRC_ONE;
+    src->fill_level = fill_target << AD_SRC_FILTER_SHIFT;
+}
+
+/*!
+    \brief      adapt the conversion ratio to the input fill level
+    \param[in]  src: pointer to converter instance
+    \param[in]  fill: input frames waiting to be converted
+    \param[in]  fill_target: input fill level in frames the ratio loop settles to
+    \param[out] none
+    \retval     none
+*/
+void audio_src_adjust (audio_src_struct *src, uint32_t fill, uint32_t fill_target)
+{
+    int32_t err, adj;
+
+    /* decay before adding the new sample, so that the filter settles at fill << AD_SRC_FILTER_SHIFT */
+    src->fill_level -= src->fill_level >> AD_SRC_FILTER_SHIFT;
+    src->fill_level += fill;
+
+    /* drain the fill error over the loop time constant: a fuller input is consumed faster */
+    err = (int32_t)src->fill_level - (int32_t)(fill_target << AD_SRC_FILTER_SHIFT);
+    adj = (int32_t)(((int64_t)err * (int64_t)AD_SRC_ONE) / ((int64_t)1 << (AD_SRC_TC_SHIFT + AD_SRC_FILTER_SHIFT)));
+
+    if (adj > (int32_t)AD_SRC_LIMIT) {
+        adj = (int32_t)AD_SRC_LIMIT;
+    } else if (adj < -(int32_t)AD_SRC_LIMIT) {
+        adj = -(int32_t)AD_SRC_LIMIT;
+    } else {
+        /* no operation */
+    }
+
+    src->step = (uint32_t)((int32_t)AD_SRC_ONE + adj);
+}
+
+/*!
+    \brief      convert input frames until the output is full or the input runs out
+    \param[in]  src: pointer to converter instance
+    \param[in]  in: interleaved input frames
+    \param[in]  in_frames: number of input frames available
+    \param[out] in_frames: number of input frames consumed
+    \param[out] out: interleaved output frames
+    \param[in]  out_frames: number of output frames wanted
+    \retval     number of output frames produced
+*/
+uint32_t audio_src_process (audio_src_struct *src, const int16_t *in, uint32_t *in_frames, int16_t *out, uint32_t out_frames)
+{
+    /* word aligned for the dual multiply, with a zero on both sides of the filter */
+    uint32_t coef_buf[AD_SRC_TAPS / 2U + 1U];
+    int16_t *coef = (int16_t *)coef_buf;
+    uint32_t used = 0U, produced = 0U, base, ch;
+
+    while (produced < out_frames) {
+        /* shift in the input frames the output position has passed */
+        while (src->phase >= AD_SRC_ONE) {
+            if (used == *in_frames) {
+                *in_frames = used;
+
+                return produced;
+            }
+
+            for (ch = 0U; ch < AD_SRC_CHANNELS; ch++) {
+                src->hist[ch][src->pos] = in[used * AD_SRC_CHANNELS + ch];
+                src->hist[ch][src->pos + AD_SRC_TAPS] = in[used * AD_SRC_CHANNELS + ch];
+            }
+
+            src->pos = (src->pos + 1U) % AD_SRC_TAPS;
+            used++;
+            src->phase -= AD_SRC_ONE;
+        }
+
+        /* the window starts at pos, the products start at the word below it */
+        base = src->pos & ~1U;
+        coef[0] = 0;
+        coef[AD_SRC_TAPS] = 0;
+        coef[AD_SRC_TAPS + 1U] = 0;
+        audio_src_coef_get(src->phase, &coef[src->pos & 1U]);
+
+        for (ch = 0U; ch < AD_SRC_CHANNELS; ch++) {
+            *out++ = AD_SRC_SAT16((audio_src_dot(&src->hist[ch][base], coef) + 0x4000) >> 15);
+        }
+
+        produced++;
+        src->phase += src->step;
+    }
+
+    *in_frames = used;
+
+    return produced;
+}
+
+/*!
+    \brief      get the filter at a fractional delay, between two delays of the table
+    \param[in]  phase: delay past the centre of the window, in input frames below AD_SRC_ONE
+    \param[out] coef: AD_SRC_TAPS coefficients in Q15
+    \retval     none
+*/
+static void audio_src_coef_get (uint32_t phase, int16_t *coef)
+{
+    const int16_t *h0 = audio_src_coef[phase >> (24U - AD_SRC_PHASE_BITS)];
+    const int16_t *h1 = h0 + AD_SRC_TAPS;
+    int32_t frac = (int32_t)((phase >> AD_SRC_FRAC_SHIFT) & 0x7FFFU);
+    uint32_t i;
+
+    for (i = 0U; i < AD_SRC_TAPS; i++) {
+        coef[i] = (int16_t)(h0[i] + ((((h1[i] - h0[i]) * frac) + 0x4000) >> 15));
+    }
+}
+
+/*!
+    \brief      dot product of a window with the filter
+    \param[in]  x: AD_SRC_TAPS + 2 input samples, word aligned
+    \param[in]  coef: AD_SRC_TAPS + 2 coefficients, word aligned
+    \param[out] none
+    \retval     sum of the products in Q15
+*/
+static int32_t audio_src_dot (const int16_t *x, const int16_t *coef)
+{
+    int32_t acc = 0;
+    uint32_t i;
+
+#ifdef AD_SRC_SIMD
+    const uint32_t *x2 = (const uint32_t *)x;
+    const uint32_t *c2 = (const uint32_t *)coef;
+
+    /* two products per instruction */
+    for (i = 0U; i < (AD_SRC_TAPS / 2U + 1U); i++) {
+        acc = (int32_t)__SMLAD(x2[i], c2[i], (uint32_t)acc);
+    }
+#else
+    for (i = 0U; i < (AD_SRC_TAPS + 2U); i++) {
+        acc += (int32_t)x[i] * coef[i];
+    }
+#endif /* AD_SRC_SIMD */
+
+    return acc;
+}
@@ -40,10 +40,55 @@ OF SUCH DAMAGE.
 
 #define USB_CDC_RX_LEN      USB_CDC_DATA_PACKET_SIZE
 
+/* define USE_USB_CDC_STREAM in usbd_conf.h for the streaming interface cdc_acm_write()/cdc_acm_read(),
+   it adds the rings and the transfer staging buffers below to the class handler */
+#ifdef USE_USB_CDC_STREAM
+/* bytes moved by one bulk transfer of the streaming interface, a multiple of the packet size */
+#ifndef USB_CDC_XFER_LEN
+    #define USB_CDC_XFER_LEN            (4U * USB_CDC_DATA_PACKET_SIZE)
+#endif /* USB_CDC_XFER_LEN */
+
+/* ring buffer sizes of the streaming interface, powers of two */
+#ifndef USB_CDC_TX_RING_SIZE
+    #define USB_CDC_TX_RING_SIZE        (4U * USB_CDC_XFER_LEN)
+#endif /* USB_CDC_TX_RING_SIZE */
+
+#ifndef USB_CDC_RX_RING_SIZE
+    #define USB_CDC_RX_RING_SIZE        (4U * USB_CDC_XFER_LEN)
+#endif /* USB_CDC_RX_RING_SIZE */
+
+#if ((USB_CDC_TX_RING_SIZE & (USB_CDC_TX_RING_SIZE - 1U)) || (USB_CDC_RX_RING_SIZE & (USB_CDC_RX_RING_SIZE - 1U)))
+    #error "the CDC ring sizes must be powers of two"
+#endif
+
+#if (USB_CDC_RX_RING_SIZE < USB_CDC_XFER_LEN)
+    #error "the CDC Rx ring must hold one transfer"
+#endif
+
+#endif /* USE_USB_CDC_STREAM */
+
 typedef struct {
     uint8_t data[USB_CDC_RX_LEN];
     uint8_t cmd[USB_CDC_CMD_PACKET_SIZE];
 
+#ifdef USE_USB_CDC_STREAM
+    /* staging buffers of the bulk transfers, the DMA of the USBHS core moves whole words */
+    __ALIGN_BEGIN uint8_t tx_xfer[USB_CDC_XFER_LEN] __ALIGN_END;
+    __ALIGN_BEGIN uint8_t rx_xfer[USB_CDC_XFER_LEN] __ALIGN_END;
+    uint8_t tx_ring[USB_CDC_TX_RING_SIZE];
+    uint8_t rx_ring[USB_CDC_RX_RING_SIZE];
+
+    /* free running ring indexes, each one is written by a single side */
+    volatile uint32_t tx_in;
+    volatile uint32_t tx_out;
+    volatile uint32_t rx_in;
+    volatile uint32_t rx_out;
+
+    uint8_t stream;
+    volatile uint8_t tx_busy;
+    volatile uint8_t rx_armed;
+#endif /* USE_USB_CDC_STREAM */
+
     uint8_t packet_sent;
     uint8_t packet_receive;
     uint32_t receive_length;
@@ -61,5 +106,11 @@ uint8_t cdc_acm_check_ready(usb_dev *udev);
 void cdc_acm_data_send(usb_dev *udev);
 /* receive CDC ACM data */
 void cdc_acm_data_receive(usb_dev *udev);
+#ifdef USE_USB_CDC_STREAM
+/* queue data for the host, returns the number of bytes accepted */
+uint32_t cdc_acm_write(usb_dev *udev, const uint8_t *buf, uint32_t len);
+/* fetch data received from the host, returns the number of bytes copied */
+uint32_t cdc_acm_read(usb_dev *udev, uint8_t *buf, uint32_t len);
+#endif /* USE_USB_CDC_STREAM */
 
 #endif /* __CDC_ACM_CORE_H */
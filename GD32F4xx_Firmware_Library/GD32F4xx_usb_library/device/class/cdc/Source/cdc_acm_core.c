@@ -32,6 +32,7 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 OF SUCH DAMAGE.
 */
 
+#include <string.h>
 #include "cdc_acm_core.h"
 
 #define USBD_VID                          0x28E9U
@@ -262,6 +263,13 @@ static uint8_t cdc_acm_req      (usb_dev *udev, usb_req *req);
 static uint8_t cdc_acm_ctlx_out (usb_dev *udev);
 static uint8_t cdc_acm_in       (usb_dev *udev, uint8_t ep_num);
 static uint8_t cdc_acm_out      (usb_dev *udev, uint8_t ep_num);
+#ifdef USE_USB_CDC_STREAM
+static void cdc_acm_stream_open (usb_dev *udev, usb_cdc_handler *cdc);
+static void cdc_acm_tx_start    (usb_dev *udev, usb_cdc_handler *cdc);
+static void cdc_acm_rx_start    (usb_dev *udev, usb_cdc_handler *cdc);
+static void cdc_acm_ring_put    (uint8_t *ring, uint32_t size, uint32_t index, const uint8_t *buf, uint32_t len);
+static void cdc_acm_ring_get    (const uint8_t *ring, uint32_t size, uint32_t index, uint8_t *buf, uint32_t len);
+#endif /* USE_USB_CDC_STREAM */
 
 /* USB CDC device class callbacks structure */
 usb_class_core cdc_class =
@@ -331,6 +339,89 @@ void cdc_acm_data_receive (usb_dev *udev)
     usbd_ep_recev (udev, CDC_DATA_OUT_EP, (uint8_t*)(cdc->data), USB_CDC_DATA_PACKET_SIZE);
 }
 
+#ifdef USE_USB_CDC_STREAM
+
+/*!
+    \brief      queue data for the host, the first call switches the class to the streaming
+                interface which must not be mixed with cdc_acm_data_send()/cdc_acm_data_receive()
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  buf: data to send
+    \param[in]  len: data length in bytes
+    \param[out] none
+    \retval     number of bytes accepted, less than len when the Tx ring is full
+*/
+uint32_t cdc_acm_write (usb_dev *udev, const uint8_t *buf, uint32_t len)
+{
+    usb_cdc_handler *cdc = (usb_cdc_handler *)udev->dev.class_data[CDC_COM_INTERFACE];
+
+    if ((NULL == cdc) || ((uint8_t)USBD_CONFIGURED != udev->dev.cur_status)) {
+        return 0U;
+    }
+
+    if (0U == cdc->stream) {
+        cdc_acm_stream_open (udev, cdc);
+    }
+
+    len = USB_MIN(len, USB_CDC_TX_RING_SIZE - (cdc->tx_in - cdc->tx_out));
+
+    cdc_acm_ring_put (cdc->tx_ring, USB_CDC_TX_RING_SIZE, cdc->tx_in, buf, len);
+
+    cdc->tx_in += len;
+
+    /* the IN completion restarts the transfer while it is busy */
+    usb_globalint_disable (&udev->regs);
+
+    if ((0U == cdc->tx_busy) && (cdc->tx_in != cdc->tx_out)) {
+        cdc_acm_tx_start (udev, cdc);
+    }
+
+    usb_globalint_enable (&udev->regs);
+
+    return len;
+}
+
+/*!
+    \brief      fetch data received from the host, the first call switches the class to the streaming
+                interface which must not be mixed with cdc_acm_data_send()/cdc_acm_data_receive()
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  len: size of the buffer in bytes
+    \param[out] buf: received data
+    \retval     number of bytes copied
+*/
+uint32_t cdc_acm_read (usb_dev *udev, uint8_t *buf, uint32_t len)
+{
+    usb_cdc_handler *cdc = (usb_cdc_handler *)udev->dev.class_data[CDC_COM_INTERFACE];
+
+    if ((NULL == cdc) || ((uint8_t)USBD_CONFIGURED != udev->dev.cur_status)) {
+        return 0U;
+    }
+
+    if (0U == cdc->stream) {
+        cdc_acm_stream_open (udev, cdc);
+    }
+
+    len = USB_MIN(len, cdc->rx_in - cdc->rx_out);
+
+    cdc_acm_ring_get (cdc->rx_ring, USB_CDC_RX_RING_SIZE, cdc->rx_out, buf, len);
+
+    cdc->rx_out += len;
+
+    /* the OUT endpoint is left NAKing while the ring can not take a whole transfer */
+    if (0U == cdc->rx_armed) {
+        usb_globalint_disable (&udev->regs);
+
+        if ((0U == cdc->rx_armed) && ((USB_CDC_RX_RING_SIZE - (cdc->rx_in - cdc->rx_out)) >= USB_CDC_XFER_LEN)) {
+            cdc_acm_rx_start (udev, cdc);
+        }
+
+        usb_globalint_enable (&udev->regs);
+    }
+
+    return len;
+}
+
+#endif /* USE_USB_CDC_STREAM */
+
 /*!
     \brief      initialize the CDC ACM device
     \param[in]  udev: pointer to USB device instance
@@ -356,6 +447,16 @@ static uint8_t cdc_acm_init (usb_dev *udev, uint8_t config_index)
     cdc_handler.packet_sent = 1U;
     cdc_handler.receive_length = 0U;
 
+#ifdef USE_USB_CDC_STREAM
+    cdc_handler.tx_in = 0U;
+    cdc_handler.tx_out = 0U;
+    cdc_handler.rx_in = 0U;
+    cdc_handler.rx_out = 0U;
+    cdc_handler.stream = 0U;
+    cdc_handler.tx_busy = 0U;
+    cdc_handler.rx_armed = 0U;
+#endif /* USE_USB_CDC_STREAM */
+
     cdc_handler.line_coding = (acm_line){
         .dwDTERate   = 115200U,
         .bCharFormat = 0U,
@@ -502,10 +603,22 @@ static uint8_t cdc_acm_in (usb_dev *udev, uint8_t ep_num)
 
     usb_cdc_handler *cdc = (usb_cdc_handler *)udev->dev.class_data[CDC_COM_INTERFACE];
 
+#ifdef USE_USB_CDC_STREAM
+    if ((0U != cdc->stream) && (cdc->tx_in != cdc->tx_out)) {
+        /* more data queued, no need to terminate the transfer */
+        cdc_acm_tx_start (udev, cdc);
+
+        return USBD_OK;
+    }
+#endif /* USE_USB_CDC_STREAM */
+
     if ((0U == transc->xfer_len % transc->max_len) && (0U != transc->xfer_len)) {
         usbd_ep_send (udev, ep_num, NULL, 0U);
     } else {
         cdc->packet_sent = 1U;
+#ifdef USE_USB_CDC_STREAM
+        cdc->tx_busy = 0U;
+#endif /* USE_USB_CDC_STREAM */
     }
 
     return USBD_OK;
@@ -522,8 +635,121 @@ static uint8_t cdc_acm_out (usb_dev *udev, uint8_t ep_num)
 {
     usb_cdc_handler *cdc = (usb_cdc_handler *)udev->dev.class_data[CDC_COM_INTERFACE];
 
+    uint32_t len = ((usb_core_driver *)udev)->dev.transc_out[ep_num].xfer_count;
+
+#ifdef USE_USB_CDC_STREAM
+    if (0U != cdc->stream) {
+        /* the endpoint was armed with room for a whole transfer */
+        cdc_acm_ring_put (cdc->rx_ring, USB_CDC_RX_RING_SIZE, cdc->rx_in, cdc->rx_xfer, len);
+
+        cdc->rx_in += len;
+
+        if ((USB_CDC_RX_RING_SIZE - (cdc->rx_in - cdc->rx_out)) >= USB_CDC_XFER_LEN) {
+            cdc_acm_rx_start (udev, cdc);
+        } else {
+            cdc->rx_armed = 0U;
+        }
+
+        return USBD_OK;
+    }
+#endif /* USE_USB_CDC_STREAM */
+
     cdc->packet_receive = 1U;
-    cdc->receive_length = ((usb_core_driver *)udev)->dev.transc_out[ep_num].xfer_count;
+    cdc->receive_length = len;
 
     return USBD_OK;
 }
+
+#ifdef USE_USB_CDC_STREAM
+
+/*!
+    \brief      switch the class to the streaming interface and start receiving
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  cdc: pointer to CDC handler
+    \param[out] none
+    \retval     none
+*/
+static void cdc_acm_stream_open (usb_dev *udev, usb_cdc_handler *cdc)
+{
+    cdc->stream = 1U;
+
+    usb_globalint_disable (&udev->regs);
+
+    cdc_acm_rx_start (udev, cdc);
+
+    usb_globalint_enable (&udev->regs);
+}
+
+/*!
+    \brief      move the queued data, up to one transfer, to the IN endpoint
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  cdc: pointer to CDC handler
+    \param[out] none
+    \retval     none
+*/
+static void cdc_acm_tx_start (usb_dev *udev, usb_cdc_handler *cdc)
+{
+    uint32_t len = USB_MIN(cdc->tx_in - cdc->tx_out, USB_CDC_XFER_LEN);
+
+    cdc_acm_ring_get (cdc->tx_ring, USB_CDC_TX_RING_SIZE, cdc->tx_out, cdc->tx_xfer, len);
+
+    cdc->tx_out += len;
+    cdc->tx_busy = 1U;
+    cdc->packet_sent = 0U;
+
+    usbd_ep_send (udev, CDC_DATA_IN_EP, cdc->tx_xfer, len);
+}
+
+/*!
+    \brief      arm the OUT endpoint for one transfer
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  cdc: pointer to CDC handler
+    \param[out] none
+    \retval     none
+*/
+static void cdc_acm_rx_start (usb_dev *udev, usb_cdc_handler *cdc)
+{
+    cdc->rx_armed = 1U;
+    cdc->packet_receive = 0U;
+
+    usbd_ep_recev (udev, CDC_DATA_OUT_EP, cdc->rx_xfer, USB_CDC_XFER_LEN);
+}
+
+/*!
+    \brief      copy data into a ring buffer
+    \param[in]  ring: ring buffer
+    \param[in]  size: ring size, a power of two
+    \param[in]  index: free running write index
+    \param[in]  buf: data to copy
+    \param[in]  len: data length, no more than the free space
+    \param[out] none
+    \retval     none
+*/
+static void cdc_acm_ring_put (uint8_t *ring, uint32_t size, uint32_t index, const uint8_t *buf, uint32_t len)
+{
+    uint32_t offset = index & (size - 1U);
+    uint32_t first = USB_MIN(len, size - offset);
+
+    memcpy (&ring[offset], buf, first);
+    memcpy (ring, &buf[first], len - first);
+}
+
+/*!
+    \brief      copy data out of a ring buffer
+    \param[in]  ring: ring buffer
+    \param[in]  size: ring size, a power of two
+    \param[in]  index: free running read index
+    \param[in]  len: data length, no more than the used space
+    \param[out] buf: copied data
+    \retval     none
+*/
+static void cdc_acm_ring_get (const uint8_t *ring, uint32_t size, uint32_t index, uint8_t *buf, uint32_t len)
+{
+    uint32_t offset = index & (size - 1U);
+    uint32_t first = USB_MIN(len, size - offset);
+
+    memcpy (buf, &ring[offset], first);
+    memcpy (&buf[first], ring, len - first);
+}
+
+#endif /* USE_USB_CDC_STREAM */
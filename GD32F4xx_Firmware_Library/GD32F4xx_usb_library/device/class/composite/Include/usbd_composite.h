@@ -0,0 +1,78 @@
+/*!
+    \file    usbd_composite.h
+    \brief   the header file of the composite device driver
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+#ifndef __USBD_COMPOSITE_H
+#define __USBD_COMPOSITE_H
+
+#include "usbd_enum.h"
+
+/* maximum number of functions in the composite device */
+#ifndef USBD_COMP_FUNC_MAX
+    #define USBD_COMP_FUNC_MAX              4U
+#endif /* USBD_COMP_FUNC_MAX */
+
+/* size of the configuration descriptor buffer */
+#ifndef USBD_COMP_CONFIG_DESC_MAX
+    #define USBD_COMP_CONFIG_DESC_MAX       256U
+#endif /* USBD_COMP_CONFIG_DESC_MAX */
+
+#ifndef NO_CMD
+    #define NO_CMD                          0xFFU
+#endif /* NO_CMD */
+
+typedef struct {
+    usb_class_core *class_core;                     /*!< class driver of the function */
+    const uint8_t *config_desc;                     /*!< configuration descriptor of the class driver */
+
+    uint8_t itf;                                    /*!< first interface */
+    uint8_t itf_num;                                /*!< number of interfaces */
+} usbd_comp_func;
+
+typedef struct {
+    uint16_t rx_size;                               /*!< Rx FIFO size in words */
+    uint16_t tx_size[USBFS_MAX_TX_FIFOS];           /*!< Tx FIFO sizes in words */
+} usbd_comp_fifo;
+
+extern usb_class_core usbd_comp_class;
+
+/* function declarations */
+/* add a function to the composite device */
+uint8_t usbd_comp_add (usb_class_core *class_core, const usb_desc *desc);
+/* build the configuration descriptor and the FIFO layout of the composite device */
+uint8_t usbd_comp_build (usb_desc *desc, usb_core_enum core);
+/* get the FIFO layout computed by usbd_comp_build() */
+const usbd_comp_fifo *usbd_comp_fifo_get (void);
+
+#endif /* __USBD_COMPOSITE_H */
@@ -0,0 +1,120 @@
+/*!
+    \file    usbd_composite_conf.h
+    \brief   interface and endpoint assignment of the composite device
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+#ifndef __USBD_COMPOSITE_CONF_H
+#define __USBD_COMPOSITE_CONF_H
+
+/* 
+    include this file at the end of usbd_conf.h after defining the functions of the device:
+    USBD_COMPOSITE_MSC, USBD_COMPOSITE_CDC and USBD_COMPOSITE_HID (standard or custom HID).
+    the functions get their endpoints in this order, IN and OUT endpoint numbers are
+    allocated separately. the interface numbers only select the class data of each driver,
+    the numbers seen by the host are assigned by usbd_comp_build()
+*/
+
+#ifdef USBD_COMPOSITE_MSC
+    #define USBD_COMP_MSC_ITF_NUM       1U
+    #define USBD_COMP_MSC_IN_NUM        1U
+    #define USBD_COMP_MSC_OUT_NUM       1U
+#else
+    #define USBD_COMP_MSC_ITF_NUM       0U
+    #define USBD_COMP_MSC_IN_NUM        0U
+    #define USBD_COMP_MSC_OUT_NUM       0U
+#endif /* USBD_COMPOSITE_MSC */
+
+#ifdef USBD_COMPOSITE_CDC
+    #define USBD_COMP_CDC_ITF_NUM       2U
+    #define USBD_COMP_CDC_IN_NUM        2U
+    #define USBD_COMP_CDC_OUT_NUM       1U
+#else
+    #define USBD_COMP_CDC_ITF_NUM       0U
+    #define USBD_COMP_CDC_IN_NUM        0U
+    #define USBD_COMP_CDC_OUT_NUM       0U
+#endif /* USBD_COMPOSITE_CDC */
+
+#ifdef USBD_COMPOSITE_HID
+    #define USBD_COMP_HID_ITF_NUM       1U
+    #define USBD_COMP_HID_IN_NUM        1U
+    #define USBD_COMP_HID_OUT_NUM       1U
+#else
+    #define USBD_COMP_HID_ITF_NUM       0U
+    #define USBD_COMP_HID_IN_NUM        0U
+    #define USBD_COMP_HID_OUT_NUM       0U
+#endif /* USBD_COMPOSITE_HID */
+
+/* first interface and endpoint numbers of each function */
+#define USBD_COMP_MSC_ITF               0U
+#define USBD_COMP_CDC_ITF               (USBD_COMP_MSC_ITF + USBD_COMP_MSC_ITF_NUM)
+#define USBD_COMP_HID_ITF               (USBD_COMP_CDC_ITF + USBD_COMP_CDC_ITF_NUM)
+
+#define USBD_COMP_MSC_IN                1U
+#define USBD_COMP_CDC_IN                (USBD_COMP_MSC_IN + USBD_COMP_MSC_IN_NUM)
+#define USBD_COMP_HID_IN                (USBD_COMP_CDC_IN + USBD_COMP_CDC_IN_NUM)
+#define USBD_COMP_EP_IN_NUM             (USBD_COMP_HID_IN + USBD_COMP_HID_IN_NUM - 1U)
+
+#define USBD_COMP_MSC_OUT               1U
+#define USBD_COMP_CDC_OUT               (USBD_COMP_MSC_OUT + USBD_COMP_MSC_OUT_NUM)
+#define USBD_COMP_HID_OUT               (USBD_COMP_CDC_OUT + USBD_COMP_CDC_OUT_NUM)
+#define USBD_COMP_EP_OUT_NUM            (USBD_COMP_HID_OUT + USBD_COMP_HID_OUT_NUM - 1U)
+
+#ifdef USE_USB_FS
+    #if (USBD_COMP_EP_IN_NUM > 3U) || (USBD_COMP_EP_OUT_NUM > 3U)
+        #error "the functions need more endpoints than the USBFS core has, use the USBHS core"
+    #endif
+#else
+    #if (USBD_COMP_EP_IN_NUM > 5U) || (USBD_COMP_EP_OUT_NUM > 5U)
+        #error "the functions need more endpoints than the USBHS core has"
+    #endif
+#endif /* USE_USB_FS */
+
+#define USBD_ITF_MAX_NUM                (USBD_COMP_HID_ITF + USBD_COMP_HID_ITF_NUM)
+
+/* interfaces and endpoints of the class drivers */
+#define USBD_MSC_INTERFACE              USBD_COMP_MSC_ITF
+#define MSC_IN_EP                       (0x80U | USBD_COMP_MSC_IN)
+#define MSC_OUT_EP                      USBD_COMP_MSC_OUT
+
+#define CDC_COM_INTERFACE               USBD_COMP_CDC_ITF
+#define CDC_DATA_IN_EP                  (0x80U | USBD_COMP_CDC_IN)
+#define CDC_CMD_EP                      (0x80U | (USBD_COMP_CDC_IN + 1U))
+#define CDC_DATA_OUT_EP                 USBD_COMP_CDC_OUT
+
+#define USBD_HID_INTERFACE              USBD_COMP_HID_ITF
+#define CUSTOM_HID_INTERFACE            USBD_COMP_HID_ITF
+#define HID_IN_EP                       (0x80U | USBD_COMP_HID_IN)
+#define CUSTOMHID_IN_EP                 (0x80U | USBD_COMP_HID_IN)
+#define CUSTOMHID_OUT_EP                USBD_COMP_HID_OUT
+
+#endif /* __USBD_COMPOSITE_CONF_H */
@@ -0,0 +1,683 @@
+/*!
+    \file    usbd_composite.c
+    \brief   composite device driver, runs several class drivers in one configuration
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+#include "usbd_composite.h"
+
+#define USB_DESCTYPE_CS_ITF             0x24U       /* class-specific interface descriptor */
+#define CDC_CALL_MANAGEMENT             0x01U       /* call management functional descriptor */
+#define CDC_UNION                       0x06U       /* union functional descriptor */
+
+#define COMP_FUNC_NONE                  0xFFU
+#define COMP_EP0_FIFO_SIZE              16U         /* 64 bytes of control endpoint */
+#define COMP_FIFO_MIN                   16U         /* smallest Tx FIFO in words */
+
+/* local function prototypes ('static') */
+static uint8_t comp_init                (usb_dev *udev, uint8_t config_index);
+static uint8_t comp_deinit              (usb_dev *udev, uint8_t config_index);
+static uint8_t comp_req                 (usb_dev *udev, usb_req *req);
+static uint8_t comp_set_intf            (usb_dev *udev, usb_req *req);
+static uint8_t comp_ctlx_in             (usb_dev *udev);
+static uint8_t comp_ctlx_out            (usb_dev *udev);
+static uint8_t comp_data_in             (usb_dev *udev, uint8_t ep_num);
+static uint8_t comp_data_out            (usb_dev *udev, uint8_t ep_num);
+static uint8_t comp_sof                 (usb_dev *udev);
+static uint8_t comp_incomplete_isoc_in  (usb_dev *udev);
+static uint8_t comp_incomplete_isoc_out (usb_dev *udev);
+static uint8_t comp_itf_func            (uint8_t itf);
+static uint8_t comp_fifo_layout         (usb_core_enum core);
+#if defined(USE_USB_HS) && defined(USE_ULPI_PHY)
+static void    comp_other_speed_build   (usb_desc *desc, uint16_t len);
+#endif /* USE_USB_HS && USE_ULPI_PHY */
+
+/* USB composite device class callbacks structure */
+usb_class_core usbd_comp_class =
+{
+    .command             = NO_CMD,
+    .alter_set           = 0U,
+
+    .init                = comp_init,
+    .deinit              = comp_deinit,
+    .req_proc            = comp_req,
+    .set_intf            = comp_set_intf,
+    .ctlx_in             = comp_ctlx_in,
+    .ctlx_out            = comp_ctlx_out,
+    .data_in             = comp_data_in,
+    .data_out            = comp_data_out,
+    .SOF                 = comp_sof,
+    .incomplete_isoc_in  = comp_incomplete_isoc_in,
+    .incomplete_isoc_out = comp_incomplete_isoc_out
+};
+
+static usbd_comp_func comp_func[USBD_COMP_FUNC_MAX];
+static uint8_t comp_func_num = 0U;
+
+/* function owning each endpoint and the one handling the current control transfer */
+static uint8_t comp_in_owner[USBFS_MAX_TX_FIFOS];
+static uint8_t comp_out_owner[USBFS_MAX_TX_FIFOS];
+static uint8_t comp_ctl_func = COMP_FUNC_NONE;
+
+/* endpoint needs gathered from the descriptors for the FIFO layout */
+static uint16_t comp_in_mps[USBFS_MAX_TX_FIFOS];
+static uint8_t comp_in_type[USBFS_MAX_TX_FIFOS];
+static uint16_t comp_out_mps_max;
+static uint32_t comp_out_weight;
+static uint8_t comp_out_num;
+
+static usbd_comp_fifo comp_fifo;
+
+__ALIGN_BEGIN static uint8_t comp_config_desc[USBD_COMP_CONFIG_DESC_MAX] __ALIGN_END;
+
+#if defined(USE_USB_HS) && defined(USE_ULPI_PHY)
+/* full speed view of the configuration for a high speed device */
+__ALIGN_BEGIN static uint8_t comp_other_speed_desc[USBD_COMP_CONFIG_DESC_MAX] __ALIGN_END;
+__ALIGN_BEGIN static uint8_t comp_qualifier_desc[USB_DEV_QUALIFIER_DESC_LEN] __ALIGN_END;
+#endif /* USE_USB_HS && USE_ULPI_PHY */
+
+/*!
+    \brief      add a function to the composite device, interfaces are numbered in the order of addition
+    \param[in]  class_core: class driver of the function
+    \param[in]  desc: descriptors of the class driver, only the configuration descriptor is used
+    \param[out] none
+    \retval     USB device operation status
+*/
+uint8_t usbd_comp_add (usb_class_core *class_core, const usb_desc *desc)
+{
+    if (comp_func_num >= USBD_COMP_FUNC_MAX) {
+        return (uint8_t)USBD_FAIL;
+    }
+
+    comp_func[comp_func_num].class_core = class_core;
+    comp_func[comp_func_num].config_desc = desc->config_desc;
+    comp_func_num++;
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      build the configuration descriptor and the FIFO layout of the composite device,
+                call it before usbd_init(); for the USBHS core with an ULPI PHY the other speed
+                configuration and the device qualifier descriptors are built as well
+    \param[in]  desc: descriptors of the composite device, the configuration descriptor is replaced
+    \param[in]  core: USB core
+      \arg        USB_CORE_ENUM_HS: USB HS core
+      \arg        USB_CORE_ENUM_FS: USB FS core
+    \param[out] none
+    \retval     USB device operation status
+*/
+uint8_t usbd_comp_build (usb_desc *desc, usb_core_enum core)
+{
+    uint8_t i, itf = 0U;
+    uint16_t len = USB_CFG_DESC_LEN;
+    uint8_t ep_count = (USB_CORE_ENUM_FS == core) ? USBFS_MAX_EP_COUNT : USBHS_MAX_EP_COUNT;
+
+    for (i = 0U; i < USBFS_MAX_TX_FIFOS; i++) {
+        comp_in_owner[i] = COMP_FUNC_NONE;
+        comp_out_owner[i] = COMP_FUNC_NONE;
+        comp_in_mps[i] = 0U;
+        comp_in_type[i] = 0U;
+    }
+
+    comp_out_mps_max = 0U;
+    comp_out_weight = 0U;
+    comp_out_num = 0U;
+
+    for (i = 0U; i < comp_func_num; i++) {
+        usbd_comp_func *func = &comp_func[i];
+        const uint8_t *src = func->config_desc;
+        const uint8_t *first_itf = NULL;
+        uint16_t total = (uint16_t)src[2] | ((uint16_t)src[3] << 8U);
+        uint16_t pos;
+
+        func->itf = itf;
+        func->itf_num = 0U;
+
+        for (pos = src[0]; pos < total; pos += src[pos]) {
+            if ((src[pos] < 2U) || ((pos + src[pos]) > total)) {
+                return (uint8_t)USBD_FAIL;
+            }
+
+            if ((USB_DESCTYPE_ITF == src[pos + 1U]) && (0U == src[pos + 3U])) {
+                if (NULL == first_itf) {
+                    first_itf = &src[pos];
+                }
+
+                func->itf_num++;
+            }
+        }
+
+        if ((NULL == first_itf) || ((len + total + USB_IAD_DESC_LEN) > USBD_COMP_CONFIG_DESC_MAX)) {
+            return (uint8_t)USBD_FAIL;
+        }
+
+        /* functions with several interfaces are grouped by an interface association */
+        if (func->itf_num > 1U) {
+            comp_config_desc[len] = USB_IAD_DESC_LEN;
+            comp_config_desc[len + 1U] = USB_DESCTYPE_IAD;
+            comp_config_desc[len + 2U] = func->itf;
+            comp_config_desc[len + 3U] = func->itf_num;
+            comp_config_desc[len + 4U] = first_itf[5];
+            comp_config_desc[len + 5U] = first_itf[6];
+            comp_config_desc[len + 6U] = first_itf[7];
+            comp_config_desc[len + 7U] = 0U;
+
+            len += USB_IAD_DESC_LEN;
+        }
+
+        for (pos = src[0]; pos < total; pos += src[pos]) {
+            uint8_t *dst = &comp_config_desc[len];
+            uint8_t k, n;
+            uint16_t mps;
+
+            for (k = 0U; k < src[pos]; k++) {
+                dst[k] = src[pos + k];
+            }
+
+            len += src[pos];
+
+            switch (dst[1]) {
+            case USB_DESCTYPE_ITF:
+                dst[2] += func->itf;
+                break;
+
+            case USB_DESCTYPE_CS_ITF:
+                if ((CDC_CALL_MANAGEMENT == dst[2]) && (dst[0] >= 5U)) {
+                    dst[4] += func->itf;
+                } else if (CDC_UNION == dst[2]) {
+                    for (k = 3U; k < dst[0]; k++) {
+                        dst[k] += func->itf;
+                    }
+                } else {
+                    /* no interface numbers */
+                }
+                break;
+
+            case USB_DESCTYPE_EP:
+                n = dst[2] & 0x0FU;
+                mps = ((uint16_t)dst[4] | ((uint16_t)dst[5] << 8U)) & 0x07FFU;
+
+                if ((0U == n) || (n >= ep_count)) {
+                    return (uint8_t)USBD_FAIL;
+                }
+
+                if (dst[2] & 0x80U) {
+                    if (COMP_FUNC_NONE != comp_in_owner[n]) {
+                        return (uint8_t)USBD_FAIL;
+                    }
+
+                    comp_in_owner[n] = i;
+                    comp_in_mps[n] = mps;
+                    comp_in_type[n] = dst[3] & (uint8_t)USB_EPTYPE_MASK;
+                } else {
+                    if (COMP_FUNC_NONE != comp_out_owner[n]) {
+                        return (uint8_t)USBD_FAIL;
+                    }
+
+                    comp_out_owner[n] = i;
+                    comp_out_mps_max = USB_MAX(comp_out_mps_max, mps);
+                    comp_out_num++;
+
+                    if ((uint8_t)USB_EPTYPE_INTR != (dst[3] & (uint8_t)USB_EPTYPE_MASK)) {
+                        comp_out_weight += mps;
+                    }
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        itf += func->itf_num;
+    }
+
+    if ((0U == comp_func_num) || (itf > USBD_ITF_MAX_NUM)) {
+        return (uint8_t)USBD_FAIL;
+    }
+
+    /* configuration header, attributes and power from the first function */
+    comp_config_desc[0] = USB_CFG_DESC_LEN;
+    comp_config_desc[1] = USB_DESCTYPE_CONFIG;
+    comp_config_desc[2] = (uint8_t)len;
+    comp_config_desc[3] = (uint8_t)(len >> 8U);
+    comp_config_desc[4] = itf;
+    comp_config_desc[5] = 0x01U;
+    comp_config_desc[6] = 0x00U;
+    comp_config_desc[7] = comp_func[0].config_desc[7];
+    comp_config_desc[8] = comp_func[0].config_desc[8];
+
+    if ((uint8_t)USBD_OK != comp_fifo_layout (core)) {
+        return (uint8_t)USBD_FAIL;
+    }
+
+    usb_devfifo_set (core, comp_fifo.rx_size, comp_fifo.tx_size);
+
+    desc->config_desc = comp_config_desc;
+
+#if defined(USE_USB_HS) && defined(USE_ULPI_PHY)
+    if (USB_CORE_ENUM_HS == core) {
+        comp_other_speed_build (desc, len);
+    }
+#endif /* USE_USB_HS && USE_ULPI_PHY */
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      get the FIFO layout computed by usbd_comp_build()
+    \param[in]  none
+    \param[out] none
+    \retval     FIFO sizes in words
+*/
+const usbd_comp_fifo *usbd_comp_fifo_get (void)
+{
+    return &comp_fifo;
+}
+
+/*!
+    \brief      size the FIFOs, every endpoint gets its minimum and the rest of the FIFO RAM
+                is shared by the bulk and isochronous IN endpoints and the Rx FIFO in
+                proportion to their packet sizes
+    \param[in]  core: USB core
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_fifo_layout (usb_core_enum core)
+{
+    uint8_t n;
+    uint32_t pkt, extra, spare, used, given = 0U, weight = comp_out_weight;
+    uint32_t total = (USB_CORE_ENUM_FS == core) ? USBFS_MAX_FIFO_WORDLEN : USBHS_MAX_FIFO_WORDLEN;
+
+    /* Rx FIFO: SETUP packets, two of the largest packets and the status words of the OUT endpoints */
+    pkt = (uint32_t)USB_MAX(comp_out_mps_max, 64U) / 4U;
+    comp_fifo.rx_size = (uint16_t)(13U + (2U * (pkt + 1U)) + (2U * comp_out_num) + 1U);
+    comp_fifo.tx_size[0] = COMP_EP0_FIFO_SIZE;
+
+    used = comp_fifo.rx_size + comp_fifo.tx_size[0];
+
+    for (n = 1U; n < USBFS_MAX_TX_FIFOS; n++) {
+        comp_fifo.tx_size[n] = 0U;
+
+        if (0U != comp_in_mps[n]) {
+            pkt = ((uint32_t)comp_in_mps[n] + 3U) / 4U;
+            comp_fifo.tx_size[n] = (uint16_t)USB_MAX(pkt, COMP_FIFO_MIN);
+            used += comp_fifo.tx_size[n];
+
+            if ((uint8_t)USB_EPTYPE_INTR != comp_in_type[n]) {
+                weight += comp_in_mps[n];
+            }
+        }
+    }
+
+    if (used > total) {
+        return (uint8_t)USBD_FAIL;
+    }
+
+    spare = total - used;
+
+    if (0U != weight) {
+        for (n = 1U; n < USBFS_MAX_TX_FIFOS; n++) {
+            if ((0U != comp_in_mps[n]) && ((uint8_t)USB_EPTYPE_INTR != comp_in_type[n])) {
+                /* whole packets only, a partial one can not be written */
+                pkt = ((uint32_t)comp_in_mps[n] + 3U) / 4U;
+                extra = (spare * comp_in_mps[n]) / weight;
+                extra -= extra % pkt;
+
+                comp_fifo.tx_size[n] += (uint16_t)extra;
+                given += extra;
+            }
+        }
+    }
+
+    /* the share of the OUT endpoints and the rounding leftovers */
+    comp_fifo.rx_size += (uint16_t)(spare - given);
+
+    return (uint8_t)USBD_OK;
+}
+
+#if defined(USE_USB_HS) && defined(USE_ULPI_PHY)
+
+/*!
+    \brief      build the full speed configuration and the device qualifier of a high speed device,
+                endpoints keep their numbers, packet sizes are limited to the full speed maximums
+                and the polling intervals are converted from microframes to frames
+    \param[in]  desc: descriptors of the composite device
+    \param[in]  len: length of the configuration descriptor
+    \param[out] none
+    \retval     none
+*/
+static void comp_other_speed_build (usb_desc *desc, uint16_t len)
+{
+    uint16_t pos, mps;
+    uint8_t *ep;
+
+    for (pos = 0U; pos < len; pos++) {
+        comp_other_speed_desc[pos] = comp_config_desc[pos];
+    }
+
+    comp_other_speed_desc[1] = USB_DESCTYPE_OTHER_SPD_CONFIG;
+
+    for (pos = 0U; pos < len; pos += comp_other_speed_desc[pos]) {
+        ep = &comp_other_speed_desc[pos];
+
+        if (USB_DESCTYPE_EP != ep[1]) {
+            continue;
+        }
+
+        /* the additional transactions per microframe do not exist at full speed */
+        mps = ((uint16_t)ep[4] | ((uint16_t)ep[5] << 8U)) & 0x07FFU;
+
+        switch (ep[3] & (uint8_t)USB_EPTYPE_MASK) {
+        case USB_EPTYPE_BULK:
+            mps = 64U;
+            ep[6] = 0U;
+            break;
+
+        case USB_EPTYPE_INTR:
+            mps = USB_MIN(mps, 64U);
+
+            /* 2^(bInterval - 1) microframes become a number of frames */
+            ep[6] = (ep[6] > 11U) ? 255U : ((ep[6] > 4U) ? (uint8_t)(1U << (ep[6] - 4U)) : 1U);
+            break;
+
+        case USB_EPTYPE_ISOC:
+            mps = USB_MIN(mps, 1023U);
+
+            /* the interval exponent counts frames instead of microframes */
+            ep[6] = (ep[6] > 4U) ? (uint8_t)(ep[6] - 3U) : 1U;
+            break;
+
+        default:
+            break;
+        }
+
+        ep[4] = (uint8_t)mps;
+        ep[5] = (uint8_t)(mps >> 8U);
+    }
+
+    /* the device qualifier repeats the device descriptor fields that do not depend on speed */
+    comp_qualifier_desc[0] = USB_DEV_QUALIFIER_DESC_LEN;
+    comp_qualifier_desc[1] = USB_DESCTYPE_DEV_QUALIFIER;
+    comp_qualifier_desc[2] = desc->dev_desc[2];
+    comp_qualifier_desc[3] = desc->dev_desc[3];
+    comp_qualifier_desc[4] = desc->dev_desc[4];
+    comp_qualifier_desc[5] = desc->dev_desc[5];
+    comp_qualifier_desc[6] = desc->dev_desc[6];
+    comp_qualifier_desc[7] = desc->dev_desc[7];
+    comp_qualifier_desc[8] = desc->dev_desc[17];
+    comp_qualifier_desc[9] = 0U;
+
+    desc->other_speed_config_desc = comp_other_speed_desc;
+    desc->qualifier_desc = comp_qualifier_desc;
+}
+
+#endif /* USE_USB_HS && USE_ULPI_PHY */
+
+/*!
+    \brief      find the function of an interface
+    \param[in]  itf: interface number
+    \param[out] none
+    \retval     function index, COMP_FUNC_NONE if none
+*/
+static uint8_t comp_itf_func (uint8_t itf)
+{
+    uint8_t i;
+
+    for (i = 0U; i < comp_func_num; i++) {
+        if ((itf >= comp_func[i].itf) && (itf < (comp_func[i].itf + comp_func[i].itf_num))) {
+            return i;
+        }
+    }
+
+    return COMP_FUNC_NONE;
+}
+
+/*!
+    \brief      initialize the functions of the composite device
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  config_index: configuration index
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_init (usb_dev *udev, uint8_t config_index)
+{
+    uint8_t i;
+
+    for (i = 0U; i < comp_func_num; i++) {
+        if ((uint8_t)USBD_OK != comp_func[i].class_core->init (udev, config_index)) {
+            return (uint8_t)USBD_FAIL;
+        }
+    }
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      deinitialize the functions of the composite device
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  config_index: configuration index
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_deinit (usb_dev *udev, uint8_t config_index)
+{
+    uint8_t i;
+
+    for (i = 0U; i < comp_func_num; i++) {
+        (void)comp_func[i].class_core->deinit (udev, config_index);
+    }
+
+    comp_ctl_func = COMP_FUNC_NONE;
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      pass a request to the function owning its interface or endpoint
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  req: device class-specific request
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_req (usb_dev *udev, usb_req *req)
+{
+    uint8_t func = COMP_FUNC_NONE;
+    uint8_t recp = BYTE_LOW(req->wIndex);
+
+    switch (req->bmRequestType & (uint8_t)USB_RECPTYPE_MASK) {
+    case USB_RECPTYPE_ITF:
+        func = comp_itf_func (recp);
+        break;
+
+    case USB_RECPTYPE_EP:
+        if (recp & 0x80U) {
+            func = comp_in_owner[recp & 0x0FU];
+        } else {
+            func = comp_out_owner[recp & 0x0FU];
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (COMP_FUNC_NONE == func) {
+        return (uint8_t)REQ_NOTSUPP;
+    }
+
+    comp_ctl_func = func;
+
+    return comp_func[func].class_core->req_proc (udev, req);
+}
+
+/*!
+    \brief      pass a set interface request to the function owning the interface
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  req: device class request
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_set_intf (usb_dev *udev, usb_req *req)
+{
+    uint8_t func = comp_itf_func (BYTE_LOW(req->wIndex));
+
+    if ((COMP_FUNC_NONE != func) && (NULL != comp_func[func].class_core->set_intf)) {
+        return comp_func[func].class_core->set_intf (udev, req);
+    }
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      pass the control IN stage to the function of the current request
+    \param[in]  udev: pointer to USB device instance
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_ctlx_in (usb_dev *udev)
+{
+    if ((COMP_FUNC_NONE != comp_ctl_func) && (NULL != comp_func[comp_ctl_func].class_core->ctlx_in)) {
+        return comp_func[comp_ctl_func].class_core->ctlx_in (udev);
+    }
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      pass the control OUT data to the function of the current request
+    \param[in]  udev: pointer to USB device instance
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_ctlx_out (usb_dev *udev)
+{
+    if ((COMP_FUNC_NONE != comp_ctl_func) && (NULL != comp_func[comp_ctl_func].class_core->ctlx_out)) {
+        return comp_func[comp_ctl_func].class_core->ctlx_out (udev);
+    }
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      pass the data IN event to the function owning the endpoint
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  ep_num: endpoint identifier
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_data_in (usb_dev *udev, uint8_t ep_num)
+{
+    uint8_t func = comp_in_owner[ep_num & 0x0FU];
+
+    if ((COMP_FUNC_NONE != func) && (NULL != comp_func[func].class_core->data_in)) {
+        return comp_func[func].class_core->data_in (udev, ep_num);
+    }
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      pass the data OUT event to the function owning the endpoint
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  ep_num: endpoint identifier
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_data_out (usb_dev *udev, uint8_t ep_num)
+{
+    uint8_t func = comp_out_owner[ep_num & 0x0FU];
+
+    if ((COMP_FUNC_NONE != func) && (NULL != comp_func[func].class_core->data_out)) {
+        return comp_func[func].class_core->data_out (udev, ep_num);
+    }
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      pass the start of frame to all functions
+    \param[in]  udev: pointer to USB device instance
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_sof (usb_dev *udev)
+{
+    uint8_t i;
+
+    for (i = 0U; i < comp_func_num; i++) {
+        if (NULL != comp_func[i].class_core->SOF) {
+            (void)comp_func[i].class_core->SOF (udev);
+        }
+    }
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      pass the incomplete isochronous IN transfer to all functions
+    \param[in]  udev: pointer to USB device instance
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_incomplete_isoc_in (usb_dev *udev)
+{
+    uint8_t i;
+
+    for (i = 0U; i < comp_func_num; i++) {
+        if (NULL != comp_func[i].class_core->incomplete_isoc_in) {
+            (void)comp_func[i].class_core->incomplete_isoc_in (udev);
+        }
+    }
+
+    return (uint8_t)USBD_OK;
+}
+
+/*!
+    \brief      pass the incomplete isochronous OUT transfer to all functions
+    \param[in]  udev: pointer to USB device instance
+    \param[out] none
+    \retval     USB device operation status
+*/
+static uint8_t comp_incomplete_isoc_out (usb_dev *udev)
+{
+    uint8_t i;
+
+    for (i = 0U; i < comp_func_num; i++) {
+        if (NULL != comp_func[i].class_core->incomplete_isoc_out) {
+            (void)comp_func[i].class_core->incomplete_isoc_out (udev);
+        }
+    }
+
+    return (uint8_t)USBD_OK;
+}
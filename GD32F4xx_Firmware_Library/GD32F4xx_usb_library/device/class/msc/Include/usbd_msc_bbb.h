@@ -40,6 +40,16 @@ OF SUCH DAMAGE.
 #include "usbd_msc_mem.h"
 #include "usbd_msc_scsi.h"
 
+/* number of media packet buffers used by READ10/WRITE10, 1 disables ping-pong buffering */
+#ifndef MSC_MEDIA_BUF_NUM
+    #define MSC_MEDIA_BUF_NUM       2U
+#endif /* MSC_MEDIA_BUF_NUM */
+
+/* a media packet is a whole number of blocks and goes out in one endpoint transfer */
+#if (MSC_MEDIA_PACKET_SIZE > (1023U * MSC_DATA_PACKET_SIZE))
+    #error "MSC_MEDIA_PACKET_SIZE exceeds the packet count of one endpoint transfer"
+#endif
+
 /* MSC BBB state */
 enum msc_bbb_state {
     BBB_IDLE = 0U,          /*!< idle state  */
@@ -58,7 +68,15 @@ enum msc_bbb_status {
 
 typedef struct
 {
-    uint8_t bbb_data[MSC_MEDIA_PACKET_SIZE];
+    uint8_t bbb_data[MSC_MEDIA_PACKET_SIZE * MSC_MEDIA_BUF_NUM];
+
+    uint8_t bbb_buf_head;
+    uint8_t bbb_buf_count;
+    uint8_t bbb_xfer_busy;
+    uint8_t bbb_media_busy;
+    uint8_t bbb_media_submit;
+    uint8_t bbb_media_err;
+    int8_t bbb_media_status;
 
     uint8_t max_lun;
     uint8_t bbb_state;
@@ -0,0 +1,82 @@
+/*!
+    \file    usbd_msc_cache.h
+    \brief   header file for the MSC block cache
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+#ifndef __USBD_MSC_CACHE_H
+#define __USBD_MSC_CACHE_H
+
+#include "usbd_msc_mem.h"
+
+/* cache block size, must match the block size of the media */
+#ifndef MSC_CACHE_BLOCK_SIZE
+    #define MSC_CACHE_BLOCK_SIZE        512U
+#endif /* MSC_CACHE_BLOCK_SIZE */
+
+/* number of cached blocks */
+#ifndef MSC_CACHE_LINE_NUM
+    #define MSC_CACHE_LINE_NUM          16U
+#endif /* MSC_CACHE_LINE_NUM */
+
+/* blocks fetched ahead of a sequential read */
+#ifndef MSC_CACHE_READ_AHEAD
+    #define MSC_CACHE_READ_AHEAD        4U
+#endif /* MSC_CACHE_READ_AHEAD */
+
+/* transfers of at least this many blocks go straight to the media */
+#ifndef MSC_CACHE_BYPASS_BLOCKS
+    #define MSC_CACHE_BYPASS_BLOCKS     (MSC_CACHE_LINE_NUM / 2U)
+#endif /* MSC_CACHE_BYPASS_BLOCKS */
+
+typedef struct
+{
+    uint32_t hits;                      /*!< blocks read from the cache */
+    uint32_t misses;                    /*!< blocks read from the media on demand */
+    uint32_t read_ahead;                /*!< blocks fetched ahead */
+    uint32_t read_ahead_hits;           /*!< fetched ahead blocks read later */
+    uint32_t bypass;                    /*!< blocks moved without caching */
+    uint32_t write_hits;                /*!< written blocks already cached */
+    uint32_t write_backs;               /*!< dirty blocks written to the media */
+    uint32_t flushes;                   /*!< flush requests finding dirty blocks */
+} usbd_cache_stat;
+
+extern usbd_mem_cb usbd_cache_fops;
+
+/* function declarations */
+/* put the cache in front of a media backend, then use usbd_cache_fops as the media */
+int8_t usbd_cache_init (usbd_mem_cb *backend);
+/* write all dirty blocks to the media, 1 while the write-backs of an asynchronous backend are pending */
+int8_t usbd_cache_flush (void);
+/* get the cache statistics */
+void usbd_cache_stat_get (usbd_cache_stat *stat);
+
+#endif /* __USBD_MSC_CACHE_H */
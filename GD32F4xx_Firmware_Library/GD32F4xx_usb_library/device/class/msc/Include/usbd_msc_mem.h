@@ -39,6 +39,9 @@ OF SUCH DAMAGE.
 
 #define USBD_STD_INQUIRY_LENGTH     36U
 
+/* completion of an asynchronous media operation, status is 0 on success and negative on failure */
+typedef void (*usbd_mem_done) (uint8_t lun, int8_t status);
+
 typedef struct
 {
     int8_t (*mem_init)         (uint8_t lun);
@@ -52,6 +55,17 @@ typedef struct
     uint8_t *mem_inquiry_data[MEM_LUN_NUM];
     uint32_t mem_block_size[MEM_LUN_NUM];
     uint32_t mem_block_len[MEM_LUN_NUM];
+
+    /* optional asynchronous access, used instead of mem_read/mem_write when not NULL */
+    int8_t (*mem_read_async)   (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done);
+    int8_t (*mem_write_async)  (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done);
+
+    /* optional, write cached data to the medium on SYNCHRONIZE CACHE, stop and idle polling */
+    int8_t (*mem_flush)        (uint8_t lun);
+
+    /* optional asynchronous flush, used instead of mem_flush when not NULL, done is NULL on idle
+       polling where nothing waits for the write-back */
+    int8_t (*mem_flush_async)  (uint8_t lun, usbd_mem_done done);
 } usbd_mem_cb;
 
 extern usbd_mem_cb *usbd_mem_fops;
@@ -0,0 +1,55 @@
+/*!
+    \file    usbd_msc_ram.h
+    \brief   header file for the RAM disk storage with asynchronous access
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+#ifndef __USBD_MSC_RAM_H
+#define __USBD_MSC_RAM_H
+
+#include "usbd_msc_mem.h"
+
+#define MSC_RAM_BLOCK_SIZE          512U
+
+/* size of the single logical unit */
+#ifndef MSC_RAM_BLOCK_NUM
+    #define MSC_RAM_BLOCK_NUM       64U
+#endif /* MSC_RAM_BLOCK_NUM */
+
+extern usbd_mem_cb usbd_ram_fops;
+
+/* function declarations */
+/* set the completion delay of asynchronous accesses, counted in usbd_ram_poll() calls */
+void usbd_ram_latency_set (uint32_t ticks);
+/* complete the pending access once its delay has elapsed */
+void usbd_ram_poll (void);
+
+#endif /* __USBD_MSC_RAM_H */
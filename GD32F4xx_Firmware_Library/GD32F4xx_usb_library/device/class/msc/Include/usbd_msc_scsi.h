@@ -42,7 +42,23 @@ OF SUCH DAMAGE.
 
 #define MODE_SENSE6_LENGTH                          8U
 #define MODE_SENSE10_LENGTH                         8U
-#define INQUIRY_PAGE00_LENGTH                       96U
+#define INQUIRY_PAGE00_LENGTH                       8U
+#define INQUIRY_PAGEB0_LENGTH                       64U
+
+/* vital product data pages */
+#define INQUIRY_PAGE_SUPPORTED                      0x00U
+#define INQUIRY_PAGE_SERIAL                         0x80U
+#define INQUIRY_PAGE_DEVICE_ID                      0x83U
+#define INQUIRY_PAGE_BLOCK_LIMITS                   0xB0U
+
+/* transfer lengths advertised in the block limits page */
+#ifndef MSC_MAX_TRANSFER_SIZE
+    #define MSC_MAX_TRANSFER_SIZE                   (1024U * 1024U)
+#endif /* MSC_MAX_TRANSFER_SIZE */
+
+#ifndef MSC_OPT_TRANSFER_SIZE
+    #define MSC_OPT_TRANSFER_SIZE                   (64U * 1024U)
+#endif /* MSC_OPT_TRANSFER_SIZE */
 #define FORMAT_CAPACITIES_LENGTH                    20U
 
 extern const uint8_t msc_page00_inquiry_data[];
@@ -0,0 +1,969 @@
+/*!
+    \file    usbd_msc_cache.c
+    \brief   LRU block cache with read-ahead and write-back for the MSC media
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "usbd_msc_cache.h"
+
+/* requests of the MSC layer to an asynchronous cache */
+enum {
+    CACHE_REQ_NONE = 0U,
+    CACHE_REQ_READ,
+    CACHE_REQ_WRITE,
+    CACHE_REQ_FLUSH
+};
+
+/* access of an asynchronous backend in flight */
+enum {
+    CACHE_IO_NONE = 0U,
+    CACHE_IO_FILL,                      /* a missed block of the request */
+    CACHE_IO_AHEAD,                     /* a block ahead of a sequential read */
+    CACHE_IO_WRITE_BACK,                /* a dirty block */
+    CACHE_IO_BYPASS                     /* the whole request, straight to the host buffer */
+};
+
+typedef struct
+{
+    uint32_t blk;                       /* block number on the media */
+    uint32_t used;                      /* LRU stamp */
+    uint8_t lun;
+    uint8_t valid;
+    uint8_t dirty;
+    uint8_t ahead;                      /* fetched ahead and not read yet */
+} cache_line;
+
+typedef struct
+{
+    uint8_t *buf;
+    uint32_t blk;
+    uint16_t len;
+    uint16_t pos;                       /* blocks done */
+    uint8_t lun;
+    uint8_t op;
+    int8_t status;
+    usbd_mem_done done;
+} cache_request;
+
+typedef struct
+{
+    usbd_mem_cb *backend;
+    uint32_t stamp;
+    uint32_t seq_next[MEM_LUN_NUM];     /* block following the last read */
+    uint32_t dirty_num[MEM_LUN_NUM];    /* dirty lines of each logical unit */
+    cache_line line[MSC_CACHE_LINE_NUM];
+    usbd_cache_stat stat;
+
+    /* asynchronous backend, a single access in flight */
+    cache_request req;
+    uint8_t io;
+    uint8_t io_lun;
+    uint8_t running;                    /* cache_run() is on the stack */
+    int32_t io_line;
+    uint32_t ahead_blk;                 /* next block to fetch ahead */
+    uint32_t ahead_left;
+    uint8_t ahead_lun;
+    uint8_t flush_bg[MEM_LUN_NUM];      /* write the dirty lines back in the background */
+    int8_t flush_err[MEM_LUN_NUM];      /* a background write-back failed, told by the next flush */
+} cache_handler;
+
+/* word aligned for DMA capable media */
+static uint32_t cache_data[MSC_CACHE_LINE_NUM][MSC_CACHE_BLOCK_SIZE / 4U];
+static cache_handler cache;
+
+usbd_mem_cb usbd_cache_fops;
+
+/* local function prototypes ('static') */
+static int8_t   cache_read        (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len);
+static int8_t   cache_write       (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len);
+static int8_t   cache_flush_lun   (uint8_t lun);
+static int32_t  cache_find        (uint8_t lun, uint32_t blk);
+static int32_t  cache_victim      (void);
+static int32_t  cache_alloc       (uint8_t lun, uint32_t blk);
+static int8_t   cache_write_back  (cache_line *line);
+static void     cache_read_ahead  (uint8_t lun, uint32_t blk);
+
+static int8_t   cache_read_async  (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done);
+static int8_t   cache_write_async (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done);
+static int8_t   cache_flush_async (uint8_t lun, usbd_mem_done done);
+static int8_t   cache_submit      (uint8_t op, uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done);
+static void     cache_run         (void);
+static void     cache_request_step(void);
+static void     cache_request_end (int8_t status);
+static uint8_t  cache_background  (void);
+static int32_t  cache_dirty_find  (uint8_t lun);
+static void     cache_io_start    (uint8_t io, int32_t idx, uint8_t lun, uint8_t *buf, uint32_t blk, uint16_t len);
+static void     cache_io_done     (uint8_t lun, int8_t status);
+
+/*!
+    \brief      put the cache in front of a media backend, a backend with both asynchronous
+                hooks is only accessed through them: the USB interrupt never waits for the media,
+                the misses, the read-ahead and the write-backs complete through usbd_mem_done
+    \param[in]  backend: media backend, its block size must be MSC_CACHE_BLOCK_SIZE
+    \param[out] none
+    \retval     status
+*/
+int8_t usbd_cache_init (usbd_mem_cb *backend)
+{
+    uint8_t lun;
+
+    for (lun = 0U; lun < MEM_LUN_NUM; lun++) {
+        if (MSC_CACHE_BLOCK_SIZE != backend->mem_block_size[lun]) {
+            return -1;
+        }
+    }
+
+    memset((void *)&cache, 0U, sizeof(cache));
+    cache.backend = backend;
+
+    /* same media description, cached access */
+    usbd_cache_fops = *backend;
+    usbd_cache_fops.mem_read = cache_read;
+    usbd_cache_fops.mem_write = cache_write;
+
+    if ((NULL != backend->mem_read_async) && (NULL != backend->mem_write_async)) {
+        usbd_cache_fops.mem_read_async = cache_read_async;
+        usbd_cache_fops.mem_write_async = cache_write_async;
+        usbd_cache_fops.mem_flush = NULL;
+        usbd_cache_fops.mem_flush_async = cache_flush_async;
+    } else {
+        usbd_cache_fops.mem_read_async = NULL;
+        usbd_cache_fops.mem_write_async = NULL;
+        usbd_cache_fops.mem_flush = cache_flush_lun;
+        usbd_cache_fops.mem_flush_async = NULL;
+    }
+
+    return 0;
+}
+
+/*!
+    \brief      write all dirty blocks to the media, call it with the USB interrupt disabled,
+                with an asynchronous backend it only starts the write-backs, call it again until
+                it returns 0
+    \param[in]  none
+    \param[out] none
+    \retval     status, 1 while write-backs of an asynchronous backend are pending
+*/
+int8_t usbd_cache_flush (void)
+{
+    int8_t status = 0;
+    uint8_t lun;
+
+    if (NULL != usbd_cache_fops.mem_flush_async) {
+        for (lun = 0U; lun < MEM_LUN_NUM; lun++) {
+            (void)cache_flush_async(lun, NULL);
+        }
+
+        for (lun = 0U; lun < MEM_LUN_NUM; lun++) {
+            if (cache.flush_err[lun] < 0) {
+                cache.flush_err[lun] = 0;
+                status = -1;
+            } else if ((0 == status) && (0U != cache.dirty_num[lun])) {
+                status = 1;
+            } else {
+                /* no operation */
+            }
+        }
+
+        return status;
+    }
+
+    for (lun = 0U; lun < MEM_LUN_NUM; lun++) {
+        if (cache_flush_lun(lun) < 0) {
+            status = -1;
+        }
+    }
+
+    return status;
+}
+
+/*!
+    \brief      get the cache statistics
+    \param[in]  none
+    \param[out] stat: pointer to the statistics
+    \retval     none
+*/
+void usbd_cache_stat_get (usbd_cache_stat *stat)
+{
+    *stat = cache.stat;
+}
+
+/*!
+    \brief      read blocks through the cache
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the buffer to save data
+    \param[in]  block_addr: byte address of 1st block to be read
+    \param[in]  block_len: number of blocks to be read
+    \param[out] none
+    \retval     status
+*/
+static int8_t cache_read (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len)
+{
+    uint32_t blk = block_addr / MSC_CACHE_BLOCK_SIZE;
+    uint32_t i;
+    int32_t idx;
+
+    if (block_len >= MSC_CACHE_BYPASS_BLOCKS) {
+        if (cache.backend->mem_read(lun, buf, block_addr, block_len) < 0) {
+            return -1;
+        }
+
+        /* the cache holds newer data for dirty blocks */
+        for (i = 0U; i < block_len; i++) {
+            idx = cache_find(lun, blk + i);
+
+            if ((idx >= 0) && (0U != cache.line[idx].dirty)) {
+                memcpy(&buf[i * MSC_CACHE_BLOCK_SIZE], cache_data[idx], MSC_CACHE_BLOCK_SIZE);
+            }
+        }
+
+        cache.stat.bypass += block_len;
+    } else {
+        for (i = 0U; i < block_len; i++) {
+            idx = cache_find(lun, blk + i);
+
+            if (idx >= 0) {
+                cache.stat.hits++;
+
+                if (0U != cache.line[idx].ahead) {
+                    cache.line[idx].ahead = 0U;
+                    cache.stat.read_ahead_hits++;
+                }
+            } else {
+                idx = cache_alloc(lun, blk + i);
+
+                if ((idx < 0) || (cache.backend->mem_read(lun, (uint8_t *)cache_data[idx], (blk + i) * MSC_CACHE_BLOCK_SIZE, 1U) < 0)) {
+                    return -1;
+                }
+
+                cache.line[idx].valid = 1U;
+                cache.stat.misses++;
+            }
+
+            cache.line[idx].used = ++cache.stamp;
+
+            memcpy(&buf[i * MSC_CACHE_BLOCK_SIZE], cache_data[idx], MSC_CACHE_BLOCK_SIZE);
+        }
+
+        /* sequential access, fetch the following blocks */
+        if (blk == cache.seq_next[lun]) {
+            cache_read_ahead(lun, blk + block_len);
+        }
+    }
+
+    cache.seq_next[lun] = blk + block_len;
+
+    return 0;
+}
+
+/*!
+    \brief      write blocks through the cache
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the buffer to write
+    \param[in]  block_addr: byte address of 1st block to be written
+    \param[in]  block_len: number of blocks to be written
+    \param[out] none
+    \retval     status
+*/
+static int8_t cache_write (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len)
+{
+    uint32_t blk = block_addr / MSC_CACHE_BLOCK_SIZE;
+    uint32_t i;
+    int32_t idx;
+
+    if (block_len >= MSC_CACHE_BYPASS_BLOCKS) {
+        if (cache.backend->mem_write(lun, buf, block_addr, block_len) < 0) {
+            return -1;
+        }
+
+        /* keep the cached copies in step with the media */
+        for (i = 0U; i < block_len; i++) {
+            idx = cache_find(lun, blk + i);
+
+            if (idx >= 0) {
+                memcpy(cache_data[idx], &buf[i * MSC_CACHE_BLOCK_SIZE], MSC_CACHE_BLOCK_SIZE);
+                if (0U != cache.line[idx].dirty) {
+                    cache.line[idx].dirty = 0U;
+                    cache.dirty_num[lun]--;
+                }
+            }
+        }
+
+        cache.stat.bypass += block_len;
+
+        return 0;
+    }
+
+    for (i = 0U; i < block_len; i++) {
+        idx = cache_find(lun, blk + i);
+
+        if (idx >= 0) {
+            cache.stat.write_hits++;
+        } else {
+            /* the whole block is overwritten, no need to read it */
+            idx = cache_alloc(lun, blk + i);
+
+            if (idx < 0) {
+                return -1;
+            }
+
+            cache.line[idx].valid = 1U;
+        }
+
+        memcpy(cache_data[idx], &buf[i * MSC_CACHE_BLOCK_SIZE], MSC_CACHE_BLOCK_SIZE);
+
+        if (0U == cache.line[idx].dirty) {
+            cache.line[idx].dirty = 1U;
+            cache.dirty_num[lun]++;
+        }
+        cache.line[idx].ahead = 0U;
+        cache.line[idx].used = ++cache.stamp;
+    }
+
+    return 0;
+}
+
+/*!
+    \brief      write the dirty blocks of a logical unit to the media
+    \param[in]  lun: logical unit number
+    \param[out] none
+    \retval     status
+*/
+static int8_t cache_flush_lun (uint8_t lun)
+{
+    int8_t status = 0;
+    uint32_t i;
+
+    /* nothing to write, cheap enough for every host poll */
+    if (0U == cache.dirty_num[lun]) {
+        return 0;
+    }
+
+    cache.stat.flushes++;
+
+    for (i = 0U; i < MSC_CACHE_LINE_NUM; i++) {
+        if ((0U != cache.line[i].valid) && (lun == cache.line[i].lun)) {
+            if (cache_write_back(&cache.line[i]) < 0) {
+                status = -1;
+            }
+        }
+    }
+
+    return status;
+}
+
+/*!
+    \brief      look up a cached block
+    \param[in]  lun: logical unit number
+    \param[in]  blk: block number
+    \param[out] none
+    \retval     line index, -1 if the block is not cached
+*/
+static int32_t cache_find (uint8_t lun, uint32_t blk)
+{
+    int32_t i;
+
+    for (i = 0; i < (int32_t)MSC_CACHE_LINE_NUM; i++) {
+        if ((0U != cache.line[i].valid) && (blk == cache.line[i].blk) && (lun == cache.line[i].lun)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+    \brief      pick a free or the least recently used line
+    \param[in]  none
+    \param[out] none
+    \retval     line index
+*/
+static int32_t cache_victim (void)
+{
+    int32_t i, victim = 0;
+
+    for (i = 0; i < (int32_t)MSC_CACHE_LINE_NUM; i++) {
+        if (0U == cache.line[i].valid) {
+            return i;
+        }
+
+        if (cache.line[i].used < cache.line[victim].used) {
+            victim = i;
+        }
+    }
+
+    return victim;
+}
+
+/*!
+    \brief      take a free or the least recently used line for a block
+    \param[in]  lun: logical unit number
+    \param[in]  blk: block number
+    \param[out] none
+    \retval     line index, -1 if the evicted block could not be written back
+*/
+static int32_t cache_alloc (uint8_t lun, uint32_t blk)
+{
+    int32_t victim = cache_victim();
+
+    if (cache_write_back(&cache.line[victim]) < 0) {
+        return -1;
+    }
+
+    cache.line[victim].valid = 0U;
+    cache.line[victim].ahead = 0U;
+    cache.line[victim].lun = lun;
+    cache.line[victim].blk = blk;
+
+    return victim;
+}
+
+/*!
+    \brief      write a dirty block to the media
+    \param[in]  line: pointer to the cache line
+    \param[out] none
+    \retval     status
+*/
+static int8_t cache_write_back (cache_line *line)
+{
+    uint8_t *data = (uint8_t *)cache_data[line - cache.line];
+
+    if ((0U == line->valid) || (0U == line->dirty)) {
+        return 0;
+    }
+
+    if (cache.backend->mem_write(line->lun, data, line->blk * MSC_CACHE_BLOCK_SIZE, 1U) < 0) {
+        return -1;
+    }
+
+    line->dirty = 0U;
+    cache.dirty_num[line->lun]--;
+    cache.stat.write_backs++;
+
+    return 0;
+}
+
+/*!
+    \brief      fetch the blocks following a sequential read
+    \param[in]  lun: logical unit number
+    \param[in]  blk: first block to fetch
+    \param[out] none
+    \retval     none
+*/
+static void cache_read_ahead (uint8_t lun, uint32_t blk)
+{
+    uint32_t i;
+    int32_t idx;
+
+    for (i = 0U; i < MSC_CACHE_READ_AHEAD; i++, blk++) {
+        if ((blk >= cache.backend->mem_block_len[lun]) || (cache_find(lun, blk) >= 0)) {
+            continue;
+        }
+
+        idx = cache_alloc(lun, blk);
+
+        if ((idx < 0) || (cache.backend->mem_read(lun, (uint8_t *)cache_data[idx], blk * MSC_CACHE_BLOCK_SIZE, 1U) < 0)) {
+            return;
+        }
+
+        cache.line[idx].valid = 1U;
+        cache.line[idx].ahead = 1U;
+        cache.line[idx].used = ++cache.stamp;
+        cache.stat.read_ahead++;
+    }
+}
+
+/*!
+    \brief      start an asynchronous read through the cache
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the buffer to save data
+    \param[in]  block_addr: byte address of 1st block to be read
+    \param[in]  block_len: number of blocks to be read
+    \param[in]  done: completion callback
+    \param[out] none
+    \retval     status
+*/
+static int8_t cache_read_async (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done)
+{
+    return cache_submit (CACHE_REQ_READ, lun, buf, block_addr, block_len, done);
+}
+
+/*!
+    \brief      start an asynchronous write through the cache
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the buffer to write
+    \param[in]  block_addr: byte address of 1st block to be written
+    \param[in]  block_len: number of blocks to be written
+    \param[in]  done: completion callback
+    \param[out] none
+    \retval     status
+*/
+static int8_t cache_write_async (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done)
+{
+    return cache_submit (CACHE_REQ_WRITE, lun, buf, block_addr, block_len, done);
+}
+
+/*!
+    \brief      start writing the dirty blocks of a logical unit back to the media
+    \param[in]  lun: logical unit number
+    \param[in]  done: completion callback, NULL to write them back in the background
+    \param[out] none
+    \retval     status
+*/
+static int8_t cache_flush_async (uint8_t lun, usbd_mem_done done)
+{
+    if (0U != cache.dirty_num[lun]) {
+        cache.stat.flushes++;
+    }
+
+    if (NULL != done) {
+        return cache_submit (CACHE_REQ_FLUSH, lun, NULL, 0U, 0U, done);
+    }
+
+    if (0U != cache.dirty_num[lun]) {
+        cache.flush_bg[lun] = 1U;
+        cache_run();
+    }
+
+    return 0;
+}
+
+/*!
+    \brief      take a request of the MSC layer, only one may be pending
+    \param[in]  op: CACHE_REQ_READ, CACHE_REQ_WRITE or CACHE_REQ_FLUSH
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the data buffer
+    \param[in]  block_addr: byte address of 1st block
+    \param[in]  block_len: number of blocks
+    \param[in]  done: completion callback
+    \param[out] none
+    \retval     status
+*/
+static int8_t cache_submit (uint8_t op, uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done)
+{
+    if (CACHE_REQ_NONE != cache.req.op) {
+        return -1;
+    }
+
+    cache.req.buf = buf;
+    cache.req.blk = block_addr / MSC_CACHE_BLOCK_SIZE;
+    cache.req.len = block_len;
+    cache.req.pos = 0U;
+    cache.req.lun = lun;
+    cache.req.status = 0;
+    cache.req.done = done;
+    cache.req.op = op;
+
+    /* the request waits for the access in flight, its completion goes on with it */
+    cache_run();
+
+    return 0;
+}
+
+/*!
+    \brief      serve the request, then the read-ahead and the background write-backs, until an
+                access of the backend is in flight
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void cache_run (void)
+{
+    /* a completion inside a submission returns here through the loop */
+    if (0U != cache.running) {
+        return;
+    }
+
+    cache.running = 1U;
+
+    while (CACHE_IO_NONE == cache.io) {
+        if (CACHE_REQ_NONE != cache.req.op) {
+            cache_request_step();
+        } else if (0U == cache_background()) {
+            break;
+        } else {
+            /* no operation */
+        }
+    }
+
+    cache.running = 0U;
+}
+
+/*!
+    \brief      move the request on, up to the next access of the backend or to its end
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void cache_request_step (void)
+{
+    cache_request *req = &cache.req;
+    uint32_t blk;
+    int32_t idx;
+
+    if (req->status < 0) {
+        cache_request_end (req->status);
+
+        return;
+    }
+
+    if (CACHE_REQ_FLUSH == req->op) {
+        idx = cache_dirty_find (req->lun);
+
+        if (idx >= 0) {
+            cache_io_start (CACHE_IO_WRITE_BACK, idx, req->lun, (uint8_t *)cache_data[idx], cache.line[idx].blk, 1U);
+        } else {
+            cache_request_end (0);
+        }
+
+        return;
+    }
+
+    if ((0U == req->pos) && (req->len >= MSC_CACHE_BYPASS_BLOCKS)) {
+        cache_io_start (CACHE_IO_BYPASS, -1, req->lun, req->buf, req->blk, req->len);
+
+        return;
+    }
+
+    while (req->pos < req->len) {
+        blk = req->blk + req->pos;
+        idx = cache_find(req->lun, blk);
+
+        if (idx >= 0) {
+            if (CACHE_REQ_READ == req->op) {
+                cache.stat.hits++;
+
+                if (0U != cache.line[idx].ahead) {
+                    cache.line[idx].ahead = 0U;
+                    cache.stat.read_ahead_hits++;
+                }
+            } else {
+                cache.stat.write_hits++;
+            }
+        } else {
+            idx = cache_victim();
+
+            if (0U != cache.line[idx].dirty) {
+                cache_io_start (CACHE_IO_WRITE_BACK, idx, cache.line[idx].lun, (uint8_t *)cache_data[idx], cache.line[idx].blk, 1U);
+
+                return;
+            }
+
+            cache.line[idx].valid = 0U;
+            cache.line[idx].ahead = 0U;
+            cache.line[idx].lun = req->lun;
+            cache.line[idx].blk = blk;
+
+            if (CACHE_REQ_READ == req->op) {
+                cache_io_start (CACHE_IO_FILL, idx, req->lun, (uint8_t *)cache_data[idx], blk, 1U);
+
+                return;
+            }
+
+            /* the whole block is overwritten, no need to read it */
+            cache.line[idx].valid = 1U;
+        }
+
+        if (CACHE_REQ_READ == req->op) {
+            memcpy(&req->buf[req->pos * MSC_CACHE_BLOCK_SIZE], cache_data[idx], MSC_CACHE_BLOCK_SIZE);
+        } else {
+            memcpy(cache_data[idx], &req->buf[req->pos * MSC_CACHE_BLOCK_SIZE], MSC_CACHE_BLOCK_SIZE);
+
+            if (0U == cache.line[idx].dirty) {
+                cache.line[idx].dirty = 1U;
+                cache.dirty_num[req->lun]++;
+            }
+            cache.line[idx].ahead = 0U;
+        }
+
+        cache.line[idx].used = ++cache.stamp;
+        req->pos++;
+    }
+
+    cache_request_end (0);
+}
+
+/*!
+    \brief      complete the request and tell the MSC layer, which may submit the next one
+    \param[in]  status: 0 on success, negative on failure
+    \param[out] none
+    \retval     none
+*/
+static void cache_request_end (int8_t status)
+{
+    cache_request *req = &cache.req;
+    usbd_mem_done done = req->done;
+    uint8_t lun = req->lun;
+
+    if (CACHE_REQ_READ == req->op) {
+        /* sequential access, fetch the following blocks once the backend is free */
+        if ((0 == status) && (req->len < MSC_CACHE_BYPASS_BLOCKS) && (req->blk == cache.seq_next[lun])) {
+            cache.ahead_lun = lun;
+            cache.ahead_blk = req->blk + req->len;
+            cache.ahead_left = MSC_CACHE_READ_AHEAD;
+        }
+
+        cache.seq_next[lun] = req->blk + req->len;
+    } else if (CACHE_REQ_FLUSH == req->op) {
+        if (cache.flush_err[lun] < 0) {
+            cache.flush_err[lun] = 0;
+            status = -1;
+        }
+    } else {
+        /* no operation */
+    }
+
+    req->op = CACHE_REQ_NONE;
+    req->done = NULL;
+
+    done (lun, status);
+}
+
+/*!
+    \brief      start the next background access, the read-ahead goes before the write-backs
+    \param[in]  none
+    \param[out] none
+    \retval     1 if an access was started, 0 when there is nothing to do
+*/
+static uint8_t cache_background (void)
+{
+    uint8_t lun = cache.ahead_lun;
+    int32_t idx;
+
+    while (cache.ahead_left > 0U) {
+        if (cache.ahead_blk >= cache.backend->mem_block_len[lun]) {
+            cache.ahead_left = 0U;
+            break;
+        }
+
+        if (cache_find(lun, cache.ahead_blk) >= 0) {
+            cache.ahead_blk++;
+            cache.ahead_left--;
+            continue;
+        }
+
+        idx = cache_victim();
+
+        if (0U != cache.line[idx].dirty) {
+            cache_io_start (CACHE_IO_WRITE_BACK, idx, cache.line[idx].lun, (uint8_t *)cache_data[idx], cache.line[idx].blk, 1U);
+
+            return 1U;
+        }
+
+        cache.line[idx].valid = 0U;
+        cache.line[idx].ahead = 0U;
+        cache.line[idx].lun = lun;
+        cache.line[idx].blk = cache.ahead_blk;
+
+        cache.ahead_blk++;
+        cache.ahead_left--;
+
+        cache_io_start (CACHE_IO_AHEAD, idx, lun, (uint8_t *)cache_data[idx], cache.line[idx].blk, 1U);
+
+        return 1U;
+    }
+
+    for (lun = 0U; lun < MEM_LUN_NUM; lun++) {
+        if (0U != cache.flush_bg[lun]) {
+            idx = cache_dirty_find (lun);
+
+            if (idx >= 0) {
+                cache_io_start (CACHE_IO_WRITE_BACK, idx, lun, (uint8_t *)cache_data[idx], cache.line[idx].blk, 1U);
+
+                return 1U;
+            }
+
+            cache.flush_bg[lun] = 0U;
+        }
+    }
+
+    return 0U;
+}
+
+/*!
+    \brief      look up a dirty line of a logical unit
+    \param[in]  lun: logical unit number
+    \param[out] none
+    \retval     line index, -1 if the logical unit has no dirty line
+*/
+static int32_t cache_dirty_find (uint8_t lun)
+{
+    int32_t i;
+
+    if (0U == cache.dirty_num[lun]) {
+        return -1;
+    }
+
+    for (i = 0; i < (int32_t)MSC_CACHE_LINE_NUM; i++) {
+        if ((0U != cache.line[i].valid) && (0U != cache.line[i].dirty) && (lun == cache.line[i].lun)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+    \brief      start an access of the asynchronous backend
+    \param[in]  io: CACHE_IO_FILL, CACHE_IO_AHEAD, CACHE_IO_WRITE_BACK or CACHE_IO_BYPASS
+    \param[in]  idx: cache line of the access, -1 for CACHE_IO_BYPASS
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the data buffer
+    \param[in]  blk: first block
+    \param[in]  len: number of blocks
+    \param[out] none
+    \retval     none
+*/
+static void cache_io_start (uint8_t io, int32_t idx, uint8_t lun, uint8_t *buf, uint32_t blk, uint16_t len)
+{
+    int8_t status;
+    uint8_t write = (uint8_t)((CACHE_IO_WRITE_BACK == io) || ((CACHE_IO_BYPASS == io) && (CACHE_REQ_WRITE == cache.req.op)));
+
+    cache.io = io;
+    cache.io_line = idx;
+    cache.io_lun = lun;
+
+    if (0U != write) {
+        status = cache.backend->mem_write_async (lun, buf, blk * MSC_CACHE_BLOCK_SIZE, len, cache_io_done);
+    } else {
+        status = cache.backend->mem_read_async (lun, buf, blk * MSC_CACHE_BLOCK_SIZE, len, cache_io_done);
+    }
+
+    /* refused, no completion will come */
+    if (status < 0) {
+        cache_io_done (lun, -1);
+    }
+}
+
+/*!
+    \brief      completion of an access of the asynchronous backend, called at the priority the
+                backend completes at, which must not preempt the USB interrupt
+    \param[in]  lun: logical unit number
+    \param[in]  status: 0 on success, negative on failure
+    \param[out] none
+    \retval     none
+*/
+static void cache_io_done (uint8_t lun, int8_t status)
+{
+    cache_request *req = &cache.req;
+    cache_line *line = (cache.io_line >= 0) ? &cache.line[cache.io_line] : NULL;
+    uint8_t io = cache.io;
+    uint32_t i;
+    int32_t idx;
+
+    lun = cache.io_lun;
+    cache.io = CACHE_IO_NONE;
+
+    switch (io) {
+    case CACHE_IO_FILL:
+        if (status < 0) {
+            req->status = -1;
+            break;
+        }
+
+        line->valid = 1U;
+        line->used = ++cache.stamp;
+        cache.stat.misses++;
+
+        memcpy(&req->buf[req->pos * MSC_CACHE_BLOCK_SIZE], cache_data[cache.io_line], MSC_CACHE_BLOCK_SIZE);
+        req->pos++;
+        break;
+
+    case CACHE_IO_AHEAD:
+        if (status < 0) {
+            cache.ahead_left = 0U;
+            break;
+        }
+
+        line->valid = 1U;
+        line->ahead = 1U;
+        line->used = ++cache.stamp;
+        cache.stat.read_ahead++;
+        break;
+
+    case CACHE_IO_WRITE_BACK:
+        if (status < 0) {
+            /* the block stays dirty, the failure goes to whoever waits for it */
+            if (CACHE_REQ_NONE != req->op) {
+                req->status = -1;
+            } else {
+                cache.ahead_left = 0U;
+                cache.flush_bg[lun] = 0U;
+                cache.flush_err[lun] = -1;
+            }
+            break;
+        }
+
+        line->dirty = 0U;
+        cache.dirty_num[lun]--;
+        cache.stat.write_backs++;
+        break;
+
+    case CACHE_IO_BYPASS:
+        if (status < 0) {
+            req->status = -1;
+            break;
+        }
+
+        for (i = 0U; i < req->len; i++) {
+            idx = cache_find(lun, req->blk + i);
+
+            if (idx < 0) {
+                continue;
+            }
+
+            if (CACHE_REQ_READ == req->op) {
+                /* the cache holds newer data for dirty blocks */
+                if (0U != cache.line[idx].dirty) {
+                    memcpy(&req->buf[i * MSC_CACHE_BLOCK_SIZE], cache_data[idx], MSC_CACHE_BLOCK_SIZE);
+                }
+            } else {
+                /* keep the cached copies in step with the media */
+                memcpy(cache_data[idx], &req->buf[i * MSC_CACHE_BLOCK_SIZE], MSC_CACHE_BLOCK_SIZE);
+
+                if (0U != cache.line[idx].dirty) {
+                    cache.line[idx].dirty = 0U;
+                    cache.dirty_num[lun]--;
+                }
+            }
+        }
+
+        cache.stat.bypass += req->len;
+        req->pos = req->len;
+        break;
+
+    default:
+        break;
+    }
+
+    cache_run();
+}
@@ -203,7 +203,8 @@ __ALIGN_BEGIN const usb_desc_config_set other_speed_msc_config_desc __ALIGN_END
     }
 };
 
-__ALIGN_BEGIN const uint8_t usbd_qualifier_desc[10] __ALIGN_END = 
+#if defined(USE_USB_HS) && defined(USE_ULPI_PHY)
+__ALIGN_BEGIN static const uint8_t usbd_qualifier_desc[10] __ALIGN_END = 
 {
     0x0A, 
     0x06,
@@ -216,6 +217,7 @@ __ALIGN_BEGIN const uint8_t usbd_qualifier_desc[10] __ALIGN_END =
     0x01, 
     0x00
 };
+#endif /* USE_USB_HS && USE_ULPI_PHY */
 
 /* USB language ID descriptor */
 static __ALIGN_BEGIN const usb_desc_LANGID usbd_language_id_desc __ALIGN_END = 
@@ -0,0 +1,294 @@
+/*!
+    \file    usbd_msc_ram.c
+    \brief   RAM disk storage with asynchronous access and configurable latency
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "usbd_msc_ram.h"
+
+/* USB mass storage standard inquiry data */
+static const uint8_t ram_inquiry_data[USBD_STD_INQUIRY_LENGTH] = 
+{
+    0x00U,          /* direct access device */
+    0x80U,          /* removable media */
+    0x02U,          /* version */
+    0x02U,          /* response data format */
+    (USBD_STD_INQUIRY_LENGTH - 5U),
+    0x00U,
+    0x00U,
+    0x00U,
+    'G', 'D', '3', '2', ' ', ' ', ' ', ' ', /* manufacturer: 8 bytes */
+    'R', 'A', 'M', ' ', 'D', 'i', 's', 'k', /* product: 16 bytes */
+    ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',
+    '1', '.', '0', '0',                     /* version: 4 bytes */
+};
+
+typedef struct
+{
+    uint8_t *buf;
+    uint32_t offset;
+    uint32_t len;
+    uint32_t ticks;
+    uint8_t lun;
+    uint8_t write;
+    uint8_t pending;
+    usbd_mem_done done;
+} ram_access;
+
+/* a single logical unit */
+static uint8_t ram_disk[MSC_RAM_BLOCK_NUM * MSC_RAM_BLOCK_SIZE];
+static uint32_t ram_latency = 0U;
+static ram_access ram_pending;
+
+/* local function prototypes ('static') */
+static int8_t ram_init            (uint8_t lun);
+static int8_t ram_ready           (uint8_t lun);
+static int8_t ram_protected       (uint8_t lun);
+static int8_t ram_read            (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len);
+static int8_t ram_write           (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len);
+static int8_t ram_maxlun          (void);
+static int8_t ram_read_async      (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done);
+static int8_t ram_write_async     (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done);
+static int8_t ram_submit          (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, uint8_t write, usbd_mem_done done);
+static void   ram_copy            (ram_access *access);
+
+usbd_mem_cb usbd_ram_fops =
+{
+    .mem_init      = ram_init,
+    .mem_ready     = ram_ready,
+    .mem_protected = ram_protected,
+    .mem_read      = ram_read,
+    .mem_write     = ram_write,
+    .mem_maxlun    = ram_maxlun,
+
+    .mem_inquiry_data = {(uint8_t *)ram_inquiry_data},
+    .mem_block_size   = {MSC_RAM_BLOCK_SIZE},
+    .mem_block_len    = {MSC_RAM_BLOCK_NUM},
+
+    .mem_read_async  = ram_read_async,
+    .mem_write_async = ram_write_async
+};
+
+/*!
+    \brief      set the completion delay of asynchronous accesses
+    \param[in]  ticks: number of usbd_ram_poll() calls before completion, 0 completes inside the submission
+    \param[out] none
+    \retval     none
+*/
+void usbd_ram_latency_set (uint32_t ticks)
+{
+    ram_latency = ticks;
+}
+
+/*!
+    \brief      complete the pending access once its delay has elapsed, call it periodically
+                at the USB interrupt priority or with the USB interrupt disabled
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void usbd_ram_poll (void)
+{
+    if ((0U == ram_pending.pending) || (--ram_pending.ticks > 0U)) {
+        return;
+    }
+
+    ram_copy (&ram_pending);
+
+    ram_pending.pending = 0U;
+    ram_pending.done (ram_pending.lun, 0);
+}
+
+/*!
+    \brief      initialize the storage medium
+    \param[in]  lun: logical unit number
+    \param[out] none
+    \retval     status
+*/
+static int8_t ram_init (uint8_t lun)
+{
+    ram_pending.pending = 0U;
+
+    return 0;
+}
+
+/*!
+    \brief      check whether the medium is ready
+    \param[in]  lun: logical unit number
+    \param[out] none
+    \retval     status
+*/
+static int8_t ram_ready (uint8_t lun)
+{
+    return 0;
+}
+
+/*!
+    \brief      check whether the medium is write-protected
+    \param[in]  lun: logical unit number
+    \param[out] none
+    \retval     status
+*/
+static int8_t ram_protected (uint8_t lun)
+{
+    return 0;
+}
+
+/*!
+    \brief      read data from the medium
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the buffer to save data
+    \param[in]  block_addr: address of 1st block to be read
+    \param[in]  block_len: number of blocks to be read
+    \param[out] none
+    \retval     status
+*/
+static int8_t ram_read (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len)
+{
+    ram_access access = {buf, block_addr, (uint32_t)block_len * MSC_RAM_BLOCK_SIZE, 0U, lun, 0U, 0U, NULL};
+
+    ram_copy (&access);
+
+    return 0;
+}
+
+/*!
+    \brief      write data to the medium
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the buffer to write
+    \param[in]  block_addr: address of 1st block to be written
+    \param[in]  block_len: number of blocks to be written
+    \param[out] none
+    \retval     status
+*/
+static int8_t ram_write (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len)
+{
+    ram_access access = {buf, block_addr, (uint32_t)block_len * MSC_RAM_BLOCK_SIZE, 0U, lun, 1U, 0U, NULL};
+
+    ram_copy (&access);
+
+    return 0;
+}
+
+/*!
+    \brief      get number of supported logical unit
+    \param[in]  none
+    \param[out] none
+    \retval     number of logical unit
+*/
+static int8_t ram_maxlun (void)
+{
+    return 0;
+}
+
+/*!
+    \brief      start an asynchronous read
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the buffer to save data
+    \param[in]  block_addr: address of 1st block to be read
+    \param[in]  block_len: number of blocks to be read
+    \param[in]  done: completion callback
+    \param[out] none
+    \retval     status
+*/
+static int8_t ram_read_async (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done)
+{
+    return ram_submit (lun, buf, block_addr, block_len, 0U, done);
+}
+
+/*!
+    \brief      start an asynchronous write
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the buffer to write
+    \param[in]  block_addr: address of 1st block to be written
+    \param[in]  block_len: number of blocks to be written
+    \param[in]  done: completion callback
+    \param[out] none
+    \retval     status
+*/
+static int8_t ram_write_async (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done)
+{
+    return ram_submit (lun, buf, block_addr, block_len, 1U, done);
+}
+
+/*!
+    \brief      queue an access, only one may be pending
+    \param[in]  lun: logical unit number
+    \param[in]  buf: pointer to the data buffer
+    \param[in]  block_addr: byte address of 1st block
+    \param[in]  block_len: number of blocks
+    \param[in]  write: 1 to write the medium, 0 to read it
+    \param[in]  done: completion callback
+    \param[out] none
+    \retval     status
+*/
+static int8_t ram_submit (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, uint8_t write, usbd_mem_done done)
+{
+    if (0U != ram_pending.pending) {
+        return -1;
+    }
+
+    ram_pending.buf = buf;
+    ram_pending.offset = block_addr;
+    ram_pending.len = (uint32_t)block_len * MSC_RAM_BLOCK_SIZE;
+    ram_pending.lun = lun;
+    ram_pending.write = write;
+    ram_pending.done = done;
+
+    if (0U == ram_latency) {
+        ram_copy (&ram_pending);
+
+        done (lun, 0);
+    } else {
+        ram_pending.ticks = ram_latency;
+        ram_pending.pending = 1U;
+    }
+
+    return 0;
+}
+
+/*!
+    \brief      move the data of an access
+    \param[in]  access: pointer to the access
+    \param[out] none
+    \retval     none
+*/
+static void ram_copy (ram_access *access)
+{
+    uint8_t *disk = &ram_disk[access->offset];
+
+    if (access->write) {
+        memcpy(disk, access->buf, access->len);
+    } else {
+        memcpy(access->buf, disk, access->len);
+    }
+}
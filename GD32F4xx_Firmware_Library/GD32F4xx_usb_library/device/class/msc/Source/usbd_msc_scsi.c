@@ -32,6 +32,7 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 OF SUCH DAMAGE.
 */
 
+#include <string.h>
 #include "usbd_enum.h"
 #include "usbd_msc_bbb.h"
 #include "usbd_msc_scsi.h"
@@ -42,10 +43,11 @@ const uint8_t msc_page00_inquiry_data[] =
     0x00U,
     0x00U,
     0x00U,
-    0x00U,
     (INQUIRY_PAGE00_LENGTH - 4U),
+    0x00U,
     0x80U,
     0x83U,
+    0xB0U,
 };
 
 /* USB mass storage sense 6 data */
@@ -74,6 +76,9 @@ const uint8_t msc_mode_sense10_data[] =
     0x00U
 };
 
+/* device of the pending asynchronous media operation */
+static usb_core_driver *msc_media_udev = NULL;
+
 /* local function prototypes ('static') */
 static int8_t scsi_test_unit_ready      (usb_core_driver *udev, uint8_t lun, uint8_t *params);
 static int8_t scsi_mode_select6         (usb_core_driver *udev, uint8_t lun, uint8_t *params);
@@ -81,18 +86,26 @@ static int8_t scsi_mode_select10        (usb_core_driver *udev, uint8_t lun, uin
 static int8_t scsi_inquiry              (usb_core_driver *udev, uint8_t lun, uint8_t *params);
 static int8_t scsi_read_format_capacity (usb_core_driver *udev, uint8_t lun, uint8_t *params);
 static int8_t scsi_read_capacity10      (usb_core_driver *udev, uint8_t lun, uint8_t *params);
+static int8_t scsi_read_capacity16      (usb_core_driver *udev, uint8_t lun, uint8_t *params);
 static int8_t scsi_request_sense        (usb_core_driver *udev, uint8_t lun, uint8_t *params);
 static int8_t scsi_mode_sense6          (usb_core_driver *udev, uint8_t lun, uint8_t *params);
 static int8_t scsi_toc_cmd_read         (usb_core_driver *udev, uint8_t lun, uint8_t *params);
 static int8_t scsi_mode_sense10         (usb_core_driver *udev, uint8_t lun, uint8_t *params);
-static int8_t scsi_write10              (usb_core_driver *udev, uint8_t lun, uint8_t *params);
-static int8_t scsi_read10               (usb_core_driver *udev, uint8_t lun, uint8_t *params);
+static int8_t scsi_write                (usb_core_driver *udev, uint8_t lun, uint8_t *params);
+static int8_t scsi_read                 (usb_core_driver *udev, uint8_t lun, uint8_t *params);
+static int8_t scsi_rw_params            (usb_core_driver *udev, uint8_t lun, uint8_t *params);
+static void   scsi_block_limits         (usb_core_driver *udev, uint8_t lun);
 static int8_t scsi_verify10             (usb_core_driver *udev, uint8_t lun, uint8_t *params);
+static int8_t scsi_sync_cache           (usb_core_driver *udev, uint8_t lun, uint8_t *params);
 
 static int8_t scsi_process_read         (usb_core_driver *udev, uint8_t lun);
 static int8_t scsi_process_write        (usb_core_driver *udev, uint8_t lun);
+static int8_t scsi_media_start          (usb_core_driver *udev, uint8_t lun);
+static int8_t scsi_media_flush          (usb_core_driver *udev, uint8_t lun);
+static void   scsi_media_advance        (usbd_msc_handler *msc, uint8_t lun);
+static void   scsi_media_done           (uint8_t lun, int8_t status);
 
-static inline int8_t scsi_check_address_range  (usb_core_driver *udev, uint8_t lun, uint32_t blk_offset, uint16_t blk_nbr);
+static inline int8_t scsi_check_address_range  (usb_core_driver *udev, uint8_t lun, uint32_t blk_offset, uint32_t blk_nbr);
 static inline int8_t scsi_format_cmd           (usb_core_driver *udev, uint8_t lun);
 static inline int8_t scsi_start_stop_unit      (usb_core_driver *udev, uint8_t lun, uint8_t *params);
 static inline int8_t scsi_allow_medium_removal (usb_core_driver *udev, uint8_t lun, uint8_t *params);
@@ -135,15 +148,24 @@ int8_t scsi_process_cmd(usb_core_driver *udev, uint8_t lun, uint8_t *params)
     case SCSI_READ_CAPACITY10:
         return scsi_read_capacity10 (udev, lun, params);
 
+    case SCSI_READ_CAPACITY16:
+        return scsi_read_capacity16 (udev, lun, params);
+
     case SCSI_READ10:
-        return scsi_read10 (udev, lun, params); 
+    case SCSI_READ16:
+        return scsi_read (udev, lun, params); 
 
     case SCSI_WRITE10:
-        return scsi_write10 (udev, lun, params);
+    case SCSI_WRITE16:
+        return scsi_write (udev, lun, params);
 
     case SCSI_VERIFY10:
         return scsi_verify10 (udev, lun, params);
 
+    case SCSI_SYNCHRONIZE_CACHE10:
+    case SCSI_SYNCHRONIZE_CACHE16:
+        return scsi_sync_cache (udev, lun, params);
+
     case SCSI_FORMAT_UNIT:
         return scsi_format_cmd (udev, lun);
 
@@ -209,6 +231,16 @@ static int8_t scsi_test_unit_ready (usb_core_driver *udev, uint8_t lun, uint8_t
         return -1;
     }
 
+    /* hosts poll with this command while idle, write back cached data if any is dirty,
+       an asynchronous media does it in the background and the command does not wait */
+    if (NULL != usbd_mem_fops->mem_flush_async) {
+        (void)usbd_mem_fops->mem_flush_async(lun, NULL);
+    } else if (NULL != usbd_mem_fops->mem_flush) {
+        (void)usbd_mem_fops->mem_flush(lun);
+    } else {
+        /* no operation */
+    }
+
     msc->bbb_datalen = 0U;
 
     return 0;
@@ -264,9 +296,32 @@ static int8_t scsi_inquiry (usb_core_driver *udev, uint8_t lun, uint8_t *params)
     usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
 
     if (params[1] & 0x01U) {
-        page = (uint8_t *)msc_page00_inquiry_data;
+        switch (params[2]) {
+        case INQUIRY_PAGE_SUPPORTED:
+            page = (uint8_t *)msc_page00_inquiry_data;
+            len = INQUIRY_PAGE00_LENGTH;
+            break;
+
+        case INQUIRY_PAGE_SERIAL:
+        case INQUIRY_PAGE_DEVICE_ID:
+            /* pages without descriptors */
+            memset(msc->bbb_data, 0U, 4U);
+            msc->bbb_data[1] = params[2];
+            len = 4U;
+            break;
+
+        case INQUIRY_PAGE_BLOCK_LIMITS:
+            scsi_block_limits (udev, lun);
+            len = INQUIRY_PAGEB0_LENGTH;
+            break;
+
+        default:
+            scsi_sense_code (udev, lun, ILLEGAL_REQUEST, INVALID_FIELED_IN_COMMAND);
 
-        len = INQUIRY_PAGE00_LENGTH;
+            return -1;
+        }
+
+        len = USB_MIN(len, ((uint16_t)params[3] << 8U) | params[4]);
     } else {
         page = (uint8_t *)usbd_mem_fops->mem_inquiry_data[lun];
 
@@ -279,14 +334,55 @@ static int8_t scsi_inquiry (usb_core_driver *udev, uint8_t lun, uint8_t *params)
 
     msc->bbb_datalen = len;
 
-    while (len) {
-        len--;
-        msc->bbb_data[len] = page[len];
+    if (NULL != page) {
+        while (len) {
+            len--;
+            msc->bbb_data[len] = page[len];
+        }
     }
 
     return 0;
 }
 
+/*!
+    \brief      build the Block Limits VPD page
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  lun: logical unit number
+    \param[out] none
+    \retval     none
+*/
+static void scsi_block_limits (usb_core_driver *udev, uint8_t lun)
+{
+    usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
+
+    uint8_t *page = msc->bbb_data;
+    uint32_t blk_size = usbd_mem_fops->mem_block_size[lun];
+    uint32_t granularity = MSC_MEDIA_PACKET_SIZE / blk_size;
+    uint32_t max_len = MSC_MAX_TRANSFER_SIZE / blk_size;
+    uint32_t opt_len = MSC_OPT_TRANSFER_SIZE / blk_size;
+
+    memset(page, 0U, INQUIRY_PAGEB0_LENGTH);
+
+    page[1] = INQUIRY_PAGE_BLOCK_LIMITS;
+    page[3] = INQUIRY_PAGEB0_LENGTH - 4U;
+
+    /* optimal transfer length granularity: one media packet */
+    page[6] = (uint8_t)(granularity >> 8U);
+    page[7] = (uint8_t)(granularity);
+
+    /* maximum transfer length */
+    page[8] = (uint8_t)(max_len >> 24U);
+    page[9] = (uint8_t)(max_len >> 16U);
+    page[10] = (uint8_t)(max_len >> 8U);
+    page[11] = (uint8_t)(max_len);
+
+    /* optimal transfer length */
+    page[12] = (uint8_t)(opt_len >> 24U);
+    page[13] = (uint8_t)(opt_len >> 16U);
+    page[14] = (uint8_t)(opt_len >> 8U);
+    page[15] = (uint8_t)(opt_len);
+}
+
 /*!
     \brief      process Read Capacity 10 command
     \param[in]  udev: pointer to USB device instance
@@ -318,6 +414,54 @@ static int8_t scsi_read_capacity10 (usb_core_driver *udev, uint8_t lun, uint8_t
     return 0;
 }
 
+/*!
+    \brief      process Service Action In (16) / Read Capacity 16 command
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  lun: logical unit number
+    \param[in]  params: command parameters
+    \param[out] none
+    \retval     status
+*/
+static int8_t scsi_read_capacity16 (usb_core_driver *udev, uint8_t lun, uint8_t *params)
+{
+    uint8_t i = 0U;
+    uint32_t alloc_len = 0U;
+    uint32_t blk_num = usbd_mem_fops->mem_block_len[lun] - 1U;
+    usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
+
+    /* Read Capacity 16 is the only supported service action */
+    if (SERVICE_ACTION_READ_CAPACITY16 != (params[1] & 0x1FU)) {
+        scsi_sense_code (udev, lun, ILLEGAL_REQUEST, INVALID_FIELED_IN_COMMAND);
+
+        return -1;
+    }
+
+    msc->scsi_blk_nbr[lun] = usbd_mem_fops->mem_block_len[lun];
+    msc->scsi_blk_size[lun] = usbd_mem_fops->mem_block_size[lun];
+
+    for (i = 0U; i < READ_CAPACITY16_DATA_LEN; i++) {
+        msc->bbb_data[i] = 0U;
+    }
+
+    /* the upper 32 bits of the last logical block address are always zero */
+    msc->bbb_data[4] = (uint8_t)(blk_num >> 24U);
+    msc->bbb_data[5] = (uint8_t)(blk_num >> 16U);
+    msc->bbb_data[6] = (uint8_t)(blk_num >> 8U);
+    msc->bbb_data[7] = (uint8_t)(blk_num);
+
+    msc->bbb_data[8] = (uint8_t)(msc->scsi_blk_size[lun] >> 24U);
+    msc->bbb_data[9] = (uint8_t)(msc->scsi_blk_size[lun] >> 16U);
+    msc->bbb_data[10] = (uint8_t)(msc->scsi_blk_size[lun] >> 8U);
+    msc->bbb_data[11] = (uint8_t)(msc->scsi_blk_size[lun]);
+
+    alloc_len = ((uint32_t)params[10] << 24U) | ((uint32_t)params[11] << 16U) | \
+                ((uint32_t)params[12] << 8U) |  params[13];
+
+    msc->bbb_datalen = (alloc_len < READ_CAPACITY16_DATA_LEN) ? alloc_len : READ_CAPACITY16_DATA_LEN;
+
+    return 0;
+}
+
 /*!
     \brief      process Read Format Capacity command
     \param[in]  udev: pointer to USB device instance
@@ -452,6 +596,11 @@ static inline int8_t scsi_start_stop_unit (usb_core_driver *udev, uint8_t lun, u
     msc->bbb_datalen = 0U;
     msc->scsi_disk_pop = 1U;
 
+    /* stop or eject, write back cached data */
+    if (0U == (params[4] & 0x01U)) {
+        return scsi_media_flush (udev, lun);
+    }
+
     return 0;
 }
 
@@ -473,14 +622,14 @@ static inline int8_t scsi_allow_medium_removal (usb_core_driver *udev, uint8_t l
 }
 
 /*!
-    \brief      process Read10 command
+    \brief      process Read10 and Read16 commands
     \param[in]  udev: pointer to USB device instance
     \param[in]  lun: logical unit number
     \param[in]  params: command parameters
     \param[out] none
     \retval     status
 */
-static int8_t scsi_read10 (usb_core_driver *udev, uint8_t lun, uint8_t *params)
+static int8_t scsi_read (usb_core_driver *udev, uint8_t lun, uint8_t *params)
 {
     usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
 
@@ -498,13 +647,22 @@ static int8_t scsi_read10 (usb_core_driver *udev, uint8_t lun, uint8_t *params)
             return -1;
         }
 
-        msc->scsi_blk_addr = (params[2] << 24U) | (params[3] << 16U) | \
-                             (params[4] << 8U) |  params[5];
+        if (scsi_rw_params (udev, lun, params) < 0) {
+            return -1; /* error */
+        }
 
-        msc->scsi_blk_len = (params[7] << 8U) | params[8];
+        /* a completion of the aborted command is still due */
+        if (0U != msc->bbb_media_busy) {
+            scsi_sense_code (udev, lun, NOT_READY, LOGICAL_UNIT_NOT_READY);
 
-        if (scsi_check_address_range (udev, lun, msc->scsi_blk_addr, (uint16_t)msc->scsi_blk_len) < 0) {
-            return -1; /* error */
+            return -1;
+        }
+
+        /* nothing to transfer, only the CSW is sent */
+        if (0U == msc->scsi_blk_len) {
+            msc->bbb_datalen = 0U;
+
+            return 0;
         }
 
         msc->bbb_state = BBB_DATA_IN;
@@ -518,6 +676,18 @@ static int8_t scsi_read10 (usb_core_driver *udev, uint8_t lun, uint8_t *params)
 
             return -1;
         }
+
+        msc->bbb_buf_head = 0U;
+        msc->bbb_buf_count = 0U;
+        msc->bbb_xfer_busy = 0U;
+        msc->bbb_media_err = 0U;
+    } else if (0U != msc->bbb_xfer_busy) {
+        /* the packet at the head has been sent */
+        msc->bbb_xfer_busy = 0U;
+        msc->bbb_buf_head = (uint8_t)((msc->bbb_buf_head + 1U) % MSC_MEDIA_BUF_NUM);
+        msc->bbb_buf_count--;
+    } else {
+        /* no operation */
     }
 
     msc->bbb_datalen = MSC_MEDIA_PACKET_SIZE;
@@ -526,14 +696,14 @@ static int8_t scsi_read10 (usb_core_driver *udev, uint8_t lun, uint8_t *params)
 }
 
 /*!
-    \brief      process Write10 command
+    \brief      process Write10 and Write16 commands
     \param[in]  udev: pointer to USB device instance
     \param[in]  lun: logical unit number
     \param[in]  params: command parameters
     \param[out] none
     \retval     status
 */
-static int8_t scsi_write10 (usb_core_driver *udev, uint8_t lun, uint8_t *params)
+static int8_t scsi_write (usb_core_driver *udev, uint8_t lun, uint8_t *params)
 {
     usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
 
@@ -559,16 +729,25 @@ static int8_t scsi_write10 (usb_core_driver *udev, uint8_t lun, uint8_t *params)
             return -1;
         }
 
-        msc->scsi_blk_addr = (params[2] << 24U) | (params[3] << 16U) | \
-                             (params[4] << 8U) |  params[5];
-
-        msc->scsi_blk_len = (params[7] << 8U) | params[8];
-
         /* check if LBA address is in the right range */
-        if (scsi_check_address_range (udev, lun, msc->scsi_blk_addr, (uint16_t)msc->scsi_blk_len) < 0) {
+        if (scsi_rw_params (udev, lun, params) < 0) {
             return -1; /* error */
         }
 
+        /* a completion of the aborted command is still due */
+        if (0U != msc->bbb_media_busy) {
+            scsi_sense_code (udev, lun, NOT_READY, LOGICAL_UNIT_NOT_READY);
+
+            return -1;
+        }
+
+        /* nothing to transfer, only the CSW is sent */
+        if (0U == msc->scsi_blk_len) {
+            msc->bbb_datalen = 0U;
+
+            return 0;
+        }
+
         msc->scsi_blk_addr *= msc->scsi_blk_size[lun];
         msc->scsi_blk_len  *= msc->scsi_blk_size[lun];
 
@@ -581,16 +760,22 @@ static int8_t scsi_write10 (usb_core_driver *udev, uint8_t lun, uint8_t *params)
 
         /* prepare endpoint to receive first data packet */
         msc->bbb_state = BBB_DATA_OUT;
-
-        usbd_ep_recev (udev, 
-                       MSC_OUT_EP, 
-                       msc->bbb_data, 
-                       USB_MIN (msc->scsi_blk_len, MSC_MEDIA_PACKET_SIZE));
+        msc->bbb_buf_head = 0U;
+        msc->bbb_buf_count = 0U;
+        msc->bbb_xfer_busy = 0U;
+        msc->bbb_media_err = 0U;
     } else { /* write process ongoing */
-        return scsi_process_write (udev, lun);
+        /* the OUT packet has been received */
+        uint32_t len = USB_MIN(msc->bbb_csw.dCSWDataResidue, MSC_MEDIA_PACKET_SIZE);
+
+        msc->bbb_xfer_busy = 0U;
+        msc->bbb_buf_count++;
+
+        /* case 12 : Ho = Do */
+        msc->bbb_csw.dCSWDataResidue -= len;
     }
 
-    return 0;
+    return scsi_process_write (udev, lun);
 }
 
 /*!
@@ -611,7 +796,7 @@ static int8_t scsi_verify10 (usb_core_driver *udev, uint8_t lun, uint8_t *params
         return -1; /* error, verify mode not supported*/
     }
 
-    if (scsi_check_address_range (udev, lun, msc->scsi_blk_addr, (uint16_t)msc->scsi_blk_len) < 0) {
+    if (scsi_check_address_range (udev, lun, msc->scsi_blk_addr, msc->scsi_blk_len) < 0) {
         return -1; /* error */
     }
 
@@ -620,6 +805,70 @@ static int8_t scsi_verify10 (usb_core_driver *udev, uint8_t lun, uint8_t *params
     return 0;
 }
 
+/*!
+    \brief      process Synchronize Cache command
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  lun: logical unit number
+    \param[in]  params: command parameters
+    \param[out] none
+    \retval     status
+*/
+static int8_t scsi_sync_cache (usb_core_driver *udev, uint8_t lun, uint8_t *params)
+{
+    usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
+
+    msc->bbb_datalen = 0U;
+
+    return scsi_media_flush (udev, lun);
+}
+
+/*!
+    \brief      get the block address and length of a Read/Write 10 or 16 command
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  lun: logical unit number
+    \param[in]  params: command parameters
+    \param[out] none
+    \retval     status
+*/
+static int8_t scsi_rw_params (usb_core_driver *udev, uint8_t lun, uint8_t *params)
+{
+    usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
+
+    if ((SCSI_READ16 == params[0]) || (SCSI_WRITE16 == params[0])) {
+        /* the media is addressed in bytes with 32 bits */
+        if (0U != (params[2] | params[3] | params[4] | params[5])) {
+            scsi_sense_code (udev, lun, ILLEGAL_REQUEST, ADDRESS_OUT_OF_RANGE);
+
+            return -1;
+        }
+
+        msc->scsi_blk_addr = ((uint32_t)params[6] << 24U) | ((uint32_t)params[7] << 16U) | \
+                             ((uint32_t)params[8] << 8U) |  params[9];
+
+        msc->scsi_blk_len = ((uint32_t)params[10] << 24U) | ((uint32_t)params[11] << 16U) | \
+                            ((uint32_t)params[12] << 8U) |  params[13];
+    } else {
+        msc->scsi_blk_addr = ((uint32_t)params[2] << 24U) | ((uint32_t)params[3] << 16U) | \
+                             ((uint32_t)params[4] << 8U) |  params[5];
+
+        msc->scsi_blk_len = ((uint32_t)params[7] << 8U) | params[8];
+    }
+
+    if (scsi_check_address_range (udev, lun, msc->scsi_blk_addr, msc->scsi_blk_len) < 0) {
+        return -1;
+    }
+
+    /* the media is addressed in bytes with 32 bits, so the last byte of the transfer
+       must stay below 4 GB (this also bounds the byte length of the CBW data) */
+    if ((msc->scsi_blk_addr + msc->scsi_blk_len) > (0xFFFFFFFFU / msc->scsi_blk_size[lun])) {
+        scsi_sense_code (udev, lun, ILLEGAL_REQUEST, ADDRESS_OUT_OF_RANGE);
+
+        return -1;
+    }
+
+    return 0;
+}
+
 /*!
     \brief      check address range
     \param[in]  udev: pointer to USB device instance
@@ -629,11 +878,11 @@ static int8_t scsi_verify10 (usb_core_driver *udev, uint8_t lun, uint8_t *params
     \param[out] none
     \retval     status
 */
-static inline int8_t scsi_check_address_range (usb_core_driver *udev, uint8_t lun, uint32_t blk_offset, uint16_t blk_nbr)
+static inline int8_t scsi_check_address_range (usb_core_driver *udev, uint8_t lun, uint32_t blk_offset, uint32_t blk_nbr)
 {
     usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
 
-    if ((blk_offset + blk_nbr) > msc->scsi_blk_nbr[lun]) {
+    if ((blk_nbr > msc->scsi_blk_nbr[lun]) || (blk_offset > (msc->scsi_blk_nbr[lun] - blk_nbr))) {
         scsi_sense_code (udev, lun, ILLEGAL_REQUEST, ADDRESS_OUT_OF_RANGE);
 
         return -1;
@@ -643,7 +892,7 @@ static inline int8_t scsi_check_address_range (usb_core_driver *udev, uint8_t lu
 }
 
 /*!
-    \brief      handle read process
+    \brief      handle read process, the IN endpoint is left unarmed (NAK) while no data is ready
     \param[in]  udev: pointer to USB device instance
     \param[in]  lun: logical unit number
     \param[out] none
@@ -653,71 +902,298 @@ static int8_t scsi_process_read (usb_core_driver *udev, uint8_t lun)
 {
     usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
 
+    uint32_t len = 0U;
+
+    for (;;) {
+        if (0U == msc->bbb_xfer_busy) {
+            if (msc->bbb_buf_count > 0U) {
+                len = USB_MIN(msc->bbb_csw.dCSWDataResidue, MSC_MEDIA_PACKET_SIZE);
+
+                usbd_ep_send (udev, MSC_IN_EP, &msc->bbb_data[msc->bbb_buf_head * MSC_MEDIA_PACKET_SIZE], len);
+
+                msc->bbb_xfer_busy = 1U;
+
+                /* case 6 : Hi = Di */
+                msc->bbb_csw.dCSWDataResidue -= len;
+
+                if (0U == msc->bbb_csw.dCSWDataResidue) {
+                    msc->bbb_state = BBB_LAST_DATA_IN;
+                }
+            } else if (0U != msc->bbb_media_err) {
+                scsi_sense_code(udev, lun, HARDWARE_ERROR, UNRECOVERED_READ_ERROR);
+
+                return -1;
+            } else {
+                /* no operation */
+            }
+        }
+
+        /* read ahead into the free buffers while a packet is on the bus */
+        if ((0U != msc->bbb_media_busy) || (0U != msc->bbb_media_err) ||
+            (msc->bbb_buf_count >= MSC_MEDIA_BUF_NUM) || (0U == msc->scsi_blk_len)) {
+            return 0;
+        }
+
+        if (scsi_media_start (udev, lun) < 0) {
+            msc->bbb_media_err = 1U;
+        }
+    }
+}
+
+/*!
+    \brief      handle write process, the OUT endpoint is left unarmed (NAK) while no buffer is free
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  lun: logical unit number
+    \param[out] none
+    \retval     status
+*/
+static int8_t scsi_process_write (usb_core_driver *udev, uint8_t lun)
+{
+    usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
+
+    uint8_t buf = 0U;
+
+    for (;;) {
+        if (0U == msc->bbb_xfer_busy) {
+            if (0U != msc->bbb_media_err) {
+                scsi_sense_code(udev, lun, HARDWARE_ERROR, WRITE_FAULT);
+
+                return -1;
+            }
+
+            /* receive the next packet while the previous ones are written to the media */
+            if ((msc->bbb_csw.dCSWDataResidue > 0U) && (msc->bbb_buf_count < MSC_MEDIA_BUF_NUM)) {
+                buf = (uint8_t)((msc->bbb_buf_head + msc->bbb_buf_count) % MSC_MEDIA_BUF_NUM);
+
+                msc->bbb_xfer_busy = 1U;
+
+                usbd_ep_recev (udev, 
+                               MSC_OUT_EP, 
+                               &msc->bbb_data[buf * MSC_MEDIA_PACKET_SIZE], 
+                               USB_MIN (msc->bbb_csw.dCSWDataResidue, MSC_MEDIA_PACKET_SIZE));
+            }
+        }
+
+        if ((0U != msc->bbb_media_busy) || (0U != msc->bbb_media_err)) {
+            return 0;
+        }
+
+        if (msc->bbb_buf_count > 0U) {
+            if (scsi_media_start (udev, lun) < 0) {
+                msc->bbb_media_err = 1U;
+            }
+        } else {
+            if ((0U == msc->bbb_xfer_busy) && (0U == msc->scsi_blk_len)) {
+                msc_bbb_csw_send (udev, CSW_CMD_PASSED);
+            }
+
+            return 0;
+        }
+    }
+}
+
+/*!
+    \brief      start the next media read into the first free buffer, or write the oldest received buffer
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  lun: logical unit number
+    \param[out] none
+    \retval     0 when done, 1 when the asynchronous operation is pending, negative on failure
+*/
+static int8_t scsi_media_start (usb_core_driver *udev, uint8_t lun)
+{
+    usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
+
+    int8_t status = 0;
+    uint8_t buf = msc->bbb_buf_head;
     uint32_t len = USB_MIN(msc->scsi_blk_len, MSC_MEDIA_PACKET_SIZE);
+    uint16_t blk_nbr = (uint16_t)(len / msc->scsi_blk_size[lun]);
 
-    if (usbd_mem_fops->mem_read(lun,
-                                msc->bbb_data, 
-                                msc->scsi_blk_addr, 
-                                (uint16_t)(len / msc->scsi_blk_size[lun])) < 0) {
-        scsi_sense_code(udev, lun, HARDWARE_ERROR, UNRECOVERED_READ_ERROR);
+    int8_t (*mem_async) (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done);
 
-        return -1; 
+    if ((uint8_t)BBB_DATA_OUT == msc->bbb_state) {
+        mem_async = usbd_mem_fops->mem_write_async;
+    } else {
+        buf = (uint8_t)((msc->bbb_buf_head + msc->bbb_buf_count) % MSC_MEDIA_BUF_NUM);
+        mem_async = usbd_mem_fops->mem_read_async;
     }
 
-    usbd_ep_send (udev, MSC_IN_EP, msc->bbb_data, len);
+    if (NULL != mem_async) {
+        msc_media_udev = udev;
+        msc->bbb_media_busy = 1U;
+        msc->bbb_media_submit = 1U;
 
-    msc->scsi_blk_addr += len;
-    msc->scsi_blk_len  -= len;
+        status = mem_async (lun, &msc->bbb_data[buf * MSC_MEDIA_PACKET_SIZE], msc->scsi_blk_addr, blk_nbr, scsi_media_done);
+
+        msc->bbb_media_submit = 0U;
+
+        if (status < 0) {
+            msc->bbb_media_busy = 0U;
+
+            return -1;
+        }
 
-    /* case 6 : Hi = Di */
-    msc->bbb_csw.dCSWDataResidue -= len;
+        if (0U != msc->bbb_media_busy) {
+            return 1;
+        }
+
+        /* completed before the submission returned */
+        status = msc->bbb_media_status;
+    } else if ((uint8_t)BBB_DATA_OUT == msc->bbb_state) {
+        status = usbd_mem_fops->mem_write (lun, &msc->bbb_data[buf * MSC_MEDIA_PACKET_SIZE], msc->scsi_blk_addr, blk_nbr);
+    } else {
+        status = usbd_mem_fops->mem_read (lun, &msc->bbb_data[buf * MSC_MEDIA_PACKET_SIZE], msc->scsi_blk_addr, blk_nbr);
+    }
 
-    if (0U == msc->scsi_blk_len) {
-        msc->bbb_state = BBB_LAST_DATA_IN;
+    if (status < 0) {
+        return -1;
     }
 
+    scsi_media_advance (msc, lun);
+
     return 0;
 }
 
 /*!
-    \brief      handle write process
+    \brief      write cached data to the media, an asynchronous flush still pending holds the
+                CSW back until scsi_media_done()
     \param[in]  udev: pointer to USB device instance
     \param[in]  lun: logical unit number
     \param[out] none
     \retval     status
 */
-static int8_t scsi_process_write (usb_core_driver *udev, uint8_t lun)
+static int8_t scsi_media_flush (usb_core_driver *udev, uint8_t lun)
 {
     usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
 
-    uint32_t len = USB_MIN(msc->scsi_blk_len, MSC_MEDIA_PACKET_SIZE);
+    int8_t status = 0;
+
+    if (NULL != usbd_mem_fops->mem_flush_async) {
+        /* case 9 : Hi > D0, case 4 : Ho > Dn, the CSW is held back without a data stage */
+        if (0U != msc->bbb_cbw.dCBWDataTransferLength) {
+            scsi_sense_code (udev, lun, ILLEGAL_REQUEST, INVALID_CDB);
+
+            return -1;
+        }
+
+        /* a completion of an aborted command is still due */
+        if (0U != msc->bbb_media_busy) {
+            scsi_sense_code (udev, lun, NOT_READY, LOGICAL_UNIT_NOT_READY);
+
+            return -1;
+        }
+
+        msc_media_udev = udev;
+        msc->bbb_media_busy = 1U;
+        msc->bbb_media_submit = 1U;
+
+        status = usbd_mem_fops->mem_flush_async (lun, scsi_media_done);
+
+        msc->bbb_media_submit = 0U;
 
-    if (usbd_mem_fops->mem_write (lun,
-                                  msc->bbb_data, 
-                                  msc->scsi_blk_addr, 
-                                  (uint16_t)(len / msc->scsi_blk_size[lun])) < 0) {
-        scsi_sense_code(udev, lun, HARDWARE_ERROR, WRITE_FAULT);
+        if (status < 0) {
+            msc->bbb_media_busy = 0U;
+        } else if (0U != msc->bbb_media_busy) {
+            /* no data to receive, scsi_process_write() sends the CSW once the flush is done */
+            msc->bbb_state = BBB_DATA_OUT;
+            msc->bbb_buf_count = 0U;
+            msc->bbb_xfer_busy = 0U;
+            msc->bbb_media_err = 0U;
+            msc->scsi_blk_len = 0U;
+
+            return 0;
+        } else {
+            /* completed before the submission returned */
+            status = msc->bbb_media_status;
+        }
+    } else if (NULL != usbd_mem_fops->mem_flush) {
+        status = usbd_mem_fops->mem_flush (lun);
+    } else {
+        /* no operation */
+    }
+
+    if (status < 0) {
+        scsi_sense_code (udev, lun, HARDWARE_ERROR, WRITE_FAULT);
 
         return -1;
     }
 
+    return 0;
+}
+
+/*!
+    \brief      account for a completed media operation
+    \param[in]  msc: pointer to MSC handler
+    \param[in]  lun: logical unit number
+    \param[out] none
+    \retval     none
+*/
+static void scsi_media_advance (usbd_msc_handler *msc, uint8_t lun)
+{
+    uint32_t len = USB_MIN(msc->scsi_blk_len, MSC_MEDIA_PACKET_SIZE);
+
+    /* a flush moves no data */
+    if (0U == len) {
+        return;
+    }
+
     msc->scsi_blk_addr += len;
     msc->scsi_blk_len  -= len;
 
-    /* case 12 : Ho = Do */
-    msc->bbb_csw.dCSWDataResidue -= len;
+    if ((uint8_t)BBB_DATA_OUT == msc->bbb_state) {
+        msc->bbb_buf_head = (uint8_t)((msc->bbb_buf_head + 1U) % MSC_MEDIA_BUF_NUM);
+        msc->bbb_buf_count--;
+    } else {
+        msc->bbb_buf_count++;
+    }
+}
 
-    if (0U == msc->scsi_blk_len) {
-        msc_bbb_csw_send (udev, CSW_CMD_PASSED);
+/*!
+    \brief      completion of an asynchronous media operation, call it at the USB interrupt
+                priority or with the USB interrupt disabled
+    \param[in]  lun: logical unit number
+    \param[in]  status: 0 on success, negative on failure
+    \param[out] none
+    \retval     none
+*/
+static void scsi_media_done (uint8_t lun, int8_t status)
+{
+    usb_core_driver *udev = msc_media_udev;
+    usbd_msc_handler *msc = (usbd_msc_handler *)udev->dev.class_data[USBD_MSC_INTERFACE];
+
+    int8_t ret = 0;
+
+    msc->bbb_media_status = status;
+    msc->bbb_media_busy = 0U;
+
+    /* scsi_media_start() handles a completion inside the submission */
+    if (0U != msc->bbb_media_submit) {
+        return;
+    }
+
+    if (status < 0) {
+        msc->bbb_media_err = 1U;
     } else {
-        /* prepare endpoint to receive next packet */
-        usbd_ep_recev (udev, 
-                       MSC_OUT_EP, 
-                       msc->bbb_data, 
-                       USB_MIN (msc->scsi_blk_len, MSC_MEDIA_PACKET_SIZE));
+        scsi_media_advance (msc, lun);
     }
 
-    return 0;
+    switch (msc->bbb_state) {
+    case BBB_DATA_IN:
+    case BBB_LAST_DATA_IN:
+        ret = scsi_process_read (udev, lun);
+        break;
+
+    case BBB_DATA_OUT:
+        ret = scsi_process_write (udev, lun);
+        break;
+
+    default:
+        /* the command was aborted */
+        break;
+    }
+
+    if (ret < 0) {
+        msc_bbb_csw_send (udev, CSW_CMD_FAILED);
+    }
 }
 
 /*!
@@ -278,7 +278,7 @@ static uint8_t* _usb_other_speed_config_desc_get (usb_core_driver *udev, uint8_t
 {
     (void)index;
 
-    *len = udev->dev.desc->other_speed_config_desc[2];
+    *len = udev->dev.desc->other_speed_config_desc[2] | (udev->dev.desc->other_speed_config_desc[3] << 8U);
 
     return udev->dev.desc->other_speed_config_desc;
 }
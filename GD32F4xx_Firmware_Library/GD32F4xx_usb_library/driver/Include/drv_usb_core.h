@@ -215,6 +215,7 @@ typedef enum _usb_pipe_status
     PIPE_BBERR,
     PIPE_REQOVR,
     PIPE_DTGERR,
+    PIPE_DMAERR,
 } usb_pipe_staus;
 
 typedef enum _usb_urb_state
@@ -163,6 +163,8 @@ __STATIC_INLINE void usb_rwkup_reset (usb_core_driver *udev)
 }
 
 /* function declarations */
+/* replace the FIFO sizes of usb_conf.h */
+void usb_devfifo_set (usb_core_enum core, uint16_t rx_size, const uint16_t *tx_size);
 /* initialize USB core registers for device mode */
 usb_status usb_devcore_init (usb_core_driver *udev);
 /* enable the USB device mode interrupts */
@@ -225,14 +225,50 @@ usb_status usb_txfifo_write (usb_core_regs *usb_regs,
                              uint8_t  fifo_num, 
                              uint16_t byte_count)
 {
-    uint32_t word_count = (byte_count + 3U) / 4U;
+    uint32_t word_count = byte_count / 4U;
+    uint32_t tail = byte_count & 0x03U;
+    uint32_t word = 0U, i;
 
     __IO uint32_t *fifo = usb_regs->DFIFO[fifo_num];
 
-    while (word_count-- > 0U) {
-        *fifo = *((__packed uint32_t *)src_buf);
+    if (0U == ((uint32_t)src_buf & 0x03U)) {
+        const uint32_t *src = (const uint32_t *)src_buf;
+
+        /* aligned buffer, eight words per loop */
+        while (word_count >= 8U) {
+            *fifo = src[0];
+            *fifo = src[1];
+            *fifo = src[2];
+            *fifo = src[3];
+            *fifo = src[4];
+            *fifo = src[5];
+            *fifo = src[6];
+            *fifo = src[7];
+
+            src += 8U;
+            word_count -= 8U;
+        }
+
+        while (word_count-- > 0U) {
+            *fifo = *src++;
+        }
+
+        src_buf = (uint8_t *)src;
+    } else {
+        while (word_count-- > 0U) {
+            *fifo = *((__packed uint32_t *)src_buf);
+
+            src_buf += 4U;
+        }
+    }
+
+    /* last partial word, do not read past the end of the buffer */
+    if (tail > 0U) {
+        for (i = 0U; i < tail; i++) {
+            word |= (uint32_t)src_buf[i] << (8U * i);
+        }
 
-        src_buf += 4U;
+        *fifo = word;
     }
 
     return USB_OK;
@@ -248,14 +284,50 @@ usb_status usb_txfifo_write (usb_core_regs *usb_regs,
 */
 void *usb_rxfifo_read (usb_core_regs *usb_regs, uint8_t *dest_buf, uint16_t byte_count)
 {
-    uint32_t word_count = (byte_count + 3U) / 4U;
+    uint32_t word_count = byte_count / 4U;
+    uint32_t tail = byte_count & 0x03U;
+    uint32_t word, i;
 
     __IO uint32_t *fifo = usb_regs->DFIFO[0];
 
-    while (word_count-- > 0U) {
-        *(__packed uint32_t *)dest_buf = *fifo;
+    if (0U == ((uint32_t)dest_buf & 0x03U)) {
+        uint32_t *dest = (uint32_t *)dest_buf;
+
+        /* aligned buffer, eight words per loop */
+        while (word_count >= 8U) {
+            dest[0] = *fifo;
+            dest[1] = *fifo;
+            dest[2] = *fifo;
+            dest[3] = *fifo;
+            dest[4] = *fifo;
+            dest[5] = *fifo;
+            dest[6] = *fifo;
+            dest[7] = *fifo;
+
+            dest += 8U;
+            word_count -= 8U;
+        }
+
+        while (word_count-- > 0U) {
+            *dest++ = *fifo;
+        }
+
+        dest_buf = (uint8_t *)dest;
+    } else {
+        while (word_count-- > 0U) {
+            *(__packed uint32_t *)dest_buf = *fifo;
 
-        dest_buf += 4U;
+            dest_buf += 4U;
+        }
+    }
+
+    /* the FIFO pops whole words, store only the bytes of the packet */
+    if (tail > 0U) {
+        word = *fifo;
+
+        for (i = 0U; i < tail; i++) {
+            *dest_buf++ = (uint8_t)(word >> (8U * i));
+        }
     }
 
     return ((void *)dest_buf);
@@ -46,6 +46,9 @@ static const uint8_t EP0_MAXLEN[4] = {
 
 #ifdef USB_FS_CORE
 
+/* USB Rx FIFO size */
+static uint16_t USBFS_RX_FIFO_SIZE = (uint16_t)RX_FIFO_FS_SIZE;
+
 /* USB endpoint Tx FIFO size */
 static uint16_t USBFS_TX_FIFO_SIZE[USBFS_MAX_EP_COUNT] = 
 {
@@ -59,6 +62,9 @@ static uint16_t USBFS_TX_FIFO_SIZE[USBFS_MAX_EP_COUNT] =
 
 #ifdef USB_HS_CORE
 
+/* USB Rx FIFO size */
+static uint16_t USBHS_RX_FIFO_SIZE = (uint16_t)RX_FIFO_HS_SIZE;
+
 uint16_t USBHS_TX_FIFO_SIZE[USBHS_MAX_EP_COUNT] = 
 {
     (uint16_t)TX0_FIFO_HS_SIZE,
@@ -71,6 +77,41 @@ uint16_t USBHS_TX_FIFO_SIZE[USBHS_MAX_EP_COUNT] =
 
 #endif /* USBHS_CORE */
 
+/*!
+    \brief      replace the FIFO sizes of usb_conf.h, used by the next usb_devcore_init()
+    \param[in]  core: USB core
+      \arg        USB_CORE_ENUM_HS: USB HS core
+      \arg        USB_CORE_ENUM_FS: USB FS core
+    \param[in]  rx_size: Rx FIFO size in words
+    \param[in]  tx_size: Tx FIFO sizes in words, one for each endpoint of the core
+    \param[out] none
+    \retval     none
+*/
+void usb_devfifo_set (usb_core_enum core, uint16_t rx_size, const uint16_t *tx_size)
+{
+    uint8_t i;
+
+#ifdef USB_FS_CORE
+    if (USB_CORE_ENUM_FS == core) {
+        USBFS_RX_FIFO_SIZE = rx_size;
+
+        for (i = 0U; i < USBFS_MAX_EP_COUNT; i++) {
+            USBFS_TX_FIFO_SIZE[i] = tx_size[i];
+        }
+    }
+#endif /* USB_FS_CORE */
+
+#ifdef USB_HS_CORE
+    if (USB_CORE_ENUM_HS == core) {
+        USBHS_RX_FIFO_SIZE = rx_size;
+
+        for (i = 0U; i < USBHS_MAX_EP_COUNT; i++) {
+            USBHS_TX_FIFO_SIZE[i] = tx_size[i];
+        }
+    }
+#endif /* USB_HS_CORE */
+}
+
 /*!
     \brief      initialize USB core registers for device mode
     \param[in]  udev: pointer to USB device
@@ -96,7 +137,7 @@ usb_status usb_devcore_init (usb_core_driver *udev)
         udev->regs.dr->DCFG |= USB_SPEED_INP_FULL;
 
         /* set Rx FIFO size */
-        usb_set_rxfifo(&udev->regs, RX_FIFO_FS_SIZE);
+        usb_set_rxfifo(&udev->regs, USBFS_RX_FIFO_SIZE);
 
         /* set endpoint 0 to 3's Tx FIFO length and RAM address */
         for (i = 0U; i < USBFS_MAX_EP_COUNT; i++) {
@@ -114,7 +155,7 @@ usb_status usb_devcore_init (usb_core_driver *udev)
         }
 
         /* Set Rx FIFO size */
-        usb_set_rxfifo(&udev->regs, RX_FIFO_HS_SIZE);
+        usb_set_rxfifo(&udev->regs, USBHS_RX_FIFO_SIZE);
 
         /* Set endpoint 0 to 6's TX FIFO length and RAM address */
         for (i = 0; i < USBHS_MAX_EP_COUNT; i++) {
@@ -44,6 +44,7 @@ static uint32_t usbd_int_reset                 (usb_core_driver *udev);
 static uint32_t usbd_int_enumfinish            (usb_core_driver *udev);
 static uint32_t usbd_int_suspend               (usb_core_driver *udev);
 static uint32_t usbd_emptytxfifo_write         (usb_core_driver *udev, uint32_t ep_num);
+static uint32_t usbd_dma_outcount              (usb_core_driver *udev, uint8_t ep_num);
 
 static const uint8_t USB_SPEED[4] = {
     [DSTAT_EM_HS_PHY_30MHZ_60MHZ] = (uint8_t)USB_SPEED_HIGH,
@@ -171,7 +172,6 @@ void usbd_isr (usb_core_driver *udev)
 uint32_t usbd_int_dedicated_ep1out (usb_core_driver *udev)
 {
     uint32_t oepintr = 0U;
-    uint32_t oeplen = 0U;
 
     oepintr = udev->regs.er_out[1]->DOEPINTF;
     oepintr &= udev->regs.dr->DOEP1INTEN;
@@ -182,12 +182,7 @@ uint32_t usbd_int_dedicated_ep1out (usb_core_driver *udev)
         udev->regs.er_out[1]->DOEPINTF = DOEPINTF_TF;
 
         if(USB_USE_DMA == udev->bp.transfer_mode){
-            usb_transc *transc = &udev->dev.transc_out[1];
-            uint32_t set_len = ((transc->xfer_len + transc->max_len - 1U) / transc->max_len) * transc->max_len;
-            oeplen = udev->regs.er_out[1]->DOEPLEN;
-
-            /* to do : handle more than one single max packet size packet */
-            udev->dev.transc_out[1].xfer_count = set_len - (oeplen & DEPLEN_TLEN);
+            udev->dev.transc_out[1].xfer_count = usbd_dma_outcount (udev, 1U);
         }
 
         /* rx complete */
@@ -234,6 +229,26 @@ uint32_t usbd_int_dedicated_ep1in (usb_core_driver *udev)
 
 #endif /* USB_HS_DEDICATED_EP1_ENABLED */
 
+/*!
+    \brief      get the number of bytes the DMA stored for a completed OUT transfer
+    \param[in]  udev: pointer to USB device instance
+    \param[in]  ep_num: endpoint identifier(0..7)
+    \param[out] none
+    \retval     received byte count
+*/
+static uint32_t usbd_dma_outcount (usb_core_driver *udev, uint8_t ep_num)
+{
+    usb_transc *transc = &udev->dev.transc_out[ep_num];
+    uint32_t set_len = transc->max_len;
+
+    /* same transfer size as programmed by usb_transc_outxfer() */
+    if ((0U != ep_num) && (0U != transc->xfer_len)) {
+        set_len = ((transc->xfer_len + transc->max_len - 1U) / transc->max_len) * transc->max_len;
+    }
+
+    return set_len - (udev->regs.er_out[ep_num]->DOEPLEN & DEPLEN_TLEN);
+}
+
 /*!
     \brief      indicates that an OUT endpoint has a pending interrupt
     \param[in]  udev: pointer to USB device instance
@@ -255,11 +270,7 @@ static uint32_t usbd_int_epout (usb_core_driver *udev)
                 udev->regs.er_out[ep_num]->DOEPINTF = DOEPINTF_TF;
 
                 if ((uint8_t)USB_USE_DMA == udev->bp.transfer_mode) {
-                    usb_transc *transc = &udev->dev.transc_out[ep_num];
-                    __IO uint32_t eplen = udev->regs.er_out[ep_num]->DOEPLEN;
-                    uint32_t set_len = ((transc->xfer_len + transc->max_len - 1U) / transc->max_len) * transc->max_len;
-
-                    udev->dev.transc_out[ep_num].xfer_count = set_len - (eplen & DEPLEN_TLEN);
+                    udev->dev.transc_out[ep_num].xfer_count = usbd_dma_outcount (udev, ep_num);
                 }
 
                 /* inform upper layer: data ready */
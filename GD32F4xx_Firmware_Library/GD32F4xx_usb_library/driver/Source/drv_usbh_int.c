@@ -149,6 +149,27 @@ static inline void usb_pp_halt (usb_core_driver *udev,
     udev->host.pipe[pp_num].pp_status = pp_status;
 }
 
+/*!
+    \brief      get the data toggle change of a completed pipe transfer
+    \param[in]  pp: pointer to the USB pipe
+    \param[in]  xfer_len: number of bytes moved by the transfer
+    \param[in]  xfer_req: number of bytes requested by the transfer
+    \param[out] none
+    \retval     1 if an odd number of packets was moved, otherwise 0
+*/
+static inline uint8_t usb_pp_toggle (usb_pipe *pp, uint32_t xfer_len, uint32_t xfer_req)
+{
+    /* in DMA mode a single transfer may move many packets */
+    uint32_t packet_count = (xfer_len + pp->ep.mps - 1U) / pp->ep.mps;
+
+    /* a transfer of no data, or an IN transfer of full packets ended early by a ZLP, moved one more packet */
+    if ((0U == xfer_len) || ((xfer_len < xfer_req) && (0U == xfer_len % pp->ep.mps))) {
+        packet_count++;
+    }
+
+    return (uint8_t)(packet_count & 0x01U);
+}
+
 /*!
     \brief      handle the host port interrupt
     \param[in]  udev: pointer to USB device instance
@@ -311,7 +332,11 @@ static uint32_t usbh_int_pipe_in (usb_core_driver *udev, uint32_t pp_num)
         case USB_EPTYPE_BULK:
             usb_pp_halt (udev, (uint8_t)pp_num, HCHINTF_NAK, PIPE_XF);
 
-            pp->data_toggle_in ^= 1U;
+            if ((uint8_t)USB_USE_DMA == udev->bp.transfer_mode) {
+                pp->data_toggle_in ^= usb_pp_toggle (pp, udev->host.backup_xfercount[pp_num], pp->xfer_len);
+            } else {
+                pp->data_toggle_in ^= 1U;
+            }
             break;
 
         case USB_EPTYPE_INTR:
@@ -343,6 +368,11 @@ static uint32_t usbh_int_pipe_in (usb_core_driver *udev, uint32_t pp_num)
             pp->data_toggle_in ^= 1U;
             break;
 
+        case PIPE_DMAERR:
+            pp->err_count = 0U;
+            pp->urb_state = URB_ERROR;
+            break;
+
         case PIPE_IDLE:
         case PIPE_HALTED:
         case PIPE_NAK:
@@ -357,6 +387,9 @@ static uint32_t usbh_int_pipe_in (usb_core_driver *udev, uint32_t pp_num)
         }
 
         pp_reg->HCHINTF = HCHINTF_CH;
+    } else if (intr_pp & HCHINTF_DMAER) {
+        /* the AHB access of the DMA failed, retrying does not help */
+        usb_pp_halt (udev, (uint8_t)pp_num, HCHINTF_DMAER, PIPE_DMAERR);
     } else if (intr_pp & HCHINTF_USBER) {
         pp->err_count++;
         usb_pp_halt (udev, (uint8_t)pp_num, HCHINTF_USBER, PIPE_TRACERR);
@@ -421,6 +454,8 @@ static uint32_t usbh_int_pipe_out (usb_core_driver *udev, uint32_t pp_num)
         pp_reg->HCHINTF = HCHINTF_NAK;
     } else if (intr_pp & HCHINTF_REQOVR) {
         usb_pp_halt (udev, (uint8_t)pp_num, HCHINTF_REQOVR, PIPE_REQOVR);
+    } else if (intr_pp & HCHINTF_DMAER) {
+        usb_pp_halt (udev, (uint8_t)pp_num, HCHINTF_DMAER, PIPE_DMAERR);
     } else if (intr_pp & HCHINTF_TF) {
         pp->err_count = 0U;
         usb_pp_halt (udev, (uint8_t)pp_num, HCHINTF_TF, PIPE_XF);
@@ -463,7 +498,11 @@ static uint32_t usbh_int_pipe_out (usb_core_driver *udev, uint32_t pp_num)
             pp->urb_state = URB_DONE;
 
             if ((uint8_t)USB_EPTYPE_BULK == ((pp_reg->HCHCTL & HCHCTL_EPTYPE) >> 18U)) {
-                pp->data_toggle_out ^= 1U; 
+                if ((uint8_t)USB_USE_DMA == udev->bp.transfer_mode) {
+                    pp->data_toggle_out ^= usb_pp_toggle (pp, pp->xfer_len, pp->xfer_len);
+                } else {
+                    pp->data_toggle_out ^= 1U;
+                }
             }
             break;
 
@@ -474,7 +513,11 @@ static uint32_t usbh_int_pipe_out (usb_core_driver *udev, uint32_t pp_num)
             pp->urb_state = URB_DONE;
 
             if ((uint8_t)USB_EPTYPE_BULK == ((pp_reg->HCHCTL & HCHCTL_EPTYPE) >> 18U)) {
-                pp->data_toggle_out ^= 1U; 
+                if ((uint8_t)USB_USE_DMA == udev->bp.transfer_mode) {
+                    pp->data_toggle_out ^= usb_pp_toggle (pp, pp->xfer_len, pp->xfer_len);
+                } else {
+                    pp->data_toggle_out ^= 1U;
+                }
             }
             break;
 
@@ -489,6 +532,11 @@ static uint32_t usbh_int_pipe_out (usb_core_driver *udev, uint32_t pp_num)
             }
             break;
 
+        case PIPE_DMAERR:
+            pp->err_count = 0U;
+            pp->urb_state = URB_ERROR;
+            break;
+
         case PIPE_IDLE:
         case PIPE_HALTED:
         case PIPE_BBERR:
@@ -0,0 +1,331 @@
+/*!
+    \file    audio_fb_sim.c
+    \brief   host simulation of the speaker feedback loop with drifting clocks, built with
+             USE_USB_AD_SRC it runs the sample rate converter behind the codec DMA refill hook
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+/* the class is built into the simulation to reach its static handlers */
+#include "audio_core.c"
+
+#include "tone_fit.h"
+
+#include <stdio.h>
+
+#define SIM_SECONDS                  1000U
+#define SIM_FRAMES                   (SIM_SECONDS * 1000U)
+#define SIM_FB_PERIOD                (1U << FEEDBACK_IN_INTERVAL)
+#define SIM_TONE                     997U       /* host test tone in Hz, repeats every second */
+#define SIM_CAPTURE                  65536U     /* DAC frames analysed at the end of a case */
+#define SIM_WINDOW                   4800U      /* analysis window, the fit tracks slow frequency wander */
+
+typedef struct {
+    int32_t dac_ppm;                 /* DAC clock error against the USB frame clock */
+    uint8_t use_feedback;            /* the host follows the feedback endpoint */
+} sim_case;
+
+typedef struct {
+    uint32_t underruns;              /* DAC periods that found the ring short */
+    uint32_t dropped;                /* packets received into the drop buffer */
+    uint32_t fill_min;               /* ring fill level range once playing, in bytes */
+    uint32_t fill_max;
+    uint32_t fb_hz;                  /* last feedback value in Hz */
+    int32_t src_min;                 /* converter ratio deviation from 1 in the second half, in ppm */
+    int32_t src_max;
+    double thdn;                     /* THD+N of the DAC output at the end */
+} sim_result;
+
+static usb_core_driver sim_udev;
+static uint8_t *sim_rx_buf = NULL;
+static uint8_t sim_playing = 0U;
+static int16_t sim_tone[USBD_SPEAKER_FREQ];
+
+/* USB core stubs, the receive buffer is remembered for the next host packet */
+uint32_t usbd_ep_setup (usb_core_driver *udev, const usb_desc_ep *ep_desc) { return 0U; }
+uint32_t usbd_ep_clear (usb_core_driver *udev, uint8_t ep_addr) { return 0U; }
+uint32_t usbd_ep_send (usb_core_driver *udev, uint8_t ep_addr, uint8_t *pbuf, uint32_t len) { return 0U; }
+uint32_t usbd_fifo_flush (usb_core_driver *udev, uint8_t ep_addr) { return 0U; }
+usb_status usb_txfifo_flush (usb_core_regs *usb_regs, uint8_t fifo_num) { return USB_OK; }
+
+uint32_t usbd_ep_recev (usb_core_driver *udev, uint8_t ep_addr, uint8_t *pbuf, uint32_t len)
+{
+    sim_rx_buf = pbuf;
+
+    return 0U;
+}
+
+#ifdef USE_USB_AD_SRC
+
+static uint32_t sim_dma_pos = 0U;
+static uint8_t sim_dma_half = AD_OUT_HALF_FIRST;
+static uint8_t sim_capturing = 0U;
+static uint32_t sim_capture_len = 0U;
+static uint64_t sim_capture_step = 0U;
+static int16_t sim_capture[SIM_CAPTURE * SPEAKER_OUT_CHANNEL_NBR];
+
+/* codec stubs below the output interface, the DAC starts on the play command */
+void codec_gpio_init (void) { }
+void codec_audio_interface_init (uint32_t audio_freq) { }
+void codec_i2s_dma_init (void) { }
+void audio_pause_resume (uint32_t cmd, uint32_t addr, uint32_t size) { }
+void audio_stop (void) { sim_playing = 0U; }
+void audio_play (uint32_t addr, uint32_t size) { sim_playing = 1U; }
+
+/* the output interface is built in for its DMA refill hook */
+#include "audio_out_itf.c"
+
+#else
+
+/* audio output stubs, the DAC starts draining the ring on the play command */
+static uint8_t sim_out_init (uint32_t audio_freq, uint32_t volume) { return AD_OK; }
+static uint8_t sim_out_deinit (void) { return AD_OK; }
+
+static uint8_t sim_out_cmd (uint8_t *pbuf, uint32_t size, uint8_t cmd)
+{
+    sim_playing = (AD_CMD_PLAY == cmd) ? 1U : sim_playing;
+
+    return AD_OK;
+}
+
+audio_fops_struct audio_out_fops = {
+    sim_out_init,
+    sim_out_deinit,
+    sim_out_cmd
+};
+
+#endif /* USE_USB_AD_SRC */
+
+/*!
+    \brief      drain the ring at the DAC rate for one USB frame
+    \param[in]  frames: sample frames the DAC plays in this frame
+    \param[out] res: simulation result
+    \retval     none
+*/
+static void sim_dac_play (uint32_t frames, sim_result *res)
+{
+#ifdef USE_USB_AD_SRC
+    uint32_t half = sizeof(audio_handler.src_out_buff) / 2U / AD_OUT_FRAME_SIZE;
+
+    /* the DMA plays the converter output circularly and refills each half it leaves */
+    for (sim_dma_pos += frames; sim_dma_pos >= half; sim_dma_pos -= half) {
+        if (audio_out_fill() < ((half + 4U) * AD_OUT_FRAME_SIZE)) {
+            res->underruns++;
+        }
+
+        audio_out_dma_refill(sim_dma_half);
+
+        /* the halves are played in the order they are refilled */
+        if (sim_capturing && ((sim_capture_len + half) <= SIM_CAPTURE)) {
+            memcpy(&sim_capture[sim_capture_len * SPEAKER_OUT_CHANNEL_NBR], \
+                   &audio_handler.src_out_buff[sim_dma_half * half * SPEAKER_OUT_CHANNEL_NBR], half * AD_OUT_FRAME_SIZE);
+            sim_capture_len += half;
+            sim_capture_step += audio_handler.src.step;
+        }
+
+        sim_dma_half = (AD_OUT_HALF_FIRST == sim_dma_half) ? AD_OUT_HALF_SECOND : AD_OUT_HALF_FIRST;
+    }
+#else
+    uint32_t fill = audio_out_fill();
+    uint32_t len = frames * AD_OUT_FRAME_SIZE;
+
+    if (fill < len) {
+        res->underruns++;
+        len = fill;
+    }
+
+    audio_handler.isoc_out_rdptr += len;
+
+    if (audio_handler.isoc_out_rdptr >= (audio_handler.isoc_out_buff + TOTAL_OUT_BUF_SIZE)) {
+        audio_handler.isoc_out_rdptr -= TOTAL_OUT_BUF_SIZE;
+    }
+#endif /* USE_USB_AD_SRC */
+}
+
+/*!
+    \brief      run one clock drift case
+    \param[in]  c: simulated case
+    \param[out] res: simulation result
+    \retval     none
+*/
+static void sim_run (const sim_case *c, sim_result *res)
+{
+    usb_req req = {0};
+    uint32_t frame, fb, len, i, host_pos = 0U;
+#ifdef USE_USB_AD_SRC
+    int32_t ppm;
+    double w, thdn;
+#endif /* USE_USB_AD_SRC */
+    uint64_t host_acc = 0U, dac_acc = 0U;
+    uint64_t dac_step = ((uint64_t)USBD_SPEAKER_FREQ << 32U) / 1000U;
+
+    memset(res, 0, sizeof(sim_result));
+    res->fill_min = TOTAL_OUT_BUF_SIZE;
+    res->src_min = INT32_MAX;
+    res->src_max = INT32_MIN;
+
+    dac_step += (uint64_t)(((int64_t)dac_step * c->dac_ppm) / 1000000);
+
+    sim_playing = 0U;
+#ifdef USE_USB_AD_SRC
+    sim_dma_pos = 0U;
+    sim_dma_half = AD_OUT_HALF_FIRST;
+    sim_capturing = 0U;
+    sim_capture_len = 0U;
+    sim_capture_step = 0U;
+#endif /* USE_USB_AD_SRC */
+    sim_udev.dev.class_core = &usbd_audio_cb;
+
+    audio_init(&sim_udev, 0U);
+
+    req.wValue = 1U;
+    audio_set_intf(&sim_udev, &req);
+
+    fb = AD_FEEDBACK_NOMINAL;
+
+    for (frame = 0U; frame < SIM_FRAMES; frame++) {
+        audio_sof(&sim_udev);
+
+        /* the host sends the feedback rate, or the nominal rate when it ignores the feedback */
+        host_acc += (c->use_feedback) ? fb : AD_FEEDBACK_NOMINAL;
+        len = (uint32_t)(host_acc >> 14U);
+        host_acc -= (uint64_t)len << 14U;
+        len *= AD_OUT_FRAME_SIZE;
+
+        if (sim_rx_buf == audio_handler.usb_rx_buffer) {
+            res->dropped++;
+        }
+
+        for (i = 0U; i < len; i += AD_OUT_FRAME_SIZE) {
+            ((int16_t *)&sim_rx_buf[i])[0] = sim_tone[host_pos];
+            ((int16_t *)&sim_rx_buf[i])[1] = sim_tone[host_pos];
+            host_pos = (host_pos + 1U) % USBD_SPEAKER_FREQ;
+        }
+
+        sim_udev.dev.transc_out[EP_ID(AD_OUT_EP)].xfer_count = len;
+        audio_data_out(&sim_udev, EP_ID(AD_OUT_EP));
+
+        if (sim_playing) {
+            dac_acc += dac_step;
+            sim_dac_play((uint32_t)(dac_acc >> 32U), res);
+            dac_acc &= 0xFFFFFFFFU;
+
+            len = audio_out_fill();
+            res->fill_min = (len < res->fill_min) ? len : res->fill_min;
+            res->fill_max = (len > res->fill_max) ? len : res->fill_max;
+        }
+
+#ifdef USE_USB_AD_SRC
+        if (frame >= (SIM_FRAMES / 2U)) {
+            ppm = (int32_t)(((int64_t)audio_handler.src.step - (int64_t)AD_SRC_ONE) * 1000000 / (int64_t)AD_SRC_ONE);
+            res->src_min = (ppm < res->src_min) ? ppm : res->src_min;
+            res->src_max = (ppm > res->src_max) ? ppm : res->src_max;
+        }
+
+        /* record the DAC output over the last frames of the case */
+        sim_capturing = (frame >= (SIM_FRAMES - (SIM_CAPTURE / (USBD_SPEAKER_FREQ / 1000U)) - 100U)) ? 1U : 0U;
+#endif /* USE_USB_AD_SRC */
+
+        /* the host polls the feedback endpoint once per refresh period */
+        if ((SIM_FB_PERIOD - 1U) == (frame % SIM_FB_PERIOD)) {
+            fb = (uint32_t)audio_handler.feedback_freq[0] | ((uint32_t)audio_handler.feedback_freq[1] << 8U) | \
+                 ((uint32_t)audio_handler.feedback_freq[2] << 16U);
+
+            audio_data_in(&sim_udev, EP_ID(AD_FEEDBACK_IN_EP));
+        }
+    }
+
+    res->fb_hz = audio_handler.actual_freq;
+#ifdef USE_USB_AD_SRC
+    /* the converter raises the tone by its mean ratio over the recording, the worst window counts */
+    w = 2.0 * M_PI * SIM_TONE / USBD_SPEAKER_FREQ * \
+        ((double)sim_capture_step / ((double)AD_SRC_ONE * (sim_capture_len / (SPEAKER_OUT_PACKET / 2U / SPEAKER_OUT_CHANNEL_NBR))));
+    res->thdn = -200.0;
+
+    for (i = 0U; (i + SIM_WINDOW) <= sim_capture_len; i += SIM_WINDOW) {
+        thdn = tone_thdn(&sim_capture[i * SPEAKER_OUT_CHANNEL_NBR], SPEAKER_OUT_CHANNEL_NBR, SIM_WINDOW, w, 2e-3);
+        res->thdn = (thdn > res->thdn) ? thdn : res->thdn;
+    }
+#endif /* USE_USB_AD_SRC */
+}
+
+int main (void)
+{
+#ifdef USE_USB_AD_SRC
+    /* the converter has to absorb the drift of hosts that ignore the feedback */
+    static const sim_case cases[] = {
+        {    0, 0U }, {  300, 0U }, { -300, 0U }, { 2000, 0U }, { -2000, 0U },
+        {  300, 1U }, { -300, 1U }
+    };
+#else
+    static const sim_case cases[] = {
+        {    0, 1U }, {  300, 1U }, { -300, 1U }, { 2000, 1U }, { -2000, 1U },
+        {  300, 0U }, { -300, 0U }
+    };
+#endif /* USE_USB_AD_SRC */
+
+    sim_result res;
+    uint32_t i, fails = 0U;
+
+    for (i = 0U; i < USBD_SPEAKER_FREQ; i++) {
+        sim_tone[i] = (int16_t)lrint(32767.0 * 0.9 * sin(2.0 * M_PI * SIM_TONE * i / USBD_SPEAKER_FREQ));
+    }
+
+    printf("ring %u bytes, %u s per case\n", (unsigned)TOTAL_OUT_BUF_SIZE, (unsigned)SIM_SECONDS);
+    printf("dac ppm  feedback  underruns  dropped  fill min/max (%%)  feedback Hz");
+#ifdef USE_USB_AD_SRC
+    printf("  ratio ppm      THD+N dB");
+#endif /* USE_USB_AD_SRC */
+    printf("\n");
+
+    for (i = 0U; i < (sizeof(cases) / sizeof(cases[0])); i++) {
+        sim_run(&cases[i], &res);
+
+        printf("%7d  %8s  %9u  %7u  %5.1f / %5.1f     %5u", (int)cases[i].dac_ppm, cases[i].use_feedback ? "on" : "off",
+               (unsigned)res.underruns, (unsigned)res.dropped,
+               100.0 * res.fill_min / TOTAL_OUT_BUF_SIZE, 100.0 * res.fill_max / TOTAL_OUT_BUF_SIZE, (unsigned)res.fb_hz);
+#ifdef USE_USB_AD_SRC
+        printf("        %5d..%-5d  %6.1f", (int)res.src_min, (int)res.src_max, res.thdn);
+#endif /* USE_USB_AD_SRC */
+        printf("\n");
+
+        /* with the feedback honoured or the converter running the ring must never run dry or overflow */
+#ifdef USE_USB_AD_SRC
+        if ((0U != res.underruns) || (0U != res.dropped)) {
+#else
+        if (cases[i].use_feedback && ((0U != res.underruns) || (0U != res.dropped))) {
+#endif /* USE_USB_AD_SRC */
+            fails++;
+        }
+    }
+
+    return (0U == fails) ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+/*!
+    \file    audio_src_bench.c
+    \brief   host benchmark of the audio sample rate converter
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+/* the compiler intrinsics go first, CMSIS redefines names they use */
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define BENCH_CYCLES()           __rdtsc()
+#else
+    #define BENCH_CYCLES()           0ULL
+#endif
+
+#include "audio_src.h"
+#include "tone_fit.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RATE                   48000.0
+#define BENCH_LEVEL                  0.9        /* tone amplitude relative to full scale */
+#define BENCH_CHUNK                  48U        /* output frames per DMA half buffer */
+#define BENCH_SETTLE                 64U        /* output frames skipped before the analysis */
+#define BENCH_FRAMES                 65536U     /* output frames analysed */
+#define BENCH_SPEED_FRAMES           (1U << 22U)
+#define BENCH_PASSBAND               18000.0    /* 0.375 fs, the documented passband of the filter */
+#define BENCH_THDN_MAX               -75.0
+#define BENCH_GAIN_MAX               0.1        /* dB, the passband ripple allowed */
+
+#define BENCH_IN_FRAMES              (((BENCH_SETTLE + BENCH_FRAMES) * 101U) / 100U + 16U)
+
+static int16_t bench_in[BENCH_IN_FRAMES * AD_SRC_CHANNELS];
+static int16_t bench_out[(BENCH_SETTLE + BENCH_FRAMES) * AD_SRC_CHANNELS];
+static uint32_t fails = 0U;
+
+/*!
+    \brief      convert the test input at a fixed ratio, one DMA half buffer at a time
+    \param[in]  src: pointer to converter instance
+    \param[in]  out_frames: output frames to produce
+    \param[out] none
+    \retval     input frames consumed
+*/
+static uint32_t bench_convert (audio_src_struct *src, uint32_t out_frames)
+{
+    uint32_t in_pos = 0U, done = 0U, n, in_frames;
+
+    while (done < out_frames) {
+        n = (out_frames - done) < BENCH_CHUNK ? (out_frames - done) : BENCH_CHUNK;
+        in_frames = BENCH_IN_FRAMES - in_pos;
+
+        done += audio_src_process(src, &bench_in[in_pos * AD_SRC_CHANNELS], &in_frames, \
+                                  &bench_out[done * AD_SRC_CHANNELS], n);
+        in_pos += in_frames;
+    }
+
+    return in_pos;
+}
+
+/*!
+    \brief      gain of the converter at the tone, from the power of the first channel
+    \param[in]  none
+    \param[out] none
+    \retval     gain in dB
+*/
+static double bench_gain (void)
+{
+    const int16_t *x = &bench_out[BENCH_SETTLE * AD_SRC_CHANNELS];
+    double power = 0.0;
+    uint32_t i;
+
+    for (i = 0U; i < BENCH_FRAMES; i++) {
+        power += (double)x[i * AD_SRC_CHANNELS] * x[i * AD_SRC_CHANNELS];
+    }
+
+    return 10.0 * log10(2.0 * power / BENCH_FRAMES) - 20.0 * log10(32767.0 * BENCH_LEVEL);
+}
+
+/*!
+    \brief      measure the quality of one tone at one conversion ratio
+    \param[in]  tone: input tone in Hz
+    \param[in]  ppm: ratio deviation from 1 in parts per million
+    \param[out] none
+    \retval     none
+*/
+static void bench_quality (double tone, int32_t ppm)
+{
+    audio_src_struct src;
+    uint32_t i, ch;
+    double w = 2.0 * M_PI * tone / BENCH_RATE;
+    double thdn, gain;
+
+    for (i = 0U; i < BENCH_IN_FRAMES; i++) {
+        for (ch = 0U; ch < AD_SRC_CHANNELS; ch++) {
+            bench_in[i * AD_SRC_CHANNELS + ch] = (int16_t)lrint(32767.0 * BENCH_LEVEL * sin(w * i));
+        }
+    }
+
+    audio_src_init(&src, 0U);
+    src.step = (uint32_t)((int32_t)AD_SRC_ONE + (int32_t)(((int64_t)ppm << 24) / 1000000));
+
+    bench_convert(&src, BENCH_SETTLE + BENCH_FRAMES);
+
+    /* an output frame advances the input by step, which raises the tone by the same ratio */
+    thdn = tone_thdn(&bench_out[BENCH_SETTLE * AD_SRC_CHANNELS], AD_SRC_CHANNELS, BENCH_FRAMES, w * src.step / AD_SRC_ONE, 0.0);
+    gain = bench_gain();
+
+    /* past the passband the tone is attenuated, its THD+N is still checked */
+    if ((thdn > BENCH_THDN_MAX) || ((tone <= BENCH_PASSBAND) && (fabs(gain) > BENCH_GAIN_MAX))) {
+        fails++;
+    }
+
+    printf("%8.0f  %6d  %8.1f  %7.2f\n", tone, (int)ppm, thdn, gain);
+}
+
+/*!
+    \brief      measure the conversion speed per output frame
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void bench_speed (void)
+{
+    audio_src_struct src;
+    struct timespec t0, t1;
+    uint64_t c0, c1;
+    uint32_t i;
+    double ns;
+
+    audio_src_init(&src, 0U);
+    src.step = AD_SRC_ONE + (AD_SRC_ONE / 1000U);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    c0 = BENCH_CYCLES();
+
+    for (i = 0U; i < (BENCH_SPEED_FRAMES / BENCH_FRAMES); i++) {
+        src.phase = 0U;
+        bench_convert(&src, BENCH_FRAMES);
+    }
+
+    c1 = BENCH_CYCLES();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / BENCH_SPEED_FRAMES;
+
+    printf("%u channels: %.1f ns, %.1f TSC cycles per output frame\n", (unsigned)AD_SRC_CHANNELS,
+           ns, (double)(c1 - c0) / BENCH_SPEED_FRAMES);
+}
+
+int main (void)
+{
+    static const double tones[] = { 997.0, 5000.0, 10000.0, 15000.0, 18000.0, 20000.0 };
+    static const int32_t ratios[] = { 0, 1000, 5000, -5000 };
+    uint32_t i, j;
+
+    printf("    tone     ppm  THD+N dB  gain dB\n");
+
+    for (i = 0U; i < (sizeof(tones) / sizeof(tones[0])); i++) {
+        for (j = 0U; j < (sizeof(ratios) / sizeof(ratios[0])); j++) {
+            bench_quality(tones[i], ratios[j]);
+        }
+    }
+
+    bench_speed();
+
+    printf("%s\n", (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+/*!
+    \file    tone_fit.h
+    \brief   THD+N of a recorded test tone, shared by the audio host tests
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef TONE_FIT_H
+#define TONE_FIT_H
+
+#include <math.h>
+#include <stdint.h>
+
+/*!
+    \brief      fit a*cos(wi) + b*sin(wi) + c to a recorded tone by least squares
+    \param[in]  x: first sample of the tone
+    \param[in]  stride: distance between two samples of the channel
+    \param[in]  n: number of samples
+    \param[in]  w: tone frequency in radians per sample
+    \param[out] none
+    \retval     residual power relative to the power of the fitted tone
+*/
+static double tone_fit (const int16_t *x, uint32_t stride, uint32_t n, double w)
+{
+    double scc = 0.0, sss = 0.0, scs = 0.0, sc = 0.0, ss = 0.0, sy = 0.0, syc = 0.0, sys = 0.0;
+    double a, b, c, det, e, sig = 0.0, res = 0.0;
+    uint32_t i;
+
+    for (i = 0U; i < n; i++) {
+        double co = cos(w * i), si = sin(w * i), y = x[i * stride];
+
+        scc += co * co; sss += si * si; scs += co * si; sc += co; ss += si;
+        sy += y; syc += y * co; sys += y * si;
+    }
+
+    /* solve the 3x3 normal equations by Cramer's rule */
+    det = scc * (sss * n - ss * ss) - scs * (scs * n - ss * sc) + sc * (scs * ss - sss * sc);
+    a = (syc * (sss * n - ss * ss) - scs * (sys * n - ss * sy) + sc * (sys * ss - sss * sy)) / det;
+    b = (scc * (sys * n - ss * sy) - syc * (scs * n - ss * sc) + sc * (scs * sy - sys * sc)) / det;
+    c = (scc * (sss * sy - sys * ss) - scs * (scs * sy - sys * sc) + syc * (scs * ss - sss * sc)) / det;
+
+    for (i = 0U; i < n; i++) {
+        double fit = a * cos(w * i) + b * sin(w * i);
+
+        e = x[i * stride] - fit - c;
+        sig += fit * fit;
+        res += e * e;
+    }
+
+    return res / sig;
+}
+
+/*!
+    \brief      THD+N of a recorded tone, the residual after the best sine fit
+    \param[in]  x: first sample of the tone
+    \param[in]  stride: distance between two samples of the channel
+    \param[in]  n: number of samples
+    \param[in]  w: expected tone frequency in radians per sample
+    \param[in]  span: relative frequency range searched around w, 0 when w is exact
+    \param[out] none
+    \retval     THD+N in dB relative to the tone
+*/
+static double tone_thdn (const int16_t *x, uint32_t stride, uint32_t n, double w, double span)
+{
+    double lo = w * (1.0 - span), hi = w * (1.0 + span), m1, m2;
+    uint32_t i;
+
+    /* golden section search for the frequency with the smallest residual */
+    for (i = 0U; (span > 0.0) && (i < 60U); i++) {
+        m1 = hi - (hi - lo) * 0.6180339887;
+        m2 = lo + (hi - lo) * 0.6180339887;
+
+        if (tone_fit(x, stride, n, m1) < tone_fit(x, stride, n, m2)) {
+            hi = m2;
+        } else {
+            lo = m1;
+        }
+    }
+
+    return 10.0 * log10(tone_fit(x, stride, n, (lo + hi) / 2.0));
+}
+
+#endif /* TONE_FIT_H */
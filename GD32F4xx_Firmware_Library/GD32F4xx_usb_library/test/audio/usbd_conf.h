@@ -0,0 +1,94 @@
+/*!
+    \file    usbd_conf.h
+    \brief   USB device configuration of the audio speaker tests
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef __USBD_CONF_H
+#define __USBD_CONF_H
+
+#include "usb_conf.h"
+
+#define USBD_CFG_MAX_NUM                          1U
+#define USBD_ITF_MAX_NUM                          2U
+
+#define USB_STR_DESC_MAX_SIZE                     64U
+#define USB_STRING_COUNT                          4U
+
+#define USB_FS_EP0_MAX_LEN                        64U
+
+#define AD_IN_EP                                  0x81U
+#define AD_OUT_EP                                 0x01U
+#define AD_FEEDBACK_IN_EP                         0x82U
+
+#define USE_USB_AD_SPEAKER
+#define AD_SPEAKER_INTERFACE
+
+#define USBD_AD_FREQ                              48000U
+#define USBD_SPEAKER_FREQ                         48000U
+#define USBD_MIC_FREQ                             48000U
+
+#define SPEAKER_OUT_CHANNEL_NBR                   2U
+#define SPEAKER_OUT_BIT_RESOLUTION                16U
+#define SPEAKER_OUT_PACKET                        (uint16_t)(((USBD_SPEAKER_FREQ * SPEAKER_OUT_CHANNEL_NBR * 2U) / 1000U))
+#define SPEAKER_OUT_MAX_PACKET                    (SPEAKER_OUT_PACKET + 4U)
+#define MIC_IN_PACKET                             (uint32_t)(((USBD_MIC_FREQ * 2U) / 1000U))
+#define AUDIO_OUT_PACKET                          SPEAKER_OUT_PACKET
+
+#define FEEDBACK_IN_PACKET                        3U
+#define FEEDBACK_IN_INTERVAL                      5U
+#define FEEDBACK_FREQ_OFFSET                      200U
+
+/* the simulated I2S clock hits the nominal rate, its drift is set by the test */
+#define I2S_ACTUAL_SAM_FREQ(audio_freq)           (audio_freq)
+
+#define DEFAULT_VOLUME                            65U
+
+#define AD_OK                                     0U
+#define AD_FAIL                                   1U
+
+#define AD_CMD_PLAY                               1U
+#define AD_CMD_PAUSE                              2U
+#define AD_CMD_RESUME                             3U
+#define AD_CMD_STOP                               4U
+
+#define AD_STATE_INACTIVE                         0U
+#define AD_STATE_ACTIVE                           1U
+#define AD_STATE_PLAYING                          2U
+#define AD_STATE_PAUSED                           3U
+#define AD_STATE_STOPPED                          4U
+#define AD_STATE_ERROR                            5U
+
+#define AD_PAUSE                                  0U
+#define AD_RESUME                                 1U
+
+#endif /* __USBD_CONF_H */
@@ -0,0 +1,307 @@
+/*!
+    \file    cdc_bench.c
+    \brief   throughput of the CDC ACM streaming interface on a simulated full or high speed bus
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#include "cdc_acm_core.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                  test_check((cond), #cond, __LINE__)
+
+/* full speed bulk: 64 byte packets, at most 19 of them in a 1 ms frame,
+   high speed bulk: 512 byte packets, at most 13 of them in a 125 us microframe */
+#ifdef CDC_BENCH_HS
+    #define BENCH_PACKET_NS          (125000U / 13U)
+    #define BENCH_BYTES              (16U * 1024U * 1024U)
+    #define BENCH_TARGET             20.0               /* MB/s */
+    #define BENCH_SPEED              "high"
+#else
+    #define BENCH_PACKET_NS          (1000000U / 19U)
+    #define BENCH_BYTES              (1024U * 1024U)
+    #define BENCH_TARGET             1.0
+    #define BENCH_SPEED              "full"
+#endif /* CDC_BENCH_HS */
+
+#define BENCH_PACKET                 USB_CDC_DATA_PACKET_SIZE
+#define BENCH_ISR_NS                 2000U              /* transfer completion to the endpoint re-armed */
+#define BENCH_POLL_NS                20000U             /* application loop period */
+#define BENCH_APP_CHUNK              4096U              /* bytes the application moves per poll */
+#define BENCH_SLOW_CHUNK             16U                /* bytes per poll of the slow reader */
+#define BENCH_WAIT_MAX               100000000U
+
+static usb_core_driver bench_udev;
+static usb_gr bench_gr;
+
+/* endpoints armed by the device and the bus time they complete at */
+static uint8_t *out_buf = NULL;
+static uint32_t out_len = 0U;
+static uint32_t out_n = 0U;
+static uint64_t out_at = 0U;
+static uint8_t *in_buf = NULL;
+static uint32_t in_len = 0U;
+static uint64_t in_at = 0U;
+static uint8_t in_armed = 0U;
+
+static uint64_t bench_now = 0U;                         /* simulated time in ns */
+static uint64_t bus_free = 0U;                          /* end of the transfer on the bus */
+static uint32_t fails = 0U;
+
+/*!
+    \brief      byte of the test stream
+    \param[in]  pos: position in the stream
+    \param[out] none
+    \retval     byte value
+*/
+static uint8_t bench_pattern (uint32_t pos)
+{
+    return (uint8_t)((pos ^ (pos >> 9U)) * 31U);
+}
+
+/*!
+    \brief      bus time of a transfer, the transfers share the bus one after the other
+    \param[in]  len: transfer length in bytes
+    \param[in]  zlp: 1 to end the transfer with a zero length packet
+    \param[out] none
+    \retval     completion time in ns
+*/
+static uint64_t bus_xfer (uint32_t len, uint8_t zlp)
+{
+    uint32_t packets = (len + BENCH_PACKET - 1U) / BENCH_PACKET + zlp;
+
+    if (0U == packets) {
+        packets = 1U;
+    }
+
+    bus_free = ((bus_free > bench_now) ? bus_free : bench_now) + (uint64_t)packets * BENCH_PACKET_NS;
+
+    return bus_free;
+}
+
+/* USB core stubs, the host side of the bench plays the bus */
+uint32_t usbd_ep_setup (usb_core_driver *udev, const usb_desc_ep *ep_desc) { return 0U; }
+uint32_t usbd_ep_clear (usb_core_driver *udev, uint8_t ep_addr) { return 0U; }
+uint32_t usbd_ep_stall (usb_core_driver *udev, uint8_t ep_addr) { return 0U; }
+uint32_t usbd_fifo_flush (usb_core_driver *udev, uint8_t ep_addr) { return 0U; }
+
+uint32_t usbd_ep_recev (usb_core_driver *udev, uint8_t ep_addr, uint8_t *pbuf, uint32_t len)
+{
+    out_buf = pbuf;
+    out_len = len;
+
+    return 0U;
+}
+
+uint32_t usbd_ep_send (usb_core_driver *udev, uint8_t ep_addr, uint8_t *pbuf, uint32_t len)
+{
+    usb_transc *transc = &udev->dev.transc_in[EP_ID(ep_addr)];
+
+    transc->xfer_len = len;
+    transc->max_len = BENCH_PACKET;
+
+    in_buf = pbuf;
+    in_len = len;
+    in_at = bus_xfer (len, 0U);
+    in_armed = 1U;
+
+    return 0U;
+}
+
+/*!
+    \brief      count a failed check
+    \param[in]  cond: check result
+    \param[in]  text: checked expression
+    \param[in]  line: source line of the check
+    \param[out] none
+    \retval     none
+*/
+static void test_check (int cond, const char *text, int line)
+{
+    if (!cond) {
+        printf("  FAIL line %d: %s\n", line, text);
+        fails++;
+    }
+}
+
+/*!
+    \brief      stream data through the class in either or both directions
+    \param[in]  tx_total: bytes the application writes to the host
+    \param[in]  rx_total: bytes the host sends to the application
+    \param[in]  rx_chunk: bytes the application reads per poll
+    \param[out] tx_mbs: device to host MB/s
+    \param[out] rx_mbs: host to device MB/s
+    \retval     none
+*/
+static void bench_stream (uint32_t tx_total, uint32_t rx_total, uint32_t rx_chunk, double *tx_mbs, double *rx_mbs)
+{
+    static uint8_t app_buf[BENCH_APP_CHUNK];
+    uint32_t app_tx = 0U, app_rx = 0U, host_tx = 0U, host_rx = 0U;
+    uint32_t tx_bad = 0U, rx_bad = 0U, zlps = 0U, ended = 1U;
+    uint32_t i, n, wait;
+    uint64_t start, next, tx_end = 0U, rx_end = 0U;
+
+    memset(&bench_udev, 0, sizeof(bench_udev));
+    bench_udev.regs.gr = &bench_gr;
+    bench_udev.dev.cur_status = (uint8_t)USBD_CONFIGURED;
+
+    out_buf = NULL;
+    out_at = 0U;
+    in_armed = 0U;
+
+    cdc_class.init (&bench_udev, 0U);
+
+    start = bench_now;
+
+    for (wait = 0U; wait < BENCH_WAIT_MAX; wait++) {
+        if ((host_rx == tx_total) && (0U != ended) && (app_rx == rx_total)) {
+            break;
+        }
+
+        /* the host sends as soon as the device takes an OUT transfer, a ZLP ends a short one of full packets */
+        if ((NULL != out_buf) && (0U == out_at) && (host_tx < rx_total)) {
+            out_n = USB_MIN(out_len, rx_total - host_tx);
+            out_at = bus_xfer (out_n, (uint8_t)((out_n < out_len) && (0U == out_n % BENCH_PACKET)));
+        }
+
+        next = (bench_now / BENCH_POLL_NS + 1U) * BENCH_POLL_NS;
+
+        if ((0U != in_armed) && (in_at <= next) && ((0U == out_at) || (in_at <= out_at))) {
+            bench_now = in_at + BENCH_ISR_NS;
+            in_armed = 0U;
+
+            for (i = 0U; i < in_len; i++) {
+                tx_bad += (in_buf[i] != bench_pattern (host_rx + i)) ? 1U : 0U;
+            }
+
+            host_rx += in_len;
+            zlps += (0U == in_len) ? 1U : 0U;
+            ended = ((0U == in_len) || (0U != in_len % BENCH_PACKET)) ? 1U : 0U;
+            tx_end = bench_now;
+
+            cdc_class.data_in (&bench_udev, CDC_DATA_IN_EP);
+        } else if ((0U != out_at) && (out_at <= next)) {
+            bench_now = out_at + BENCH_ISR_NS;
+            out_at = 0U;
+
+            for (i = 0U; i < out_n; i++) {
+                out_buf[i] = bench_pattern (host_tx + i);
+            }
+
+            host_tx += out_n;
+            out_buf = NULL;
+            bench_udev.dev.transc_out[EP_ID(CDC_DATA_OUT_EP)].xfer_count = out_n;
+
+            cdc_class.data_out (&bench_udev, EP_ID(CDC_DATA_OUT_EP));
+        } else {
+            bench_now = next;
+
+            if (app_tx < tx_total) {
+                n = USB_MIN(BENCH_APP_CHUNK, tx_total - app_tx);
+
+                for (i = 0U; i < n; i++) {
+                    app_buf[i] = bench_pattern (app_tx + i);
+                }
+
+                app_tx += cdc_acm_write (&bench_udev, app_buf, n);
+
+                if (0U != tx_total) {
+                    ended = 0U;
+                }
+            }
+
+            if (app_rx < rx_total) {
+                n = cdc_acm_read (&bench_udev, app_buf, rx_chunk);
+
+                for (i = 0U; i < n; i++) {
+                    rx_bad += (app_buf[i] != bench_pattern (app_rx + i)) ? 1U : 0U;
+                }
+
+                app_rx += n;
+                rx_end = bench_now;
+            }
+        }
+    }
+
+    CHECK(wait < BENCH_WAIT_MAX);
+    CHECK(host_rx == tx_total);
+    CHECK(app_rx == rx_total);
+    CHECK(0U == tx_bad);
+    CHECK(0U == rx_bad);
+
+    /* a device to host stream of whole packets is ended by a ZLP */
+    if ((0U != tx_total) && (0U == tx_total % BENCH_PACKET)) {
+        CHECK(0U != zlps);
+    }
+
+    *tx_mbs = (0U != tx_total) ? (double)tx_total * 1000.0 / (double)(tx_end - start) : 0.0;
+    *rx_mbs = (0U != rx_total) ? (double)rx_total * 1000.0 / (double)(rx_end - start) : 0.0;
+}
+
+int main (void)
+{
+    double limit, tx, rx, slow;
+
+    limit = (double)BENCH_PACKET * 1000.0 / BENCH_PACKET_NS;
+
+    printf("%s speed, %u byte packets, %u byte transfers, %u/%u byte Tx/Rx rings, bus limit %.2f MB/s\n",
+           BENCH_SPEED, (unsigned)BENCH_PACKET, (unsigned)USB_CDC_XFER_LEN, (unsigned)USB_CDC_TX_RING_SIZE,
+           (unsigned)USB_CDC_RX_RING_SIZE, limit);
+    printf("  stream                 Tx MB/s   Rx MB/s\n");
+
+    bench_stream (BENCH_BYTES, 0U, BENCH_APP_CHUNK, &tx, &rx);
+    printf("  device to host        %8.2f         -\n", tx);
+    CHECK(tx >= BENCH_TARGET);
+
+    bench_stream (0U, BENCH_BYTES, BENCH_APP_CHUNK, &tx, &rx);
+    printf("  host to device               -  %8.2f\n", rx);
+    CHECK(rx >= BENCH_TARGET);
+
+    /* both directions share the bus */
+    bench_stream (BENCH_BYTES, BENCH_BYTES, BENCH_APP_CHUNK, &tx, &rx);
+    printf("  both                  %8.2f  %8.2f\n", tx, rx);
+    CHECK(tx + rx >= BENCH_TARGET);
+
+    /* the OUT endpoint NAKs while the ring is full, the host is held back without losing data */
+    bench_stream (0U, BENCH_BYTES / 16U, BENCH_SLOW_CHUNK, &tx, &slow);
+    printf("  host to slow reader          -  %8.2f (reader %.2f MB/s)\n", slow,
+           (double)BENCH_SLOW_CHUNK * 1000.0 / BENCH_POLL_NS);
+    CHECK(slow <= (double)BENCH_SLOW_CHUNK * 1000.0 / BENCH_POLL_NS * 1.01);
+
+    /* a stream that ends in a short packet needs no ZLP */
+    bench_stream (BENCH_PACKET * 3U + 5U, 0U, BENCH_APP_CHUNK, &tx, &rx);
+
+    printf("target %.1f MB/s: %s\n", BENCH_TARGET, (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
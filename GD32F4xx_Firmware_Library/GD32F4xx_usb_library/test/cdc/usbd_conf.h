@@ -0,0 +1,66 @@
+/*!
+    \file    usbd_conf.h
+    \brief   USB device configuration of the CDC ACM streaming throughput test
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef __USBD_CONF_H
+#define __USBD_CONF_H
+
+#include "usb_conf.h"
+
+#define USBD_CFG_MAX_NUM                          1U
+#define USBD_ITF_MAX_NUM                          1U
+
+#define USB_STR_DESC_MAX_SIZE                     64U
+#define USB_STRING_COUNT                          4U
+
+#define USB_FS_EP0_MAX_LEN                        64U
+
+#define CDC_COM_INTERFACE                         0U
+
+#define CDC_DATA_IN_EP                            EP1_IN
+#define CDC_CMD_EP                                EP2_IN
+#define CDC_DATA_OUT_EP                           EP1_OUT
+
+/* the high speed build models the USBHS core with its 512 byte bulk packets */
+#ifdef CDC_BENCH_HS
+    #define USB_CDC_DATA_PACKET_SIZE              512U
+#else
+    #define USB_CDC_DATA_PACKET_SIZE              64U
+#endif /* CDC_BENCH_HS */
+
+#define USB_CDC_CMD_PACKET_SIZE                   8U
+
+#define USE_USB_CDC_STREAM
+
+#endif /* __USBD_CONF_H */
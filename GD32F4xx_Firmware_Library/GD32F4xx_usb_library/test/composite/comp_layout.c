@@ -0,0 +1,309 @@
+/*!
+    \file    comp_layout.c
+    \brief   host check of the composite configuration descriptor and FIFO layout
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#include "usbd_composite.h"
+#include "usbd_msc_core.h"
+#include "usbd_msc_mem.h"
+#include "cdc_acm_core.h"
+#ifdef USBD_COMPOSITE_HID
+#include "standard_hid_core.h"
+#endif /* USBD_COMPOSITE_HID */
+
+#include <stdio.h>
+
+#ifdef COMP_TEST_HS
+    #define TEST_CORE                USB_CORE_ENUM_HS
+    #define TEST_CORE_NAME           "USBHS"
+    #define TEST_EP_COUNT            USBHS_MAX_EP_COUNT
+    #define TEST_FIFO_WORDS          USBHS_MAX_FIFO_WORDLEN
+#else
+    #define TEST_CORE                USB_CORE_ENUM_FS
+    #define TEST_CORE_NAME           "USBFS"
+    #define TEST_EP_COUNT            USBFS_MAX_EP_COUNT
+    #define TEST_FIFO_WORDS          USBFS_MAX_FIFO_WORDLEN
+#endif /* COMP_TEST_HS */
+
+#define CHECK(cond)                  test_check((cond), #cond, __LINE__)
+
+/* device descriptor of a composite device using interface associations */
+static uint8_t test_dev_desc[USB_DEV_DESC_LEN] = {
+    USB_DEV_DESC_LEN, USB_DESCTYPE_DEV, 0x00U, 0x02U, 0xEFU, 0x02U, 0x01U, 64U,
+    0xE9U, 0x28U, 0x00U, 0x30U, 0x00U, 0x01U, 1U, 2U, 3U, 1U
+};
+
+static usb_desc test_desc = {
+    .dev_desc = test_dev_desc
+};
+
+static uint16_t set_rx;
+static uint16_t set_tx[USBFS_MAX_TX_FIFOS];
+static uint32_t fails = 0U;
+
+/* USB core and MSC transport stubs, only the FIFO setting is recorded */
+void usb_devfifo_set (usb_core_enum core, uint16_t rx_size, const uint16_t *tx_size)
+{
+    uint8_t i;
+
+    set_rx = rx_size;
+
+    for (i = 0U; i < USBFS_MAX_TX_FIFOS; i++) {
+        set_tx[i] = tx_size[i];
+    }
+}
+
+uint32_t usbd_ep_setup (usb_core_driver *udev, const usb_desc_ep *ep_desc) { return 0U; }
+uint32_t usbd_ep_clear (usb_core_driver *udev, uint8_t ep_addr) { return 0U; }
+uint32_t usbd_ep_recev (usb_core_driver *udev, uint8_t ep_addr, uint8_t *pbuf, uint32_t len) { return 0U; }
+uint32_t usbd_ep_send (usb_core_driver *udev, uint8_t ep_addr, uint8_t *pbuf, uint32_t len) { return 0U; }
+void msc_bbb_init (usb_core_driver *udev) { }
+void msc_bbb_reset (usb_core_driver *udev) { }
+void msc_bbb_deinit (usb_core_driver *udev) { }
+void msc_bbb_data_in (usb_core_driver *udev, uint8_t ep_num) { }
+void msc_bbb_data_out (usb_core_driver *udev, uint8_t ep_num) { }
+void msc_bbb_clrfeature (usb_core_driver *udev, uint8_t ep_num) { }
+usbd_mem_cb *usbd_mem_fops = NULL;
+
+/*!
+    \brief      count a failed check
+    \param[in]  cond: check result
+    \param[in]  text: checked expression
+    \param[in]  line: source line of the check
+    \param[out] none
+    \retval     none
+*/
+static void test_check (int cond, const char *text, int line)
+{
+    if (!cond) {
+        printf("  FAIL line %d: %s\n", line, text);
+        fails++;
+    }
+}
+
+/*!
+    \brief      walk a built configuration, check its structure and print it
+    \param[in]  desc: configuration or other speed configuration descriptor
+    \param[in]  type: expected descriptor type
+    \param[out] none
+    \retval     none
+*/
+static void test_config (const uint8_t *desc, uint8_t type)
+{
+    uint16_t total = (uint16_t)desc[2] | ((uint16_t)desc[3] << 8U);
+    uint16_t pos, mps;
+    uint8_t itf_num = 0U, comm_itf = 0xFFU, iad_seen = 0U, k;
+    uint8_t ep_used[2][USBFS_MAX_TX_FIFOS] = {{0U}};
+
+    printf("%s descriptor, %u bytes, %u interfaces\n", (USB_DESCTYPE_CONFIG == type) ? "configuration" : "other speed",
+           (unsigned)total, (unsigned)desc[4]);
+
+    CHECK(type == desc[1]);
+    CHECK(total <= USBD_COMP_CONFIG_DESC_MAX);
+
+    for (pos = desc[0]; pos < total; pos += desc[pos]) {
+        const uint8_t *d = &desc[pos];
+
+        CHECK(d[0] >= 2U);
+        CHECK((pos + d[0]) <= total);
+
+        if (d[0] < 2U) {
+            return;
+        }
+
+        switch (d[1]) {
+        case USB_DESCTYPE_IAD:
+            printf("  IAD       interfaces %u..%u class %02x\n", d[2], d[2] + d[3] - 1U, d[4]);
+            CHECK(d[2] == itf_num);
+            iad_seen = 1U;
+            break;
+
+        case USB_DESCTYPE_ITF:
+            printf("  interface %u alt %u class %02x, %u endpoints\n", d[2], d[3], d[5], d[4]);
+
+            if (0U == d[3]) {
+                /* interfaces are numbered from 0 in the order of the functions */
+                CHECK(d[2] == itf_num);
+                itf_num++;
+            }
+
+            if (0x02U == d[5]) {
+                comm_itf = d[2];
+                CHECK(iad_seen);
+            }
+            break;
+
+        case 0x24U:
+            /* CDC union and call management must point at the renumbered data interface */
+            if (0x06U == d[2]) {
+                CHECK(d[3] == comm_itf);
+
+                for (k = 4U; k < d[0]; k++) {
+                    CHECK(d[k] == (comm_itf + k - 3U));
+                }
+            } else if (0x01U == d[2]) {
+                CHECK(d[4] == (comm_itf + 1U));
+            }
+            break;
+
+        case USB_DESCTYPE_EP:
+            mps = ((uint16_t)d[4] | ((uint16_t)d[5] << 8U)) & 0x07FFU;
+            printf("  endpoint  %02x type %u, %u bytes, interval %u\n", d[2], d[3] & 3U, mps, d[6]);
+
+            CHECK(0U != (d[2] & 0x0FU));
+            CHECK((d[2] & 0x0FU) < TEST_EP_COUNT);
+            CHECK(0U == ep_used[d[2] >> 7U][d[2] & 0x0FU]);
+            ep_used[d[2] >> 7U][d[2] & 0x0FU] = 1U;
+
+            if (USB_DESCTYPE_OTHER_SPD_CONFIG == type) {
+                CHECK(mps <= (((d[3] & 3U) == USB_EPTYPE_ISOC) ? 1023U : 64U));
+                CHECK(((d[3] & 3U) != USB_EPTYPE_BULK) || (0U == d[6]));
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    CHECK(pos == total);
+    CHECK(desc[4] == itf_num);
+    CHECK(desc[4] <= USBD_ITF_MAX_NUM);
+}
+
+/*!
+    \brief      check the FIFO layout against the endpoints of the configuration
+    \param[in]  desc: configuration descriptor
+    \param[out] none
+    \retval     none
+*/
+static void test_fifo (const uint8_t *desc)
+{
+    const usbd_comp_fifo *fifo = usbd_comp_fifo_get ();
+    uint16_t total = (uint16_t)desc[2] | ((uint16_t)desc[3] << 8U);
+    uint16_t pos, mps, out_max = 64U;
+    uint32_t used;
+    uint8_t i;
+
+    used = fifo->rx_size;
+    printf("FIFO words of %u: rx %u, tx", (unsigned)TEST_FIFO_WORDS, fifo->rx_size);
+
+    for (i = 0U; i < USBFS_MAX_TX_FIFOS; i++) {
+        used += fifo->tx_size[i];
+        CHECK(fifo->tx_size[i] == set_tx[i]);
+
+        if (0U != fifo->tx_size[i]) {
+            printf(" %u:%u", i, fifo->tx_size[i]);
+        }
+    }
+
+    printf(", %u used\n", (unsigned)used);
+
+    CHECK(fifo->rx_size == set_rx);
+    CHECK(used <= TEST_FIFO_WORDS);
+    CHECK(fifo->tx_size[0] >= 16U);
+
+    for (pos = desc[0]; pos < total; pos += desc[pos]) {
+        const uint8_t *d = &desc[pos];
+
+        if (USB_DESCTYPE_EP != d[1]) {
+            continue;
+        }
+
+        mps = ((uint16_t)d[4] | ((uint16_t)d[5] << 8U)) & 0x07FFU;
+
+        if (d[2] & 0x80U) {
+            /* every IN endpoint holds at least one packet, bulk ones whole packets only */
+            CHECK(fifo->tx_size[d[2] & 0x0FU] >= ((mps + 3U) / 4U));
+            CHECK(((d[3] & 3U) != USB_EPTYPE_BULK) || (0U == (fifo->tx_size[d[2] & 0x0FU] % ((mps + 3U) / 4U))));
+        } else {
+            out_max = USB_MAX(out_max, mps);
+        }
+    }
+
+    /* SETUP packets and two of the largest OUT packets */
+    CHECK(fifo->rx_size >= (13U + (2U * ((out_max / 4U) + 1U))));
+}
+
+int main (void)
+{
+    uint8_t i;
+
+    printf("%s core\n", TEST_CORE_NAME);
+
+    CHECK(USBD_OK == usbd_comp_add (&msc_class, &msc_desc));
+    CHECK(USBD_OK == usbd_comp_add (&cdc_class, &cdc_desc));
+#ifdef USBD_COMPOSITE_HID
+    CHECK(USBD_OK == usbd_comp_add (&usbd_hid_cb, &hid_desc));
+#endif /* USBD_COMPOSITE_HID */
+
+    CHECK(USBD_OK == usbd_comp_build (&test_desc, TEST_CORE));
+
+    if (NULL == test_desc.config_desc) {
+        printf("no configuration built\n");
+
+        return 1;
+    }
+
+    test_config (test_desc.config_desc, USB_DESCTYPE_CONFIG);
+    test_fifo (test_desc.config_desc);
+
+#if defined(USE_USB_HS) && defined(USE_ULPI_PHY)
+    CHECK(NULL != test_desc.other_speed_config_desc);
+    CHECK(NULL != test_desc.qualifier_desc);
+
+    if ((NULL != test_desc.other_speed_config_desc) && (NULL != test_desc.qualifier_desc)) {
+        test_config (test_desc.other_speed_config_desc, USB_DESCTYPE_OTHER_SPD_CONFIG);
+
+        /* same structure at the other speed */
+        CHECK(test_desc.other_speed_config_desc[2] == test_desc.config_desc[2]);
+        CHECK(test_desc.other_speed_config_desc[3] == test_desc.config_desc[3]);
+
+        CHECK(USB_DEV_QUALIFIER_DESC_LEN == test_desc.qualifier_desc[0]);
+        CHECK(USB_DESCTYPE_DEV_QUALIFIER == test_desc.qualifier_desc[1]);
+        CHECK(test_dev_desc[4] == test_desc.qualifier_desc[4]);
+        CHECK(test_dev_desc[17] == test_desc.qualifier_desc[8]);
+    }
+#endif /* USE_USB_HS && USE_ULPI_PHY */
+
+    /* the function table is bounded */
+    for (i = 0U; i < USBD_COMP_FUNC_MAX; i++) {
+        (void)usbd_comp_add (&cdc_class, &cdc_desc);
+    }
+
+    CHECK(USBD_FAIL == usbd_comp_add (&cdc_class, &cdc_desc));
+
+    printf("%s\n", (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
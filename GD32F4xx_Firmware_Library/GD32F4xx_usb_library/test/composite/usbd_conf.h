@@ -0,0 +1,74 @@
+/*!
+    \file    usbd_conf.h
+    \brief   USB device configuration of the composite device tests
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef __USBD_CONF_H
+#define __USBD_CONF_H
+
+#include "usb_conf.h"
+
+#define USBD_CFG_MAX_NUM                          1U
+
+#define USB_STR_DESC_MAX_SIZE                     64U
+#define USB_STRING_COUNT                          4U
+
+#define USB_FS_EP0_MAX_LEN                        64U
+#define USB_HS_EP0_MAX_LEN                        64U
+
+/* the USBFS core has endpoints for MSC and CDC, the USBHS core adds HID */
+#define USBD_COMPOSITE_MSC
+#define USBD_COMPOSITE_CDC
+
+#ifdef COMP_TEST_HS
+    #define USBD_COMPOSITE_HID
+
+    #define MSC_DATA_PACKET_SIZE                  512U
+    #define USB_CDC_DATA_PACKET_SIZE              512U
+#else
+    #define MSC_DATA_PACKET_SIZE                  64U
+    #define USB_CDC_DATA_PACKET_SIZE              64U
+#endif /* COMP_TEST_HS */
+
+#define MSC_MEDIA_PACKET_SIZE                     4096U
+#define MEM_LUN_NUM                               1U
+
+#define USB_CDC_CMD_PACKET_SIZE                   8U
+
+#define HID_IN_PACKET                             8U
+#define USB_HID_CONFIG_DESC_LEN                   0x22U
+#define USB_HID_REPORT_DESC_LEN                   0x2EU
+
+#include "usbd_composite_conf.h"
+
+#endif /* __USBD_CONF_H */
@@ -0,0 +1,60 @@
+/*!
+    \file    usb_conf.h
+    \brief   USB core configuration for the host side tests
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef __USB_CONF_H
+#define __USB_CONF_H
+
+#include "gd32f4xx.h"
+
+/* the tests build the device stack of the full speed core */
+#define USE_USB_FS
+#define USB_FS_CORE
+#define USE_DEVICE_MODE
+
+#define USBFS_SOF_OUTPUT                          0U
+#define USBFS_LOW_POWER                           0U
+
+#define RX_FIFO_FS_SIZE                           128U
+#define TX0_FIFO_FS_SIZE                          64U
+#define TX1_FIFO_FS_SIZE                          128U
+#define TX2_FIFO_FS_SIZE                          0U
+#define TX3_FIFO_FS_SIZE                          0U
+
+#define __ALIGN_BEGIN
+#define __ALIGN_END
+
+#define __packed                                  __attribute__ ((__packed__))
+
+#endif /* __USB_CONF_H */
@@ -0,0 +1,327 @@
+/*!
+    \file    fifo_bench.c
+    \brief   host microbenchmark of the FIFO copy routines over a simulated FIFO register
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+/*
+    The FIFO register is a volatile word in host memory, every access of the routines goes to it
+    as to the DFIFO window of the core. The cycles are host TSC cycles, the comparison between the
+    routines carries over to the MCU, not the numbers. The routines before the aligned fast path
+    are kept here as the reference, once as GCC builds them and once with the byte loads and
+    stores other toolchains emit for their __packed word accesses.
+*/
+
+#include "drv_usb_core.h"
+#include "drv_usb_hw.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_PACKET                 512U
+#define BENCH_PACKETS                20000U             /* packets of one round */
+#define BENCH_ROUNDS                 15U                /* the fastest round counts */
+#define BENCH_GUARD                  4U
+#define BENCH_PATTERN                0xA55A3CC3U
+
+typedef usb_status (*bench_write_fn) (usb_core_regs *usb_regs, uint8_t *src_buf, uint8_t fifo_num, uint16_t byte_count);
+typedef void *(*bench_read_fn) (usb_core_regs *usb_regs, uint8_t *dest_buf, uint16_t byte_count);
+
+static volatile uint32_t fifo_reg = BENCH_PATTERN;
+static usb_core_regs bench_regs;
+static uint32_t fails = 0U;
+
+/* one spare word in front, the unaligned buffers start one byte into the aligned ones */
+static uint32_t src_words[BENCH_PACKET / 4U + 2U];
+static uint32_t dest_words[BENCH_PACKET / 4U + 2U];
+
+void usb_udelay (const uint32_t usec)
+{
+    (void)usec;
+}
+
+void usb_mdelay (const uint32_t msec)
+{
+    (void)msec;
+}
+
+/*!
+    \brief      host cycle counter
+    \param[in]  none
+    \param[out] none
+    \retval     TSC cycles, or ns where there is no TSC
+*/
+static uint64_t bench_cycles (void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    /* x86intrin.h clashes with the CMSIS register qualifiers */
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/*!
+    \brief      usb_txfifo_write() before the aligned fast path
+    \param[in]  usb_regs: pointer to USB core registers
+    \param[in]  src_buf: pointer to source buffer
+    \param[in]  fifo_num: FIFO number which is in (0..3 or 0..5)
+    \param[in]  byte_count: packet length
+    \param[out] none
+    \retval     operation status
+*/
+static usb_status txfifo_write_word (usb_core_regs *usb_regs, uint8_t *src_buf, uint8_t fifo_num, uint16_t byte_count)
+{
+    uint32_t word_count = (byte_count + 3U) / 4U;
+
+    __IO uint32_t *fifo = usb_regs->DFIFO[fifo_num];
+
+    while (word_count-- > 0U) {
+        *fifo = *((__packed uint32_t *)src_buf);
+
+        src_buf += 4U;
+    }
+
+    return USB_OK;
+}
+
+/*!
+    \brief      usb_rxfifo_read() before the aligned fast path
+    \param[in]  usb_regs: pointer to USB core registers
+    \param[in]  dest_buf: pointer to destination buffer
+    \param[in]  byte_count: packet length
+    \param[out] none
+    \retval     pointer to destination buffer
+*/
+static void *rxfifo_read_word (usb_core_regs *usb_regs, uint8_t *dest_buf, uint16_t byte_count)
+{
+    uint32_t word_count = (byte_count + 3U) / 4U;
+
+    __IO uint32_t *fifo = usb_regs->DFIFO[0];
+
+    while (word_count-- > 0U) {
+        *(__packed uint32_t *)dest_buf = *fifo;
+
+        dest_buf += 4U;
+    }
+
+    return ((void *)dest_buf);
+}
+
+/*!
+    \brief      usb_txfifo_write() before the fast path, with byte loads for the __packed access
+    \param[in]  usb_regs: pointer to USB core registers
+    \param[in]  src_buf: pointer to source buffer
+    \param[in]  fifo_num: FIFO number which is in (0..3 or 0..5)
+    \param[in]  byte_count: packet length
+    \param[out] none
+    \retval     operation status
+*/
+static usb_status txfifo_write_byte (usb_core_regs *usb_regs, uint8_t *src_buf, uint8_t fifo_num, uint16_t byte_count)
+{
+    uint32_t word_count = (byte_count + 3U) / 4U;
+    volatile uint8_t *src = src_buf;
+
+    __IO uint32_t *fifo = usb_regs->DFIFO[fifo_num];
+
+    while (word_count-- > 0U) {
+        *fifo = (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+
+        src += 4U;
+    }
+
+    return USB_OK;
+}
+
+/*!
+    \brief      usb_rxfifo_read() before the fast path, with byte stores for the __packed access
+    \param[in]  usb_regs: pointer to USB core registers
+    \param[in]  dest_buf: pointer to destination buffer
+    \param[in]  byte_count: packet length
+    \param[out] none
+    \retval     pointer to destination buffer
+*/
+static void *rxfifo_read_byte (usb_core_regs *usb_regs, uint8_t *dest_buf, uint16_t byte_count)
+{
+    uint32_t word_count = (byte_count + 3U) / 4U;
+    volatile uint8_t *dest = dest_buf;
+    uint32_t word;
+
+    __IO uint32_t *fifo = usb_regs->DFIFO[0];
+
+    while (word_count-- > 0U) {
+        word = *fifo;
+        dest[0] = (uint8_t)word;
+        dest[1] = (uint8_t)(word >> 8);
+        dest[2] = (uint8_t)(word >> 16);
+        dest[3] = (uint8_t)(word >> 24);
+
+        dest += 4U;
+    }
+
+    return ((void *)dest);
+}
+
+/*!
+    \brief      cycles of one 512 byte packet written to the FIFO
+    \param[in]  write: the routine
+    \param[in]  buf: source buffer
+    \param[out] none
+    \retval     cycles per packet
+*/
+static uint64_t bench_write (bench_write_fn write, uint8_t *buf)
+{
+    uint64_t start, cycles, best = UINT64_MAX;
+    uint32_t round, i;
+
+    for (round = 0U; round < BENCH_ROUNDS; round++) {
+        start = bench_cycles();
+        for (i = 0U; i < BENCH_PACKETS; i++) {
+            (void)write(&bench_regs, buf, 0U, BENCH_PACKET);
+        }
+        cycles = bench_cycles() - start;
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+
+    return (best + BENCH_PACKETS / 2U) / BENCH_PACKETS;
+}
+
+/*!
+    \brief      cycles of one 512 byte packet read from the FIFO
+    \param[in]  read: the routine
+    \param[in]  buf: destination buffer
+    \param[out] none
+    \retval     cycles per packet
+*/
+static uint64_t bench_read (bench_read_fn read, uint8_t *buf)
+{
+    uint64_t start, cycles, best = UINT64_MAX;
+    uint32_t round, i;
+
+    for (round = 0U; round < BENCH_ROUNDS; round++) {
+        start = bench_cycles();
+        for (i = 0U; i < BENCH_PACKETS; i++) {
+            (void)read(&bench_regs, buf, BENCH_PACKET);
+        }
+        cycles = bench_cycles() - start;
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+
+    return (best + BENCH_PACKETS / 2U) / BENCH_PACKETS;
+}
+
+/*!
+    \brief      bytes a read of a short packet stores past its end
+    \param[in]  read: the routine
+    \param[in]  buf: destination buffer, with BENCH_GUARD bytes behind the packet
+    \param[in]  len: packet length
+    \param[out] none
+    \retval     bytes overwritten behind the packet, 0xFF if the packet itself is wrong
+*/
+static uint32_t bench_overrun (bench_read_fn read, uint8_t *buf, uint16_t len)
+{
+    uint32_t i, over = 0U;
+
+    fifo_reg = BENCH_PATTERN;
+    memset(buf, 0, len + BENCH_GUARD);
+    (void)read(&bench_regs, buf, len);
+
+    for (i = 0U; i < len; i++) {
+        if (buf[i] != (uint8_t)(BENCH_PATTERN >> (8U * (i & 3U)))) {
+            return 0xFFU;
+        }
+    }
+    for (i = 0U; i < BENCH_GUARD; i++) {
+        if (0U != buf[len + i]) {
+            over++;
+        }
+    }
+
+    return over;
+}
+
+int main (void)
+{
+    static const struct {
+        const char *name;
+        bench_write_fn write;
+        bench_read_fn read;
+    } routine[] = {
+        {"before, __packed word access", txfifo_write_word, rxfifo_read_word},
+        {"before, __packed as byte access", txfifo_write_byte, rxfifo_read_byte},
+        {"aligned fast path", usb_txfifo_write, usb_rxfifo_read},
+    };
+    uint8_t *src_aligned = (uint8_t *)&src_words[1];
+    uint8_t *dest_aligned = (uint8_t *)&dest_words[1];
+    uint64_t cycles[4];
+    uint32_t i, over;
+
+    memset(&bench_regs, 0, sizeof(bench_regs));
+    bench_regs.DFIFO[0] = &fifo_reg;
+    for (i = 0U; i < BENCH_PACKET; i++) {
+        src_aligned[i] = (uint8_t)i;
+    }
+
+    printf("cycles per %u byte packet      write aligned  write unaligned  read aligned  read unaligned\n",
+           BENCH_PACKET);
+    for (i = 0U; i < (sizeof(routine) / sizeof(routine[0])); i++) {
+        cycles[0] = bench_write(routine[i].write, src_aligned);
+        cycles[1] = bench_write(routine[i].write, src_aligned + 1U);
+        cycles[2] = bench_read(routine[i].read, dest_aligned);
+        cycles[3] = bench_read(routine[i].read, dest_aligned + 1U);
+        printf("%-32s  %13llu  %15llu  %12llu  %14llu\n", routine[i].name, (unsigned long long)cycles[0],
+               (unsigned long long)cycles[1], (unsigned long long)cycles[2], (unsigned long long)cycles[3]);
+    }
+
+    /* a short packet must not be stored past its end */
+    printf("bytes stored past a 509 byte packet: before %u, ", bench_overrun(rxfifo_read_word, dest_aligned, 509U));
+    over = bench_overrun(usb_rxfifo_read, dest_aligned, 509U) +
+           bench_overrun(usb_rxfifo_read, dest_aligned + 1U, 509U) +
+           bench_overrun(usb_rxfifo_read, dest_aligned, 508U);
+    printf("now %u\n", over);
+    if (0U != over) {
+        fails++;
+    }
+
+    printf("%s\n", (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
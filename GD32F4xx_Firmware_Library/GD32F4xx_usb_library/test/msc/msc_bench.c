@@ -0,0 +1,276 @@
+/*!
+    \file    msc_bench.c
+    \brief   sequential RAM disk throughput of the MSC data stages on a simulated high speed bus
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#include "usbd_msc_bbb.h"
+#include "usbd_msc_ram.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                  test_check((cond), #cond, __LINE__)
+
+/* high speed bulk: 512 byte packets, at most 13 of them in a 125 us microframe */
+#define BENCH_PACKET                 512U
+#define BENCH_PACKET_NS              (125000U / 13U)
+#define BENCH_POLL_NS                1000U              /* usbd_ram_poll() period */
+#define BENCH_CMD_BLKS               128U               /* 64 KB per Read10/Write10, as hosts issue them */
+#define BENCH_BYTES                  (MSC_RAM_BLOCK_NUM * MSC_RAM_BLOCK_SIZE)
+#define BENCH_WAIT_MAX               10000000U
+
+static usb_core_driver bench_udev;
+static usbd_msc_handler bench_msc;
+
+/* endpoints armed by the device and the bus time they complete at */
+static uint8_t *out_buf = NULL;
+static uint32_t out_len = 0U;
+static uint64_t out_at = 0U;
+static uint8_t *in_buf = NULL;
+static uint32_t in_len = 0U;
+static uint64_t in_at = 0U;
+static uint8_t in_armed = 0U;
+
+static uint64_t bench_now = 0U;                         /* simulated time in ns */
+static uint64_t bus_free = 0U;                          /* end of the transfer on the bus */
+static uint32_t bench_tag = 0U;
+static uint32_t fails = 0U;
+
+static uint8_t host_buf[BENCH_CMD_BLKS * MSC_RAM_BLOCK_SIZE];
+
+usbd_mem_cb *usbd_mem_fops = &usbd_ram_fops;
+
+/*!
+    \brief      bus time of a transfer, the transfers share the bus one after the other
+    \param[in]  len: transfer length in bytes
+    \param[out] none
+    \retval     completion time in ns
+*/
+static uint64_t bus_xfer (uint32_t len)
+{
+    uint32_t packets = (len + BENCH_PACKET - 1U) / BENCH_PACKET;
+
+    if (0U == packets) {
+        packets = 1U;
+    }
+
+    bus_free = ((bus_free > bench_now) ? bus_free : bench_now) + (uint64_t)packets * BENCH_PACKET_NS;
+
+    return bus_free;
+}
+
+/* USB core stubs, the host side of the bench plays the bus */
+uint32_t usbd_ep_recev (usb_core_driver *udev, uint8_t ep_addr, uint8_t *pbuf, uint32_t len)
+{
+    out_buf = pbuf;
+    out_len = len;
+
+    return 0U;
+}
+
+uint32_t usbd_ep_send (usb_core_driver *udev, uint8_t ep_addr, uint8_t *pbuf, uint32_t len)
+{
+    in_buf = pbuf;
+    in_len = len;
+    in_at = bus_xfer (len);
+    in_armed = 1U;
+
+    return 0U;
+}
+
+uint32_t usbd_ep_stall (usb_core_driver *udev, uint8_t ep_addr) { return 0U; }
+uint32_t usbd_fifo_flush (usb_core_driver *udev, uint8_t ep_addr) { return 0U; }
+
+/*!
+    \brief      count a failed check
+    \param[in]  cond: check result
+    \param[in]  text: checked expression
+    \param[in]  line: source line of the check
+    \param[out] none
+    \retval     none
+*/
+static void test_check (int cond, const char *text, int line)
+{
+    if (!cond) {
+        printf("  FAIL line %d: %s\n", line, text);
+        fails++;
+    }
+}
+
+/*!
+    \brief      run a Read10 or Write10 command as the host
+    \param[in]  write: 1 to write the blocks
+    \param[in]  lba: first block
+    \param[in]  blks: number of blocks
+    \param[out] none
+    \retval     CSW status, 0xFF if the device stopped answering
+*/
+static uint8_t bench_rw (uint8_t write, uint32_t lba, uint16_t blks)
+{
+    msc_bbb_cbw cbw;
+    uint32_t len = (uint32_t)blks * MSC_RAM_BLOCK_SIZE;
+    uint32_t pos = 0U, n, wait;
+    uint64_t next;
+
+    memset(&cbw, 0, sizeof(cbw));
+    cbw.dCBWSignature = BBB_CBW_SIGNATURE;
+    cbw.dCBWTag = ++bench_tag;
+    cbw.dCBWDataTransferLength = len;
+    cbw.bmCBWFlags = (0U != write) ? 0x00U : 0x80U;
+    cbw.bCBWCBLength = 10U;
+    cbw.CBWCB[0] = (0U != write) ? SCSI_WRITE10 : SCSI_READ10;
+    cbw.CBWCB[2] = (uint8_t)(lba >> 24U);
+    cbw.CBWCB[3] = (uint8_t)(lba >> 16U);
+    cbw.CBWCB[4] = (uint8_t)(lba >> 8U);
+    cbw.CBWCB[5] = (uint8_t)lba;
+    cbw.CBWCB[7] = (uint8_t)(blks >> 8U);
+    cbw.CBWCB[8] = (uint8_t)blks;
+
+    if (out_buf != (uint8_t *)&bench_msc.bbb_cbw) {
+        return 0xFFU;
+    }
+
+    bench_now = bus_xfer (BBB_CBW_LENGTH);
+    memcpy(out_buf, &cbw, BBB_CBW_LENGTH);
+    out_buf = NULL;
+    bench_udev.dev.transc_out[MSC_OUT_EP & 0x7FU].xfer_count = BBB_CBW_LENGTH;
+    msc_bbb_data_out (&bench_udev, MSC_OUT_EP);
+
+    for (wait = 0U; wait < BENCH_WAIT_MAX; wait++) {
+        /* the host sends as soon as the device takes an OUT packet */
+        if ((0U != write) && (NULL != out_buf) && (0U == out_at) && (pos < len)) {
+            out_at = bus_xfer (USB_MIN(out_len, len - pos));
+        }
+
+        next = (bench_now / BENCH_POLL_NS + 1U) * BENCH_POLL_NS;
+
+        if ((0U != in_armed) && (in_at <= next)) {
+            bench_now = in_at;
+            in_armed = 0U;
+
+            if (in_buf == (uint8_t *)&bench_msc.bbb_csw) {
+                msc_bbb_data_in (&bench_udev, MSC_IN_EP);
+
+                return bench_msc.bbb_csw.bCSWStatus;
+            }
+
+            pos += in_len;
+            msc_bbb_data_in (&bench_udev, MSC_IN_EP);
+        } else if ((0U != out_at) && (out_at <= next)) {
+            bench_now = out_at;
+            out_at = 0U;
+
+            n = USB_MIN(out_len, len - pos);
+            memcpy(out_buf, &host_buf[pos], n);
+            pos += n;
+            out_buf = NULL;
+            bench_udev.dev.transc_out[MSC_OUT_EP & 0x7FU].xfer_count = n;
+            msc_bbb_data_out (&bench_udev, MSC_OUT_EP);
+        } else {
+            bench_now = next;
+            usbd_ram_poll();
+        }
+    }
+
+    return 0xFFU;
+}
+
+/*!
+    \brief      move the whole disk with sequential commands
+    \param[in]  write: 1 to write the disk
+    \param[out] none
+    \retval     MB/s
+*/
+static double bench_seq (uint8_t write)
+{
+    uint64_t start;
+    uint32_t lba;
+
+    memset(&bench_msc, 0, sizeof(bench_msc));
+    memset(&bench_udev, 0, sizeof(bench_udev));
+    bench_udev.dev.class_data[USBD_MSC_INTERFACE] = &bench_msc;
+
+    /* the block size and count come from Read Capacity */
+    bench_msc.scsi_blk_size[0] = MSC_RAM_BLOCK_SIZE;
+    bench_msc.scsi_blk_nbr[0] = MSC_RAM_BLOCK_NUM;
+
+    msc_bbb_init (&bench_udev);
+
+    start = bench_now;
+
+    for (lba = 0U; lba < MSC_RAM_BLOCK_NUM; lba += BENCH_CMD_BLKS) {
+        CHECK(CSW_CMD_PASSED == bench_rw (write, lba, BENCH_CMD_BLKS));
+    }
+
+    return (double)BENCH_BYTES * 1000.0 / (double)(bench_now - start);
+}
+
+int main (void)
+{
+    static const uint32_t latency[] = {0U, 40U, 80U, 120U, 160U};
+    double bus_ns, media_ns, bound, rd, wr;
+    uint32_t i;
+
+    /* bus time of one media packet, and the CBW and CSW spread over the command */
+    bus_ns = (double)(MSC_MEDIA_PACKET_SIZE / BENCH_PACKET) * BENCH_PACKET_NS;
+    bus_ns += 2.0 * BENCH_PACKET_NS * MSC_MEDIA_PACKET_SIZE / (BENCH_CMD_BLKS * MSC_RAM_BLOCK_SIZE);
+
+    printf("%u media buffer(s) of %u bytes, %u KB commands, bus limit %.1f MB/s\n",
+           (unsigned)MSC_MEDIA_BUF_NUM, (unsigned)MSC_MEDIA_PACKET_SIZE,
+           (unsigned)(BENCH_CMD_BLKS * MSC_RAM_BLOCK_SIZE / 1024U), MSC_MEDIA_PACKET_SIZE * 1000.0 / bus_ns);
+    printf("  media us/packet   read MB/s   write MB/s   model MB/s\n");
+
+    for (i = 0U; i < sizeof(latency) / sizeof(latency[0]); i++) {
+        usbd_ram_latency_set (latency[i]);
+
+        rd = bench_seq (0U);
+        wr = bench_seq (1U);
+
+        /* one buffer serializes the bus and the media, ping-pong overlaps them */
+        media_ns = (double)latency[i] * BENCH_POLL_NS;
+        bound = (1U == MSC_MEDIA_BUF_NUM) ? (bus_ns + media_ns) : ((bus_ns > media_ns) ? bus_ns : media_ns);
+        bound = MSC_MEDIA_PACKET_SIZE * 1000.0 / bound;
+
+        printf("  %15u   %9.2f   %10.2f   %10.2f\n", (unsigned)latency[i], rd, wr, bound);
+
+        /* within the per command stalls of the model */
+        CHECK(rd <= bound * 1.01);
+        CHECK(wr <= bound * 1.01);
+        CHECK(rd >= bound * 0.85);
+        CHECK(wr >= bound * 0.85);
+    }
+
+    printf("%s\n", (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
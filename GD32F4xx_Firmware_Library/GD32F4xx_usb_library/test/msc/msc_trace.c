@@ -0,0 +1,474 @@
+/*!
+    \file    msc_trace.c
+    \brief   replay of a file copy SCSI command trace through the cached RAM disk
+
+    \version 2024-01-15, V3.2.0, firmware for GD32F4xx
+*/
+
+/*
+    Copyright (c) 2024, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+
+#include "usbd_msc_bbb.h"
+#include "usbd_msc_cache.h"
+#include "usbd_msc_ram.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond)                  test_check((cond), #cond, __LINE__)
+
+#define TEST_BLK                     MSC_RAM_BLOCK_SIZE
+#define TEST_BLK_NUM                 MSC_RAM_BLOCK_NUM
+#define TEST_LATENCY                 3U                 /* usbd_ram_poll() calls per media access */
+#define TEST_WAIT_MAX                1000000U
+
+/* layout of the FAT volume of the trace */
+#define TEST_FAT_LBA                 1U
+#define TEST_FAT_BLKS                8U
+#define TEST_DIR_LBA                 17U
+#define TEST_DATA_LBA                64U
+#define TEST_CLUSTER_BLKS            64U                /* 32 KB clusters, written by the host in one command */
+#define TEST_FILE_CLUSTERS           12U
+
+typedef struct
+{
+    uint32_t ticks;                  /* usbd_ram_poll() calls */
+    uint32_t isr_sync;               /* synchronous media accesses inside the USB interrupt */
+    uint32_t async;                  /* asynchronous media accesses */
+} test_count;
+
+static usb_core_driver test_udev;
+static usbd_msc_handler test_msc;
+static usbd_mem_cb test_media;
+static test_count count;
+
+/* endpoints armed by the device */
+static uint8_t *out_buf = NULL;
+static uint32_t out_len = 0U;
+static uint8_t *in_buf = NULL;
+static uint32_t in_len = 0U;
+static uint8_t in_armed = 0U;
+static uint8_t in_stall = 0U;
+
+static uint8_t test_isr = 0U;
+static uint8_t media_fail = 0U;
+static uint32_t test_tag = 0U;
+static uint32_t fails = 0U;
+
+static uint8_t shadow[TEST_BLK_NUM * TEST_BLK];
+static uint8_t host_buf[TEST_CLUSTER_BLKS * TEST_BLK];
+
+usbd_mem_cb *usbd_mem_fops = NULL;
+
+/* USB core stubs, the host side of the test plays the bus */
+uint32_t usbd_ep_recev (usb_core_driver *udev, uint8_t ep_addr, uint8_t *pbuf, uint32_t len)
+{
+    out_buf = pbuf;
+    out_len = len;
+
+    return 0U;
+}
+
+uint32_t usbd_ep_send (usb_core_driver *udev, uint8_t ep_addr, uint8_t *pbuf, uint32_t len)
+{
+    in_buf = pbuf;
+    in_len = len;
+    in_armed = 1U;
+
+    return 0U;
+}
+
+uint32_t usbd_ep_stall (usb_core_driver *udev, uint8_t ep_addr)
+{
+    if (0x80U & ep_addr) {
+        in_stall = 1U;
+    }
+
+    return 0U;
+}
+
+uint32_t usbd_fifo_flush (usb_core_driver *udev, uint8_t ep_addr) { return 0U; }
+
+/* the media behind the cache counts its accesses and may fail the writes */
+static int8_t media_read (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len)
+{
+    count.isr_sync += test_isr;
+
+    return usbd_ram_fops.mem_read (lun, buf, block_addr, block_len);
+}
+
+static int8_t media_write (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len)
+{
+    count.isr_sync += test_isr;
+
+    return (0U != media_fail) ? -1 : usbd_ram_fops.mem_write (lun, buf, block_addr, block_len);
+}
+
+static int8_t media_read_async (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done)
+{
+    count.async++;
+
+    return usbd_ram_fops.mem_read_async (lun, buf, block_addr, block_len, done);
+}
+
+static int8_t media_write_async (uint8_t lun, uint8_t *buf, uint32_t block_addr, uint16_t block_len, usbd_mem_done done)
+{
+    count.async++;
+
+    return (0U != media_fail) ? -1 : usbd_ram_fops.mem_write_async (lun, buf, block_addr, block_len, done);
+}
+
+/*!
+    \brief      count a failed check
+    \param[in]  cond: check result
+    \param[in]  text: checked expression
+    \param[in]  line: source line of the check
+    \param[out] none
+    \retval     none
+*/
+static void test_check (int cond, const char *text, int line)
+{
+    if (!cond) {
+        printf("  FAIL line %d: %s\n", line, text);
+        fails++;
+    }
+}
+
+/*!
+    \brief      let the media complete its accesses, outside of the USB interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void test_poll (void)
+{
+    count.ticks++;
+    usbd_ram_poll();
+}
+
+/*!
+    \brief      run one command of the trace as the host
+    \param[in]  cb: command block
+    \param[in]  cb_len: command block length
+    \param[in]  dir_in: 1 for a device to host data stage
+    \param[in]  data: data of the data stage
+    \param[in]  len: length of the data stage
+    \param[out] none
+    \retval     CSW status, 0xFF if the device stopped answering
+*/
+static uint8_t test_cmd (const uint8_t *cb, uint8_t cb_len, uint8_t dir_in, uint8_t *data, uint32_t len)
+{
+    msc_bbb_cbw cbw;
+    msc_bbb_csw csw;
+    uint32_t pos = 0U, n, wait = 0U;
+
+    /* the previous command may still hold the CBW endpoint */
+    while (out_buf != (uint8_t *)&test_msc.bbb_cbw) {
+        if (++wait > TEST_WAIT_MAX) {
+            return 0xFFU;
+        }
+
+        test_poll();
+    }
+
+    memset(&cbw, 0, sizeof(cbw));
+    cbw.dCBWSignature = BBB_CBW_SIGNATURE;
+    cbw.dCBWTag = ++test_tag;
+    cbw.dCBWDataTransferLength = len;
+    cbw.bmCBWFlags = (0U != dir_in) ? 0x80U : 0x00U;
+    cbw.bCBWCBLength = cb_len;
+    memcpy(cbw.CBWCB, cb, cb_len);
+
+    memcpy(out_buf, &cbw, BBB_CBW_LENGTH);
+    out_buf = NULL;
+    test_udev.dev.transc_out[MSC_OUT_EP & 0x7FU].xfer_count = BBB_CBW_LENGTH;
+
+    test_isr = 1U;
+    msc_bbb_data_out (&test_udev, MSC_OUT_EP);
+    test_isr = 0U;
+
+    for (wait = 0U; wait < TEST_WAIT_MAX; wait++) {
+        if ((0U != in_armed) && (in_buf == (uint8_t *)&test_msc.bbb_csw)) {
+            break;
+        }
+
+        test_isr = 1U;
+
+        if (0U != in_stall) {
+            /* the host clears the halt, the device answers with a failed CSW */
+            in_stall = 0U;
+            msc_bbb_clrfeature (&test_udev, MSC_IN_EP);
+        } else if ((0U != dir_in) && (0U != in_armed)) {
+            n = USB_MIN(in_len, len - pos);
+            memcpy(&data[pos], in_buf, n);
+            pos += n;
+            in_armed = 0U;
+            msc_bbb_data_in (&test_udev, MSC_IN_EP);
+        } else if ((0U == dir_in) && (NULL != out_buf) && (pos < len)) {
+            n = USB_MIN(out_len, len - pos);
+            memcpy(out_buf, &data[pos], n);
+            pos += n;
+            out_buf = NULL;
+            test_udev.dev.transc_out[MSC_OUT_EP & 0x7FU].xfer_count = n;
+            msc_bbb_data_out (&test_udev, MSC_OUT_EP);
+        } else {
+            test_isr = 0U;
+            test_poll();
+        }
+
+        test_isr = 0U;
+    }
+
+    if (TEST_WAIT_MAX == wait) {
+        return 0xFFU;
+    }
+
+    memcpy(&csw, in_buf, BBB_CSW_LENGTH);
+    in_armed = 0U;
+
+    test_isr = 1U;
+    msc_bbb_data_in (&test_udev, MSC_IN_EP);
+    test_isr = 0U;
+
+    CHECK(BBB_CSW_SIGNATURE == csw.dCSWSignature);
+    CHECK(test_tag == csw.dCSWTag);
+
+    if (CSW_CMD_PASSED == csw.bCSWStatus) {
+        CHECK(pos == len);
+        CHECK(0U == csw.dCSWDataResidue);
+    }
+
+    return csw.bCSWStatus;
+}
+
+/*!
+    \brief      run a command without data stage
+    \param[in]  op: operation code
+    \param[in]  byte4: byte 4 of the command block
+    \param[out] none
+    \retval     CSW status
+*/
+static uint8_t test_cmd6 (uint8_t op, uint8_t byte4)
+{
+    uint8_t cb[6] = {op, 0U, 0U, 0U, byte4, 0U};
+
+    return test_cmd (cb, 6U, 0U, NULL, 0U);
+}
+
+/*!
+    \brief      read or write blocks with Read10/Write10
+    \param[in]  write: 1 to write the blocks
+    \param[in]  lba: first block
+    \param[in]  blks: number of blocks
+    \param[in]  data: block data
+    \param[out] none
+    \retval     CSW status
+*/
+static uint8_t test_rw (uint8_t write, uint32_t lba, uint16_t blks, uint8_t *data)
+{
+    uint8_t cb[10] = {(0U != write) ? SCSI_WRITE10 : SCSI_READ10, 0U,
+                      (uint8_t)(lba >> 24U), (uint8_t)(lba >> 16U), (uint8_t)(lba >> 8U), (uint8_t)lba,
+                      0U, (uint8_t)(blks >> 8U), (uint8_t)blks, 0U};
+
+    return test_cmd (cb, 10U, (uint8_t)(0U == write), data, (uint32_t)blks * TEST_BLK);
+}
+
+/*!
+    \brief      write blocks of new content and keep the shadow copy
+    \param[in]  lba: first block
+    \param[in]  blks: number of blocks
+    \param[in]  seed: content seed
+    \param[out] none
+    \retval     none
+*/
+static void test_write (uint32_t lba, uint16_t blks, uint32_t seed)
+{
+    uint32_t i;
+
+    for (i = 0U; i < (uint32_t)blks * TEST_BLK; i++) {
+        host_buf[i] = (uint8_t)((seed * 131U) + (i * 7U) + (i >> 9U));
+    }
+
+    memcpy(&shadow[lba * TEST_BLK], host_buf, (uint32_t)blks * TEST_BLK);
+
+    CHECK(CSW_CMD_PASSED == test_rw (1U, lba, blks, host_buf));
+}
+
+/*!
+    \brief      read blocks and compare them with the shadow copy
+    \param[in]  lba: first block
+    \param[in]  blks: number of blocks
+    \param[out] none
+    \retval     none
+*/
+static void test_read (uint32_t lba, uint16_t blks)
+{
+    memset(host_buf, 0xA5, (uint32_t)blks * TEST_BLK);
+
+    CHECK(CSW_CMD_PASSED == test_rw (0U, lba, blks, host_buf));
+    CHECK(0 == memcmp(host_buf, &shadow[lba * TEST_BLK], (uint32_t)blks * TEST_BLK));
+}
+
+/*!
+    \brief      replay the trace of a host mounting the volume and copying a file to it
+    \param[in]  async: 1 to give the cache the asynchronous media hooks
+    \param[out] none
+    \retval     none
+*/
+static void test_trace (uint8_t async)
+{
+    static uint8_t disk[TEST_BLK_NUM * TEST_BLK];
+    uint8_t inquiry[6] = {SCSI_INQUIRY, 0U, 0U, 0U, USBD_STD_INQUIRY_LENGTH, 0U};
+    uint8_t capacity[10] = {SCSI_READ_CAPACITY10, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
+    uint8_t sync[10] = {SCSI_SYNCHRONIZE_CACHE10, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
+    uint8_t sense[6] = {SCSI_REQUEST_SENSE, 0U, 0U, 0U, REQUEST_SENSE_DATA_LEN, 0U};
+    uint8_t data[64];
+    usbd_cache_stat stat;
+    uint32_t i, c, lba;
+
+    printf("%s media:\n", (0U != async) ? "asynchronous" : "synchronous");
+
+    memset(&count, 0, sizeof(count));
+    memset(&test_msc, 0, sizeof(test_msc));
+    memset(&test_udev, 0, sizeof(test_udev));
+    test_udev.dev.class_data[USBD_MSC_INTERFACE] = &test_msc;
+
+    /* a formatted volume */
+    for (i = 0U; i < sizeof(shadow); i++) {
+        shadow[i] = (uint8_t)(i * 13U + (i >> 9U));
+    }
+
+    usbd_ram_latency_set (0U);
+    (void)usbd_ram_fops.mem_write (0U, shadow, 0U, TEST_BLK_NUM);
+    usbd_ram_latency_set (TEST_LATENCY);
+
+    test_media = usbd_ram_fops;
+    test_media.mem_read = media_read;
+    test_media.mem_write = media_write;
+    test_media.mem_read_async = (0U != async) ? media_read_async : NULL;
+    test_media.mem_write_async = (0U != async) ? media_write_async : NULL;
+
+    CHECK(0 == usbd_cache_init (&test_media));
+    CHECK((NULL != usbd_cache_fops.mem_read_async) == (0U != async));
+    usbd_mem_fops = &usbd_cache_fops;
+
+    msc_bbb_init (&test_udev);
+
+    /* enumeration */
+    CHECK(CSW_CMD_PASSED == test_cmd (inquiry, 6U, 1U, data, USBD_STD_INQUIRY_LENGTH));
+    CHECK(CSW_CMD_PASSED == test_cmd (capacity, 10U, 1U, data, 8U));
+    CHECK(TEST_BLK_NUM - 1U == (((uint32_t)data[2] << 8U) | data[3]));
+    CHECK(CSW_CMD_PASSED == test_cmd6 (SCSI_TEST_UNIT_READY, 0U));
+
+    /* mount: boot sector, FAT and root directory one block at a time */
+    test_read (0U, 1U);
+
+    for (i = 0U; i < TEST_FAT_BLKS; i++) {
+        test_read (TEST_FAT_LBA + i, 1U);
+    }
+
+    test_read (TEST_DIR_LBA, 4U);
+
+    /* file copy: clusters in one command each, FAT and directory entry updates in between */
+    for (c = 0U; c < TEST_FILE_CLUSTERS; c++) {
+        lba = TEST_DATA_LBA + (c * TEST_CLUSTER_BLKS);
+
+        test_write (lba, TEST_CLUSTER_BLKS, c);
+        test_write (TEST_FAT_LBA + (c / 4U), 1U, 100U + c);
+        test_write (TEST_DIR_LBA, 1U, 200U + c);
+
+        if (3U == (c % 4U)) {
+            /* the host polls while the copy waits for the source */
+            CHECK(CSW_CMD_PASSED == test_cmd6 (SCSI_TEST_UNIT_READY, 0U));
+            test_read (TEST_FAT_LBA, 2U);
+        }
+    }
+
+    /* read the copy back: the clusters bypass the cache, the dirty FAT comes from it */
+    for (c = 0U; c < TEST_FILE_CLUSTERS; c++) {
+        test_read (TEST_DATA_LBA + (c * TEST_CLUSTER_BLKS), TEST_CLUSTER_BLKS);
+    }
+
+    test_read (TEST_FAT_LBA, TEST_FAT_BLKS);
+
+    /* directory listing, small sequential reads fetched ahead */
+    for (i = 0U; i < 16U; i++) {
+        test_read (TEST_DIR_LBA + i, 1U);
+    }
+
+    CHECK(CSW_CMD_PASSED == test_cmd (sync, 10U, 0U, NULL, 0U));
+
+    /* a write-back failure reaches the host through Synchronize Cache */
+    test_write (TEST_DIR_LBA, 1U, 300U);
+    media_fail = 1U;
+    CHECK(CSW_CMD_FAILED == test_cmd (sync, 10U, 0U, NULL, 0U));
+    CHECK(CSW_CMD_PASSED == test_cmd (sense, 6U, 1U, data, REQUEST_SENSE_DATA_LEN));
+    CHECK((HARDWARE_ERROR == data[2]) && (WRITE_FAULT == data[12]));
+    media_fail = 0U;
+    test_read (TEST_DIR_LBA, 1U);
+    CHECK(CSW_CMD_PASSED == test_cmd (sync, 10U, 0U, NULL, 0U));
+
+    /* eject */
+    test_write (TEST_FAT_LBA, 1U, 400U);
+    CHECK(CSW_CMD_PASSED == test_cmd6 (SCSI_START_STOP_UNIT, 0x02U));
+
+    usbd_cache_stat_get (&stat);
+    usbd_ram_latency_set (0U);
+    (void)usbd_ram_fops.mem_read (0U, disk, 0U, TEST_BLK_NUM);
+    CHECK(0 == memcmp(disk, shadow, sizeof(disk)));
+
+    printf("  %u polls, %u async accesses, %u sync accesses in the USB interrupt\n",
+           (unsigned)count.ticks, (unsigned)count.async, (unsigned)count.isr_sync);
+    printf("  hits %u misses %u ahead %u/%u bypass %u write hits %u write-backs %u flushes %u\n",
+           (unsigned)stat.hits, (unsigned)stat.misses, (unsigned)stat.read_ahead_hits, (unsigned)stat.read_ahead,
+           (unsigned)stat.bypass, (unsigned)stat.write_hits, (unsigned)stat.write_backs, (unsigned)stat.flushes);
+
+    CHECK(stat.hits > 0U);
+    CHECK(stat.read_ahead_hits > 0U);
+    CHECK(stat.write_hits > 0U);
+    CHECK(stat.bypass >= 2U * TEST_FILE_CLUSTERS * TEST_CLUSTER_BLKS);
+
+    if (0U != async) {
+        /* the USB interrupt only starts media accesses, they all complete in the polls */
+        CHECK(0U == count.isr_sync);
+        CHECK(count.async > 0U);
+    } else {
+        CHECK(count.isr_sync > 0U);
+        CHECK(0U == count.async);
+    }
+}
+
+int main (void)
+{
+    test_trace (0U);
+    test_trace (1U);
+
+    printf("%s\n", (0U == fails) ? "PASS" : "FAIL");
+
+    return (0U == fails) ? 0 : 1;
+}
@@ -53,9 +53,12 @@ OF SUCH DAMAGE.
 
 #define SCSI_READ_CAPACITY10                        0x25U
 #define SCSI_READ_CAPACITY16                        0x9EU
+#define SERVICE_ACTION_READ_CAPACITY16              0x10U
 
 #define SCSI_REQUEST_SENSE                          0x03U
 #define SCSI_START_STOP_UNIT                        0x1BU
+#define SCSI_SYNCHRONIZE_CACHE10                    0x35U
+#define SCSI_SYNCHRONIZE_CACHE16                    0x91U
 #define SCSI_TEST_UNIT_READY                        0x00U
 #define SCSI_WRITE6                                 0x0AU
 #define SCSI_WRITE10                                0x2AU
@@ -74,6 +77,7 @@ OF SUCH DAMAGE.
 #define PARAMETER_LIST_LENGTH_ERROR                 0x1AU
 #define INVALID_FIELD_IN_PARAMETER_LIST             0x26U
 #define ADDRESS_OUT_OF_RANGE                        0x21U
+#define LOGICAL_UNIT_NOT_READY                      0x04U
 #define MEDIUM_NOT_PRESENT                          0x3AU
 #define MEDIUM_HAVE_CHANGED                         0x28U
 #define WRITE_PROTECTED                             0x27U
@@ -82,6 +86,7 @@ OF SUCH DAMAGE.
 
 #define READ_FORMAT_CAPACITY_DATA_LEN               0x0CU
 #define READ_CAPACITY10_DATA_LEN                    0x08U
+#define READ_CAPACITY16_DATA_LEN                    0x20U
 #define MODE_SENSE10_DATA_LEN                       0x08U
 #define MODE_SENSE6_DATA_LEN                        0x04U
 #define READ_TOC_CMD_LEN                            0x14U
@@ -141,6 +141,7 @@ enum _usbx_type {
 #define BYTE_HIGH(x)         ((uint8_t)(((x) & 0xFF00U) >> 8U))
 
 #define USB_MIN(a, b)        (((a) < (b)) ? (a) : (b))
+#define USB_MAX(a, b)        (((a) > (b)) ? (a) : (b))
 
 #define USB_DEFAULT_CONFIG                  0U
 
@@ -6,6 +6,8 @@
  * {data}         rgw          first version
  */
 #include "sdk_board.h"
+#include "gd32_common.h"
+
 void sdk_hw_us_delay(uint32_t us)
 {
     uint32_t ticks;
@@ -36,14 +38,158 @@ void sdk_hw_us_delay(uint32_t us)
     }
 }
 
+static volatile uint32_t irq_nest = 0;
+static volatile uint32_t irq_primask = 0;
+
 void sdk_hw_interrupt_enable(void)
 {
-    __enable_irq();
+    /* an enable without a matching disable unmasks, as it always did */
+    if (irq_nest == 0)
+    {
+        __enable_irq();
+        return;
+    }
+    /* only the outermost enable restores the state saved by the first disable */
+    if (--irq_nest == 0)
+    {
+        __set_PRIMASK(irq_primask);
+    }
 }
 
 void sdk_hw_interrupt_disable(void)
 {
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (irq_nest++ == 0)
+    {
+        irq_primask = primask;
+    }
+}
+
+#if defined(SOC_SERIES_GD32L23x)
+/* Cortex-M23 has no BASEPRI, mask everything through PRIMASK */
+uint32_t sdk_hw_critical_enter(void)
+{
+    uint32_t level = __get_PRIMASK();
+
     __disable_irq();
+    return level;
+}
+
+void sdk_hw_critical_exit(uint32_t level)
+{
+    __set_PRIMASK(level);
+}
+
+void sdk_hw_critical_threshold_set(uint32_t preempt_prio)
+{
+    (void)preempt_prio;
+}
+
+#define CRITICAL_CYCLES()   0U
+
+#else
+/* 0 until first use, the NVIC priority grouping is only known at run time */
+static uint32_t critical_basepri = 0;
+
+/* BASEPRI value masking preempt_prio and lower under the current priority grouping */
+static uint32_t critical_basepri_calc(uint32_t preempt_prio)
+{
+    uint32_t prio;
+
+    /* threshold 0 would disable BASEPRI masking, keep at least priority 1 */
+    if (preempt_prio == 0)
+    {
+        preempt_prio = 1;
+    }
+    prio = NVIC_EncodePriority(NVIC_GetPriorityGrouping(), preempt_prio, 0);
+
+    return (prio << (8U - __NVIC_PRIO_BITS)) & 0xFFU;
+}
+
+uint32_t sdk_hw_critical_enter(void)
+{
+    uint32_t level = __get_BASEPRI();
+
+    if (critical_basepri == 0)
+    {
+        critical_basepri = critical_basepri_calc(SDK_HW_CRITICAL_PREEMPT_PRIO);
+    }
+    /* only raise the mask, a nested section never lowers it */
+    if ((level == 0) || (level > critical_basepri))
+    {
+        __set_BASEPRI(critical_basepri);
+        __DSB();
+        __ISB();
+    }
+    return level;
+}
+
+void sdk_hw_critical_exit(uint32_t level)
+{
+    __set_BASEPRI(level);
+}
+
+/* call again after changing the priority grouping */
+void sdk_hw_critical_threshold_set(uint32_t preempt_prio)
+{
+    critical_basepri = critical_basepri_calc(preempt_prio);
+}
+
+#define CRITICAL_CYCLES()   (DWT->CYCCNT)
+
+#endif
+
+static sdk_hw_critical_site_t *critical_sites = NULL;
+
+uint32_t sdk_hw_critical_enter_site(sdk_hw_critical_site_t *site)
+{
+    uint32_t level = sdk_hw_critical_enter();
+
+    if (site->count++ == 0)
+    {
+        site->next = critical_sites;
+        critical_sites = site;
+#if !defined(SOC_SERIES_GD32L23x)
+        if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+        {
+            CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+            DWT->CYCCNT = 0;
+            DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        }
+#endif
+    }
+    site->start = CRITICAL_CYCLES();
+    return level;
+}
+
+void sdk_hw_critical_exit_site(sdk_hw_critical_site_t *site, uint32_t level)
+{
+    site->last_cycles = CRITICAL_CYCLES() - site->start;
+    if (site->last_cycles > site->max_cycles)
+    {
+        site->max_cycles = site->last_cycles;
+    }
+    sdk_hw_critical_exit(level);
+}
+
+sdk_hw_critical_site_t *sdk_hw_critical_site_list(void)
+{
+    return critical_sites;
+}
+
+void sdk_hw_critical_site_reset(void)
+{
+    sdk_hw_critical_site_t *site;
+    uint32_t level = sdk_hw_critical_enter();
+
+    for (site = critical_sites; site != NULL; site = site->next)
+    {
+        site->last_cycles = 0;
+        site->max_cycles = 0;
+    }
+    sdk_hw_critical_exit(level);
 }
 
 #if 0 // It is usually implemented in sdk_board.c
@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2022 Infinitech Technology Co., Ltd
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     agent        first version, nestable critical section
+ */
+
+#ifndef __GD32_COMMON_H
+#define __GD32_COMMON_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Critical section threshold, as a pre-emption priority (0 is the highest).
+ * Interrupts whose pre-emption priority is numerically lower than this value
+ * keep running inside a critical section, everything else is masked.
+ * It is encoded with the NVIC priority grouping in effect at the first
+ * critical section, call sdk_hw_critical_threshold_set() after changing it.
+ * L23x (Cortex-M23) has no BASEPRI and always falls back to PRIMASK.
+ */
+#ifndef SDK_HW_CRITICAL_PREEMPT_PRIO
+#define SDK_HW_CRITICAL_PREEMPT_PRIO    1U
+#endif
+
+/* per call site hold time record, only updated with SDK_HW_CRITICAL_PROFILE */
+typedef struct sdk_hw_critical_site
+{
+    const char *name;
+    uint32_t count;
+    uint32_t start;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+    struct sdk_hw_critical_site *next;
+} sdk_hw_critical_site_t;
+
+uint32_t sdk_hw_critical_enter(void);
+void sdk_hw_critical_exit(uint32_t level);
+void sdk_hw_critical_threshold_set(uint32_t preempt_prio);
+
+uint32_t sdk_hw_critical_enter_site(sdk_hw_critical_site_t *site);
+void sdk_hw_critical_exit_site(sdk_hw_critical_site_t *site, uint32_t level);
+sdk_hw_critical_site_t *sdk_hw_critical_site_list(void);
+void sdk_hw_critical_site_reset(void);
+
+#ifdef SDK_HW_CRITICAL_PROFILE
+#define SDK_HW_CRITICAL_SITE(site)          static sdk_hw_critical_site_t site = {#site}
+#define SDK_HW_CRITICAL_ENTER(site)         sdk_hw_critical_enter_site(&(site))
+#define SDK_HW_CRITICAL_EXIT(site, level)   sdk_hw_critical_exit_site(&(site), (level))
+#else
+#define SDK_HW_CRITICAL_SITE(site)
+#define SDK_HW_CRITICAL_ENTER(site)         sdk_hw_critical_enter()
+#define SDK_HW_CRITICAL_EXIT(site, level)   sdk_hw_critical_exit(level)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GD32_COMMON_H */
@@ -0,0 +1,297 @@
+/**
+ * Copyright (c) 2022 Infinitech Technology Co., Ltd
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     agent        first version, multicast filter manager
+ * 2026-10-19     agent        add PTP engine
+ * 2026-10-19     agent        add telemetry sampler
+ * 2026-10-19     agent        add adaptive flow control
+ * 2026-10-19     agent        add UDP fast path
+ * 2026-10-19     agent        add non-blocking PHY manager
+ * 2026-10-19     agent        add VLAN tagging and priority Tx scheduler
+ */
+
+#ifndef __GD32_ENET_H
+#define __GD32_ENET_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Multicast filter manager. The first groups take the perfect filters of MAC
+ * address 1 to 3, the rest go to the 64 bit hash table, and frames hitting a
+ * hash bucket are checked in software against the joined groups.
+ * MAC address 1 to 3 belong to the manager once it is initialized.
+ */
+#ifndef GD32_ENET_MCAST_MAX
+#define GD32_ENET_MCAST_MAX             64
+#endif
+
+typedef struct gd32_enet_mcast_stat
+{
+    uint32_t groups;            /* joined groups */
+    uint32_t perfect;           /* groups in the perfect filters */
+    uint32_t hashed;            /* groups in the hash table */
+    uint32_t buckets;           /* hash table bits set */
+    uint32_t sw_checked;        /* frames checked in software after a hash hit */
+    uint32_t sw_dropped;        /* hash collisions dropped in software */
+} gd32_enet_mcast_stat_t;
+
+int gd32_enet_mcast_init(void);
+int gd32_enet_mcast_join(const uint8_t *addr);
+int gd32_enet_mcast_leave(const uint8_t *addr);
+int gd32_enet_mcast_accept(const uint8_t *frame);
+uint32_t gd32_enet_mcast_hash(const uint8_t *addr);
+void gd32_enet_mcast_stat_get(gd32_enet_mcast_stat_t *stat);
+
+/*
+ * IEEE 1588 v2 engine on the MAC hardware timestamps, the PTP clock runs at
+ * 50 MHz (20 ns subsecond increment, digital rollover) and is disciplined by
+ * a PI servo on the addend register. One-step and two-step masters are both
+ * accepted by the slave, the master side is two-step. Messages are passed
+ * from the PTP header on, the transport (Ethernet or UDP) is up to the caller.
+ */
+#ifndef GD32_ENET_PTP_STEP_NS
+#define GD32_ENET_PTP_STEP_NS           1000000     /* offsets above it step the clock */
+#endif
+#ifndef GD32_ENET_PTP_LOCK_NS
+#define GD32_ENET_PTP_LOCK_NS           1000        /* servo is locked when offsets stay below it */
+#endif
+#ifndef GD32_ENET_PTP_MAX_PPB
+#define GD32_ENET_PTP_MAX_PPB           500000
+#endif
+
+typedef struct gd32_enet_ptp_time
+{
+    uint32_t sec;
+    uint32_t nsec;
+} gd32_enet_ptp_time_t;
+
+/* send a PTP message, event messages return their transmit timestamp in tx_ts */
+typedef int (*gd32_enet_ptp_send_t)(const uint8_t *msg, uint32_t len, int event, gd32_enet_ptp_time_t *tx_ts);
+
+typedef struct gd32_enet_ptp_stat
+{
+    int64_t offset_ns;          /* last offset from master */
+    int64_t delay_ns;           /* mean path delay */
+    int32_t freq_ppb;           /* frequency adjustment in use */
+    uint32_t locked;
+    uint32_t syncs;             /* sync messages handled, sent by a master */
+    uint32_t steps;             /* clock steps */
+    uint32_t delay_reqs;        /* delay requests handled, sent by a slave */
+} gd32_enet_ptp_stat_t;
+
+int gd32_enet_ptp_init(uint32_t hclk, int master, const uint8_t *clock_id, gd32_enet_ptp_send_t send);
+void gd32_enet_ptp_time_get(gd32_enet_ptp_time_t *time);
+int gd32_enet_ptp_time_set(const gd32_enet_ptp_time_t *time);
+int gd32_enet_ptp_step(int64_t ns);
+int gd32_enet_ptp_adjfreq(int32_t ppb);
+int gd32_enet_ptp_servo_sample(int64_t offset_ns);
+int gd32_enet_ptp_pps_config(uint32_t freq);
+int gd32_enet_ptp_rx(const uint8_t *msg, uint32_t len, const gd32_enet_ptp_time_t *rx_ts);
+int gd32_enet_ptp_poll(void);
+void gd32_enet_ptp_stat_get(gd32_enet_ptp_stat_t *stat);
+
+/*
+ * Telemetry sampler. gd32_enet_telemetry_sample() is called periodically from
+ * a thread with a millisecond time stamp, it folds the MSC counters and the
+ * DMA missed frame counters into 64 bit totals and per second rates over the
+ * last interval. The missed frame counters clear on read and are 16 and 11
+ * bits wide, so sample well before they can wrap under the worst case load.
+ */
+typedef enum
+{
+    GD32_ENET_TM_TX_GOOD = 0,   /* transmitted good frames */
+    GD32_ENET_TM_TX_SINGLE_COL, /* transmitted after a single collision */
+    GD32_ENET_TM_TX_MULTI_COL,  /* transmitted after more than one collision */
+    GD32_ENET_TM_RX_UNICAST,    /* received good unicast frames */
+    GD32_ENET_TM_RX_CRC_ERR,
+    GD32_ENET_TM_RX_ALIGN_ERR,
+    GD32_ENET_TM_RX_FIFO_DROP,  /* missed by the application, Rx FIFO overflow */
+    GD32_ENET_TM_RX_DMA_DROP,   /* missed by the controller, no free Rx descriptor */
+    GD32_ENET_TM_NUM
+} gd32_enet_tm_counter_t;
+
+typedef struct gd32_enet_telemetry
+{
+    uint64_t total[GD32_ENET_TM_NUM];
+    uint32_t rate[GD32_ENET_TM_NUM];    /* per second over the last interval */
+    uint32_t interval_ms;               /* length of the last interval */
+    uint32_t samples;
+} gd32_enet_telemetry_t;
+
+int gd32_enet_telemetry_init(uint32_t now_ms);
+void gd32_enet_telemetry_sample(uint32_t now_ms);
+void gd32_enet_telemetry_get(gd32_enet_telemetry_t *tm);
+uint64_t gd32_enet_telemetry_total(gd32_enet_tm_counter_t counter);
+uint32_t gd32_enet_telemetry_rate(gd32_enet_tm_counter_t counter);
+
+/*
+ * Adaptive flow control on the Rx descriptor ring occupancy. Above the high
+ * watermark the link partner is paused (full duplex) or back pressured (half
+ * duplex), the pause is refreshed before it expires and released with a zero
+ * quanta pause once the occupancy is back under the low watermark.
+ * gd32_enet_flowctl_update() is called after each Rx batch and from a timer,
+ * it reads speed and duplex from the MAC so it follows the link changes.
+ */
+#ifndef GD32_ENET_FLOWCTL_PAUSE_TIME
+#define GD32_ENET_FLOWCTL_PAUSE_TIME    0x1000      /* pause quanta of 512 bit times */
+#endif
+
+typedef struct gd32_enet_flowctl_stat
+{
+    uint32_t paused;            /* 1 while the link partner is held */
+    uint32_t pauses;            /* pause frames or back pressure asserted */
+    uint32_t refreshes;         /* pause frames sent again before expiry */
+    uint32_t releases;          /* zero quanta pause frames or back pressure released */
+    uint32_t occupancy;         /* Rx descriptors in use at the last update */
+    uint32_t occupancy_max;
+} gd32_enet_flowctl_stat_t;
+
+int gd32_enet_flowctl_init(uint32_t high, uint32_t low);
+void gd32_enet_flowctl_update(uint32_t now_ms);
+void gd32_enet_flowctl_stat_get(gd32_enet_flowctl_stat_t *stat);
+
+/*
+ * UDP/IPv4 fast path straight on the descriptor rings. A flow keeps a
+ * prebuilt Ethernet/IPv4/UDP header, gd32_enet_udp_tx_alloc() copies it into
+ * the current Tx DMA buffer and returns where the payload goes, and
+ * gd32_enet_udp_tx_send() hands the frame to the DMA with IP and UDP checksum
+ * insertion, which needs the Tx FIFO in store-and-forward mode. Addresses are
+ * in host byte order. The fast path is not reentrant, call all of it from
+ * the network thread, and reclaim the Tx ring first when it is mixed with
+ * enet_frame_transmit_sg().
+ */
+#ifndef GD32_ENET_ARP_NUM
+#define GD32_ENET_ARP_NUM               8
+#endif
+
+/* first ARP retry interval of an unresolved flow, doubled after each unanswered request */
+#ifndef GD32_ENET_ARP_RETRY_MS
+#define GD32_ENET_ARP_RETRY_MS          1000
+#endif
+
+#define GD32_ENET_UDP_HDR_LEN           42          /* Ethernet, IPv4 and UDP headers */
+
+/* a datagram for this host */
+typedef void (*gd32_enet_udp_rx_t)(uint32_t src_ip, uint16_t src_port, uint16_t dst_port,
+                                   const uint8_t *data, uint32_t len);
+
+typedef struct gd32_enet_udp_flow
+{
+    uint32_t dst_ip;
+    uint32_t next_hop;          /* dst_ip or the gateway */
+    uint16_t ip_id;
+    uint8_t resolved;           /* destination MAC known */
+    uint8_t arp_tries;          /* unanswered ARP requests */
+    uint32_t arp_tick;          /* systick of the last ARP request */
+    uint8_t hdr[GD32_ENET_UDP_HDR_LEN];
+} gd32_enet_udp_flow_t;
+
+typedef struct gd32_enet_udp_stat
+{
+    uint32_t tx_frames;
+    uint32_t tx_bytes;          /* payload bytes */
+    uint32_t tx_busy;           /* no free Tx descriptor */
+    uint32_t rx_frames;         /* datagrams given to the handler */
+    uint32_t rx_dropped;        /* bad or unbound IPv4/UDP frames for this host */
+    uint32_t rx_checksum_err;   /* of them, IP header or UDP checksum errors */
+    uint32_t arp_requests;      /* requests sent */
+    uint32_t arp_replies;       /* replies sent */
+} gd32_enet_udp_stat_t;
+
+int gd32_enet_udp_init(const uint8_t *mac, uint32_t ip, uint32_t netmask, uint32_t gateway, gd32_enet_udp_rx_t rx);
+int gd32_enet_udp_flow_init(gd32_enet_udp_flow_t *flow, uint32_t dst_ip, uint16_t src_port, uint16_t dst_port);
+int gd32_enet_udp_resolve(gd32_enet_udp_flow_t *flow);
+uint8_t *gd32_enet_udp_tx_alloc(gd32_enet_udp_flow_t *flow, uint32_t *max_len);
+int gd32_enet_udp_tx_send(gd32_enet_udp_flow_t *flow, uint32_t len);
+int gd32_enet_udp_input(const uint8_t *frame, uint32_t len, uint32_t checksum);
+void gd32_enet_udp_stat_get(gd32_enet_udp_stat_t *stat);
+
+/*
+ * Non-blocking PHY manager. Bring the MAC up with enet_init(ENET_PHY_DEFERRED,
+ * ...) so nothing waits for the PHY, then call gd32_enet_phy_poll() every few
+ * milliseconds from a timer or thread, and from the PHY interrupt if wired.
+ * Each call runs at most one step of the PHY reset, auto-negotiation and link
+ * monitoring, one MDIO access is started or collected per call. The MAC speed
+ * and duplex are set on link up before the link callback runs.
+ */
+#ifndef GD32_ENET_PHY_RESET_MS
+#define GD32_ENET_PHY_RESET_MS          500
+#endif
+#ifndef GD32_ENET_PHY_ANEG_MS
+#define GD32_ENET_PHY_ANEG_MS           5000        /* auto-negotiation is restarted after it */
+#endif
+
+/* link change, mediamode is one of ENET_100M_FULLDUPLEX ... ENET_10M_HALFDUPLEX */
+typedef void (*gd32_enet_phy_link_t)(int up, uint32_t mediamode);
+
+typedef struct gd32_enet_phy_stat
+{
+    uint32_t state;
+    uint32_t link_up;
+    uint32_t mediamode;         /* valid while the link is up */
+    uint32_t link_ups;
+    uint32_t link_downs;
+    uint32_t resets;            /* PHY resets, including the first one */
+    uint32_t aneg_timeouts;
+} gd32_enet_phy_stat_t;
+
+int gd32_enet_phy_init(uint32_t mediamode, gd32_enet_phy_link_t link);
+void gd32_enet_phy_poll(uint32_t now_ms);
+int gd32_enet_phy_link_up(void);
+void gd32_enet_phy_stat_get(gd32_enet_phy_stat_t *stat);
+
+/*
+ * VLAN tagging and priority Tx scheduler. Frames are queued by priority,
+ * queue 0 first, and gd32_enet_txq_run() moves them into the Tx ring,
+ * inserting the 802.1Q tag on the way. Queues are served in strict priority,
+ * the last one carries bulk traffic and is shaped by a token bucket. Bulk
+ * also never takes the last GD32_ENET_TXQ_RESERVE free Tx descriptors, so a
+ * burst cannot fill the ring ahead of control frames whatever the rate.
+ * Time stamps are in us from any free running counter. The MAC has no tag
+ * insertion, tags are written while the frame is copied into the DMA buffer.
+ */
+#ifndef GD32_ENET_TXQ_NUM
+#define GD32_ENET_TXQ_NUM               4
+#endif
+#ifndef GD32_ENET_TXQ_DEPTH
+#define GD32_ENET_TXQ_DEPTH             16
+#endif
+#ifndef GD32_ENET_TXQ_RESERVE
+#define GD32_ENET_TXQ_RESERVE           2               /* Tx descriptors kept for the higher queues */
+#endif
+
+#define GD32_ENET_VLAN_NONE             0xFFFFFFFFUL    /* send the frame untagged */
+#define GD32_ENET_VLAN_TCI(pcp, vid)    ((((uint32_t)(pcp) & 0x7) << 13) | ((uint32_t)(vid) & 0xFFF))
+
+/* the frame was handed to the DMA or dropped, its buffer is free again */
+typedef void (*gd32_enet_txq_release_t)(void *token);
+
+typedef struct gd32_enet_txq_stat
+{
+    uint32_t depth;
+    uint32_t depth_max;
+    uint32_t sent;
+    uint32_t dropped;           /* queue full or frame too large */
+    uint32_t latency_last_us;   /* enqueue to Tx ring */
+    uint32_t latency_max_us;
+    uint64_t latency_sum_us;    /* divided by sent for the mean */
+} gd32_enet_txq_stat_t;
+
+int gd32_enet_vlan_filter_set(uint32_t vid);
+uint8_t *gd32_enet_vlan_untag(uint8_t *frame, uint32_t *len, uint32_t *tci);
+int gd32_enet_txq_init(uint32_t bulk_rate, uint32_t bulk_burst, gd32_enet_txq_release_t release);
+int gd32_enet_txq_enqueue(uint32_t queue, const uint8_t *frame, uint32_t len, uint32_t tci, void *token, uint32_t now_us);
+uint32_t gd32_enet_txq_run(uint32_t now_us);
+void gd32_enet_txq_stat_get(uint32_t queue, gd32_enet_txq_stat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GD32_ENET_H */
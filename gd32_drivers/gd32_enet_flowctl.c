@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2022 Infinitech Technology Co., Ltd
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     agent        first version
+ */
+
+#include <string.h>
+#include "sdk_board.h"
+#include "gd32_common.h"
+#include "gd32_enet.h"
+
+typedef struct
+{
+    uint32_t high;
+    uint32_t low;
+    uint32_t sent_ms;           /* last pause frame */
+    uint32_t refresh_ms;        /* half of the pause duration at the current speed */
+    uint32_t quanta_ns;         /* pause quantum at the current speed */
+    uint8_t full_duplex;
+    gd32_enet_flowctl_stat_t stat;
+} flowctl_ctx_t;
+
+static flowctl_ctx_t flowctl_ctx;
+
+/*
+ * Speed and duplex follow the MAC, which the PHY driver sets on each link
+ * up. A hold made in another mode does not carry over, a pause sent at the
+ * other speed runs out at another time, so it is dropped and the next update
+ * holds the partner again if the ring is still above high.
+ */
+static void flowctl_link_sample(void)
+{
+    uint32_t cfg = ENET_MAC_CFG, quanta_ns;
+    uint8_t full_duplex = (cfg & ENET_MAC_CFG_DPM) ? 1 : 0;
+
+    /* a pause quantum is 512 bit times */
+    quanta_ns = (cfg & ENET_MAC_CFG_SPD) ? 5120 : 51200;
+    if ((flowctl_ctx.stat.paused != 0) && ((full_duplex != flowctl_ctx.full_duplex) || (quanta_ns != flowctl_ctx.quanta_ns)))
+    {
+        if (flowctl_ctx.full_duplex == 0)
+        {
+            enet_flowcontrol_feature_disable(ENET_BACK_PRESSURE);
+        }
+        flowctl_ctx.stat.paused = 0;
+        flowctl_ctx.stat.releases++;
+    }
+    flowctl_ctx.full_duplex = full_duplex;
+    flowctl_ctx.quanta_ns = quanta_ns;
+    flowctl_ctx.refresh_ms = (uint32_t)((uint64_t)GD32_ENET_FLOWCTL_PAUSE_TIME * quanta_ns / 2000000);
+}
+
+/* high and low are watermarks in Rx descriptors, 0 picks 3/4 and 1/4 of the ring */
+int gd32_enet_flowctl_init(uint32_t high, uint32_t low)
+{
+    uint32_t total;
+
+    enet_rxdesc_occupancy_get(&total);
+    if (high == 0)
+    {
+        high = total * 3 / 4;
+    }
+    if (low == 0)
+    {
+        low = total / 4;
+    }
+    if ((high > total) || (low >= high))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    memset(&flowctl_ctx, 0, sizeof(flowctl_ctx));
+    flowctl_ctx.high = high;
+    flowctl_ctx.low = low;
+    flowctl_link_sample();
+
+    /* pause frames are generated in software, the MAC only sends them */
+    enet_pauseframe_config(GD32_ENET_FLOWCTL_PAUSE_TIME, ENET_PAUSETIME_MINUS28);
+    enet_flowcontrol_feature_enable(ENET_TX_FLOWCONTROL);
+
+    return SDK_OK;
+}
+
+static int flowctl_pause(uint32_t pause_time)
+{
+    if (flowctl_ctx.full_duplex == 0)
+    {
+        if (pause_time != 0)
+        {
+            enet_flowcontrol_feature_enable(ENET_BACK_PRESSURE);
+        }
+        else
+        {
+            enet_flowcontrol_feature_disable(ENET_BACK_PRESSURE);
+        }
+        return SDK_OK;
+    }
+
+    /* the previous pause frame is still on its way when this fails */
+    if (ENET_MAC_FCTL & ENET_MAC_FCTL_FLCBBKPA)
+    {
+        return -SDK_E_BUSY;
+    }
+    enet_pauseframe_config(pause_time, ENET_PAUSETIME_MINUS28);
+
+    return (enet_pauseframe_generate() == SUCCESS) ? SDK_OK : -SDK_E_BUSY;
+}
+
+void gd32_enet_flowctl_update(uint32_t now_ms)
+{
+    uint32_t used, level;
+    SDK_HW_CRITICAL_SITE(enet_flowctl_cs);
+
+    used = enet_rxdesc_occupancy_get(NULL);
+
+    level = SDK_HW_CRITICAL_ENTER(enet_flowctl_cs);
+    flowctl_link_sample();
+    flowctl_ctx.stat.occupancy = used;
+    if (used > flowctl_ctx.stat.occupancy_max)
+    {
+        flowctl_ctx.stat.occupancy_max = used;
+    }
+
+    if (flowctl_ctx.stat.paused == 0)
+    {
+        if ((used >= flowctl_ctx.high) && (flowctl_pause(GD32_ENET_FLOWCTL_PAUSE_TIME) == SDK_OK))
+        {
+            flowctl_ctx.stat.paused = 1;
+            flowctl_ctx.stat.pauses++;
+            flowctl_ctx.sent_ms = now_ms;
+        }
+    }
+    else if (used <= flowctl_ctx.low)
+    {
+        if (flowctl_pause(0) == SDK_OK)
+        {
+            flowctl_ctx.stat.paused = 0;
+            flowctl_ctx.stat.releases++;
+        }
+    }
+    else if ((flowctl_ctx.full_duplex != 0) && (now_ms - flowctl_ctx.sent_ms >= flowctl_ctx.refresh_ms))
+    {
+        /* still draining, hold the partner before the pause runs out */
+        if (flowctl_pause(GD32_ENET_FLOWCTL_PAUSE_TIME) == SDK_OK)
+        {
+            flowctl_ctx.stat.refreshes++;
+            flowctl_ctx.sent_ms = now_ms;
+        }
+    }
+    SDK_HW_CRITICAL_EXIT(enet_flowctl_cs, level);
+}
+
+void gd32_enet_flowctl_stat_get(gd32_enet_flowctl_stat_t *stat)
+{
+    uint32_t level;
+    SDK_HW_CRITICAL_SITE(enet_flowctl_cs);
+
+    level = SDK_HW_CRITICAL_ENTER(enet_flowctl_cs);
+    *stat = flowctl_ctx.stat;
+    SDK_HW_CRITICAL_EXIT(enet_flowctl_cs, level);
+}
@@ -0,0 +1,284 @@
+/**
+ * Copyright (c) 2022 Infinitech Technology Co., Ltd
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     agent        first version
+ */
+
+#include <string.h>
+#include "sdk_board.h"
+#include "gd32_common.h"
+#include "gd32_enet.h"
+
+#define DBG_TAG "bsp.enet"
+#define DBG_LVL DBG_LOG
+#include "sdk_log.h"
+
+#define MCAST_PERFECT_NUM       3           /* MAC address 1 to 3, address 0 is the station address */
+#define MCAST_HASH_NUM          64
+#define MCAST_NONE              0xFFFF
+
+typedef struct
+{
+    uint8_t addr[6];
+    uint8_t hash;
+    uint8_t perfect;                        /* 1 when the group is in a perfect filter */
+    uint16_t refcnt;                        /* 0 for a free slot */
+    uint16_t next;                          /* next group in the same hash bucket */
+} mcast_group_t;
+
+static const enet_macaddress_enum mcast_perfect_reg[MCAST_PERFECT_NUM] =
+{
+    ENET_MAC_ADDRESS1, ENET_MAC_ADDRESS2, ENET_MAC_ADDRESS3
+};
+
+static mcast_group_t mcast_group[GD32_ENET_MCAST_MAX];
+static uint16_t mcast_bucket[MCAST_HASH_NUM];
+static uint32_t mcast_hash_table[2];
+static gd32_enet_mcast_stat_t mcast_stat;
+static int mcast_init_done = 0;             /* the buckets are empty chains only after the init */
+
+/* the MAC indexes the hash table by the upper 6 bits of the bit reversed CRC32 of the address */
+uint32_t gd32_enet_mcast_hash(const uint8_t *addr)
+{
+    uint32_t crc = 0xFFFFFFFF, hash = 0;
+    int i, j;
+
+    for (i = 0; i < 6; i++)
+    {
+        crc ^= addr[i];
+        for (j = 0; j < 8; j++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    crc = ~crc;
+    for (i = 0; i < 6; i++)
+    {
+        hash = (hash << 1) | ((crc >> i) & 1);
+    }
+
+    return hash;
+}
+
+static int mcast_find(const uint8_t *addr, uint32_t hash)
+{
+    uint16_t i = mcast_bucket[hash];
+
+    while (i != MCAST_NONE)
+    {
+        if (memcmp(mcast_group[i].addr, addr, 6) == 0)
+        {
+            return i;
+        }
+        i = mcast_group[i].next;
+    }
+
+    return -1;
+}
+
+/* the first groups in slot order take the perfect filters, the rest the hash table */
+static void mcast_program(void)
+{
+    uint32_t i, perfect = 0, hashed = 0, buckets = 0;
+
+    mcast_hash_table[0] = 0;
+    mcast_hash_table[1] = 0;
+    for (i = 0; i < GD32_ENET_MCAST_MAX; i++)
+    {
+        if (mcast_group[i].refcnt == 0)
+        {
+            continue;
+        }
+        if (perfect < MCAST_PERFECT_NUM)
+        {
+            mcast_group[i].perfect = 1;
+            enet_mac_address_set(mcast_perfect_reg[perfect], mcast_group[i].addr);
+            enet_address_filter_config(mcast_perfect_reg[perfect], 0, ENET_ADDRESS_FILTER_DA);
+            enet_address_filter_enable(mcast_perfect_reg[perfect]);
+            perfect++;
+        }
+        else
+        {
+            mcast_group[i].perfect = 0;
+            mcast_hash_table[mcast_group[i].hash >> 5] |= 1UL << (mcast_group[i].hash & 31);
+            hashed++;
+        }
+    }
+    for (i = perfect; i < MCAST_PERFECT_NUM; i++)
+    {
+        enet_address_filter_disable(mcast_perfect_reg[i]);
+    }
+
+    ENET_MAC_HLL = mcast_hash_table[0];
+    ENET_MAC_HLH = mcast_hash_table[1];
+    if (hashed != 0)
+    {
+        enet_fliter_feature_enable(ENET_MULTICAST_FILTER_HASH_MODE);
+    }
+    else
+    {
+        enet_fliter_feature_disable(ENET_MULTICAST_FILTER_HASH_MODE);
+    }
+
+    for (i = 0; i < MCAST_HASH_NUM; i++)
+    {
+        if (mcast_hash_table[i >> 5] & (1UL << (i & 31)))
+        {
+            buckets++;
+        }
+    }
+    mcast_stat.groups = perfect + hashed;
+    mcast_stat.perfect = perfect;
+    mcast_stat.hashed = hashed;
+    mcast_stat.buckets = buckets;
+}
+
+int gd32_enet_mcast_init(void)
+{
+    uint32_t level;
+    SDK_HW_CRITICAL_SITE(enet_mcast_cs);
+
+    level = SDK_HW_CRITICAL_ENTER(enet_mcast_cs);
+    memset(mcast_group, 0, sizeof(mcast_group));
+    memset(mcast_bucket, 0xFF, sizeof(mcast_bucket));
+    memset(&mcast_stat, 0, sizeof(mcast_stat));
+    /* stop passing all multicast frames, pass the ones matching the perfect or the hash filters */
+    enet_fliter_feature_disable(ENET_MULTICAST_FILTER_PASS);
+    enet_fliter_feature_enable(ENET_FILTER_MODE_EITHER);
+    mcast_program();
+    mcast_init_done = 1;
+    SDK_HW_CRITICAL_EXIT(enet_mcast_cs, level);
+
+    return SDK_OK;
+}
+
+int gd32_enet_mcast_join(const uint8_t *addr)
+{
+    uint32_t level, hash;
+    int i, slot = -1;
+    SDK_HW_CRITICAL_SITE(enet_mcast_cs);
+
+    if ((mcast_init_done == 0) || (addr == NULL) || ((addr[0] & 0x01) == 0))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    hash = gd32_enet_mcast_hash(addr);
+    level = SDK_HW_CRITICAL_ENTER(enet_mcast_cs);
+    i = mcast_find(addr, hash);
+    if (i >= 0)
+    {
+        mcast_group[i].refcnt++;
+        SDK_HW_CRITICAL_EXIT(enet_mcast_cs, level);
+        return SDK_OK;
+    }
+
+    for (i = 0; i < GD32_ENET_MCAST_MAX; i++)
+    {
+        if (mcast_group[i].refcnt == 0)
+        {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0)
+    {
+        SDK_HW_CRITICAL_EXIT(enet_mcast_cs, level);
+        LOG_E("multicast table full");
+        return -SDK_ERROR;
+    }
+
+    memcpy(mcast_group[slot].addr, addr, 6);
+    mcast_group[slot].hash = (uint8_t)hash;
+    mcast_group[slot].refcnt = 1;
+    mcast_group[slot].next = mcast_bucket[hash];
+    mcast_bucket[hash] = (uint16_t)slot;
+    mcast_program();
+    SDK_HW_CRITICAL_EXIT(enet_mcast_cs, level);
+
+    return SDK_OK;
+}
+
+int gd32_enet_mcast_leave(const uint8_t *addr)
+{
+    uint32_t level, hash;
+    uint16_t *link;
+    int i;
+    SDK_HW_CRITICAL_SITE(enet_mcast_cs);
+
+    if ((mcast_init_done == 0) || (addr == NULL))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    hash = gd32_enet_mcast_hash(addr);
+    level = SDK_HW_CRITICAL_ENTER(enet_mcast_cs);
+    i = mcast_find(addr, hash);
+    if (i < 0)
+    {
+        SDK_HW_CRITICAL_EXIT(enet_mcast_cs, level);
+        return -SDK_E_INVALID;
+    }
+
+    if (--mcast_group[i].refcnt == 0)
+    {
+        link = &mcast_bucket[hash];
+        while (*link != (uint16_t)i)
+        {
+            link = &mcast_group[*link].next;
+        }
+        *link = mcast_group[i].next;
+        mcast_program();
+    }
+    SDK_HW_CRITICAL_EXIT(enet_mcast_cs, level);
+
+    return SDK_OK;
+}
+
+/*
+ * Software check of a received frame, returns 1 to accept it. Unicast,
+ * broadcast and perfect filter hits are accepted at once, a frame hitting a
+ * hash bucket is compared with the groups of that bucket.
+ */
+int gd32_enet_mcast_accept(const uint8_t *frame)
+{
+    static const uint8_t broadcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint32_t level, hash;
+    int i;
+    SDK_HW_CRITICAL_SITE(enet_mcast_cs);
+
+    if (((frame[0] & 0x01) == 0) || (memcmp(frame, broadcast, 6) == 0))
+    {
+        return 1;
+    }
+
+    hash = gd32_enet_mcast_hash(frame);
+    if ((mcast_hash_table[hash >> 5] & (1UL << (hash & 31))) == 0)
+    {
+        /* only the perfect filters pass it */
+        return 1;
+    }
+
+    level = SDK_HW_CRITICAL_ENTER(enet_mcast_cs);
+    mcast_stat.sw_checked++;
+    i = mcast_find(frame, hash);
+    if (i < 0)
+    {
+        mcast_stat.sw_dropped++;
+    }
+    SDK_HW_CRITICAL_EXIT(enet_mcast_cs, level);
+
+    return (i >= 0) ? 1 : 0;
+}
+
+void gd32_enet_mcast_stat_get(gd32_enet_mcast_stat_t *stat)
+{
+    uint32_t level;
+    SDK_HW_CRITICAL_SITE(enet_mcast_cs);
+
+    level = SDK_HW_CRITICAL_ENTER(enet_mcast_cs);
+    *stat = mcast_stat;
+    SDK_HW_CRITICAL_EXIT(enet_mcast_cs, level);
+}
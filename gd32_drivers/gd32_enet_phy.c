@@ -0,0 +1,214 @@
+/**
+ * Copyright (c) 2022 Infinitech Technology Co., Ltd
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     agent        first version
+ */
+
+#include <string.h>
+#include "sdk_board.h"
+#include "gd32_enet.h"
+
+#define DBG_TAG "bsp.enet"
+#define DBG_LVL DBG_LOG
+#include "sdk_log.h"
+
+enum
+{
+    PHY_ST_RESET = 0,           /* write the reset bit */
+    PHY_ST_RESET_WAIT,          /* wait for the reset bit to clear */
+    PHY_ST_CONFIG,              /* start auto-negotiation or force the mode */
+    PHY_ST_LINK_WAIT,           /* wait for a link */
+    PHY_ST_ANEG_WAIT,           /* wait for auto-negotiation to complete */
+    PHY_ST_ANEG_RESULT,         /* read the negotiated speed and duplex */
+    PHY_ST_LINK_UP,             /* watch the link */
+};
+
+typedef struct
+{
+    uint32_t mediamode;         /* ENET_AUTO_NEGOTIATION or a fixed mode */
+    gd32_enet_phy_link_t link;
+    uint32_t since_ms;          /* entry of the current state */
+    uint8_t mdio_busy;
+    gd32_enet_phy_stat_t stat;
+} phy_ctx_t;
+
+static phy_ctx_t phy_ctx;
+
+/* one MDIO access spread over successive polls, -SDK_E_BUSY until it completes */
+static int phy_mdio(enet_phydirection_enum direction, uint16_t reg, uint16_t *value)
+{
+    if (phy_ctx.mdio_busy == 0)
+    {
+        if (enet_phy_access_start(direction, PHY_ADDRESS, reg, *value) == SUCCESS)
+        {
+            phy_ctx.mdio_busy = 1;
+        }
+        return -SDK_E_BUSY;
+    }
+    if (enet_phy_access_complete((direction == ENET_PHY_READ) ? value : NULL) != SET)
+    {
+        return -SDK_E_BUSY;
+    }
+    phy_ctx.mdio_busy = 0;
+
+    return SDK_OK;
+}
+
+static void phy_state_set(uint32_t state, uint32_t now_ms)
+{
+    phy_ctx.stat.state = state;
+    phy_ctx.since_ms = now_ms;
+}
+
+static void phy_link_set(int up, uint32_t mediamode)
+{
+    phy_ctx.stat.link_up = up ? 1 : 0;
+    if (up)
+    {
+        phy_ctx.stat.mediamode = mediamode;
+        phy_ctx.stat.link_ups++;
+        enet_media_config((enet_mediamode_enum)mediamode);
+    }
+    else
+    {
+        phy_ctx.stat.link_downs++;
+    }
+    if (phy_ctx.link != NULL)
+    {
+        phy_ctx.link(up, mediamode);
+    }
+}
+
+/* mediamode is ENET_AUTO_NEGOTIATION or one of the fixed modes, link may be NULL */
+int gd32_enet_phy_init(uint32_t mediamode, gd32_enet_phy_link_t link)
+{
+    if ((mediamode != ENET_AUTO_NEGOTIATION) && (mediamode != ENET_100M_FULLDUPLEX) &&
+        (mediamode != ENET_100M_HALFDUPLEX) && (mediamode != ENET_10M_FULLDUPLEX) &&
+        (mediamode != ENET_10M_HALFDUPLEX))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    memset(&phy_ctx, 0, sizeof(phy_ctx));
+    phy_ctx.mediamode = mediamode;
+    phy_ctx.link = link;
+    phy_ctx.stat.state = PHY_ST_RESET;
+
+    return SDK_OK;
+}
+
+void gd32_enet_phy_poll(uint32_t now_ms)
+{
+    uint16_t value = 0;
+    uint32_t mode;
+
+    switch (phy_ctx.stat.state)
+    {
+    case PHY_ST_RESET:
+        value = PHY_RESET;
+        if (phy_mdio(ENET_PHY_WRITE, PHY_REG_BCR, &value) == SDK_OK)
+        {
+            phy_ctx.stat.resets++;
+            phy_state_set(PHY_ST_RESET_WAIT, now_ms);
+        }
+        break;
+    case PHY_ST_RESET_WAIT:
+        if (phy_mdio(ENET_PHY_READ, PHY_REG_BCR, &value) != SDK_OK)
+        {
+            break;
+        }
+        if ((value & PHY_RESET) == 0)
+        {
+            phy_state_set(PHY_ST_CONFIG, now_ms);
+        }
+        else if (now_ms - phy_ctx.since_ms >= GD32_ENET_PHY_RESET_MS)
+        {
+            LOG_E("phy reset timeout");
+            phy_state_set(PHY_ST_RESET, now_ms);
+        }
+        break;
+    case PHY_ST_CONFIG:
+        if (phy_ctx.mediamode == ENET_AUTO_NEGOTIATION)
+        {
+            value = PHY_AUTONEGOTIATION | PHY_RESTART_AUTONEGOTIATION;
+        }
+        else
+        {
+            /* same mapping of the MAC mode bits to BCR as enet_init() */
+            value = (uint16_t)((phy_ctx.mediamode & ENET_MAC_CFG_DPM) >> 3);
+            value |= (uint16_t)((phy_ctx.mediamode & ENET_MAC_CFG_SPD) >> 1);
+        }
+        if (phy_mdio(ENET_PHY_WRITE, PHY_REG_BCR, &value) == SDK_OK)
+        {
+            phy_state_set(PHY_ST_LINK_WAIT, now_ms);
+        }
+        break;
+    case PHY_ST_LINK_WAIT:
+        if ((phy_mdio(ENET_PHY_READ, PHY_REG_BSR, &value) != SDK_OK) || ((value & PHY_LINKED_STATUS) == 0))
+        {
+            break;
+        }
+        if (phy_ctx.mediamode == ENET_AUTO_NEGOTIATION)
+        {
+            phy_state_set(PHY_ST_ANEG_WAIT, now_ms);
+        }
+        else
+        {
+            phy_state_set(PHY_ST_LINK_UP, now_ms);
+            phy_link_set(1, phy_ctx.mediamode);
+        }
+        break;
+    case PHY_ST_ANEG_WAIT:
+        if (phy_mdio(ENET_PHY_READ, PHY_REG_BSR, &value) != SDK_OK)
+        {
+            break;
+        }
+        if ((value & PHY_LINKED_STATUS) == 0)
+        {
+            phy_state_set(PHY_ST_LINK_WAIT, now_ms);
+        }
+        else if (value & PHY_AUTONEGO_COMPLETE)
+        {
+            phy_state_set(PHY_ST_ANEG_RESULT, now_ms);
+        }
+        else if (now_ms - phy_ctx.since_ms >= GD32_ENET_PHY_ANEG_MS)
+        {
+            phy_ctx.stat.aneg_timeouts++;
+            phy_state_set(PHY_ST_CONFIG, now_ms);
+        }
+        break;
+    case PHY_ST_ANEG_RESULT:
+        if (phy_mdio(ENET_PHY_READ, PHY_SR, &value) != SDK_OK)
+        {
+            break;
+        }
+        mode = (value & PHY_DUPLEX_STATUS) ? ENET_MODE_FULLDUPLEX : ENET_MODE_HALFDUPLEX;
+        mode |= (value & PHY_SPEED_STATUS) ? ENET_SPEEDMODE_10M : ENET_SPEEDMODE_100M;
+        phy_state_set(PHY_ST_LINK_UP, now_ms);
+        phy_link_set(1, mode);
+        break;
+    case PHY_ST_LINK_UP:
+        /* the link status is latched low, a drop is seen by the next read */
+        if ((phy_mdio(ENET_PHY_READ, PHY_REG_BSR, &value) == SDK_OK) && ((value & PHY_LINKED_STATUS) == 0))
+        {
+            phy_state_set(PHY_ST_LINK_WAIT, now_ms);
+            phy_link_set(0, phy_ctx.stat.mediamode);
+        }
+        break;
+    default:
+        phy_state_set(PHY_ST_RESET, now_ms);
+        break;
+    }
+}
+
+int gd32_enet_phy_link_up(void)
+{
+    return (int)phy_ctx.stat.link_up;
+}
+
+void gd32_enet_phy_stat_get(gd32_enet_phy_stat_t *stat)
+{
+    *stat = phy_ctx.stat;
+}
@@ -0,0 +1,525 @@
+/**
+ * Copyright (c) 2022 Infinitech Technology Co., Ltd
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     agent        first version
+ */
+
+#include <string.h>
+#include "sdk_board.h"
+#include "gd32_common.h"
+#include "gd32_enet.h"
+
+#define DBG_TAG "bsp.enet"
+#define DBG_LVL DBG_LOG
+#include "sdk_log.h"
+
+#define PTP_CLOCK_HZ            50000000UL  /* rate of the subsecond increments */
+#define PTP_TICK_NS             (1000000000UL / PTP_CLOCK_HZ)
+#define PTP_NS_PER_SEC          1000000000LL
+
+/* PI servo gains in 1/1000, for offsets in ns sampled about once a second */
+#define PTP_SERVO_KP            700
+#define PTP_SERVO_KI            300
+#define PTP_SERVO_LOCK_COUNT    4
+
+/* PTP v2 message types and layout */
+#define PTP_MSG_SYNC            0x0
+#define PTP_MSG_DELAY_REQ       0x1
+#define PTP_MSG_FOLLOW_UP       0x8
+#define PTP_MSG_DELAY_RESP      0x9
+
+#define PTP_HDR_LEN             34
+#define PTP_SYNC_LEN            44          /* also Delay_Req and Follow_Up */
+#define PTP_DELAY_RESP_LEN      54
+#define PTP_FLAG_TWO_STEP       0x02        /* in the first flag byte */
+#define PTP_OFS_TYPE            0
+#define PTP_OFS_VERSION         1
+#define PTP_OFS_LENGTH          2
+#define PTP_OFS_FLAGS           6
+#define PTP_OFS_CORRECTION      8
+#define PTP_OFS_PORT_ID         20
+#define PTP_OFS_SEQ             30
+#define PTP_OFS_CONTROL         32
+#define PTP_OFS_INTERVAL        33
+#define PTP_OFS_TIMESTAMP       34
+#define PTP_OFS_REQ_PORT_ID     44
+#define PTP_PORT_ID_LEN         10
+
+typedef struct
+{
+    int master;
+    uint32_t addend_base;
+    gd32_enet_ptp_send_t send;
+    uint8_t port_id[PTP_PORT_ID_LEN];
+
+    /* slave side, t1/t2 of the last sync and t3 of the pending delay request */
+    int64_t t1, t2, t3;
+    uint16_t sync_seq;
+    uint16_t delay_seq;
+    uint8_t sync_valid;
+    uint8_t follow_up_wait;
+    uint8_t delay_valid;
+    uint8_t delay_pending;
+
+    /* master side */
+    uint16_t tx_seq;
+
+    /* servo */
+    uint8_t servo_started;
+    uint8_t lock_count;
+    int64_t integral;
+
+    gd32_enet_ptp_stat_t stat;
+} ptp_ctx_t;
+
+static ptp_ctx_t ptp_ctx;
+
+static int64_t ptp_time_to_ns(const gd32_enet_ptp_time_t *t)
+{
+    return (int64_t)t->sec * PTP_NS_PER_SEC + t->nsec;
+}
+
+static uint16_t ptp_get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void ptp_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+/* 48 bit seconds and 32 bit nanoseconds, big endian */
+static int64_t ptp_get_timestamp(const uint8_t *p)
+{
+    uint64_t sec = 0;
+    uint32_t nsec = 0;
+    int i;
+
+    for (i = 0; i < 6; i++)
+    {
+        sec = (sec << 8) | p[i];
+    }
+    for (i = 6; i < 10; i++)
+    {
+        nsec = (nsec << 8) | p[i];
+    }
+
+    return (int64_t)sec * PTP_NS_PER_SEC + nsec;
+}
+
+static void ptp_put_timestamp(uint8_t *p, int64_t ns)
+{
+    uint64_t sec = (uint64_t)(ns / PTP_NS_PER_SEC);
+    uint32_t nsec = (uint32_t)(ns % PTP_NS_PER_SEC);
+    int i;
+
+    for (i = 5; i >= 0; i--)
+    {
+        p[i] = (uint8_t)sec;
+        sec >>= 8;
+    }
+    for (i = 9; i >= 6; i--)
+    {
+        p[i] = (uint8_t)nsec;
+        nsec >>= 8;
+    }
+}
+
+/* the correction field is in ns scaled by 2^16 */
+static int64_t ptp_get_correction(const uint8_t *p)
+{
+    uint64_t v = 0;
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        v = (v << 8) | p[i];
+    }
+
+    return (int64_t)v / 65536;
+}
+
+static void ptp_build_header(uint8_t *msg, uint8_t type, uint32_t len, uint16_t seq, uint8_t control)
+{
+    memset(msg, 0, len);
+    msg[PTP_OFS_TYPE] = type;
+    msg[PTP_OFS_VERSION] = 2;
+    ptp_put16(&msg[PTP_OFS_LENGTH], (uint16_t)len);
+    memcpy(&msg[PTP_OFS_PORT_ID], ptp_ctx.port_id, PTP_PORT_ID_LEN);
+    ptp_put16(&msg[PTP_OFS_SEQ], seq);
+    msg[PTP_OFS_CONTROL] = control;
+    msg[PTP_OFS_INTERVAL] = (type == PTP_MSG_DELAY_REQ) ? 0x7F : 0;
+}
+
+static int ptp_update_wait(enet_ptp_function_enum func)
+{
+    if (enet_ptp_timestamp_function_config(func) != SUCCESS)
+    {
+        LOG_E("ptp time update timeout");
+        return -SDK_E_TIMEOUT;
+    }
+
+    return SDK_OK;
+}
+
+int gd32_enet_ptp_init(uint32_t hclk, int master, const uint8_t *clock_id, gd32_enet_ptp_send_t send)
+{
+    gd32_enet_ptp_time_t zero = {0, 0};
+
+    /* the 50 MHz PTP clock is derived from HCLK by the addend accumulator */
+    if ((hclk <= PTP_CLOCK_HZ) || (clock_id == NULL) || (send == NULL))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    memset(&ptp_ctx, 0, sizeof(ptp_ctx));
+    ptp_ctx.master = master;
+    ptp_ctx.send = send;
+    memcpy(ptp_ctx.port_id, clock_id, 8);
+    ptp_ctx.port_id[9] = 1;
+    ptp_ctx.addend_base = (uint32_t)(((uint64_t)PTP_CLOCK_HZ << 32) / hclk);
+
+    enet_ptp_feature_enable(ENET_RXTX_TIMESTAMP | ENET_NONTYPE_FRAME_SNAPSHOT | ENET_IPV4_FRAME_SNAPSHOT);
+    enet_ptp_timestamp_function_config(ENET_SNOOPING_PTP_VERSION_2);
+    enet_ptp_timestamp_function_config(ENET_EVENT_TYPE_MESSAGES_SNAPSHOT);
+    enet_ptp_timestamp_function_config(ENET_SUBSECOND_DIGITAL_ROLLOVER);
+    enet_ptp_subsecond_increment_config(PTP_TICK_NS);
+    enet_ptp_timestamp_function_config(ENET_PTP_FINEMODE);
+    enet_ptp_timestamp_addend_config(ptp_ctx.addend_base);
+    if (ptp_update_wait(ENET_PTP_ADDEND_UPDATE) != SDK_OK)
+    {
+        return -SDK_E_TIMEOUT;
+    }
+
+    return gd32_enet_ptp_time_set(&zero);
+}
+
+/* read the registers directly, the library helpers assume binary rollover on some series */
+void gd32_enet_ptp_time_get(gd32_enet_ptp_time_t *time)
+{
+    uint32_t sec, nsec;
+
+    /* read again when the seconds rolled over between the two registers */
+    do
+    {
+        sec = ENET_PTP_TSH;
+        nsec = GET_PTP_TSL_STMSS(ENET_PTP_TSL);
+    } while (sec != ENET_PTP_TSH);
+
+    time->sec = sec;
+    time->nsec = nsec;
+}
+
+int gd32_enet_ptp_time_set(const gd32_enet_ptp_time_t *time)
+{
+    if ((time == NULL) || (time->nsec >= PTP_NS_PER_SEC))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    enet_ptp_timestamp_update_config(ENET_PTP_ADD_TO_TIME, time->sec, time->nsec);
+
+    return ptp_update_wait(ENET_PTP_SYSTIME_INIT);
+}
+
+int gd32_enet_ptp_step(int64_t ns)
+{
+    uint32_t sign = ENET_PTP_ADD_TO_TIME;
+    int ret;
+
+    if (ns < 0)
+    {
+        sign = ENET_PTP_SUBSTRACT_FROM_TIME;
+        ns = -ns;
+    }
+
+    enet_ptp_timestamp_update_config(sign, (uint32_t)(ns / PTP_NS_PER_SEC), (uint32_t)(ns % PTP_NS_PER_SEC));
+    ret = ptp_update_wait(ENET_PTP_SYSTIME_UPDATE);
+    if (ret == SDK_OK)
+    {
+        ptp_ctx.stat.steps++;
+    }
+
+    return ret;
+}
+
+/* a positive ppb speeds the clock up */
+int gd32_enet_ptp_adjfreq(int32_t ppb)
+{
+    int64_t addend;
+
+    if (ptp_ctx.addend_base == 0)
+    {
+        return -SDK_ERROR;
+    }
+    if (ppb > GD32_ENET_PTP_MAX_PPB)
+    {
+        ppb = GD32_ENET_PTP_MAX_PPB;
+    }
+    else if (ppb < -GD32_ENET_PTP_MAX_PPB)
+    {
+        ppb = -GD32_ENET_PTP_MAX_PPB;
+    }
+
+    addend = (int64_t)ptp_ctx.addend_base + (int64_t)ptp_ctx.addend_base * ppb / PTP_NS_PER_SEC;
+    if ((addend <= 0) || (addend > 0xFFFFFFFFLL))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    enet_ptp_timestamp_addend_config((uint32_t)addend);
+    if (ptp_update_wait(ENET_PTP_ADDEND_UPDATE) != SDK_OK)
+    {
+        return -SDK_E_TIMEOUT;
+    }
+    ptp_ctx.stat.freq_ppb = ppb;
+
+    return SDK_OK;
+}
+
+/*
+ * Feed one offset from master (local minus master time) to the PI servo.
+ * The clock is stepped on the first sample and whenever the offset is larger
+ * than GD32_ENET_PTP_STEP_NS, it is slewed on the addend otherwise.
+ */
+int gd32_enet_ptp_servo_sample(int64_t offset_ns)
+{
+    int64_t ppb, limit = (int64_t)GD32_ENET_PTP_MAX_PPB * 1000;
+    int64_t abs_offset = (offset_ns < 0) ? -offset_ns : offset_ns;
+
+    ptp_ctx.stat.offset_ns = offset_ns;
+    if ((ptp_ctx.servo_started == 0) || (abs_offset > GD32_ENET_PTP_STEP_NS))
+    {
+        ptp_ctx.servo_started = 1;
+        ptp_ctx.lock_count = 0;
+        ptp_ctx.stat.locked = 0;
+        /* the servo just restarted, the last sync pair is stale */
+        ptp_ctx.sync_valid = 0;
+        return gd32_enet_ptp_step(-offset_ns);
+    }
+
+    /* integral kept in ppb * 1000 and clamped against windup */
+    ptp_ctx.integral += offset_ns * PTP_SERVO_KI;
+    if (ptp_ctx.integral > limit)
+    {
+        ptp_ctx.integral = limit;
+    }
+    else if (ptp_ctx.integral < -limit)
+    {
+        ptp_ctx.integral = -limit;
+    }
+    ppb = -(offset_ns * PTP_SERVO_KP + ptp_ctx.integral) / 1000;
+
+    if (abs_offset < GD32_ENET_PTP_LOCK_NS)
+    {
+        if (ptp_ctx.lock_count < PTP_SERVO_LOCK_COUNT)
+        {
+            ptp_ctx.lock_count++;
+        }
+    }
+    else
+    {
+        ptp_ctx.lock_count = 0;
+    }
+    ptp_ctx.stat.locked = (ptp_ctx.lock_count >= PTP_SERVO_LOCK_COUNT) ? 1 : 0;
+
+    if (ppb > GD32_ENET_PTP_MAX_PPB)
+    {
+        ppb = GD32_ENET_PTP_MAX_PPB;
+    }
+    else if (ppb < -GD32_ENET_PTP_MAX_PPB)
+    {
+        ppb = -GD32_ENET_PTP_MAX_PPB;
+    }
+
+    return gd32_enet_ptp_adjfreq((int32_t)ppb);
+}
+
+/* freq is the PPS output rate in Hz, a power of two from 1 to 32768 */
+int gd32_enet_ptp_pps_config(uint32_t freq)
+{
+    uint32_t n = 0;
+
+    if ((freq == 0) || (freq > 32768) || ((freq & (freq - 1)) != 0))
+    {
+        return -SDK_E_INVALID;
+    }
+    while ((1UL << n) != freq)
+    {
+        n++;
+    }
+    enet_ptp_pps_output_frequency_config(PTP_PPSCTL_PPSOFC(n));
+
+    return SDK_OK;
+}
+
+static void ptp_slave_sync(int64_t t1)
+{
+    ptp_ctx.t1 = t1;
+    ptp_ctx.sync_valid = 1;
+    ptp_ctx.follow_up_wait = 0;
+    ptp_ctx.stat.syncs++;
+
+    /* without a path delay yet the raw offset still gets the clock close */
+    gd32_enet_ptp_servo_sample((ptp_ctx.t2 - ptp_ctx.t1) - ptp_ctx.stat.delay_ns);
+}
+
+static int ptp_slave_rx(const uint8_t *msg, uint32_t len, const gd32_enet_ptp_time_t *rx_ts)
+{
+    uint8_t type = msg[PTP_OFS_TYPE] & 0x0F;
+    uint16_t seq = ptp_get16(&msg[PTP_OFS_SEQ]);
+    int64_t t4;
+
+    switch (type)
+    {
+    case PTP_MSG_SYNC:
+        if ((len < PTP_SYNC_LEN) || (rx_ts == NULL))
+        {
+            return -SDK_E_INVALID;
+        }
+        ptp_ctx.t2 = ptp_time_to_ns(rx_ts);
+        ptp_ctx.sync_seq = seq;
+        if (msg[PTP_OFS_FLAGS] & PTP_FLAG_TWO_STEP)
+        {
+            ptp_ctx.follow_up_wait = 1;
+        }
+        else
+        {
+            ptp_slave_sync(ptp_get_timestamp(&msg[PTP_OFS_TIMESTAMP]) +
+                           ptp_get_correction(&msg[PTP_OFS_CORRECTION]));
+        }
+        break;
+    case PTP_MSG_FOLLOW_UP:
+        if ((len < PTP_SYNC_LEN) || (ptp_ctx.follow_up_wait == 0) || (seq != ptp_ctx.sync_seq))
+        {
+            return -SDK_E_INVALID;
+        }
+        ptp_slave_sync(ptp_get_timestamp(&msg[PTP_OFS_TIMESTAMP]) +
+                       ptp_get_correction(&msg[PTP_OFS_CORRECTION]));
+        break;
+    case PTP_MSG_DELAY_RESP:
+        if ((len < PTP_DELAY_RESP_LEN) || (ptp_ctx.delay_pending == 0) || (seq != ptp_ctx.delay_seq) ||
+            (memcmp(&msg[PTP_OFS_REQ_PORT_ID], ptp_ctx.port_id, PTP_PORT_ID_LEN) != 0))
+        {
+            return -SDK_E_INVALID;
+        }
+        ptp_ctx.delay_pending = 0;
+        if (ptp_ctx.sync_valid == 0)
+        {
+            break;
+        }
+        t4 = ptp_get_timestamp(&msg[PTP_OFS_TIMESTAMP]) - ptp_get_correction(&msg[PTP_OFS_CORRECTION]);
+        ptp_ctx.stat.delay_ns = ((ptp_ctx.t2 - ptp_ctx.t1) + (t4 - ptp_ctx.t3)) / 2;
+        if (ptp_ctx.stat.delay_ns < 0)
+        {
+            ptp_ctx.stat.delay_ns = 0;
+        }
+        ptp_ctx.delay_valid = 1;
+        break;
+    default:
+        break;
+    }
+
+    return SDK_OK;
+}
+
+static int ptp_master_rx(const uint8_t *msg, uint32_t len, const gd32_enet_ptp_time_t *rx_ts)
+{
+    uint8_t resp[PTP_DELAY_RESP_LEN];
+
+    if ((msg[PTP_OFS_TYPE] & 0x0F) != PTP_MSG_DELAY_REQ)
+    {
+        return SDK_OK;
+    }
+    if ((len < PTP_SYNC_LEN) || (rx_ts == NULL))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    ptp_build_header(resp, PTP_MSG_DELAY_RESP, PTP_DELAY_RESP_LEN, ptp_get16(&msg[PTP_OFS_SEQ]), 3);
+    memcpy(&resp[PTP_OFS_CORRECTION], &msg[PTP_OFS_CORRECTION], 8);
+    ptp_put_timestamp(&resp[PTP_OFS_TIMESTAMP], ptp_time_to_ns(rx_ts));
+    memcpy(&resp[PTP_OFS_REQ_PORT_ID], &msg[PTP_OFS_PORT_ID], PTP_PORT_ID_LEN);
+    ptp_ctx.stat.delay_reqs++;
+
+    return ptp_ctx.send(resp, PTP_DELAY_RESP_LEN, 0, NULL);
+}
+
+/* msg starts at the PTP header, rx_ts is the hardware receive timestamp of event messages */
+int gd32_enet_ptp_rx(const uint8_t *msg, uint32_t len, const gd32_enet_ptp_time_t *rx_ts)
+{
+    if ((msg == NULL) || (len < PTP_HDR_LEN) || ((msg[PTP_OFS_VERSION] & 0x0F) != 2))
+    {
+        return -SDK_E_INVALID;
+    }
+    if (ptp_ctx.send == NULL)
+    {
+        return -SDK_ERROR;
+    }
+    /* our own messages looped back */
+    if (memcmp(&msg[PTP_OFS_PORT_ID], ptp_ctx.port_id, PTP_PORT_ID_LEN) == 0)
+    {
+        return SDK_OK;
+    }
+
+    return ptp_ctx.master ? ptp_master_rx(msg, len, rx_ts) : ptp_slave_rx(msg, len, rx_ts);
+}
+
+/*
+ * Call once per sync interval. A master sends Sync and its Follow_Up, a
+ * slave sends a Delay_Req once it has a sync pair to measure against.
+ */
+int gd32_enet_ptp_poll(void)
+{
+    uint8_t msg[PTP_SYNC_LEN];
+    gd32_enet_ptp_time_t ts;
+    int ret;
+
+    if (ptp_ctx.send == NULL)
+    {
+        return -SDK_ERROR;
+    }
+
+    if (ptp_ctx.master)
+    {
+        ptp_ctx.tx_seq++;
+        ptp_build_header(msg, PTP_MSG_SYNC, PTP_SYNC_LEN, ptp_ctx.tx_seq, 0);
+        msg[PTP_OFS_FLAGS] = PTP_FLAG_TWO_STEP;
+        ret = ptp_ctx.send(msg, PTP_SYNC_LEN, 1, &ts);
+        if (ret != SDK_OK)
+        {
+            return ret;
+        }
+        ptp_ctx.stat.syncs++;
+
+        ptp_build_header(msg, PTP_MSG_FOLLOW_UP, PTP_SYNC_LEN, ptp_ctx.tx_seq, 2);
+        ptp_put_timestamp(&msg[PTP_OFS_TIMESTAMP], ptp_time_to_ns(&ts));
+        return ptp_ctx.send(msg, PTP_SYNC_LEN, 0, NULL);
+    }
+
+    if (ptp_ctx.sync_valid == 0)
+    {
+        return SDK_OK;
+    }
+    ptp_ctx.delay_seq++;
+    ptp_build_header(msg, PTP_MSG_DELAY_REQ, PTP_SYNC_LEN, ptp_ctx.delay_seq, 1);
+    ret = ptp_ctx.send(msg, PTP_SYNC_LEN, 1, &ts);
+    if (ret != SDK_OK)
+    {
+        return ret;
+    }
+    ptp_ctx.t3 = ptp_time_to_ns(&ts);
+    ptp_ctx.delay_pending = 1;
+    ptp_ctx.stat.delay_reqs++;
+
+    return SDK_OK;
+}
+
+void gd32_enet_ptp_stat_get(gd32_enet_ptp_stat_t *stat)
+{
+    *stat = ptp_ctx.stat;
+}
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2022 Infinitech Technology Co., Ltd
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     agent        first version
+ */
+
+#include <string.h>
+#include "sdk_board.h"
+#include "gd32_common.h"
+#include "gd32_enet.h"
+
+#define TM_MSC_NUM              6           /* counters read from the MSC block */
+
+/* in the order of gd32_enet_tm_counter_t */
+static const enet_msc_counter_enum tm_msc_reg[TM_MSC_NUM] =
+{
+    ENET_MSC_TX_TGFCNT, ENET_MSC_TX_SCCNT, ENET_MSC_TX_MSCCNT,
+    ENET_MSC_RX_RGUFCNT, ENET_MSC_RX_RFCECNT, ENET_MSC_RX_RFAECNT
+};
+
+static uint32_t tm_msc_last[TM_MSC_NUM];
+static uint32_t tm_last_ms;
+static gd32_enet_telemetry_t tm_data;
+
+int gd32_enet_telemetry_init(uint32_t now_ms)
+{
+    uint32_t i, fifo_drop, dma_drop;
+
+    /* free running counters that wrap, the deltas are taken in software */
+    enet_msc_feature_disable(ENET_MSC_RESET_ON_READ | ENET_MSC_COUNTER_STOP_ROLLOVER | ENET_MSC_COUNTERS_FREEZE);
+    for (i = 0; i < TM_MSC_NUM; i++)
+    {
+        tm_msc_last[i] = enet_msc_counters_get(tm_msc_reg[i]);
+    }
+    /* drop what was missed before */
+    enet_missed_frame_counter_get(&fifo_drop, &dma_drop);
+
+    memset(&tm_data, 0, sizeof(tm_data));
+    tm_last_ms = now_ms;
+
+    return SDK_OK;
+}
+
+static uint32_t tm_rate(uint32_t delta, uint32_t interval_ms)
+{
+    return (uint32_t)(((uint64_t)delta * 1000 + interval_ms / 2) / interval_ms);
+}
+
+void gd32_enet_telemetry_sample(uint32_t now_ms)
+{
+    uint32_t delta[GD32_ENET_TM_NUM];
+    uint32_t i, now, interval, level;
+    SDK_HW_CRITICAL_SITE(enet_tm_cs);
+
+    for (i = 0; i < TM_MSC_NUM; i++)
+    {
+        now = enet_msc_counters_get(tm_msc_reg[i]);
+        delta[i] = now - tm_msc_last[i];
+        tm_msc_last[i] = now;
+    }
+    enet_missed_frame_counter_get(&delta[GD32_ENET_TM_RX_FIFO_DROP], &delta[GD32_ENET_TM_RX_DMA_DROP]);
+    interval = now_ms - tm_last_ms;
+    tm_last_ms = now_ms;
+
+    /* readers see either the old or the new sample as a whole */
+    level = SDK_HW_CRITICAL_ENTER(enet_tm_cs);
+    for (i = 0; i < GD32_ENET_TM_NUM; i++)
+    {
+        tm_data.total[i] += delta[i];
+        tm_data.rate[i] = (interval != 0) ? tm_rate(delta[i], interval) : 0;
+    }
+    tm_data.interval_ms = interval;
+    tm_data.samples++;
+    SDK_HW_CRITICAL_EXIT(enet_tm_cs, level);
+}
+
+void gd32_enet_telemetry_get(gd32_enet_telemetry_t *tm)
+{
+    uint32_t level;
+    SDK_HW_CRITICAL_SITE(enet_tm_cs);
+
+    level = SDK_HW_CRITICAL_ENTER(enet_tm_cs);
+    *tm = tm_data;
+    SDK_HW_CRITICAL_EXIT(enet_tm_cs, level);
+}
+
+uint64_t gd32_enet_telemetry_total(gd32_enet_tm_counter_t counter)
+{
+    uint64_t total;
+    uint32_t level;
+    SDK_HW_CRITICAL_SITE(enet_tm_cs);
+
+    if ((uint32_t)counter >= GD32_ENET_TM_NUM)
+    {
+        return 0;
+    }
+
+    level = SDK_HW_CRITICAL_ENTER(enet_tm_cs);
+    total = tm_data.total[counter];
+    SDK_HW_CRITICAL_EXIT(enet_tm_cs, level);
+
+    return total;
+}
+
+uint32_t gd32_enet_telemetry_rate(gd32_enet_tm_counter_t counter)
+{
+    if ((uint32_t)counter >= GD32_ENET_TM_NUM)
+    {
+        return 0;
+    }
+
+    return tm_data.rate[counter];
+}
@@ -0,0 +1,309 @@
+/**
+ * Copyright (c) 2022 Infinitech Technology Co., Ltd
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     agent        first version
+ */
+
+#include <string.h>
+#include "sdk_board.h"
+#include "gd32_common.h"
+#include "gd32_enet.h"
+
+#define ETH_ADDR_LEN            12          /* destination and source addresses */
+#define ETH_HDR_LEN             14
+#define ETH_TYPE_VLAN           0x8100
+#define VLAN_TAG_LEN            4
+#define TXQ_BULK                (GD32_ENET_TXQ_NUM - 1)
+
+typedef struct
+{
+    const uint8_t *frame;
+    uint32_t len;
+    uint32_t tci;
+    void *token;
+    uint32_t enqueue_us;
+} txq_entry_t;
+
+typedef struct
+{
+    txq_entry_t entry[GD32_ENET_TXQ_DEPTH];
+    uint32_t head;
+    uint32_t count;
+    gd32_enet_txq_stat_t stat;
+} txq_t;
+
+typedef struct
+{
+    txq_t queue[GD32_ENET_TXQ_NUM];
+    gd32_enet_txq_release_t release;
+    uint32_t bulk_rate;                     /* bytes per second, 0 for no shaping */
+    uint32_t bulk_burst;                    /* bucket size in bytes */
+    uint32_t bulk_tokens;
+    uint32_t bulk_us;                       /* last refill */
+} txq_ctx_t;
+
+static txq_ctx_t txq_ctx;
+
+/* largest frame the ring takes, the buffers may be larger than the MAC allows */
+static uint32_t txq_len_max(void)
+{
+    uint32_t size = enet_txbuf_size_get();
+
+    return (size < ENET_MAX_FRAME_SIZE) ? size : ENET_MAX_FRAME_SIZE;
+}
+
+/* pass only tagged frames of this VLAN, 0 turns the filter off */
+int gd32_enet_vlan_filter_set(uint32_t vid)
+{
+    if (vid > 0xFFF)
+    {
+        return -SDK_E_INVALID;
+    }
+
+    ENET_MAC_VLT = (vid != 0) ? (ENET_VLANTAGCOMPARISON_12BIT | vid) : 0;
+
+    return SDK_OK;
+}
+
+/* strip the 802.1Q tag in place, returns the new frame start, tci is GD32_ENET_VLAN_NONE if untagged */
+uint8_t *gd32_enet_vlan_untag(uint8_t *frame, uint32_t *len, uint32_t *tci)
+{
+    if ((*len < ETH_HDR_LEN + VLAN_TAG_LEN) || (((frame[12] << 8) | frame[13]) != ETH_TYPE_VLAN))
+    {
+        *tci = GD32_ENET_VLAN_NONE;
+        return frame;
+    }
+
+    *tci = ((uint32_t)frame[14] << 8) | frame[15];
+    memmove(frame + VLAN_TAG_LEN, frame, ETH_ADDR_LEN);
+    *len -= VLAN_TAG_LEN;
+
+    return frame + VLAN_TAG_LEN;
+}
+
+/* bulk_rate in bytes per second shapes the last queue, 0 leaves it unshaped, call it after enet_ring_config() */
+int gd32_enet_txq_init(uint32_t bulk_rate, uint32_t bulk_burst, gd32_enet_txq_release_t release)
+{
+    if ((bulk_rate != 0) && (bulk_burst < txq_len_max()))
+    {
+        /* a full sized frame must fit in the bucket */
+        return -SDK_E_INVALID;
+    }
+    if (enet_txdesc_free_get() <= GD32_ENET_TXQ_RESERVE)
+    {
+        /* the ring is idle here, bulk would never get a descriptor */
+        return -SDK_E_INVALID;
+    }
+
+    memset(&txq_ctx, 0, sizeof(txq_ctx));
+    txq_ctx.release = release;
+    txq_ctx.bulk_rate = bulk_rate;
+    txq_ctx.bulk_burst = bulk_burst;
+    txq_ctx.bulk_tokens = bulk_burst;
+
+    return SDK_OK;
+}
+
+/* frame stays owned by the caller until the release callback gets token */
+int gd32_enet_txq_enqueue(uint32_t queue, const uint8_t *frame, uint32_t len, uint32_t tci, void *token, uint32_t now_us)
+{
+    txq_t *q;
+    txq_entry_t *e;
+    uint32_t level, extra;
+    SDK_HW_CRITICAL_SITE(enet_txq_cs);
+
+    if ((queue >= GD32_ENET_TXQ_NUM) || (frame == NULL) || (len < ETH_HDR_LEN))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    q = &txq_ctx.queue[queue];
+    extra = (tci != GD32_ENET_VLAN_NONE) ? VLAN_TAG_LEN : 0;
+    level = SDK_HW_CRITICAL_ENTER(enet_txq_cs);
+    if ((q->count >= GD32_ENET_TXQ_DEPTH) || (len + extra > txq_len_max()))
+    {
+        q->stat.dropped++;
+        SDK_HW_CRITICAL_EXIT(enet_txq_cs, level);
+        return (q->count >= GD32_ENET_TXQ_DEPTH) ? -SDK_E_FULL : -SDK_E_INVALID;
+    }
+
+    e = &q->entry[(q->head + q->count) % GD32_ENET_TXQ_DEPTH];
+    e->frame = frame;
+    e->len = len;
+    e->tci = tci;
+    e->token = token;
+    e->enqueue_us = now_us;
+    q->count++;
+    q->stat.depth = q->count;
+    if (q->count > q->stat.depth_max)
+    {
+        q->stat.depth_max = q->count;
+    }
+    SDK_HW_CRITICAL_EXIT(enet_txq_cs, level);
+
+    return SDK_OK;
+}
+
+static void txq_bulk_refill(uint32_t now_us)
+{
+    uint64_t tokens;
+
+    if (txq_ctx.bulk_rate == 0)
+    {
+        return;
+    }
+    tokens = txq_ctx.bulk_tokens + (uint64_t)(now_us - txq_ctx.bulk_us) * txq_ctx.bulk_rate / 1000000;
+    /* keep the fraction of a byte for the next refill */
+    if (tokens != txq_ctx.bulk_tokens)
+    {
+        txq_ctx.bulk_us = now_us;
+    }
+    txq_ctx.bulk_tokens = (tokens > txq_ctx.bulk_burst) ? txq_ctx.bulk_burst : (uint32_t)tokens;
+}
+
+/* bytes put on the wire for an entry, with the tag it gets on the way out */
+static uint32_t txq_wire_len(const txq_entry_t *e)
+{
+    return e->len + ((e->tci != GD32_ENET_VLAN_NONE) ? VLAN_TAG_LEN : 0);
+}
+
+/* the highest priority queue allowed to send now, -1 if none, avail is the count of free Tx descriptors */
+static int txq_pick(uint32_t avail)
+{
+    txq_t *q;
+    int i;
+
+    for (i = 0; i < GD32_ENET_TXQ_NUM; i++)
+    {
+        q = &txq_ctx.queue[i];
+        if (q->count == 0)
+        {
+            continue;
+        }
+        if ((i == TXQ_BULK) && (txq_ctx.bulk_rate != 0) && (txq_ctx.bulk_tokens < txq_wire_len(&q->entry[q->head])))
+        {
+            return -1;
+        }
+        /* bulk leaves the reserve to the higher queues, whatever its rate */
+        if ((i == TXQ_BULK) && (avail <= GD32_ENET_TXQ_RESERVE))
+        {
+            return -1;
+        }
+        return i;
+    }
+
+    return -1;
+}
+
+/*
+ * Move queued frames into the Tx ring while it has free descriptors, returns
+ * the number of frames handed to the DMA. Call it from the network thread
+ * after enqueuing and when Tx descriptors complete.
+ */
+uint32_t gd32_enet_txq_run(uint32_t now_us)
+{
+    txq_entry_t e;
+    txq_t *q;
+    uint8_t *buffer;
+    uint32_t sent = 0, level, latency, len, avail;
+    int i;
+    SDK_HW_CRITICAL_SITE(enet_txq_cs);
+
+    txq_bulk_refill(now_us);
+    while ((buffer = enet_txbuf_current_get()) != NULL)
+    {
+        avail = enet_txdesc_free_get();
+        level = SDK_HW_CRITICAL_ENTER(enet_txq_cs);
+        i = txq_pick(avail);
+        if (i < 0)
+        {
+            SDK_HW_CRITICAL_EXIT(enet_txq_cs, level);
+            break;
+        }
+        q = &txq_ctx.queue[i];
+        e = q->entry[q->head];
+        q->head = (q->head + 1) % GD32_ENET_TXQ_DEPTH;
+        q->count--;
+        q->stat.depth = q->count;
+        SDK_HW_CRITICAL_EXIT(enet_txq_cs, level);
+
+        /* copy into the DMA buffer, the tag goes after the addresses */
+        if (e.tci != GD32_ENET_VLAN_NONE)
+        {
+            memcpy(buffer, e.frame, ETH_ADDR_LEN);
+            buffer[12] = (uint8_t)(ETH_TYPE_VLAN >> 8);
+            buffer[13] = (uint8_t)ETH_TYPE_VLAN;
+            buffer[14] = (uint8_t)(e.tci >> 8);
+            buffer[15] = (uint8_t)e.tci;
+            memcpy(buffer + ETH_ADDR_LEN + VLAN_TAG_LEN, e.frame + ETH_ADDR_LEN, e.len - ETH_ADDR_LEN);
+            len = e.len + VLAN_TAG_LEN;
+        }
+        else
+        {
+            memcpy(buffer, e.frame, e.len);
+            len = e.len;
+        }
+
+        latency = now_us - e.enqueue_us;
+        if (enet_frame_transmit(NULL, len) != SUCCESS)
+        {
+            /* the frame goes back to the head of its queue, unless it filled up meanwhile */
+            level = SDK_HW_CRITICAL_ENTER(enet_txq_cs);
+            if (q->count < GD32_ENET_TXQ_DEPTH)
+            {
+                q->head = (q->head + GD32_ENET_TXQ_DEPTH - 1) % GD32_ENET_TXQ_DEPTH;
+                q->entry[q->head] = e;
+                q->count++;
+                q->stat.depth = q->count;
+                SDK_HW_CRITICAL_EXIT(enet_txq_cs, level);
+                break;
+            }
+            q->stat.dropped++;
+            SDK_HW_CRITICAL_EXIT(enet_txq_cs, level);
+            if (txq_ctx.release != NULL)
+            {
+                txq_ctx.release(e.token);
+            }
+            break;
+        }
+        if (txq_ctx.release != NULL)
+        {
+            txq_ctx.release(e.token);
+        }
+        if ((i == TXQ_BULK) && (txq_ctx.bulk_rate != 0))
+        {
+            txq_ctx.bulk_tokens -= len;
+        }
+
+        level = SDK_HW_CRITICAL_ENTER(enet_txq_cs);
+        q->stat.sent++;
+        q->stat.latency_last_us = latency;
+        q->stat.latency_sum_us += latency;
+        if (latency > q->stat.latency_max_us)
+        {
+            q->stat.latency_max_us = latency;
+        }
+        SDK_HW_CRITICAL_EXIT(enet_txq_cs, level);
+        sent++;
+    }
+
+    return sent;
+}
+
+void gd32_enet_txq_stat_get(uint32_t queue, gd32_enet_txq_stat_t *stat)
+{
+    uint32_t level;
+    SDK_HW_CRITICAL_SITE(enet_txq_cs);
+
+    if (queue >= GD32_ENET_TXQ_NUM)
+    {
+        memset(stat, 0, sizeof(*stat));
+        return;
+    }
+
+    level = SDK_HW_CRITICAL_ENTER(enet_txq_cs);
+    *stat = txq_ctx.queue[queue].stat;
+    SDK_HW_CRITICAL_EXIT(enet_txq_cs, level);
+}
@@ -0,0 +1,468 @@
+/**
+ * Copyright (c) 2022 Infinitech Technology Co., Ltd
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     agent        first version
+ */
+
+#include <string.h>
+#include "sdk_board.h"
+#include "gd32_enet.h"
+
+#define ETH_HDR_LEN             14
+#define ETH_TYPE_IP             0x0800
+#define ETH_TYPE_ARP            0x0806
+#define IP_HDR_LEN              20
+#define IP_PROTO_UDP            17
+#define IP_FLAG_DF              0x4000
+#define IP_FRAG_MASK            0x3FFF      /* MF flag and fragment offset */
+#define IP_TTL                  64
+#define UDP_HDR_LEN             8
+#define ARP_LEN                 28
+#define ARP_OP_REQUEST          1
+#define ARP_OP_REPLY            2
+
+#define ETH_FRAME_MAX           1514
+
+#define ARP_BACKOFF_MAX         4           /* the retry interval doubles up to 8 times */
+
+typedef struct
+{
+    uint32_t ip;                            /* 0 for a free entry */
+    uint8_t mac[6];
+} arp_entry_t;
+
+typedef struct
+{
+    uint8_t mac[6];
+    uint32_t ip;
+    uint32_t netmask;
+    uint32_t gateway;
+    gd32_enet_udp_rx_t rx;
+    arp_entry_t arp[GD32_ENET_ARP_NUM];
+    uint32_t arp_next;                      /* round robin replacement */
+    gd32_enet_udp_stat_t stat;
+} udp_ctx_t;
+
+static udp_ctx_t udp_ctx;
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static const uint8_t *arp_lookup(uint32_t ip)
+{
+    uint32_t i;
+
+    for (i = 0; i < GD32_ENET_ARP_NUM; i++)
+    {
+        if (udp_ctx.arp[i].ip == ip)
+        {
+            return udp_ctx.arp[i].mac;
+        }
+    }
+
+    return NULL;
+}
+
+static void arp_update(uint32_t ip, const uint8_t *mac)
+{
+    uint32_t i;
+
+    if (ip == 0)
+    {
+        return;
+    }
+    for (i = 0; i < GD32_ENET_ARP_NUM; i++)
+    {
+        if (udp_ctx.arp[i].ip == ip)
+        {
+            memcpy(udp_ctx.arp[i].mac, mac, 6);
+            return;
+        }
+    }
+    i = udp_ctx.arp_next;
+    udp_ctx.arp_next = (i + 1) % GD32_ENET_ARP_NUM;
+    udp_ctx.arp[i].ip = ip;
+    memcpy(udp_ctx.arp[i].mac, mac, 6);
+}
+
+/* largest datagram in one Tx buffer of the configured ring without IP fragmentation */
+static uint32_t udp_payload_max(void)
+{
+    uint32_t size = enet_txbuf_size_get();
+
+    if (size > ETH_FRAME_MAX)
+    {
+        size = ETH_FRAME_MAX;
+    }
+
+    return (size > GD32_ENET_UDP_HDR_LEN) ? (size - GD32_ENET_UDP_HDR_LEN) : 0;
+}
+
+/* one's complement sum of the 16 bit words, an odd last byte is padded with zero */
+static uint32_t inet_sum(uint32_t sum, const uint8_t *p, uint32_t len)
+{
+    while (len > 1)
+    {
+        sum += get16(p);
+        p += 2;
+        len -= 2;
+    }
+    if (len != 0)
+    {
+        sum += (uint32_t)p[0] << 8;
+    }
+
+    return sum;
+}
+
+static uint16_t inet_fold(uint32_t sum)
+{
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+
+    return (uint16_t)sum;
+}
+
+static int arp_send(uint16_t op, const uint8_t *dst_mac, uint32_t target_ip)
+{
+    static const uint8_t broadcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t frame[ETH_HDR_LEN + ARP_LEN];
+    uint8_t *arp = &frame[ETH_HDR_LEN];
+
+    memcpy(&frame[0], (dst_mac != NULL) ? dst_mac : broadcast, 6);
+    memcpy(&frame[6], udp_ctx.mac, 6);
+    put16(&frame[12], ETH_TYPE_ARP);
+    put16(&arp[0], 1);
+    put16(&arp[2], ETH_TYPE_IP);
+    arp[4] = 6;
+    arp[5] = 4;
+    put16(&arp[6], op);
+    memcpy(&arp[8], udp_ctx.mac, 6);
+    put32(&arp[14], udp_ctx.ip);
+    memset(&arp[18], 0, 6);
+    if (dst_mac != NULL)
+    {
+        memcpy(&arp[18], dst_mac, 6);
+    }
+    put32(&arp[24], target_ip);
+
+    /* the MAC pads it to the minimum frame size */
+    if (enet_frame_transmit(frame, sizeof(frame)) != SUCCESS)
+    {
+        udp_ctx.stat.tx_busy++;
+        return -SDK_E_BUSY;
+    }
+
+    return SDK_OK;
+}
+
+int gd32_enet_udp_init(const uint8_t *mac, uint32_t ip, uint32_t netmask, uint32_t gateway, gd32_enet_udp_rx_t rx)
+{
+    if ((mac == NULL) || (ip == 0))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    memset(&udp_ctx, 0, sizeof(udp_ctx));
+    memcpy(udp_ctx.mac, mac, 6);
+    udp_ctx.ip = ip;
+    udp_ctx.netmask = netmask;
+    udp_ctx.gateway = gateway;
+    udp_ctx.rx = rx;
+
+    return SDK_OK;
+}
+
+int gd32_enet_udp_flow_init(gd32_enet_udp_flow_t *flow, uint32_t dst_ip, uint16_t src_port, uint16_t dst_port)
+{
+    uint8_t *ip, *udp;
+
+    if ((flow == NULL) || (dst_ip == 0) || (udp_ctx.ip == 0))
+    {
+        return -SDK_E_INVALID;
+    }
+
+    memset(flow, 0, sizeof(*flow));
+    flow->dst_ip = dst_ip;
+    flow->next_hop = ((dst_ip ^ udp_ctx.ip) & udp_ctx.netmask) ? udp_ctx.gateway : dst_ip;
+    if (flow->next_hop == 0)
+    {
+        return -SDK_E_INVALID;
+    }
+
+    /* the destination MAC is filled in once resolved, lengths and checksums on each frame */
+    memcpy(&flow->hdr[6], udp_ctx.mac, 6);
+    put16(&flow->hdr[12], ETH_TYPE_IP);
+    ip = &flow->hdr[ETH_HDR_LEN];
+    ip[0] = 0x45;
+    put16(&ip[6], IP_FLAG_DF);
+    ip[8] = IP_TTL;
+    ip[9] = IP_PROTO_UDP;
+    put32(&ip[12], udp_ctx.ip);
+    put32(&ip[16], dst_ip);
+    udp = &ip[IP_HDR_LEN];
+    put16(&udp[0], src_port);
+    put16(&udp[2], dst_port);
+
+    gd32_enet_udp_resolve(flow);
+
+    return SDK_OK;
+}
+
+/*
+ * Returns SDK_OK once the destination MAC is known, asks for it by ARP
+ * otherwise. A flow sends at most one request per retry interval, and the
+ * interval doubles with each unanswered request, so that a sender polling
+ * an unresolved flow does not flood the link with broadcasts.
+ */
+int gd32_enet_udp_resolve(gd32_enet_udp_flow_t *flow)
+{
+    const uint8_t *mac;
+    uint32_t now, interval;
+
+    if (flow->resolved)
+    {
+        return SDK_OK;
+    }
+
+    mac = arp_lookup(flow->next_hop);
+    if (mac != NULL)
+    {
+        memcpy(&flow->hdr[0], mac, 6);
+        flow->resolved = 1;
+        flow->arp_tries = 0;
+        return SDK_OK;
+    }
+
+    now = sdk_hw_get_systick();
+    if (flow->arp_tries != 0)
+    {
+        interval = (uint32_t)GD32_ENET_ARP_RETRY_MS * SDK_SYSTICK_PER_SECOND / 1000;
+        interval <<= (flow->arp_tries < ARP_BACKOFF_MAX) ? (flow->arp_tries - 1) : (ARP_BACKOFF_MAX - 1);
+        if (now - flow->arp_tick < interval)
+        {
+            return -SDK_E_BUSY;
+        }
+    }
+
+    if (arp_send(ARP_OP_REQUEST, NULL, flow->next_hop) == SDK_OK)
+    {
+        udp_ctx.stat.arp_requests++;
+        flow->arp_tick = now;
+        if (flow->arp_tries < 0xFF)
+        {
+            flow->arp_tries++;
+        }
+    }
+
+    return -SDK_E_BUSY;
+}
+
+/*
+ * Take the current Tx DMA buffer for a datagram of the flow, returns where
+ * the payload is written and its largest length, or NULL when the ring is
+ * full or the destination is not resolved yet.
+ */
+uint8_t *gd32_enet_udp_tx_alloc(gd32_enet_udp_flow_t *flow, uint32_t *max_len)
+{
+    uint8_t *buffer;
+
+    if ((flow->resolved == 0) && (gd32_enet_udp_resolve(flow) != SDK_OK))
+    {
+        return NULL;
+    }
+    buffer = enet_txbuf_current_get();
+    if (buffer == NULL)
+    {
+        udp_ctx.stat.tx_busy++;
+        return NULL;
+    }
+
+    memcpy(buffer, flow->hdr, GD32_ENET_UDP_HDR_LEN);
+    if (max_len != NULL)
+    {
+        *max_len = udp_payload_max();
+    }
+
+    return buffer + GD32_ENET_UDP_HDR_LEN;
+}
+
+/* send the datagram filled after gd32_enet_udp_tx_alloc(), len is the payload length */
+int gd32_enet_udp_tx_send(gd32_enet_udp_flow_t *flow, uint32_t len)
+{
+    uint8_t *buffer, *ip;
+
+    if (len > udp_payload_max())
+    {
+        return -SDK_E_INVALID;
+    }
+    buffer = enet_txbuf_current_get();
+    if (buffer == NULL)
+    {
+        udp_ctx.stat.tx_busy++;
+        return -SDK_E_BUSY;
+    }
+
+    ip = buffer + ETH_HDR_LEN;
+    put16(&ip[2], (uint16_t)(IP_HDR_LEN + UDP_HDR_LEN + len));
+    put16(&ip[4], flow->ip_id++);
+    put16(&ip[IP_HDR_LEN + 4], (uint16_t)(UDP_HDR_LEN + len));
+    /* both checksums are inserted by the MAC, the fields must be zero */
+    put16(&ip[10], 0);
+    put16(&ip[IP_HDR_LEN + 6], 0);
+
+    if (enet_frame_transmit_checksum(NULL, GD32_ENET_UDP_HDR_LEN + len, ENET_CHECKSUM_TCPUDPICMP_FULL) != SUCCESS)
+    {
+        udp_ctx.stat.tx_busy++;
+        return -SDK_E_BUSY;
+    }
+    udp_ctx.stat.tx_frames++;
+    udp_ctx.stat.tx_bytes += len;
+
+    return SDK_OK;
+}
+
+static int udp_arp_input(const uint8_t *frame, uint32_t len)
+{
+    const uint8_t *arp = &frame[ETH_HDR_LEN];
+    uint32_t sender_ip;
+
+    if ((len < ETH_HDR_LEN + ARP_LEN) || (get16(&arp[0]) != 1) || (get16(&arp[2]) != ETH_TYPE_IP) ||
+        (arp[4] != 6) || (arp[5] != 4) || (get32(&arp[24]) != udp_ctx.ip))
+    {
+        return 0;
+    }
+
+    sender_ip = get32(&arp[14]);
+    arp_update(sender_ip, &arp[8]);
+    if ((get16(&arp[6]) == ARP_OP_REQUEST) && (arp_send(ARP_OP_REPLY, &arp[8], sender_ip) == SDK_OK))
+    {
+        udp_ctx.stat.arp_replies++;
+    }
+
+    return 1;
+}
+
+/*
+ * Takes the verdict of the Rx checksum offload, checksum holds its
+ * ENET_RXCSUM_x flags, and checks in software what it did not verify.
+ */
+static int udp_checksum_ok(const uint8_t *ip, uint32_t ihl, uint32_t ulen, uint32_t checksum)
+{
+    const uint8_t *udp = &ip[ihl];
+    uint32_t sum;
+
+    if (checksum & (ENET_RXCSUM_IPHDR_ERR | ENET_RXCSUM_PAYLOAD_ERR))
+    {
+        return 0;
+    }
+    if (((checksum & ENET_RXCSUM_IPHDR_OK) == 0) && (inet_fold(inet_sum(0, ip, ihl)) != 0xFFFF))
+    {
+        return 0;
+    }
+    /* a zero UDP checksum was not computed by the sender */
+    if (((checksum & ENET_RXCSUM_PAYLOAD_OK) == 0) && (get16(&udp[6]) != 0))
+    {
+        sum = inet_sum(IP_PROTO_UDP + ulen, &ip[12], 8);
+        if (inet_fold(inet_sum(sum, udp, ulen)) != 0xFFFF)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int udp_ip_input(const uint8_t *frame, uint32_t len, uint32_t checksum)
+{
+    const uint8_t *ip = &frame[ETH_HDR_LEN];
+    const uint8_t *udp;
+    uint32_t ihl, total, ulen;
+
+    if ((len < ETH_HDR_LEN + IP_HDR_LEN) || ((ip[0] >> 4) != 4) || (get32(&ip[16]) != udp_ctx.ip) ||
+        (ip[9] != IP_PROTO_UDP))
+    {
+        return 0;
+    }
+
+    ihl = (uint32_t)(ip[0] & 0x0F) * 4;
+    total = get16(&ip[2]);
+    if ((ihl < IP_HDR_LEN) || (total < ihl + UDP_HDR_LEN) || (ETH_HDR_LEN + total > len) ||
+        (get16(&ip[6]) & IP_FRAG_MASK) || (udp_ctx.rx == NULL))
+    {
+        udp_ctx.stat.rx_dropped++;
+        return 1;
+    }
+    udp = &ip[ihl];
+    ulen = get16(&udp[4]);
+    if ((ulen < UDP_HDR_LEN) || (ulen > total - ihl))
+    {
+        udp_ctx.stat.rx_dropped++;
+        return 1;
+    }
+    if (!udp_checksum_ok(ip, ihl, ulen, checksum))
+    {
+        udp_ctx.stat.rx_dropped++;
+        udp_ctx.stat.rx_checksum_err++;
+        return 1;
+    }
+
+    udp_ctx.stat.rx_frames++;
+    udp_ctx.rx(get32(&ip[12]), get16(&udp[0]), get16(&udp[2]), &udp[UDP_HDR_LEN], ulen - UDP_HDR_LEN);
+
+    return 1;
+}
+
+/*
+ * Offer a received frame to the fast path, returns 1 when it took the frame
+ * (ARP for this host, UDP datagrams for this host), 0 to pass it on.
+ * checksum is the result of the Rx checksum offload for the frame, from
+ * enet_rxframe_checksum_get() or the checksum of a lent frame, 0 when unknown.
+ */
+int gd32_enet_udp_input(const uint8_t *frame, uint32_t len, uint32_t checksum)
+{
+    if ((frame == NULL) || (len < ETH_HDR_LEN) || (udp_ctx.ip == 0))
+    {
+        return 0;
+    }
+
+    switch (get16(&frame[12]))
+    {
+    case ETH_TYPE_ARP:
+        return udp_arp_input(frame, len);
+    case ETH_TYPE_IP:
+        return udp_ip_input(frame, len, checksum);
+    default:
+        return 0;
+    }
+}
+
+void gd32_enet_udp_stat_get(gd32_enet_udp_stat_t *stat)
+{
+    *stat = udp_ctx.stat;
+}
@@ -8,6 +8,7 @@
 
 #include "sdk_board.h"
 #include "sdk_flash.h"
+#include "gd32_common.h"
 
 #define DBG_LVL DBG_LOG
 #define DBG_TAG "mcu.flash"
@@ -227,9 +228,11 @@ int32_t gd32_flash_read(sdk_flash_t *flash, uint32_t addr, uint8_t *buf, size_t
 
 int32_t gd32_flash_write(sdk_flash_t *flash, uint32_t addr, const uint8_t *buf, size_t size)
 {
+    uint32_t level;
     sdk_err_t result = SDK_OK;
     fmc_state_enum fmc_state = FMC_READY;
     uint32_t end_addr = addr + size;
+    SDK_HW_CRITICAL_SITE(flash_write_cs);
 
     if (addr % 4 != 0)
     {
@@ -243,7 +246,7 @@ int32_t gd32_flash_write(sdk_flash_t *flash, uint32_t addr, const uint8_t *buf,
         return -SDK_E_INVALID;
     }
 
-    sdk_hw_interrupt_disable();
+    level = SDK_HW_CRITICAL_ENTER(flash_write_cs);
     fmc_unlock();
     fmc_flag_clear(FMC_FLAG_END | FMC_FLAG_OPERR | FMC_FLAG_WPERR | FMC_FLAG_PGMERR | FMC_FLAG_PGSERR);
     while (addr < end_addr)
@@ -269,7 +272,7 @@ int32_t gd32_flash_write(sdk_flash_t *flash, uint32_t addr, const uint8_t *buf,
     }
 
     fmc_lock();
-    sdk_hw_interrupt_enable();
+    SDK_HW_CRITICAL_EXIT(flash_write_cs, level);
 
     if (result != SDK_OK)
     {
@@ -281,8 +284,10 @@ int32_t gd32_flash_write(sdk_flash_t *flash, uint32_t addr, const uint8_t *buf,
 
 sdk_err_t gd32_flash_erase(sdk_flash_t *flash, uint32_t addr, size_t size)
 {
+    uint32_t level;
     sdk_err_t result = SDK_OK;
     uint32_t first_sector_name = 0, num_of_sectors = 0;
+    SDK_HW_CRITICAL_SITE(flash_erase_cs);
 
     if ((addr + size) > MCU_FLASH_END_ADDRESS)
     {
@@ -290,7 +295,7 @@ sdk_err_t gd32_flash_erase(sdk_flash_t *flash, uint32_t addr, size_t size)
         return -SDK_E_INVALID;
     }
 
-    sdk_hw_interrupt_disable();
+    level = SDK_HW_CRITICAL_ENTER(flash_erase_cs);
     fmc_unlock();
     /* Get the 1st sector to erase */
     first_sector_name = get_sector_name(addr);
@@ -314,7 +319,7 @@ sdk_err_t gd32_flash_erase(sdk_flash_t *flash, uint32_t addr, size_t size)
 
 __exit:
     fmc_lock();
-    sdk_hw_interrupt_enable();
+    SDK_HW_CRITICAL_EXIT(flash_erase_cs, level);
 
     if (result != SDK_OK)
     {
@@ -6,6 +6,7 @@
 
 #include "sdk_board.h"
 #include "sdk_uart.h"
+#include "gd32_common.h"
 
 extern sdk_uart_t uart0;
 
@@ -132,6 +133,9 @@ static int32_t gd32_uart_getc(sdk_uart_t *uart)
 
 static int32_t gd32_uart_control(sdk_uart_t *uart, int32_t cmd, void *args)
 {
+    uint32_t level;
+    SDK_HW_CRITICAL_SITE(uart_dma_cs);
+
     switch (cmd)
     {
     case SDK_CONTROL_UART_DISABLE_INT:
@@ -147,14 +151,19 @@ static int32_t gd32_uart_control(sdk_uart_t *uart, int32_t cmd, void *args)
         usart_interrupt_enable(uart->instance, USART_INT_RBNE);
         break;
     case SDK_CONTROL_UART_ENABLE_DMA:
+        /* switch register mode and write op together, a writer in an isr must not see them mixed */
+        level = SDK_HW_CRITICAL_ENTER(uart_dma_cs);
         usart_dma_receive_config(uart->instance, USART_RECEIVE_DMA_ENABLE);
         usart_dma_transmit_config(uart->instance, USART_TRANSMIT_DMA_ENABLE);
         uart->ops.write = gd32_uart_write_dma;
+        SDK_HW_CRITICAL_EXIT(uart_dma_cs, level);
         break;
     case SDK_CONTROL_UART_DISABLE_DMA:
+        level = SDK_HW_CRITICAL_ENTER(uart_dma_cs);
         usart_dma_receive_config(uart->instance, USART_RECEIVE_DMA_DISABLE);
         usart_dma_transmit_config(uart->instance, USART_TRANSMIT_DMA_DISABLE);
         uart->ops.write = gd32_uart_write;
+        SDK_HW_CRITICAL_EXIT(uart_dma_cs, level);
         break;
     default:
         return -SDK_E_INVALID;